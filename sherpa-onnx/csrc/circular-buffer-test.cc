@@ -147,4 +147,89 @@ TEST(CircularBuffer, PushAndPop) {
   EXPECT_EQ(c[1], 4000);
 }
 
+TEST(CircularBuffer, Chunks) {
+  // capacity 4, 3 elements per chunk
+  CircularBuffer buffer(4, 3);
+
+  std::vector<float> a;
+  for (int32_t i = 0; i != 20; ++i) {
+    a.push_back(i);
+  }
+
+  buffer.Push(a.data(), 8);
+  EXPECT_EQ(buffer.Size(), 8);
+
+  auto c = buffer.Get(1, 7);
+  EXPECT_EQ(c.size(), 7);
+  for (int32_t i = 0; i != 7; ++i) {
+    EXPECT_EQ(c[i], i + 1);
+  }
+
+  buffer.Pop(5);
+  buffer.Push(a.data() + 8, 12);
+  EXPECT_EQ(buffer.Size(), 15);
+  EXPECT_EQ(buffer.Head(), 5);
+  EXPECT_EQ(buffer.Tail(), 20);
+
+  c = buffer.Get(5, 15);
+  EXPECT_EQ(c.size(), 15);
+  for (int32_t i = 0; i != 15; ++i) {
+    EXPECT_EQ(c[i], i + 5);
+  }
+
+  buffer.Reset();
+  EXPECT_EQ(buffer.Size(), 0);
+
+  buffer.Push(a.data(), 2);
+  c = buffer.Get(0, 2);
+  EXPECT_EQ(c.size(), 2);
+  EXPECT_EQ(c[0], 0);
+  EXPECT_EQ(c[1], 1);
+}
+
+TEST(CircularBuffer, View) {
+  CircularBuffer buffer(10, 4);
+
+  std::vector<float> a;
+  for (int32_t i = 0; i != 10; ++i) {
+    a.push_back(i);
+  }
+  buffer.Push(a.data(), a.size());
+
+  // [2, 3], [4, 5, 6, 7], [8]
+  auto v = buffer.View(2, 7);
+  EXPECT_EQ(v.Start(), 2);
+  EXPECT_EQ(v.Size(), 7);
+  EXPECT_EQ(v.NumParts(), 3);
+
+  int32_t n = 0;
+  const float *p = v.Part(0, &n);
+  EXPECT_EQ(n, 2);
+  EXPECT_EQ(p[0], 2);
+
+  p = v.Part(1, &n);
+  EXPECT_EQ(n, 4);
+  EXPECT_EQ(p[0], 4);
+  EXPECT_EQ(p[3], 7);
+
+  p = v.Part(2, &n);
+  EXPECT_EQ(n, 1);
+  EXPECT_EQ(p[0], 8);
+
+  // The view is still valid after popping elements before it
+  buffer.Pop(2);
+  std::vector<float> c = v.ToVector();
+  EXPECT_EQ(c.size(), 7);
+  for (int32_t i = 0; i != 7; ++i) {
+    EXPECT_EQ(c[i], i + 2);
+  }
+
+  v = buffer.View(4, 4);
+  EXPECT_EQ(v.NumParts(), 1);
+
+  v = buffer.View(0, 1);
+  EXPECT_EQ(v.Size(), 0);
+  EXPECT_EQ(v.NumParts(), 0);
+}
+
 }  // namespace sherpa_onnx
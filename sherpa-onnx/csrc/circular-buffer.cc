@@ -10,162 +10,127 @@
 
 namespace sherpa_onnx {
 
-CircularBuffer::CircularBuffer(int32_t capacity) {
-  if (capacity <= 0) {
-    SHERPA_ONNX_LOGE("Please specify a positive capacity. Given: %d\n",
-                     capacity);
-    exit(-1);
+int32_t CircularBufferView::NumParts() const {
+  if (n_ == 0) {
+    return 0;
   }
-  buffer_.resize(capacity);
+
+  int32_t chunk_size = buffer_->chunk_size_;
+  return (start_ + n_ - 1) / chunk_size - start_ / chunk_size + 1;
 }
 
-void CircularBuffer::Resize(int32_t new_capacity) {
-  int32_t capacity = static_cast<int32_t>(buffer_.size());
-  if (new_capacity <= capacity) {
-#if __OHOS__
-    SHERPA_ONNX_LOGE(
-        "new_capacity (%{public}d) <= original capacity (%{public}d). Skip it.",
-        new_capacity, capacity);
-#else
-    SHERPA_ONNX_LOGE("new_capacity (%d) <= original capacity (%d). Skip it.",
-                     new_capacity, capacity);
-#endif
-    return;
-  }
+const float *CircularBufferView::Part(int32_t i, int32_t *n) const {
+  int32_t chunk_size = buffer_->chunk_size_;
 
-  int32_t size = Size();
-  if (size == 0) {
-    buffer_.resize(new_capacity);
-    return;
-  }
+  // index of the first element of this part
+  int32_t begin =
+      i == 0 ? start_ : (start_ / chunk_size + i) * chunk_size;
+  int32_t end = std::min((begin / chunk_size + 1) * chunk_size, start_ + n_);
 
-  std::vector<float> new_buffer(new_capacity);
-  int32_t start = head_ % capacity;
-  int32_t dest = head_ % new_capacity;
+  *n = end - begin;
 
-  if (start + size <= capacity) {
-    if (dest + size <= new_capacity) {
-      std::copy(buffer_.begin() + start, buffer_.begin() + start + size,
-                new_buffer.begin() + dest);
-    } else {
-      int32_t part1_size = new_capacity - dest;
+  return buffer_->ChunkData(begin) + begin % chunk_size;
+}
 
-      // copy [start, start+part1_size] to new_buffer
-      std::copy(buffer_.begin() + start, buffer_.begin() + start + part1_size,
-                new_buffer.begin() + dest);
+void CircularBufferView::CopyTo(float *dst) const {
+  int32_t num_parts = NumParts();
+  for (int32_t i = 0; i != num_parts; ++i) {
+    int32_t n = 0;
+    const float *p = Part(i, &n);
+    std::copy(p, p + n, dst);
+    dst += n;
+  }
+}
 
-      // copy [start+part1_size, start+size] to new_buffer
-      std::copy(buffer_.begin() + start + part1_size,
-                buffer_.begin() + start + size, new_buffer.begin());
-    }
-  } else {
-    int32_t part1_size = capacity - start;
-    int32_t part2_size = size - part1_size;
-
-    // copy [start, start+part1_size] to new_buffer
-    if (dest + part1_size <= new_capacity) {
-      std::copy(buffer_.begin() + start, buffer_.begin() + start + part1_size,
-                new_buffer.begin() + dest);
-    } else {
-      int32_t first_part = new_capacity - dest;
-      std::copy(buffer_.begin() + start, buffer_.begin() + start + first_part,
-                new_buffer.begin() + dest);
+std::vector<float> CircularBufferView::ToVector() const {
+  std::vector<float> ans(n_);
+  CopyTo(ans.data());
+  return ans;
+}
 
-      std::copy(buffer_.begin() + start + first_part,
-                buffer_.begin() + start + part1_size, new_buffer.begin());
-    }
+CircularBuffer::CircularBuffer(int32_t capacity, int32_t chunk_size /*= 4096*/)
+    : chunk_size_(std::min(chunk_size, capacity)) {
+  if (capacity <= 0) {
+    SHERPA_ONNX_LOGE("Please specify a positive capacity. Given: %d\n",
+                     capacity);
+    exit(-1);
+  }
 
-    int32_t new_dest = (dest + part1_size) % new_capacity;
+  if (chunk_size <= 0) {
+    SHERPA_ONNX_LOGE("Please specify a positive chunk size. Given: %d\n",
+                     chunk_size);
+    exit(-1);
+  }
 
-    if (new_dest + part2_size <= new_capacity) {
-      std::copy(buffer_.begin(), buffer_.begin() + part2_size,
-                new_buffer.begin() + new_dest);
-    } else {
-      int32_t first_part = new_capacity - new_dest;
-      std::copy(buffer_.begin(), buffer_.begin() + first_part,
-                new_buffer.begin() + new_dest);
-      std::copy(buffer_.begin() + first_part, buffer_.begin() + part2_size,
-                new_buffer.begin());
-    }
+  int32_t num_chunks = (capacity + chunk_size_ - 1) / chunk_size_;
+  pool_.reserve(num_chunks);
+  for (int32_t i = 0; i != num_chunks; ++i) {
+    pool_.push_back(std::make_unique<float[]>(chunk_size_));
   }
-  buffer_.swap(new_buffer);
 }
 
 void CircularBuffer::Push(const float *p, int32_t n) {
-  int32_t capacity = static_cast<int32_t>(buffer_.size());
-  int32_t size = Size();
-  if (n + size > capacity) {
-    int32_t new_capacity = std::max(capacity * 2, n + size);
-#if __OHOS__
-    SHERPA_ONNX_LOGE(
-        "Overflow! n: %{public}d, size: %{public}d, n+size: %{public}d, "
-        "capacity: %{public}d. Increase "
-        "capacity to: %{public}d. (Original data is copied. No data loss!)",
-        n, size, n + size, capacity, new_capacity);
-#else
-    SHERPA_ONNX_LOGE(
-        "Overflow! n: %d, size: %d, n+size: %d, capacity: %d. Increase "
-        "capacity to: %d. (Original data is copied. No data loss!)",
-        n, size, n + size, capacity, new_capacity);
-#endif
-    Resize(new_capacity);
-
-    capacity = new_capacity;
+  // Get more chunks if needed
+  while ((first_chunk_ + static_cast<int32_t>(chunks_.size())) * chunk_size_ <
+         tail_ + n) {
+    if (!pool_.empty()) {
+      chunks_.push_back(std::move(pool_.back()));
+      pool_.pop_back();
+    } else {
+      chunks_.push_back(std::make_unique<float[]>(chunk_size_));
+    }
   }
 
-  int32_t start = tail_ % capacity;
+  while (n > 0) {
+    int32_t offset = tail_ % chunk_size_;
+    int32_t k = std::min(n, chunk_size_ - offset);
 
-  tail_ += n;
+    std::copy(p, p + k,
+              chunks_[tail_ / chunk_size_ - first_chunk_].get() + offset);
 
-  if (start + n < capacity) {
-    std::copy(p, p + n, buffer_.begin() + start);
-    return;
+    p += k;
+    n -= k;
+    tail_ += k;
   }
-
-  int32_t part1_size = capacity - start;
-
-  std::copy(p, p + part1_size, buffer_.begin() + start);
-
-  std::copy(p + part1_size, p + n, buffer_.begin());
 }
 
-std::vector<float> CircularBuffer::Get(int32_t start_index, int32_t n) const {
+bool CircularBuffer::Check(int32_t start_index, int32_t n) const {
   if (start_index < head_ || start_index >= tail_) {
     SHERPA_ONNX_LOGE("Invalid start_index: %d. head_: %d, tail_: %d",
                      start_index, head_, tail_);
-    return {};
+    return false;
   }
 
   int32_t size = Size();
   if (n < 0 || n > size) {
     SHERPA_ONNX_LOGE("Invalid n: %d. size: %d", n, size);
-    return {};
+    return false;
   }
 
-  int32_t capacity = static_cast<int32_t>(buffer_.size());
-
   if (start_index - head_ + n > size) {
     SHERPA_ONNX_LOGE("Invalid start_index: %d and n: %d. head_: %d, size: %d",
                      start_index, n, head_, size);
-    return {};
+    return false;
   }
 
-  int32_t start = start_index % capacity;
+  return true;
+}
 
-  if (start + n < capacity) {
-    return {buffer_.begin() + start, buffer_.begin() + start + n};
+std::vector<float> CircularBuffer::Get(int32_t start_index, int32_t n) const {
+  if (!Check(start_index, n)) {
+    return {};
   }
 
-  std::vector<float> ans(n);
-
-  std::copy(buffer_.begin() + start, buffer_.end(), ans.begin());
+  return CircularBufferView(this, start_index, n).ToVector();
+}
 
-  int32_t part1_size = capacity - start;
-  int32_t part2_size = n - part1_size;
-  std::copy(buffer_.begin(), buffer_.begin() + part2_size,
-            ans.begin() + part1_size);
+CircularBufferView CircularBuffer::View(int32_t start_index,
+                                        int32_t n) const {
+  if (!Check(start_index, n)) {
+    return {};
+  }
 
-  return ans;
+  return CircularBufferView(this, start_index, n);
 }
 
 void CircularBuffer::Pop(int32_t n) {
@@ -176,6 +141,24 @@ void CircularBuffer::Pop(int32_t n) {
   }
 
   head_ += n;
+
+  // Return chunks that are no longer used to the pool
+  while (!chunks_.empty() && (first_chunk_ + 1) * chunk_size_ <= head_) {
+    pool_.push_back(std::move(chunks_.front()));
+    chunks_.pop_front();
+    ++first_chunk_;
+  }
+}
+
+void CircularBuffer::Reset() {
+  while (!chunks_.empty()) {
+    pool_.push_back(std::move(chunks_.front()));
+    chunks_.pop_front();
+  }
+
+  first_chunk_ = 0;
+  head_ = 0;
+  tail_ = 0;
 }
 
 }  // namespace sherpa_onnx
@@ -5,22 +5,68 @@
 #define SHERPA_ONNX_CSRC_CIRCULAR_BUFFER_H_
 
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <vector>
 
 namespace sherpa_onnx {
 
+class CircularBuffer;
+
+// A read-only view of consecutive elements in a CircularBuffer.
+// No data is copied. Since elements are stored in fixed-size chunks,
+// the view may consist of several contiguous parts.
+//
+// It is valid until the viewed elements are popped from the buffer.
+class CircularBufferView {
+ public:
+  CircularBufferView() = default;
+
+  // Index of the first element in the buffer
+  int32_t Start() const { return start_; }
+
+  // Number of elements in this view
+  int32_t Size() const { return n_; }
+
+  // Number of contiguous parts
+  int32_t NumParts() const;
+
+  // Return the start address of the i-th part and set *n to its size.
+  //
+  // @param i Should be in the range [0, NumParts())
+  const float *Part(int32_t i, int32_t *n) const;
+
+  // Copy all elements to dst, which must have space for Size() elements
+  void CopyTo(float *dst) const;
+
+  std::vector<float> ToVector() const;
+
+ private:
+  friend class CircularBuffer;
+
+  CircularBufferView(const CircularBuffer *buffer, int32_t start, int32_t n)
+      : buffer_(buffer), start_(start), n_(n) {}
+
+  const CircularBuffer *buffer_ = nullptr;
+  int32_t start_ = 0;
+  int32_t n_ = 0;
+};
+
+// Elements are stored in fixed-size chunks. Chunks that are no longer
+// used after Pop() are kept in a pool and reused by later Push() calls,
+// so no memory is allocated once the buffer has reached its peak size.
 class CircularBuffer {
  public:
-  // Capacity of this buffer. Should be large enough.
-  // If it is full, we just print a message and exit the program.
-  explicit CircularBuffer(int32_t capacity);
+  // @param capacity Number of elements to pre-allocate. The buffer grows
+  //                 by chunk_size elements when it is full.
+  // @param chunk_size Number of elements per chunk. If it is larger than
+  //                   capacity, capacity is used.
+  explicit CircularBuffer(int32_t capacity, int32_t chunk_size = 4096);
 
   // Push an array
   //
   // @param p Pointer to the start address of the array
   // @param n Number of elements in the array
-  //
-  // Note: If n + Size() > capacity, we print an error message and exit.
   void Push(const float *p, int32_t n);
 
   // @param start_index Should in the range [head_, tail_)
@@ -28,6 +74,10 @@ class CircularBuffer {
   // @return Return a vector of size n containing the requested elements
   std::vector<float> Get(int32_t start_index, int32_t n) const;
 
+  // Like Get() but it returns a view of the requested elements without
+  // copying them. An empty view is returned on error.
+  CircularBufferView View(int32_t start_index, int32_t n) const;
+
   // Remove n elements from the buffer
   //
   // @param n Should be in the range [0, size_]
@@ -42,15 +92,28 @@ class CircularBuffer {
   // Current position of the tail
   int32_t Tail() const { return tail_; }
 
-  void Reset() {
-    head_ = 0;
-    tail_ = 0;
+  void Reset();
+
+ private:
+  friend class CircularBufferView;
+
+  // Return the start address of the chunk containing the given element
+  const float *ChunkData(int32_t index) const {
+    return chunks_[index / chunk_size_ - first_chunk_].get();
   }
 
-  void Resize(int32_t new_capacity);
+  bool Check(int32_t start_index, int32_t n) const;
 
  private:
-  std::vector<float> buffer_;
+  int32_t chunk_size_;
+
+  // chunks_[i] contains elements in the range
+  // [(first_chunk_ + i) * chunk_size_, (first_chunk_ + i + 1) * chunk_size_)
+  std::deque<std::unique_ptr<float[]>> chunks_;
+  int32_t first_chunk_ = 0;
+
+  // chunks that are not in use
+  std::vector<std::unique_ptr<float[]>> pool_;
 
   int32_t head_ = 0;  // linear index; always increasing; never wraps around
   int32_t tail_ = 0;  // linear index, always increasing; never wraps around.
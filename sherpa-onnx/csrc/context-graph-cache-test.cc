@@ -0,0 +1,66 @@
+// sherpa-onnx/csrc/context-graph-cache-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/context-graph-cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static ContextGraphPtr BuildGraph(const std::string &s, int32_t *num_builds) {
+  ++*num_builds;
+  std::vector<std::vector<int32_t>> token_ids = {{s.begin(), s.end()}};
+  return std::make_shared<ContextGraph>(token_ids, 1.0f);
+}
+
+TEST(ContextGraphCache, Hit) {
+  ContextGraphCache cache(2);
+  int32_t num_builds = 0;
+
+  auto build = [&]() { return BuildGraph("HELLO", &num_builds); };
+
+  auto a = cache.Get("HELLO", build);
+  auto b = cache.Get("HELLO", build);
+
+  EXPECT_EQ(num_builds, 1);
+  EXPECT_EQ(a.get(), b.get());
+  EXPECT_EQ(cache.Size(), 1);
+}
+
+TEST(ContextGraphCache, Evict) {
+  ContextGraphCache cache(2);
+  int32_t num_builds = 0;
+
+  auto a = cache.Get("A", [&]() { return BuildGraph("A", &num_builds); });
+  cache.Get("B", [&]() { return BuildGraph("B", &num_builds); });
+
+  // A is now the most recently used one, so C evicts B
+  cache.Get("A", [&]() { return BuildGraph("A", &num_builds); });
+  cache.Get("C", [&]() { return BuildGraph("C", &num_builds); });
+  EXPECT_EQ(num_builds, 3);
+  EXPECT_EQ(cache.Size(), 2);
+
+  auto a2 = cache.Get("A", [&]() { return BuildGraph("A", &num_builds); });
+  EXPECT_EQ(num_builds, 3);
+  EXPECT_EQ(a.get(), a2.get());
+
+  cache.Get("B", [&]() { return BuildGraph("B", &num_builds); });
+  EXPECT_EQ(num_builds, 4);
+}
+
+TEST(ContextGraphCache, Disabled) {
+  ContextGraphCache cache(0);
+  int32_t num_builds = 0;
+
+  cache.Get("A", [&]() { return BuildGraph("A", &num_builds); });
+  cache.Get("A", [&]() { return BuildGraph("A", &num_builds); });
+  EXPECT_EQ(num_builds, 2);
+  EXPECT_EQ(cache.Size(), 0);
+}
+
+}  // namespace sherpa_onnx
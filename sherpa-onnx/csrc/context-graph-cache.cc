@@ -0,0 +1,61 @@
+// sherpa-onnx/csrc/context-graph-cache.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/context-graph-cache.h"
+
+#include <string>
+#include <utility>
+
+namespace sherpa_onnx {
+
+ContextGraphPtr ContextGraphCache::Get(
+    const std::string &key, const std::function<ContextGraphPtr()> &build) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      items_.splice(items_.begin(), items_, it->second);
+      return it->second->second;
+    }
+  }
+
+  ContextGraphPtr graph = build();
+
+  if (capacity_ <= 0) {
+    return graph;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // Another thread has built it in the meantime. Use the cached one so
+    // that all streams share a single copy.
+    items_.splice(items_.begin(), items_, it->second);
+    return it->second->second;
+  }
+
+  items_.emplace_front(key, graph);
+  index_[key] = items_.begin();
+
+  while (static_cast<int32_t>(items_.size()) > capacity_) {
+    index_.erase(items_.back().first);
+    items_.pop_back();
+  }
+
+  return graph;
+}
+
+int32_t ContextGraphCache::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int32_t>(items_.size());
+}
+
+void ContextGraphCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  items_.clear();
+  index_.clear();
+}
+
+}  // namespace sherpa_onnx
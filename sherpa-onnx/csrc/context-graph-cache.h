@@ -0,0 +1,56 @@
+// sherpa-onnx/csrc/context-graph-cache.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_CONTEXT_GRAPH_CACHE_H_
+#define SHERPA_ONNX_CSRC_CONTEXT_GRAPH_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "sherpa-onnx/csrc/context-graph.h"
+
+namespace sherpa_onnx {
+
+// A thread-safe LRU cache of compiled context graphs, keyed by the
+// hotwords string they are built from.
+//
+// A ContextGraph is not changed after it is built, so a cached graph is
+// shared by all streams created with the same hotwords.
+class ContextGraphCache {
+ public:
+  explicit ContextGraphCache(int32_t capacity = 256) : capacity_(capacity) {}
+
+  /* Return the graph for the given key. If it is not in the cache,
+   * build() is called to create it.
+   *
+   * build() is called without holding the lock, so that a slow build does
+   * not block streams that hit the cache.
+   */
+  ContextGraphPtr Get(const std::string &key,
+                      const std::function<ContextGraphPtr()> &build);
+
+  int32_t Size() const;
+
+  void Clear();
+
+ private:
+  using Item = std::pair<std::string, ContextGraphPtr>;
+
+  int32_t capacity_;
+
+  mutable std::mutex mutex_;
+
+  // Most recently used first
+  std::list<Item> items_;
+  std::unordered_map<std::string, std::list<Item>::iterator> index_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_CONTEXT_GRAPH_CACHE_H_
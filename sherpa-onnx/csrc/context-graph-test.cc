@@ -6,6 +6,9 @@
 
 #include <chrono>  // NOLINT
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
 #include <map>
 #include <random>
 #include <string>
@@ -74,6 +77,84 @@ TEST(ContextGraph, TestCustomizeNonStrict) {
   TestHelper(queries, 5, false);
 }
 
+TEST(ContextGraph, SaveAndLoad) {
+  std::vector<std::string> contexts_str({"HE", "SHE", "HIS", "HERS"});
+  std::vector<std::vector<int32_t>> contexts;
+  for (const auto &s : contexts_str) {
+    contexts.emplace_back(s.begin(), s.end());
+  }
+
+  ContextGraph graph(contexts, 1, 0.5, {}, contexts_str);
+
+  std::string filename = "context-graph-test.bin";
+  graph.Save(filename);
+
+  {
+    auto loaded = ContextGraph::Load(filename);
+    EXPECT_EQ(loaded->NumStates(), graph.NumStates());
+
+    std::string query = "USHERS";
+    auto state = graph.Root();
+    auto loaded_state = loaded->Root();
+    for (auto q : query) {
+      auto res = graph.ForwardOneStep(state, q);
+      auto loaded_res = loaded->ForwardOneStep(loaded_state, q);
+      EXPECT_EQ(std::get<0>(res), std::get<0>(loaded_res));
+
+      state = std::get<1>(res);
+      loaded_state = std::get<1>(loaded_res);
+      EXPECT_EQ(state - graph.Root(), loaded_state - loaded->Root());
+
+      auto matched = graph.IsMatched(state);
+      auto loaded_matched = loaded->IsMatched(loaded_state);
+      EXPECT_EQ(matched.first, loaded_matched.first);
+      if (matched.first) {
+        EXPECT_EQ(graph.Phrase(matched.second),
+                  loaded->Phrase(loaded_matched.second));
+      }
+    }
+
+    // USHERS ends with HERS
+    auto matched = loaded->IsMatched(loaded_state);
+    EXPECT_TRUE(matched.first);
+    EXPECT_EQ(loaded->Phrase(matched.second), "HERS");
+    EXPECT_EQ(matched.second->level, 4);
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(ContextGraph, LoadCorrupted) {
+  std::vector<std::string> contexts_str({"HE", "SHE", "HIS", "HERS"});
+  std::vector<std::vector<int32_t>> contexts;
+  for (const auto &s : contexts_str) {
+    contexts.emplace_back(s.begin(), s.end());
+  }
+
+  ContextGraph graph(contexts, 1);
+
+  std::string filename = "context-graph-test-corrupted.bin";
+  graph.Save(filename);
+  EXPECT_TRUE(ContextGraph::IsSavedGraph(filename));
+
+  {
+    // Point the fail link of the last state to itself
+    std::fstream fs(filename,
+                    std::ios::binary | std::ios::in | std::ios::out);
+    int32_t last = graph.NumStates() - 1;
+    int32_t header_size = 32;
+    fs.seekp(header_size + last * sizeof(ContextState) +
+             offsetof(ContextState, fail));
+    fs.write(reinterpret_cast<const char *>(&last), sizeof(last));
+  }
+
+  EXPECT_DEATH(ContextGraph::Load(filename), "Corrupted context graph");
+
+  std::remove(filename.c_str());
+
+  EXPECT_FALSE(ContextGraph::IsSavedGraph(filename));
+}
+
 TEST(ContextGraph, Benchmark) {
   std::random_device rd;
   std::mt19937 mt(rd());
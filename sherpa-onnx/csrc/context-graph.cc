@@ -6,18 +6,71 @@
 
 #include <algorithm>
 #include <cassert>
-#include <queue>
+#include <cstring>
+#include <fstream>
+#include <map>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
+
+static_assert(std::is_trivially_copyable<ContextState>::value,
+              "ContextState is saved to and loaded from files as is");
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'O', 'C', 'G', 'R', 'A', 'P', 'H'};
+constexpr int32_t kVersion = 1;
+
+// The serialized graph is
+//  Header
+//  ContextState states[num_states]
+//  int32_t tokens[num_states]
+//  int32_t root_next[root_next_size]
+//  char phrases[phrases_size]
+struct Header {
+  char magic[8];
+  int32_t version;
+  int32_t state_size;  // sizeof(ContextState)
+  int32_t num_states;
+  int32_t root_next_size;
+  int32_t phrases_size;
+  int32_t padding;
+};
+
+// A node of the trie used only during construction
+struct BuildNode {
+  std::map<int32_t, int32_t> next;  // token -> node index
+  int32_t token = -1;
+  float token_score = 0;
+  float node_score = 0;
+  float output_score = 0;
+  int32_t level = 0;
+  float ac_threshold = 0;
+  bool is_end = false;
+  int32_t phrase = -1;  // index into phrases
+};
+
+}  // namespace
+
+ContextGraph::ContextGraph(const std::vector<std::vector<int32_t>> &token_ids,
+                           float context_score, float ac_threshold,
+                           const std::vector<float> &scores /*= {}*/,
+                           const std::vector<std::string> &phrases /*= {}*/,
+                           const std::vector<float> &ac_thresholds /*= {}*/) {
+  Build(token_ids, context_score, ac_threshold, scores, phrases,
+        ac_thresholds);
+}
+
 void ContextGraph::Build(const std::vector<std::vector<int32_t>> &token_ids,
+                         float context_score, float ac_threshold,
                          const std::vector<float> &scores,
                          const std::vector<std::string> &phrases,
-                         const std::vector<float> &ac_thresholds) const {
+                         const std::vector<float> &ac_thresholds) {
   if (!scores.empty()) {
     SHERPA_ONNX_CHECK_EQ(token_ids.size(), scores.size());
   }
@@ -27,78 +80,320 @@ void ContextGraph::Build(const std::vector<std::vector<int32_t>> &token_ids,
   if (!ac_thresholds.empty()) {
     SHERPA_ONNX_CHECK_EQ(token_ids.size(), ac_thresholds.size());
   }
+
+  // Build a trie first. Nodes are referred to by indexes since the vector
+  // may be reallocated.
+  std::vector<BuildNode> nodes(1);
   for (int32_t i = 0; i < static_cast<int32_t>(token_ids.size()); ++i) {
-    auto node = root_.get();
+    int32_t node = 0;
     float score = scores.empty() ? 0.0f : scores[i];
-    score = score == 0.0f ? context_score_ : score;
-    float ac_threshold = ac_thresholds.empty() ? 0.0f : ac_thresholds[i];
-    ac_threshold = ac_threshold == 0.0f ? ac_threshold_ : ac_threshold;
-    std::string phrase = phrases.empty() ? std::string() : phrases[i];
+    score = score == 0.0f ? context_score : score;
+    float threshold = ac_thresholds.empty() ? 0.0f : ac_thresholds[i];
+    threshold = threshold == 0.0f ? ac_threshold : threshold;
+    int32_t phrase = phrases.empty() ? -1 : i;
 
-    for (int32_t j = 0; j < static_cast<int32_t>(token_ids[i].size()); ++j) {
+    int32_t num_tokens = static_cast<int32_t>(token_ids[i].size());
+    for (int32_t j = 0; j < num_tokens; ++j) {
       int32_t token = token_ids[i][j];
-      if (0 == node->next.count(token)) {
-        bool is_end = j == (static_cast<int32_t>(token_ids[i].size()) - 1);
-        node->next[token] = std::make_unique<ContextState>(
-            token, score, node->node_score + score,
-            is_end ? node->node_score + score : 0, j + 1,
-            is_end ? ac_threshold : 0.0f, is_end,
-            is_end ? phrase : std::string());
+      bool is_last = j == num_tokens - 1;
+      auto it = nodes[node].next.find(token);
+      int32_t child;
+      if (it == nodes[node].next.end()) {
+        child = static_cast<int32_t>(nodes.size());
+        nodes[node].next[token] = child;
+
+        BuildNode n;
+        n.token = token;
+        n.token_score = score;
+        n.node_score = nodes[node].node_score + score;
+        n.output_score = is_last ? n.node_score : 0;
+        n.level = j + 1;
+        n.ac_threshold = is_last ? threshold : 0.0f;
+        n.is_end = is_last;
+        n.phrase = is_last ? phrase : -1;
+        nodes.push_back(std::move(n));
       } else {
-        float token_score = std::max(score, node->next[token]->token_score);
-        node->next[token]->token_score = token_score;
-        float node_score = node->node_score + token_score;
-        node->next[token]->node_score = node_score;
-        bool is_end = (j == static_cast<int32_t>(token_ids[i].size()) - 1) ||
-                      node->next[token]->is_end;
-        node->next[token]->output_score = is_end ? node_score : 0.0f;
-        node->next[token]->is_end = is_end;
-        if (j == static_cast<int32_t>(token_ids[i].size()) - 1) {
-          node->next[token]->phrase = phrase;
-          node->next[token]->ac_threshold = ac_threshold;
+        child = it->second;
+        BuildNode &n = nodes[child];
+        n.token_score = std::max(score, n.token_score);
+        n.node_score = nodes[node].node_score + n.token_score;
+        n.is_end = is_last || n.is_end;
+        n.output_score = n.is_end ? n.node_score : 0.0f;
+        if (is_last) {
+          n.phrase = phrase;
+          n.ac_threshold = threshold;
         }
       }
-      node = node->next[token].get();
+      node = child;
     }
   }
+
+  // Number the nodes in breadth-first order so that children of a node
+  // are contiguous and sorted by token
+  int32_t num_states = static_cast<int32_t>(nodes.size());
+  std::vector<int32_t> order = {0};
+  std::vector<int32_t> first_child(num_states, 0);
+  order.reserve(num_states);
+  for (int32_t k = 0; k != static_cast<int32_t>(order.size()); ++k) {
+    first_child[k] = static_cast<int32_t>(order.size());
+    for (const auto &p : nodes[order[k]].next) {
+      order.push_back(p.second);
+    }
+  }
+
+  int32_t root_next_size = 0;
+  if (!nodes[0].next.empty() && nodes[0].next.begin()->first >= 0) {
+    root_next_size = nodes[0].next.rbegin()->first + 1;
+  }
+
+  std::string phrases_buf;
+  std::vector<int32_t> phrase_offsets(phrases.size(), -1);
+
+  // The header is a multiple of 4 bytes and so are all sections except the
+  // last one, so all sections are properly aligned
+  size_t states_offset = sizeof(Header);
+  size_t tokens_offset = states_offset + num_states * sizeof(ContextState);
+  size_t root_next_offset = tokens_offset + num_states * sizeof(int32_t);
+  size_t phrases_offset = root_next_offset + root_next_size * sizeof(int32_t);
+
+  for (int32_t k = 0; k != num_states; ++k) {
+    int32_t p = nodes[order[k]].phrase;
+    if (p != -1 && phrase_offsets[p] == -1) {
+      phrase_offsets[p] = static_cast<int32_t>(phrases_buf.size());
+      phrases_buf += phrases[p];
+    }
+  }
+
+  data_.assign(phrases_offset + phrases_buf.size(), 0);
+
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.state_size = sizeof(ContextState);
+  header.num_states = num_states;
+  header.root_next_size = root_next_size;
+  header.phrases_size = static_cast<int32_t>(phrases_buf.size());
+  header.padding = 0;
+  std::memcpy(data_.data(), &header, sizeof(header));
+
+  auto states = reinterpret_cast<ContextState *>(data_.data() + states_offset);
+  auto tokens = reinterpret_cast<int32_t *>(data_.data() + tokens_offset);
+  auto root_next = reinterpret_cast<int32_t *>(data_.data() + root_next_offset);
+
+  std::fill(root_next, root_next + root_next_size, -1);
+
+  for (int32_t k = 0; k != num_states; ++k) {
+    const BuildNode &n = nodes[order[k]];
+    ContextState &s = states[k];
+    s.token = n.token;
+    s.token_score = n.token_score;
+    s.node_score = n.node_score;
+    s.output_score = n.output_score;
+    s.level = n.level;
+    s.ac_threshold = n.ac_threshold;
+    s.is_end = n.is_end;
+    s.fail = 0;
+    s.output = -1;
+    s.first_child = first_child[k];
+    s.num_children = static_cast<int32_t>(n.next.size());
+    s.phrase_offset = n.phrase == -1 ? 0 : phrase_offsets[n.phrase];
+    s.phrase_length =
+        n.phrase == -1 ? 0 : static_cast<int32_t>(phrases[n.phrase].size());
+
+    tokens[k] = n.token;
+  }
+
+  for (int32_t k = 0; k != states[0].num_children; ++k) {
+    int32_t child = states[0].first_child + k;
+    if (root_next_size > 0) {
+      root_next[tokens[child]] = child;
+    }
+  }
+
+  std::copy(phrases_buf.begin(), phrases_buf.end(),
+            data_.data() + phrases_offset);
+
+  Init(data_.data(), data_.size());
+
   FillFailOutput();
 }
 
+void ContextGraph::Init(const char *data, size_t size) {
+  Header header;
+  if (size < sizeof(header)) {
+    SHERPA_ONNX_LOGE("Invalid context graph. Size: %d",
+                     static_cast<int32_t>(size));
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    SHERPA_ONNX_LOGE("Not a context graph");
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  if (header.version != kVersion ||
+      header.state_size != static_cast<int32_t>(sizeof(ContextState))) {
+    SHERPA_ONNX_LOGE(
+        "Unsupported context graph. Version: %d, state size: %d. Expected "
+        "version: %d, state size: %d",
+        header.version, header.state_size, kVersion,
+        static_cast<int32_t>(sizeof(ContextState)));
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  size_t expected = 0;
+  if (header.num_states >= 1 && header.root_next_size >= 0 &&
+      header.phrases_size >= 0) {
+    expected = sizeof(Header) +
+               static_cast<size_t>(header.num_states) * sizeof(ContextState) +
+               static_cast<size_t>(header.num_states) * sizeof(int32_t) +
+               static_cast<size_t>(header.root_next_size) * sizeof(int32_t) +
+               static_cast<size_t>(header.phrases_size);
+  }
+
+  if (size != expected) {
+    SHERPA_ONNX_LOGE(
+        "Corrupted context graph. Number of states: %d, size: %d, expected "
+        "size: %d",
+        header.num_states, static_cast<int32_t>(size),
+        static_cast<int32_t>(expected));
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  const char *p = data + sizeof(Header);
+
+  states_ = reinterpret_cast<const ContextState *>(p);
+  num_states_ = header.num_states;
+  p += num_states_ * sizeof(ContextState);
+
+  tokens_ = reinterpret_cast<const int32_t *>(p);
+  p += num_states_ * sizeof(int32_t);
+
+  root_next_ = reinterpret_cast<const int32_t *>(p);
+  root_next_size_ = header.root_next_size;
+  p += root_next_size_ * sizeof(int32_t);
+
+  phrases_ = p;
+
+  // Links are used without checks when decoding. In breadth-first order,
+  // the fail and output states of a state come before it and its children
+  // after it, which also rules out loops of fail links.
+  for (int32_t i = 0; i != num_states_; ++i) {
+    const ContextState &s = states_[i];
+    int64_t children_end =
+        static_cast<int64_t>(s.first_child) + s.num_children;
+    int64_t phrase_end =
+        static_cast<int64_t>(s.phrase_offset) + s.phrase_length;
+
+    bool ok = (i == 0 ? s.fail == 0 : (s.fail >= 0 && s.fail < i)) &&
+              (s.output == -1 || (s.output > 0 && s.output < i)) &&
+              s.num_children >= 0 && s.first_child >= 0 &&
+              children_end <= num_states_ &&
+              (s.num_children == 0 || s.first_child > i) &&
+              s.phrase_offset >= 0 && s.phrase_length >= 0 &&
+              phrase_end <= header.phrases_size;
+    if (!ok) {
+      SHERPA_ONNX_LOGE("Corrupted context graph. Invalid state %d", i);
+      SHERPA_ONNX_EXIT(-1);
+    }
+  }
+
+  for (int32_t i = 0; i != root_next_size_; ++i) {
+    if (root_next_[i] < -1 || root_next_[i] >= num_states_) {
+      SHERPA_ONNX_LOGE("Corrupted context graph. Invalid child %d of root",
+                       root_next_[i]);
+      SHERPA_ONNX_EXIT(-1);
+    }
+  }
+}
+
+ContextGraphPtr ContextGraph::Load(const std::string &filename) {
+  // The default constructor is private
+  ContextGraphPtr graph(new ContextGraph);
+  graph->file_ = MapFile(filename);
+  graph->Init(graph->file_.data(), graph->file_.size());
+  return graph;
+}
+
+bool ContextGraph::IsSavedGraph(const std::string &filename) {
+  std::ifstream is(filename, std::ios::binary);
+
+  char magic[sizeof(kMagic)] = {0};
+  is.read(magic, sizeof(magic));
+
+  return is && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+void ContextGraph::Save(const std::string &filename) const {
+  std::ofstream os(filename, std::ios::binary);
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to open '%s' for writing", filename.c_str());
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  if (!data_.empty()) {
+    os.write(data_.data(), data_.size());
+  } else {
+    os.write(file_.data(), file_.size());
+  }
+
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to write '%s'", filename.c_str());
+    SHERPA_ONNX_EXIT(-1);
+  }
+}
+
+int32_t ContextGraph::Next(int32_t state, int32_t token) const {
+  if (state == 0 && root_next_size_ > 0) {
+    if (token < 0 || token >= root_next_size_) {
+      return -1;
+    }
+    return root_next_[token];
+  }
+
+  const ContextState &s = states_[state];
+  const int32_t *begin = tokens_ + s.first_child;
+  const int32_t *end = begin + s.num_children;
+  const int32_t *p = std::lower_bound(begin, end, token);
+  if (p == end || *p != token) {
+    return -1;
+  }
+
+  return static_cast<int32_t>(p - tokens_);
+}
+
 std::tuple<float, const ContextState *, const ContextState *>
 ContextGraph::ForwardOneStep(const ContextState *state, int32_t token,
                              bool strict_mode /*= true*/) const {
-  const ContextState *node = nullptr;
+  int32_t s = static_cast<int32_t>(state - states_);
+  int32_t n = Next(s, token);
   float score = 0;
-  if (1 == state->next.count(token)) {
-    node = state->next.at(token).get();
-    score = node->token_score;
+  if (n != -1) {
+    score = states_[n].token_score;
   } else {
-    node = state->fail;
-    while (0 == node->next.count(token)) {
-      node = node->fail;
-      if (-1 == node->token) break;  // root
+    n = state->fail;
+    int32_t next;
+    while ((next = Next(n, token)) == -1) {
+      n = states_[n].fail;
+      if (n == 0) break;  // root
     }
-    if (1 == node->next.count(token)) {
-      node = node->next.at(token).get();
+    if (next != -1 || (next = Next(n, token)) != -1) {
+      n = next;
     }
-    score = node->node_score - state->node_score;
+    score = states_[n].node_score - state->node_score;
   }
 
-  if (!node) {
-    SHERPA_ONNX_LOGE("Some bad things happened.");
-    exit(-1);
-  }
+  const ContextState *node = states_ + n;
 
   const ContextState *matched_node =
-      node->is_end ? node : (node->output != nullptr ? node->output : nullptr);
+      node->is_end ? node
+                   : (node->output != -1 ? states_ + node->output : nullptr);
 
   if (!strict_mode && node->output_score != 0) {
     SHERPA_ONNX_CHECK(nullptr != matched_node);
-    float output_score =
-        node->is_end ? node->node_score
-                     : (node->output != nullptr ? node->output->node_score
-                                                : node->node_score);
-    return std::make_tuple(score + output_score - node->node_score, root_.get(),
+    float output_score = matched_node->node_score;
+    return std::make_tuple(score + output_score - node->node_score, Root(),
                            matched_node);
   }
   return std::make_tuple(score + node->output_score, node, matched_node);
@@ -107,7 +402,7 @@ ContextGraph::ForwardOneStep(const ContextState *state, int32_t token,
 std::pair<float, const ContextState *> ContextGraph::Finalize(
     const ContextState *state) const {
   float score = -state->node_score;
-  return std::make_pair(score, root_.get());
+  return std::make_pair(score, Root());
 }
 
 std::pair<bool, const ContextState *> ContextGraph::IsMatched(
@@ -118,50 +413,59 @@ std::pair<bool, const ContextState *> ContextGraph::IsMatched(
     status = true;
     node = state;
   } else {
-    if (state->output != nullptr) {
+    if (state->output != -1) {
       status = true;
-      node = state->output;
+      node = states_ + state->output;
     }
   }
   return std::make_pair(status, node);
 }
 
-void ContextGraph::FillFailOutput() const {
-  std::queue<const ContextState *> node_queue;
-  for (auto &kv : root_->next) {
-    kv.second->fail = root_.get();
-    node_queue.push(kv.second.get());
-  }
-  while (!node_queue.empty()) {
-    auto current_node = node_queue.front();
-    node_queue.pop();
-    for (auto &kv : current_node->next) {
-      auto fail = current_node->fail;
-      if (1 == fail->next.count(kv.first)) {
-        fail = fail->next.at(kv.first).get();
-      } else {
-        fail = fail->fail;
-        while (0 == fail->next.count(kv.first)) {
-          fail = fail->fail;
-          if (-1 == fail->token) break;
+void ContextGraph::FillFailOutput() {
+  // states_ points into data_ while building
+  auto states = const_cast<ContextState *>(states_);
+
+  // In breadth-first order, the fail and output links of a state are
+  // set before they are used by deeper states
+  for (int32_t s = 0; s != num_states_; ++s) {
+    const ContextState &current = states[s];
+    for (int32_t k = 0; k != current.num_children; ++k) {
+      int32_t child = current.first_child + k;
+      int32_t token = tokens_[child];
+
+      int32_t fail = 0;
+      if (s != 0) {
+        fail = current.fail;
+        int32_t next = Next(fail, token);
+        if (next != -1) {
+          fail = next;
+        } else {
+          fail = states[fail].fail;
+          while ((next = Next(fail, token)) == -1) {
+            fail = states[fail].fail;
+            if (fail == 0) break;
+          }
+          if (next != -1 || (next = Next(fail, token)) != -1) {
+            fail = next;
+          }
         }
-        if (1 == fail->next.count(kv.first))
-          fail = fail->next.at(kv.first).get();
       }
-      kv.second->fail = fail;
+      states[child].fail = fail;
+
       // fill the output arc
-      auto output = fail;
-      while (!output->is_end) {
-        output = output->fail;
-        if (-1 == output->token) {
-          output = nullptr;
+      int32_t output = fail;
+      while (!states[output].is_end) {
+        output = states[output].fail;
+        if (output == 0) {
+          output = -1;
           break;
         }
       }
-      kv.second->output = output;
-      kv.second->output_score += output == nullptr ? 0 : output->output_score;
-      node_queue.push(kv.second.get());
+      states[child].output = output;
+      states[child].output_score +=
+          output == -1 ? 0 : states[output].output_score;
     }
   }
 }
+
 }  // namespace sherpa_onnx
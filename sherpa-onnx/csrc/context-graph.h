@@ -5,13 +5,14 @@
 #ifndef SHERPA_ONNX_CSRC_CONTEXT_GRAPH_H_
 #define SHERPA_ONNX_CSRC_CONTEXT_GRAPH_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <tuple>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/log.h"
 
 namespace sherpa_onnx {
@@ -19,6 +20,9 @@ namespace sherpa_onnx {
 class ContextGraph;
 using ContextGraphPtr = std::shared_ptr<ContextGraph>;
 
+// A state of the Aho-Corasick automaton. All states of a graph are stored
+// in a single array in breadth-first order. Links to other states are
+// indexes into that array.
 struct ContextState {
   int32_t token;
   float token_score;
@@ -27,44 +31,56 @@ struct ContextState {
   int32_t level;
   float ac_threshold;
   bool is_end;
-  std::string phrase;
-  std::unordered_map<int32_t, std::unique_ptr<ContextState>> next;
-  const ContextState *fail = nullptr;
-  const ContextState *output = nullptr;
-
-  ContextState() = default;
-  ContextState(int32_t token, float token_score, float node_score,
-               float output_score, int32_t level = 0, float ac_threshold = 0.0f,
-               bool is_end = false, const std::string &phrase = {})
-      : token(token),
-        token_score(token_score),
-        node_score(node_score),
-        output_score(output_score),
-        level(level),
-        ac_threshold(ac_threshold),
-        is_end(is_end),
-        phrase(phrase) {}
+
+  // index of the fail state
+  int32_t fail;
+
+  // index of the output state, or -1 if there is none
+  int32_t output;
+
+  // Children are in [first_child, first_child + num_children), sorted
+  // by token
+  int32_t first_child;
+  int32_t num_children;
+
+  // Use ContextGraph::Phrase() to get the phrase of an end state
+  int32_t phrase_offset;
+  int32_t phrase_length;
 };
 
 class ContextGraph {
  public:
-  ContextGraph() = default;
   ContextGraph(const std::vector<std::vector<int32_t>> &token_ids,
                float context_score, float ac_threshold,
                const std::vector<float> &scores = {},
                const std::vector<std::string> &phrases = {},
-               const std::vector<float> &ac_thresholds = {})
-      : context_score_(context_score), ac_threshold_(ac_threshold) {
-    root_ = std::make_unique<ContextState>(-1, 0, 0, 0);
-    root_->fail = root_.get();
-    Build(token_ids, scores, phrases, ac_thresholds);
-  }
+               const std::vector<float> &ac_thresholds = {});
 
   ContextGraph(const std::vector<std::vector<int32_t>> &token_ids,
                float context_score, const std::vector<float> &scores = {})
       : ContextGraph(token_ids, context_score, 0.0f, scores,
                      std::vector<std::string>(), std::vector<float>()) {}
 
+  // States point into the memory owned by this object
+  ContextGraph(const ContextGraph &) = delete;
+  ContextGraph &operator=(const ContextGraph &) = delete;
+  ContextGraph(ContextGraph &&) = default;
+  ContextGraph &operator=(ContextGraph &&) = default;
+
+  /** Load a graph saved by Save().
+   *
+   * The file is memory mapped and used in place, so loading a large graph
+   * costs nearly nothing. It must be saved on a machine with the same
+   * endianness.
+   */
+  static ContextGraphPtr Load(const std::string &filename);
+
+  // Return true if the file starts like a graph saved by Save()
+  static bool IsSavedGraph(const std::string &filename);
+
+  // Save the graph so that it can be loaded with Load()
+  void Save(const std::string &filename) const;
+
   std::tuple<float, const ContextState *, const ContextState *> ForwardOneStep(
       const ContextState *state, int32_t token_id,
       bool strict_mode = true) const;
@@ -75,17 +91,52 @@ class ContextGraph {
   std::pair<float, const ContextState *> Finalize(
       const ContextState *state) const;
 
-  const ContextState *Root() const { return root_.get(); }
+  const ContextState *Root() const { return states_; }
+
+  std::string Phrase(const ContextState *state) const {
+    return std::string(phrases_ + state->phrase_offset, state->phrase_length);
+  }
+
+  int32_t NumStates() const { return num_states_; }
 
  private:
-  float context_score_;
-  float ac_threshold_;
-  std::unique_ptr<ContextState> root_;
+  // Used by Load()
+  ContextGraph() = default;
+
+  // Return the index of the child of the given state with the given token.
+  // Return -1 if there is no such child.
+  int32_t Next(int32_t state, int32_t token) const;
+
+  // Point the arrays below to the serialized graph in data.
+  // It exits if the graph is corrupted.
+  void Init(const char *data, size_t size);
+
   void Build(const std::vector<std::vector<int32_t>> &token_ids,
+             float context_score, float ac_threshold,
              const std::vector<float> &scores,
              const std::vector<std::string> &phrases,
-             const std::vector<float> &ac_thresholds) const;
-  void FillFailOutput() const;
+             const std::vector<float> &ac_thresholds);
+
+  void FillFailOutput();
+
+ private:
+  // The serialized graph is in either data_ or file_
+  std::vector<char> data_;
+  FileBuffer file_;
+
+  const ContextState *states_ = nullptr;
+  int32_t num_states_ = 0;
+
+  // tokens_[i] == states_[i].token. It is used to look up children.
+  const int32_t *tokens_ = nullptr;
+
+  // root_next_[token] is the index of the child of the root with the given
+  // token, or -1. The fail link of nearly every state ends at the root,
+  // so it is looked up without a binary search.
+  const int32_t *root_next_ = nullptr;
+  int32_t root_next_size_ = 0;
+
+  const char *phrases_ = nullptr;
 };
 
 }  // namespace sherpa_onnx
@@ -15,7 +15,10 @@ std::string FastClusteringConfig::ToString() const {
 
   os << "FastClusteringConfig(";
   os << "num_clusters=" << num_clusters << ", ";
-  os << "threshold=" << threshold << ")";
+  os << "threshold=" << threshold << ", ";
+  os << "max_exact_num_rows=" << max_exact_num_rows << ", ";
+  os << "num_centroids=" << num_centroids << ", ";
+  os << "num_kmeans_iterations=" << num_kmeans_iterations << ")";
 
   return os.str();
 }
@@ -31,6 +34,24 @@ void FastClusteringConfig::Register(ParseOptions *po) {
                "If num_clusters is not specified, then it specifies the "
                "distance threshold for clustering. smaller value -> more "
                "clusters. larger value -> fewer clusters");
+
+  po->Register("cluster-max-exact-num-rows", &max_exact_num_rows,
+               "If the number of embeddings is larger than this value, "
+               "first over-cluster them with k-means into "
+               "--cluster-num-centroids groups and then cluster the "
+               "centroids. This bounds memory usage for long recordings. "
+               "The default is 5000, so recordings with more embeddings "
+               "than that are clustered approximately and the labels may "
+               "differ slightly from exact clustering. Use a value <= 0 to "
+               "always use exact clustering.");
+
+  po->Register("cluster-num-centroids", &num_centroids,
+               "Number of k-means centroids used when the number of "
+               "embeddings exceeds --cluster-max-exact-num-rows");
+
+  po->Register("cluster-num-kmeans-iterations", &num_kmeans_iterations,
+               "Number of k-means iterations used when the number of "
+               "embeddings exceeds --cluster-max-exact-num-rows");
 }
 
 bool FastClusteringConfig::Validate() const {
@@ -39,6 +60,20 @@ bool FastClusteringConfig::Validate() const {
     return false;
   }
 
+  if (max_exact_num_rows > 0) {
+    if (num_centroids < 2) {
+      SHERPA_ONNX_LOGE("num_centroids should be at least 2. Given: %d",
+                       num_centroids);
+      return false;
+    }
+
+    if (num_kmeans_iterations < 1) {
+      SHERPA_ONNX_LOGE("num_kmeans_iterations should be positive. Given: %d",
+                       num_kmeans_iterations);
+      return false;
+    }
+  }
+
   return true;
 }
 
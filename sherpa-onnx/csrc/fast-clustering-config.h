@@ -24,11 +24,36 @@ struct FastClusteringConfig {
   // The larger, the fewer clusters it will generate.
   float threshold = 0.5;
 
+  // If the number of inputs is larger than this value, we first
+  // over-cluster the inputs into num_centroids groups with k-means and
+  // then run agglomerative clustering on the centroids. This keeps memory
+  // bounded for long recordings. Note that the result may differ slightly
+  // from exact clustering for inputs with more than this number of rows.
+  //
+  // If it is less than or equal to 0, we always use exact clustering, which
+  // needs O(N^2) memory and time.
+  int32_t max_exact_num_rows = 5000;
+
+  // Used only when the number of inputs is larger than max_exact_num_rows.
+  int32_t num_centroids = 1000;
+
+  // Number of iterations for the k-means over-clustering step.
+  int32_t num_kmeans_iterations = 10;
+
   FastClusteringConfig() = default;
 
   FastClusteringConfig(int32_t num_clusters, float threshold)
       : num_clusters(num_clusters), threshold(threshold) {}
 
+  FastClusteringConfig(int32_t num_clusters, float threshold,
+                       int32_t max_exact_num_rows, int32_t num_centroids,
+                       int32_t num_kmeans_iterations)
+      : num_clusters(num_clusters),
+        threshold(threshold),
+        max_exact_num_rows(max_exact_num_rows),
+        num_centroids(num_centroids),
+        num_kmeans_iterations(num_kmeans_iterations) {}
+
   std::string ToString() const;
 
   void Register(ParseOptions *po);
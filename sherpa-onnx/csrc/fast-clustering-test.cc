@@ -4,6 +4,10 @@
 
 #include "sherpa-onnx/csrc/fast-clustering.h"
 
+#include <chrono>  // NOLINT
+#include <random>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -66,4 +70,113 @@ TEST(FastClustering, TestClusteringWithThreshold) {
   }
 }
 
+// Generate num_speakers clusters of points around random unit vectors
+static std::vector<float> GenerateFeatures(int32_t num_speakers,
+                                           int32_t num_points_per_speaker,
+                                           int32_t dim) {
+  std::mt19937 gen(20241018);
+  std::normal_distribution<float> dist(0, 1);
+
+  std::vector<float> centers(num_speakers * dim);
+  for (auto &f : centers) {
+    f = dist(gen);
+  }
+
+  std::vector<float> features;
+  features.reserve(num_speakers * num_points_per_speaker * dim);
+  for (int32_t i = 0; i != num_points_per_speaker; ++i) {
+    for (int32_t s = 0; s != num_speakers; ++s) {
+      for (int32_t d = 0; d != dim; ++d) {
+        features.push_back(centers[s * dim + d] + 0.2f * dist(gen));
+      }
+    }
+  }
+
+  return features;
+}
+
+static double Seconds(
+    const std::chrono::steady_clock::time_point &start,
+    const std::chrono::steady_clock::time_point &end) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+             .count() /
+         1000.;
+}
+
+// The two labelings should be identical up to a permutation
+static void ExpectSameClusters(const std::vector<int32_t> &a,
+                               const std::vector<int32_t> &b,
+                               int32_t num_clusters) {
+  ASSERT_EQ(a.size(), b.size());
+
+  std::set<std::pair<int32_t, int32_t>> pairs;
+  for (int32_t i = 0; i != static_cast<int32_t>(a.size()); ++i) {
+    pairs.insert({a[i], b[i]});
+  }
+  EXPECT_EQ(static_cast<int32_t>(pairs.size()), num_clusters);
+}
+
+TEST(FastClustering, TestCentroidsMatchExact) {
+  int32_t num_speakers = 4;
+  int32_t num_points_per_speaker = 150;
+  int32_t dim = 32;
+  int32_t num_rows = num_speakers * num_points_per_speaker;
+
+  std::vector<float> features =
+      GenerateFeatures(num_speakers, num_points_per_speaker, dim);
+  std::vector<float> features2 = features;
+
+  FastClusteringConfig config;
+  config.num_clusters = num_speakers;
+  config.max_exact_num_rows = -1;
+
+  auto exact = FastClustering(config).Cluster(features.data(), num_rows, dim);
+
+  config.max_exact_num_rows = 100;
+  config.num_centroids = 50;
+
+  auto approx =
+      FastClustering(config).Cluster(features2.data(), num_rows, dim);
+
+  ExpectSameClusters(exact, approx, num_speakers);
+
+  // Points generated from the same speaker share the same label
+  for (int32_t i = num_speakers; i != num_rows; ++i) {
+    EXPECT_EQ(approx[i], approx[i % num_speakers]);
+  }
+}
+
+// Compare the time of exact clustering with that of clustering the
+// centroids
+TEST(FastClustering, DISABLED_Benchmark) {
+  int32_t num_speakers = 4;
+  int32_t num_points_per_speaker = 1000;
+  int32_t dim = 32;
+  int32_t num_rows = num_speakers * num_points_per_speaker;
+
+  std::vector<float> features =
+      GenerateFeatures(num_speakers, num_points_per_speaker, dim);
+  std::vector<float> features2 = features;
+
+  FastClusteringConfig config;
+  config.num_clusters = num_speakers;
+  config.max_exact_num_rows = -1;
+
+  auto start = std::chrono::steady_clock::now();
+  auto exact = FastClustering(config).Cluster(features.data(), num_rows, dim);
+  auto end = std::chrono::steady_clock::now();
+  std::cout << "exact: " << Seconds(start, end) << " s\n";
+
+  config.max_exact_num_rows = 1000;
+  config.num_centroids = 200;
+
+  start = std::chrono::steady_clock::now();
+  auto approx =
+      FastClustering(config).Cluster(features2.data(), num_rows, dim);
+  end = std::chrono::steady_clock::now();
+  std::cout << "centroids: " << Seconds(start, end) << " s\n";
+
+  ExpectSameClusters(exact, approx, num_speakers);
+}
+
 }  // namespace sherpa_onnx
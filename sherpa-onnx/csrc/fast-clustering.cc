@@ -4,6 +4,7 @@
 
 #include "sherpa-onnx/csrc/fast-clustering.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "Eigen/Dense"
@@ -11,6 +12,13 @@
 
 namespace sherpa_onnx {
 
+using Matrix2D =
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+// Number of rows processed per GEMM call when computing similarities.
+// It bounds the size of the temporary similarity matrix.
+static constexpr int32_t kBlockSize = 512;
+
 class FastClustering::Impl {
  public:
   explicit Impl(const FastClusteringConfig &config) : config_(config) {}
@@ -25,26 +33,54 @@ class FastClustering::Impl {
       return {0};
     }
 
-    Eigen::Map<
-        Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
-        m(features, num_rows, num_cols);
+    Eigen::Map<Matrix2D> m(features, num_rows, num_cols);
     m.rowwise().normalize();
 
-    std::vector<double> distance((num_rows * (num_rows - 1)) / 2);
+    if (config_.max_exact_num_rows > 0 &&
+        num_rows > config_.max_exact_num_rows &&
+        config_.num_centroids < num_rows) {
+      return ClusterWithCentroids(m);
+    }
 
-    int32_t k = 0;
-    for (int32_t i = 0; i != num_rows; ++i) {
-      auto v = m.row(i);
-      for (int32_t j = i + 1; j != num_rows; ++j) {
-        double cosine_similarity = v.dot(m.row(j));
-        double consine_dissimilarity = 1 - cosine_similarity;
+    return ClusterExact(m);
+  }
 
-        if (consine_dissimilarity < 0) {
-          consine_dissimilarity = 0;
-        }
+ private:
+  // @param m Each row is L2-normalized.
+  template <typename Derived>
+  std::vector<int32_t> ClusterExact(const Eigen::MatrixBase<Derived> &m) const {
+    int32_t num_rows = m.rows();
+    if (num_rows == 1) {
+      return {0};
+    }
+
+    std::vector<double> distance(static_cast<int64_t>(num_rows) *
+                                 (num_rows - 1) / 2);
+
+    // Compute cosine similarities block by block with GEMM. Entries of the
+    // condensed distance matrix are stored row by row, so we can fill
+    // them sequentially.
+    int64_t k = 0;
+    Matrix2D sim;
+    for (int32_t start = 0; start < num_rows - 1; start += kBlockSize) {
+      int32_t n = std::min(kBlockSize, num_rows - 1 - start);
+      int32_t num_right = num_rows - start;
 
-        distance[k] = consine_dissimilarity;
-        ++k;
+      sim.noalias() = m.middleRows(start, n) *
+                      m.middleRows(start, num_right).transpose();
+
+      for (int32_t i = 0; i != n; ++i) {
+        const float *p = sim.row(i).data();
+        for (int32_t j = i + 1; j != num_right; ++j) {
+          double cosine_dissimilarity = 1 - p[j];
+
+          if (cosine_dissimilarity < 0) {
+            cosine_dissimilarity = 0;
+          }
+
+          distance[k] = cosine_dissimilarity;
+          ++k;
+        }
       }
     }
 
@@ -57,7 +93,8 @@ class FastClustering::Impl {
 
     std::vector<int32_t> labels(num_rows);
     if (config_.num_clusters > 0) {
-      fastclustercpp::cutree_k(num_rows, merge.data(), config_.num_clusters,
+      fastclustercpp::cutree_k(num_rows, merge.data(),
+                               std::min(config_.num_clusters, num_rows),
                                labels.data());
     } else {
       fastclustercpp::cutree_cdist(num_rows, merge.data(), height.data(),
@@ -67,7 +104,98 @@ class FastClustering::Impl {
     return labels;
   }
 
- private:
+  // Over-cluster the input with spherical k-means and run agglomerative
+  // clustering on the resulting centroids. Memory usage is
+  // O(num_rows + num_centroids^2) instead of O(num_rows^2).
+  //
+  // @param m Each row is L2-normalized.
+  std::vector<int32_t> ClusterWithCentroids(
+      const Eigen::Map<Matrix2D> &m) const {
+    int32_t num_rows = m.rows();
+    int32_t num_cols = m.cols();
+    int32_t num_centroids = config_.num_centroids;
+
+    // Use evenly spaced rows for initialization so that the result
+    // is deterministic. Embeddings are in temporal order, so this
+    // also covers the whole recording.
+    Matrix2D centroids(num_centroids, num_cols);
+    for (int32_t i = 0; i != num_centroids; ++i) {
+      centroids.row(i) =
+          m.row(static_cast<int64_t>(i) * num_rows / num_centroids);
+    }
+
+    std::vector<int32_t> assignment(num_rows, -1);
+    std::vector<int32_t> counts(num_centroids);
+    Matrix2D sums(num_centroids, num_cols);
+    Matrix2D sim;
+
+    for (int32_t iter = 0; iter != config_.num_kmeans_iterations; ++iter) {
+      bool changed = false;
+      for (int32_t start = 0; start < num_rows; start += kBlockSize) {
+        int32_t n = std::min(kBlockSize, num_rows - start);
+        sim.noalias() = m.middleRows(start, n) * centroids.transpose();
+
+        for (int32_t i = 0; i != n; ++i) {
+          Eigen::Index best;
+          sim.row(i).maxCoeff(&best);
+          if (assignment[start + i] != best) {
+            assignment[start + i] = static_cast<int32_t>(best);
+            changed = true;
+          }
+        }
+      }
+
+      if (!changed) {
+        break;
+      }
+
+      sums.setZero();
+      std::fill(counts.begin(), counts.end(), 0);
+      for (int32_t i = 0; i != num_rows; ++i) {
+        sums.row(assignment[i]) += m.row(i);
+        counts[assignment[i]] += 1;
+      }
+
+      for (int32_t c = 0; c != num_centroids; ++c) {
+        // An empty cluster keeps its previous centroid
+        if (counts[c] > 0) {
+          centroids.row(c) = sums.row(c).normalized();
+        }
+      }
+    }
+
+    // Only non-empty centroids take part in the agglomerative clustering
+    std::fill(counts.begin(), counts.end(), 0);
+    for (auto a : assignment) {
+      counts[a] += 1;
+    }
+
+    std::vector<int32_t> old2new(num_centroids, -1);
+    int32_t num_used = 0;
+    for (int32_t c = 0; c != num_centroids; ++c) {
+      if (counts[c] > 0) {
+        old2new[c] = num_used;
+        ++num_used;
+      }
+    }
+
+    Matrix2D used(num_used, num_cols);
+    for (int32_t c = 0; c != num_centroids; ++c) {
+      if (old2new[c] != -1) {
+        used.row(old2new[c]) = centroids.row(c);
+      }
+    }
+
+    std::vector<int32_t> centroid_labels = ClusterExact(used);
+
+    std::vector<int32_t> labels(num_rows);
+    for (int32_t i = 0; i != num_rows; ++i) {
+      labels[i] = centroid_labels[old2new[assignment[i]]];
+    }
+
+    return labels;
+  }
+
   FastClusteringConfig config_;
 };
 
@@ -27,6 +27,10 @@ class FastClustering {
    * @param num_rows Number of feature frames
    * @param num-cols The feature dimension.
    *
+   * If num_rows is larger than config.max_exact_num_rows, the rows are
+   * first grouped into config.num_centroids clusters with k-means and
+   * the agglomerative clustering runs on the centroids.
+   *
    * @return Return a vector of size num_rows. ans[i] contains the label
    *         for the i-th feature frame, i.e., the i-th row of the feature
    *         matrix.
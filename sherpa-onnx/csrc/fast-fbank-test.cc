@@ -0,0 +1,185 @@
+// sherpa-onnx/csrc/fast-fbank-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/fast-fbank.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "kaldi-native-fbank/csrc/online-feature.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+static knf::FbankOptions GetOptions() {
+  knf::FbankOptions opts;
+  opts.frame_opts.dither = 0;
+  opts.frame_opts.snip_edges = false;
+  opts.frame_opts.samp_freq = 16000;
+  opts.mel_opts.num_bins = 80;
+  opts.mel_opts.high_freq = -400;
+  return opts;
+}
+
+// Speech-like test signal: a few harmonics with a slowly changing pitch
+// plus some noise
+static std::vector<float> GetWave(int32_t n, float sample_rate) {
+  std::mt19937 gen(20250101);
+  std::normal_distribution<float> noise(0, 0.01);
+
+  std::vector<float> wave(n);
+  double phase = 0;
+  for (int32_t i = 0; i != n; ++i) {
+    double f0 = 150 + 50 * std::sin(2 * M_PI * i / sample_rate);
+    phase += 2 * M_PI * f0 / sample_rate;
+
+    float s = 0;
+    for (int32_t h = 1; h <= 10; ++h) {
+      s += std::sin(h * phase) / h;
+    }
+    wave[i] = 0.1f * s + noise(gen);
+  }
+  return wave;
+}
+
+// Feed wave to both extractors in chunks of chunk_size samples and
+// compare all frames
+static void Compare(const knf::FbankOptions &opts, int32_t chunk_size) {
+  auto wave = GetWave(16000, opts.frame_opts.samp_freq);
+
+  knf::OnlineFbank expected(opts);
+  FastFbank fbank(opts);
+
+  float sample_rate = opts.frame_opts.samp_freq;
+  for (int32_t start = 0; start < static_cast<int32_t>(wave.size());
+       start += chunk_size) {
+    int32_t n = std::min<int32_t>(chunk_size, wave.size() - start);
+    expected.AcceptWaveform(sample_rate, wave.data() + start, n);
+    fbank.AcceptWaveform(sample_rate, wave.data() + start, n);
+    ASSERT_EQ(fbank.NumFramesReady(), expected.NumFramesReady());
+  }
+
+  expected.InputFinished();
+  fbank.InputFinished();
+
+  int32_t num_frames = expected.NumFramesReady();
+  ASSERT_EQ(fbank.NumFramesReady(), num_frames);
+  ASSERT_GT(num_frames, 0);
+  EXPECT_TRUE(fbank.IsLastFrame(num_frames - 1));
+
+  int32_t dim = fbank.Dim();
+  ASSERT_EQ(dim, opts.mel_opts.num_bins);
+
+  std::vector<float> frames(num_frames * dim);
+  fbank.GetFrames(0, num_frames, frames.data());
+
+  float max_diff = 0;
+  for (int32_t f = 0; f != num_frames; ++f) {
+    const float *a = expected.GetFrame(f);
+    const float *b = fbank.GetFrame(f);
+    for (int32_t i = 0; i != dim; ++i) {
+      max_diff = std::max(max_diff, std::abs(a[i] - b[i]));
+      EXPECT_EQ(b[i], frames[f * dim + i]);
+    }
+  }
+
+  // The features are log energies. Differences come only from rounding
+  // in the FFT and the log.
+  EXPECT_LT(max_diff, 1e-3f);
+}
+
+TEST(FastFbank, Default) { Compare(GetOptions(), 16000); }
+
+TEST(FastFbank, Streaming) {
+  for (int32_t chunk_size : {1, 100, 160, 1234}) {
+    Compare(GetOptions(), chunk_size);
+  }
+}
+
+TEST(FastFbank, SnipEdges) {
+  auto opts = GetOptions();
+  opts.frame_opts.snip_edges = true;
+  Compare(opts, 1000);
+}
+
+TEST(FastFbank, OtherOptions) {
+  auto opts = GetOptions();
+  opts.frame_opts.samp_freq = 8000;
+  opts.frame_opts.window_type = "hamming";
+  opts.frame_opts.remove_dc_offset = false;
+  opts.frame_opts.preemph_coeff = 0;
+  opts.mel_opts.num_bins = 40;
+  Compare(opts, 800);
+}
+
+TEST(FastFbank, Pop) {
+  auto opts = GetOptions();
+  auto wave = GetWave(16000, 16000);
+
+  knf::OnlineFbank expected(opts);
+  FastFbank fbank(opts);
+
+  expected.AcceptWaveform(16000, wave.data(), wave.size());
+  fbank.AcceptWaveform(16000, wave.data(), wave.size());
+
+  int32_t dim = fbank.Dim();
+  for (int32_t f = 0; f + 10 < fbank.NumFramesReady(); f += 7) {
+    const float *a = expected.GetFrame(f);
+    const float *b = fbank.GetFrame(f);
+    for (int32_t i = 0; i != dim; ++i) {
+      EXPECT_NEAR(a[i], b[i], 1e-3f);
+    }
+    expected.Pop(7);
+    fbank.Pop(7);
+  }
+}
+
+TEST(FastFbank, IsSupported) {
+  auto opts = GetOptions();
+  EXPECT_TRUE(FastFbank::IsSupported(opts));
+
+  opts.frame_opts.dither = 1;
+  EXPECT_FALSE(FastFbank::IsSupported(opts));
+
+  opts = GetOptions();
+  opts.use_energy = true;
+  EXPECT_FALSE(FastFbank::IsSupported(opts));
+
+  opts = GetOptions();
+  opts.frame_opts.round_to_power_of_two = false;
+  EXPECT_FALSE(FastFbank::IsSupported(opts));
+}
+
+TEST(FastFbank, DISABLED_Benchmark) {
+  auto opts = GetOptions();
+  auto wave = GetWave(16000 * 60, 16000);
+
+  for (int32_t i = 0; i != 2; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    knf::OnlineFbank expected(opts);
+    expected.AcceptWaveform(16000, wave.data(), wave.size());
+    expected.InputFinished();
+    auto mid = std::chrono::steady_clock::now();
+    FastFbank fbank(opts);
+    fbank.AcceptWaveform(16000, wave.data(), wave.size());
+    fbank.InputFinished();
+    auto stop = std::chrono::steady_clock::now();
+
+    int32_t knf_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(mid - start)
+            .count();
+    int32_t fast_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(stop - mid)
+            .count();
+
+    SHERPA_ONNX_LOGE("60 seconds of audio. knf: %d us, FastFbank: %d us",
+                     knf_us, fast_us);
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,533 @@
+// sherpa-onnx/csrc/fast-fbank.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/fast-fbank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "kaldi-native-fbank/csrc/feature-window.h"
+#include "kaldi-native-fbank/csrc/mel-computations.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
+
+// The kernels below are written as loops over the kNumLanes interleaved
+// frames, which compilers turn into SSE/NEON instructions. On x86_64 with
+// glibc we additionally build an AVX2 version of them and select one at
+// runtime.
+#if defined(__x86_64__) && defined(__GLIBC__) && defined(__GNUC__) && \
+    (!defined(__clang__) || __clang_major__ >= 14)
+#define SHERPA_ONNX_TARGET_CLONES \
+  __attribute__((target_clones("avx2", "default")))
+#else
+#define SHERPA_ONNX_TARGET_CLONES
+#endif
+
+namespace sherpa_onnx {
+
+namespace {
+
+constexpr int32_t kNumLanes = FastFbank::kNumLanes;
+
+// Natural logarithm of a positive normal float.
+//
+// It is the single precision log from Cephes. The relative error is about
+// 1e-7. Unlike std::log(), it has no branches or calls and can be
+// vectorized.
+inline float VectorizableLog(float x) {
+  uint32_t u;
+  std::memcpy(&u, &x, sizeof(u));
+
+  int32_t e = static_cast<int32_t>(u >> 23) - 127;
+
+  // m is in [1, 2)
+  u = (u & 0x007fffff) | 0x3f800000;
+  float m;
+  std::memcpy(&m, &u, sizeof(m));
+
+  // Move m to [sqrt(0.5), sqrt(2))
+  bool large = m > 1.41421356f;
+  m = large ? m * 0.5f : m;
+  float fe = static_cast<float>(large ? e + 1 : e);
+
+  float f = m - 1.0f;
+  float z = f * f;
+
+  float y = 7.0376836292e-2f;
+  y = y * f - 1.1514610310e-1f;
+  y = y * f + 1.1676998740e-1f;
+  y = y * f - 1.2420140846e-1f;
+  y = y * f + 1.4249322787e-1f;
+  y = y * f - 1.6668057665e-1f;
+  y = y * f + 2.0000714765e-1f;
+  y = y * f - 2.4999993993e-1f;
+  y = y * f + 3.3333331174e-1f;
+  y = y * f * z;
+
+  y += -2.12194440e-4f * fe;
+  y += -0.5f * z;
+
+  return f + y + 0.693359375f * fe;
+}
+
+/* In-place complex FFT of kNumLanes interleaved sequences.
+ *
+ * @param re  re[k * kNumLanes + l] is the real part of the k-th entry of
+ *            the l-th sequence. The input must be in bit-reversed order.
+ * @param im  The imaginary part. Same layout as re.
+ * @param n   Length of each sequence. Must be a power of 2.
+ * @param cos_table cos(pi * k / n) for k in [0, n]
+ * @param sin_table sin(pi * k / n) for k in [0, n]
+ */
+SHERPA_ONNX_TARGET_CLONES
+void ComplexFft(float *re, float *im, int32_t n, const float *cos_table,
+                const float *sin_table) {
+  for (int32_t len = 2; len <= n; len <<= 1) {
+    int32_t half = len / 2;
+    // The twiddle factor exp(-2 pi i j / len) is entry 2 * j * n / len
+    // of the tables
+    int32_t stride = 2 * n / len;
+    for (int32_t i = 0; i < n; i += len) {
+      for (int32_t j = 0; j < half; ++j) {
+        float wr = cos_table[j * stride];
+        float wi = -sin_table[j * stride];
+
+        float *ar = re + (i + j) * kNumLanes;
+        float *ai = im + (i + j) * kNumLanes;
+        float *br = re + (i + j + half) * kNumLanes;
+        float *bi = im + (i + j + half) * kNumLanes;
+
+        for (int32_t l = 0; l != kNumLanes; ++l) {
+          float tr = wr * br[l] - wi * bi[l];
+          float ti = wr * bi[l] + wi * br[l];
+          br[l] = ar[l] - tr;
+          bi[l] = ai[l] - ti;
+          ar[l] += tr;
+          ai[l] += ti;
+        }
+      }
+    }
+  }
+}
+
+/* Compute the power spectrum of kNumLanes real sequences of length 2 * n
+ * from the complex FFT of length n of their even (real part) and odd
+ * (imaginary part) samples.
+ *
+ * @param re  Output of ComplexFft()
+ * @param im  Output of ComplexFft()
+ * @param n   Length of the complex FFT
+ * @param cos_table cos(pi * k / n) for k in [0, n]
+ * @param sin_table sin(pi * k / n) for k in [0, n]
+ * @param power  On return, power[k * kNumLanes + l] is the power of the
+ *               k-th frequency bin of the l-th sequence, for k in [0, n].
+ */
+SHERPA_ONNX_TARGET_CLONES
+void PowerSpectrum(const float *re, const float *im, int32_t n,
+                   const float *cos_table, const float *sin_table,
+                   float *power) {
+  for (int32_t l = 0; l != kNumLanes; ++l) {
+    float dc = re[l] + im[l];
+    float nyquist = re[l] - im[l];
+    power[l] = dc * dc;
+    power[n * kNumLanes + l] = nyquist * nyquist;
+  }
+
+  for (int32_t k = 1; k < n; ++k) {
+    float c = cos_table[k];
+    float s = sin_table[k];
+
+    const float *ar = re + k * kNumLanes;
+    const float *ai = im + k * kNumLanes;
+    const float *br = re + (n - k) * kNumLanes;
+    const float *bi = im + (n - k) * kNumLanes;
+    float *p = power + k * kNumLanes;
+
+    for (int32_t l = 0; l != kNumLanes; ++l) {
+      // even part: (Z[k] + conj(Z[n - k])) / 2
+      float er = 0.5f * (ar[l] + br[l]);
+      float ei = 0.5f * (ai[l] - bi[l]);
+
+      // odd part: (Z[k] - conj(Z[n - k])) / 2i
+      float or_ = 0.5f * (ai[l] + bi[l]);
+      float oi = -0.5f * (ar[l] - br[l]);
+
+      // X[k] = even + exp(-2 pi i k / (2n)) * odd
+      float xr = er + c * or_ + s * oi;
+      float xi = ei + c * oi - s * or_;
+
+      p[l] = xr * xr + xi * xi;
+    }
+  }
+}
+
+/* Apply the mel filterbank and take the log.
+ *
+ * @param power Output of PowerSpectrum()
+ * @param num_bins Number of mel bins
+ * @param first  See FastFbank::mel_first_
+ * @param offsets  See FastFbank::mel_offsets_
+ * @param weights  See FastFbank::mel_weights_
+ * @param mel  On return, mel[i * kNumLanes + l] is the log energy of
+ *             the i-th mel bin of the l-th sequence.
+ */
+SHERPA_ONNX_TARGET_CLONES
+void LogMel(const float *power, int32_t num_bins, const int32_t *first,
+            const int32_t *offsets, const float *weights, float *mel) {
+  constexpr float kEps = std::numeric_limits<float>::epsilon();
+
+  for (int32_t i = 0; i != num_bins; ++i) {
+    float sum[kNumLanes] = {0};
+
+    const float *p = power + first[i] * kNumLanes;
+    for (int32_t k = offsets[i]; k != offsets[i + 1]; ++k) {
+      float w = weights[k];
+      for (int32_t l = 0; l != kNumLanes; ++l) {
+        sum[l] += w * p[l];
+      }
+      p += kNumLanes;
+    }
+
+    float *m = mel + i * kNumLanes;
+    for (int32_t l = 0; l != kNumLanes; ++l) {
+      m[l] = VectorizableLog(std::max(sum[l], kEps));
+    }
+  }
+}
+
+}  // namespace
+
+bool FastFbank::IsSupported(const knf::FbankOptions &opts) {
+  const auto &frame_opts = opts.frame_opts;
+  int32_t padded_size = frame_opts.PaddedWindowSize();
+
+  return frame_opts.dither == 0 && !opts.use_energy && opts.use_log_fbank &&
+         opts.use_power && !opts.mel_opts.htk_mode &&
+         !opts.mel_opts.is_librosa && padded_size >= 4 &&
+         (padded_size & (padded_size - 1)) == 0 &&
+         frame_opts.WindowShift() > 0 &&
+         frame_opts.WindowSize() <= padded_size;
+}
+
+FastFbank::FastFbank(const knf::FbankOptions &opts)
+    : opts_(opts),
+      frame_length_(opts.frame_opts.WindowSize()),
+      frame_shift_(opts.frame_opts.WindowShift()),
+      padded_size_(opts.frame_opts.PaddedWindowSize()),
+      num_bins_(opts.mel_opts.num_bins) {
+  if (!IsSupported(opts)) {
+    SHERPA_ONNX_LOGE("Unsupported fbank options for FastFbank:\n%s",
+                     opts.ToString().c_str());
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  // Get the window from knf by applying it to a frame of ones
+  window_.assign(frame_length_, 1.0f);
+  knf::FeatureWindowFunction window_function(opts.frame_opts);
+  window_function.Apply(window_.data());
+
+  int32_t n = padded_size_ / 2;
+
+  // exp(-pi i k / n) for k in [0, n]. It is used by both the complex FFT
+  // of size n and the real FFT of size 2n.
+  cos_.resize(n + 1);
+  sin_.resize(n + 1);
+  for (int32_t k = 0; k <= n; ++k) {
+    double a = M_PI * k / n;
+    cos_[k] = static_cast<float>(std::cos(a));
+    sin_[k] = static_cast<float>(std::sin(a));
+  }
+
+  int32_t num_bits = 0;
+  while ((1 << num_bits) < n) {
+    ++num_bits;
+  }
+
+  bit_reverse_.resize(n);
+  for (int32_t i = 0; i != n; ++i) {
+    int32_t r = 0;
+    for (int32_t b = 0; b != num_bits; ++b) {
+      r |= ((i >> b) & 1) << (num_bits - 1 - b);
+    }
+    bit_reverse_[i] = r;
+  }
+
+  // Get the mel weights from knf by applying the filterbank to one-hot
+  // power spectra, so that they are exactly the ones knf uses.
+  knf::MelBanks mel_banks(opts.mel_opts, opts.frame_opts, 1.0f);
+
+  int32_t num_fft_bins = n + 1;
+  std::vector<float> dense(static_cast<int64_t>(num_bins_) * num_fft_bins);
+  std::vector<float> one_hot(num_fft_bins, 0.0f);
+  std::vector<float> out(num_bins_);
+  for (int32_t k = 0; k != num_fft_bins; ++k) {
+    one_hot[k] = 1;
+    mel_banks.Compute(one_hot.data(), out.data());
+    one_hot[k] = 0;
+    for (int32_t i = 0; i != num_bins_; ++i) {
+      dense[i * num_fft_bins + k] = out[i];
+    }
+  }
+
+  mel_first_.resize(num_bins_);
+  mel_offsets_.resize(num_bins_ + 1);
+  mel_offsets_[0] = 0;
+  for (int32_t i = 0; i != num_bins_; ++i) {
+    const float *row = dense.data() + i * num_fft_bins;
+
+    int32_t begin = 0;
+    while (begin < num_fft_bins && row[begin] == 0) {
+      ++begin;
+    }
+
+    int32_t end = num_fft_bins;
+    while (end > begin && row[end - 1] == 0) {
+      --end;
+    }
+
+    mel_first_[i] = begin;
+    mel_weights_.insert(mel_weights_.end(), row + begin, row + end);
+    mel_offsets_[i + 1] = static_cast<int32_t>(mel_weights_.size());
+  }
+
+  frames_.resize(kNumLanes * padded_size_);
+  re_.resize(n * kNumLanes);
+  im_.resize(n * kNumLanes);
+  power_.resize((n + 1) * kNumLanes);
+  mel_.resize(num_bins_ * kNumLanes);
+}
+
+void FastFbank::AcceptWaveform(float sampling_rate, const float *waveform,
+                               int32_t n) {
+  if (sampling_rate != opts_.frame_opts.samp_freq) {
+    SHERPA_ONNX_LOGE("Sampling rate mismatch. Expected: %d, given: %d",
+                     static_cast<int32_t>(opts_.frame_opts.samp_freq),
+                     static_cast<int32_t>(sampling_rate));
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  if (input_finished_) {
+    SHERPA_ONNX_LOGE("AcceptWaveform() called after InputFinished()");
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  if (n <= 0) {
+    return;
+  }
+
+  waveform_remainder_.insert(waveform_remainder_.end(), waveform,
+                             waveform + n);
+  ComputeFeatures();
+}
+
+void FastFbank::InputFinished() {
+  input_finished_ = true;
+  ComputeFeatures();
+}
+
+const float *FastFbank::GetFrame(int32_t frame) const {
+  if (frame < first_valid_ || frame >= num_frames_) {
+    SHERPA_ONNX_LOGE("Invalid frame %d. Available frames: [%d, %d)", frame,
+                     first_valid_, num_frames_);
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  return features_.data() +
+         static_cast<int64_t>(frame - first_frame_) * num_bins_;
+}
+
+void FastFbank::GetFrames(int32_t frame, int32_t n, float *dst) const {
+  if (n <= 0) {
+    return;
+  }
+
+  // GetFrame() checks the range
+  GetFrame(frame + n - 1);
+  const float *src = GetFrame(frame);
+
+  std::copy(src, src + static_cast<int64_t>(n) * num_bins_, dst);
+}
+
+void FastFbank::Pop(int32_t n) {
+  first_valid_ = std::min(first_valid_ + std::max(n, 0), num_frames_);
+
+  // Remove popped frames once they take more than half of the buffer, so
+  // that each frame is moved at most once on average.
+  int32_t num_popped = first_valid_ - first_frame_;
+  if (num_popped > 0 && num_popped >= num_frames_ - first_valid_) {
+    features_.erase(features_.begin(),
+                    features_.begin() +
+                        static_cast<int64_t>(num_popped) * num_bins_);
+    first_frame_ = first_valid_;
+  }
+}
+
+int64_t FastFbank::FirstSampleOfFrame(int32_t frame) const {
+  if (opts_.frame_opts.snip_edges) {
+    return static_cast<int64_t>(frame) * frame_shift_;
+  }
+
+  int64_t midpoint_of_frame =
+      static_cast<int64_t>(frame_shift_) * frame + frame_shift_ / 2;
+  return midpoint_of_frame - frame_length_ / 2;
+}
+
+int32_t FastFbank::NumFrames(int64_t num_samples, bool flush) const {
+  if (opts_.frame_opts.snip_edges) {
+    if (num_samples < frame_length_) {
+      return 0;
+    }
+    return 1 + (num_samples - frame_length_) / frame_shift_;
+  }
+
+  int32_t num_frames = (num_samples + frame_shift_ / 2) / frame_shift_;
+  if (flush) {
+    return num_frames;
+  }
+
+  // Do not output frames that extend past the end of the available samples
+  int64_t end_sample_of_last_frame =
+      FirstSampleOfFrame(num_frames - 1) + frame_length_;
+  while (num_frames > 0 && end_sample_of_last_frame > num_samples) {
+    --num_frames;
+    end_sample_of_last_frame -= frame_shift_;
+  }
+
+  return num_frames;
+}
+
+void FastFbank::ExtractWindow(int32_t f, float *dst) const {
+  const float *wave = waveform_remainder_.data();
+  int64_t wave_dim = waveform_remainder_.size();
+
+  int64_t wave_start = FirstSampleOfFrame(f) - waveform_offset_;
+  int64_t wave_end = wave_start + frame_length_;
+
+  if (wave_start >= 0 && wave_end <= wave_dim) {
+    std::copy(wave + wave_start, wave + wave_end, dst);
+  } else {
+    // Reflect at the boundaries of the available samples
+    for (int32_t s = 0; s != frame_length_; ++s) {
+      int64_t s_in_wave = s + wave_start;
+      while (s_in_wave < 0 || s_in_wave >= wave_dim) {
+        if (s_in_wave < 0) {
+          s_in_wave = -s_in_wave - 1;
+        } else {
+          s_in_wave = 2 * wave_dim - 1 - s_in_wave;
+        }
+      }
+      dst[s] = wave[s_in_wave];
+    }
+  }
+
+  if (opts_.frame_opts.remove_dc_offset) {
+    float sum = 0;
+    for (int32_t i = 0; i != frame_length_; ++i) {
+      sum += dst[i];
+    }
+
+    float mean = sum / frame_length_;
+    for (int32_t i = 0; i != frame_length_; ++i) {
+      dst[i] -= mean;
+    }
+  }
+
+  float preemph_coeff = opts_.frame_opts.preemph_coeff;
+  if (preemph_coeff != 0) {
+    for (int32_t i = frame_length_ - 1; i > 0; --i) {
+      dst[i] -= preemph_coeff * dst[i - 1];
+    }
+    dst[0] -= preemph_coeff * dst[0];
+  }
+
+  for (int32_t i = 0; i != frame_length_; ++i) {
+    dst[i] *= window_[i];
+  }
+
+  std::fill(dst + frame_length_, dst + padded_size_, 0.0f);
+}
+
+void FastFbank::ComputeFrames(const float *frames, int32_t n, float *out) {
+  int32_t half = padded_size_ / 2;
+
+  // Interleave the frames. Even samples go to the real part and odd samples
+  // go to the imaginary part. Unused lanes are set to 0.
+  for (int32_t k = 0; k != half; ++k) {
+    int32_t r = bit_reverse_[k];
+    float *pr = re_.data() + k * kNumLanes;
+    float *pi = im_.data() + k * kNumLanes;
+    for (int32_t l = 0; l != kNumLanes; ++l) {
+      if (l < n) {
+        const float *frame = frames + l * padded_size_;
+        pr[l] = frame[2 * r];
+        pi[l] = frame[2 * r + 1];
+      } else {
+        pr[l] = 0;
+        pi[l] = 0;
+      }
+    }
+  }
+
+  ComplexFft(re_.data(), im_.data(), half, cos_.data(), sin_.data());
+
+  PowerSpectrum(re_.data(), im_.data(), half, cos_.data(), sin_.data(),
+                power_.data());
+
+  LogMel(power_.data(), num_bins_, mel_first_.data(), mel_offsets_.data(),
+         mel_weights_.data(), mel_.data());
+
+  for (int32_t l = 0; l != n; ++l) {
+    float *dst = out + l * num_bins_;
+    for (int32_t i = 0; i != num_bins_; ++i) {
+      dst[i] = mel_[i * kNumLanes + l];
+    }
+  }
+}
+
+void FastFbank::ComputeFeatures() {
+  int64_t num_samples_total = waveform_offset_ + waveform_remainder_.size();
+  int32_t num_frames_new = NumFrames(num_samples_total, input_finished_);
+
+  if (num_frames_new > num_frames_) {
+    features_.resize(static_cast<int64_t>(num_frames_new - first_frame_) *
+                     num_bins_);
+
+    for (int32_t f = num_frames_; f < num_frames_new; f += kNumLanes) {
+      int32_t n = std::min(kNumLanes, num_frames_new - f);
+      for (int32_t i = 0; i != n; ++i) {
+        ExtractWindow(f + i, frames_.data() + i * padded_size_);
+      }
+
+      float *out = features_.data() +
+                   static_cast<int64_t>(f - first_frame_) * num_bins_;
+      ComputeFrames(frames_.data(), n, out);
+    }
+
+    num_frames_ = num_frames_new;
+  }
+
+  // Discard samples that are not needed by later frames
+  int64_t first_sample_of_next_frame = FirstSampleOfFrame(num_frames_new);
+  int64_t samples_to_discard = first_sample_of_next_frame - waveform_offset_;
+  if (samples_to_discard > 0) {
+    int64_t new_num_samples = waveform_remainder_.size() - samples_to_discard;
+    if (new_num_samples <= 0) {
+      waveform_offset_ += waveform_remainder_.size();
+      waveform_remainder_.clear();
+    } else {
+      waveform_remainder_.erase(
+          waveform_remainder_.begin(),
+          waveform_remainder_.begin() + samples_to_discard);
+      waveform_offset_ += samples_to_discard;
+    }
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,117 @@
+// sherpa-onnx/csrc/fast-fbank.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_FAST_FBANK_H_
+#define SHERPA_ONNX_CSRC_FAST_FBANK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "kaldi-native-fbank/csrc/feature-fbank.h"
+
+namespace sherpa_onnx {
+
+// A drop-in replacement of knf::OnlineFbank for the common case, i.e.,
+// log mel filterbank without dithering and energy.
+//
+// Frames are processed in groups of kNumLanes. Samples of the frames in a
+// group are interleaved so that the FFT, the mel filterbank and the log
+// run on all frames of the group with vector instructions. Features are
+// kept in a single contiguous buffer and GetFrames() copies a range of
+// frames with one call.
+//
+// The output agrees with knf::OnlineFbank up to floating point rounding.
+// Frame extraction and mel weights are identical; the FFT and the log
+// are different implementations.
+class FastFbank {
+ public:
+  static constexpr int32_t kNumLanes = 8;
+
+  // Return true if FastFbank can be used for the given options.
+  static bool IsSupported(const knf::FbankOptions &opts);
+
+  explicit FastFbank(const knf::FbankOptions &opts);
+
+  int32_t Dim() const { return num_bins_; }
+
+  // sampling_rate must equal opts.frame_opts.samp_freq
+  void AcceptWaveform(float sampling_rate, const float *waveform, int32_t n);
+
+  void InputFinished();
+
+  int32_t NumFramesReady() const { return num_frames_; }
+
+  bool IsLastFrame(int32_t frame) const {
+    return input_finished_ && frame == num_frames_ - 1;
+  }
+
+  const float *GetFrame(int32_t frame) const;
+
+  // Copy frames [frame, frame + n) to dst, which has n * Dim() entries.
+  void GetFrames(int32_t frame, int32_t n, float *dst) const;
+
+  // Discard the n oldest frames that have not been discarded yet.
+  // Indexes of the remaining frames are not changed.
+  void Pop(int32_t n);
+
+ private:
+  void ComputeFeatures();
+
+  int64_t FirstSampleOfFrame(int32_t frame) const;
+  int32_t NumFrames(int64_t num_samples, bool flush) const;
+
+  // Extract the windowed frame f into dst, which has padded_size_ entries
+  void ExtractWindow(int32_t f, float *dst) const;
+
+  // frames: (n, padded_size_), n <= kNumLanes
+  // out: (n, num_bins_)
+  void ComputeFrames(const float *frames, int32_t n, float *out);
+
+ private:
+  knf::FbankOptions opts_;
+
+  int32_t frame_length_;
+  int32_t frame_shift_;
+  int32_t padded_size_;
+  int32_t num_bins_;
+
+  std::vector<float> window_;  // window function, of size frame_length_
+
+  // cos_[k] = cos(2 * pi * k / padded_size_) and sin_ likewise, for k in
+  // [0, padded_size_ / 2], and the bit-reversal permutation for the
+  // complex FFT of size padded_size_ / 2 used to compute the real FFT of
+  // size padded_size_
+  std::vector<float> cos_;
+  std::vector<float> sin_;
+  std::vector<int32_t> bit_reverse_;
+
+  // The mel filterbank in CSR format. Bin i has weights
+  // mel_weights_[mel_offsets_[i] .. mel_offsets_[i + 1]) for power spectrum
+  // entries starting at mel_first_[i].
+  std::vector<int32_t> mel_first_;
+  std::vector<int32_t> mel_offsets_;
+  std::vector<float> mel_weights_;
+
+  // Buffers for ComputeFeatures(), reused across calls
+  std::vector<float> frames_;
+  std::vector<float> re_;
+  std::vector<float> im_;
+  std::vector<float> power_;
+  std::vector<float> mel_;
+
+  std::vector<float> waveform_remainder_;
+  int64_t waveform_offset_ = 0;
+  bool input_finished_ = false;
+
+  // features_ contains frames [first_frame_, num_frames_). Frames before
+  // first_valid_ have been popped and are removed from features_ lazily.
+  std::vector<float> features_;
+  int32_t first_frame_ = 0;
+  int32_t first_valid_ = 0;
+  int32_t num_frames_ = 0;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_FAST_FBANK_H_
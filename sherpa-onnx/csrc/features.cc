@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "kaldi-native-fbank/csrc/online-feature.h"
+#include "sherpa-onnx/csrc/fast-fbank.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/resample.h"
 
@@ -38,6 +39,12 @@ void FeatureExtractorConfig::Register(ParseOptions *po) {
                "By default the audio samples are in range [-1,+1], "
                "so 0.00003 is a good value, "
                "equivalent to the default 1.0 from kaldi");
+
+  po->Register("use-fast-fbank", &use_fast_fbank,
+               "True to compute fbank features with the vectorized "
+               "implementation if it supports the feature options. "
+               "Its output may differ slightly from the default one "
+               "due to floating point rounding");
 }
 
 std::string FeatureExtractorConfig::ToString() const {
@@ -50,7 +57,8 @@ std::string FeatureExtractorConfig::ToString() const {
   os << "high_freq=" << high_freq << ", ";
   os << "dither=" << dither << ", ";
   os << "normalize_samples=" << (normalize_samples ? "True" : "False") << ", ";
-  os << "snip_edges=" << (snip_edges ? "True" : "False") << ")";
+  os << "snip_edges=" << (snip_edges ? "True" : "False") << ", ";
+  os << "use_fast_fbank=" << (use_fast_fbank ? "True" : "False") << ")";
 
   return os.str();
 }
@@ -94,11 +102,10 @@ class FeatureExtractor::Impl {
         exit(-1);
       }
 
-      std::vector<float> samples;
-      resampler_->Resample(waveform, n, false, &samples);
+      resampler_->Resample(waveform, n, false, &resampled_);
 
-      AcceptWaveformWrapper(config_.sampling_rate, samples.data(),
-                            samples.size());
+      AcceptWaveformWrapper(config_.sampling_rate, resampled_.data(),
+                            resampled_.size());
       return;
     }
 
@@ -117,11 +124,10 @@ class FeatureExtractor::Impl {
           sampling_rate, config_.sampling_rate, lowpass_cutoff,
           lowpass_filter_width);
 
-      std::vector<float> samples;
-      resampler_->Resample(waveform, n, false, &samples);
+      resampler_->Resample(waveform, n, false, &resampled_);
 
-      AcceptWaveformWrapper(config_.sampling_rate, samples.data(),
-                            samples.size());
+      AcceptWaveformWrapper(config_.sampling_rate, resampled_.data(),
+                            resampled_.size());
 
       return;
     }
@@ -131,7 +137,10 @@ class FeatureExtractor::Impl {
 
   void InputFinished() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (fbank_) {
+    if (fast_fbank_) {
+      fast_fbank_->InputFinished();
+      return;
+    } else if (fbank_) {
       fbank_->InputFinished();
       return;
     } else if (whisper_fbank_) {
@@ -150,7 +159,9 @@ class FeatureExtractor::Impl {
   }
 
   int32_t NumFramesReady() const {
-    if (fbank_) {
+    if (fast_fbank_) {
+      return fast_fbank_->NumFramesReady();
+    } else if (fbank_) {
       return fbank_->NumFramesReady();
     } else if (whisper_fbank_) {
       return whisper_fbank_->NumFramesReady();
@@ -166,7 +177,9 @@ class FeatureExtractor::Impl {
 
   bool IsLastFrame(int32_t frame) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (fbank_) {
+    if (fast_fbank_) {
+      return fast_fbank_->IsLastFrame(frame);
+    } else if (fbank_) {
       return fbank_->IsLastFrame(frame);
     } else if (whisper_fbank_) {
       return whisper_fbank_->IsLastFrame(frame);
@@ -181,7 +194,7 @@ class FeatureExtractor::Impl {
     return false;
   }
 
-  std::vector<float> GetFrames(int32_t frame_index, int32_t n) {
+  void GetFrames(int32_t frame_index, int32_t n, float *dst) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (frame_index + n > NumFramesReady()) {
       SHERPA_ONNX_LOGE("%d + %d > %d\n", frame_index, n, NumFramesReady());
@@ -197,24 +210,25 @@ class FeatureExtractor::Impl {
 
     PopWrapper(discard_num);
 
-    int32_t feature_dim = FeatureDim();
-    std::vector<float> features(feature_dim * n);
-
-    float *p = features.data();
+    if (fast_fbank_) {
+      // Frames are contiguous, so they are copied with a single call
+      fast_fbank_->GetFrames(frame_index, n, dst);
+    } else {
+      int32_t feature_dim = FeatureDim();
+      float *p = dst;
 
-    for (int32_t i = 0; i != n; ++i) {
-      const float *f = GetFrameWrapper(i + frame_index);
-      std::copy(f, f + feature_dim, p);
-      p += feature_dim;
+      for (int32_t i = 0; i != n; ++i) {
+        const float *f = GetFrameWrapper(i + frame_index);
+        std::copy(f, f + feature_dim, p);
+        p += feature_dim;
+      }
     }
 
     last_frame_index_ = frame_index;
-
-    return features;
   }
 
   int32_t FeatureDim() const {
-    if (fbank_ || whisper_fbank_) {
+    if (fast_fbank_ || fbank_ || whisper_fbank_) {
       return opts_.mel_opts.num_bins;
     } else if (mfcc_) {
       return mfcc_opts_.num_ceps;
@@ -230,7 +244,10 @@ class FeatureExtractor::Impl {
  private:
   void AcceptWaveformWrapper(float sampling_rate, const float *waveform,
                              int32_t n) const {
-    if (fbank_) {
+    if (fast_fbank_) {
+      fast_fbank_->AcceptWaveform(sampling_rate, waveform, n);
+      return;
+    } else if (fbank_) {
       fbank_->AcceptWaveform(sampling_rate, waveform, n);
       return;
     } else if (whisper_fbank_) {
@@ -249,7 +266,9 @@ class FeatureExtractor::Impl {
   }
 
   const float *GetFrameWrapper(int32_t frame_index) const {
-    if (fbank_) {
+    if (fast_fbank_) {
+      return fast_fbank_->GetFrame(frame_index);
+    } else if (fbank_) {
       return fbank_->GetFrame(frame_index);
     } else if (whisper_fbank_) {
       return whisper_fbank_->GetFrame(frame_index);
@@ -265,7 +284,10 @@ class FeatureExtractor::Impl {
   }
 
   void PopWrapper(int32_t discard_num) const {
-    if (fbank_) {
+    if (fast_fbank_) {
+      fast_fbank_->Pop(discard_num);
+      return;
+    } else if (fbank_) {
       fbank_->Pop(discard_num);
       return;
     } else if (whisper_fbank_) {
@@ -301,7 +323,11 @@ class FeatureExtractor::Impl {
 
     opts_.mel_opts.is_librosa = config_.is_librosa;
 
-    fbank_ = std::make_unique<knf::OnlineFbank>(opts_);
+    if (config_.use_fast_fbank && FastFbank::IsSupported(opts_)) {
+      fast_fbank_ = std::make_unique<FastFbank>(opts_);
+    } else {
+      fbank_ = std::make_unique<knf::OnlineFbank>(opts_);
+    }
   }
 
   void InitMfcc() {
@@ -350,6 +376,7 @@ class FeatureExtractor::Impl {
   }
 
  private:
+  std::unique_ptr<FastFbank> fast_fbank_;
   std::unique_ptr<knf::OnlineFbank> fbank_;
   std::unique_ptr<knf::OnlineMfcc> mfcc_;
   std::unique_ptr<knf::OnlineWhisperFbank> whisper_fbank_;
@@ -360,6 +387,9 @@ class FeatureExtractor::Impl {
   FeatureExtractorConfig config_;
   mutable std::mutex mutex_;
   std::unique_ptr<LinearResample> resampler_;
+
+  // output of resampler_, reused across calls
+  std::vector<float> resampled_;
   int32_t last_frame_index_ = 0;
 };
 
@@ -385,7 +415,14 @@ bool FeatureExtractor::IsLastFrame(int32_t frame) const {
 
 std::vector<float> FeatureExtractor::GetFrames(int32_t frame_index,
                                                int32_t n) const {
-  return impl_->GetFrames(frame_index, n);
+  std::vector<float> features(static_cast<int64_t>(n) * FeatureDim());
+  impl_->GetFrames(frame_index, n, features.data());
+  return features;
+}
+
+void FeatureExtractor::GetFrames(int32_t frame_index, int32_t n,
+                                 float *dst) const {
+  impl_->GetFrames(frame_index, n, dst);
 }
 
 int32_t FeatureExtractor::FeatureDim() const { return impl_->FeatureDim(); }
@@ -85,6 +85,11 @@ struct FeatureExtractorConfig {
 
   bool round_to_power_of_two = true;
 
+  // If true, use FastFbank instead of knf::OnlineFbank for fbank features
+  // when the options are supported by it. Its output agrees with
+  // knf::OnlineFbank only up to floating point rounding.
+  bool use_fast_fbank = false;
+
   std::string ToString() const;
 
   void Register(ParseOptions *po);
@@ -130,6 +135,10 @@ class FeatureExtractor {
    */
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) const;
 
+  // Like GetFrames() above, but write the frames to dst, which must have
+  // n * FeatureDim() entries.
+  void GetFrames(int32_t frame_index, int32_t n, float *dst) const;
+
   /// Return feature dim of this extractor
   int32_t FeatureDim() const;
 
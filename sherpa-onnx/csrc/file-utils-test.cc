@@ -0,0 +1,43 @@
+// sherpa-onnx/csrc/file-utils-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/file-utils.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(FileUtils, MapFile) {
+  std::string filename = "sherpa-onnx-file-utils-test.bin";
+  std::string contents = "hello sherpa-onnx";
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os << contents;
+  }
+
+  {
+    FileBuffer a = MapFile(filename);
+    ASSERT_EQ(a.size(), contents.size());
+    EXPECT_EQ(std::string(a.data(), a.size()), contents);
+
+    // The same file is mapped only once
+    FileBuffer b = MapFile(filename);
+    EXPECT_EQ(a.data(), b.data());
+  }
+
+  std::vector<char> buf = ReadFile(filename);
+  EXPECT_EQ(std::string(buf.begin(), buf.end()), contents);
+
+  FileBuffer c = MapFile(filename);
+  EXPECT_EQ(std::string(c.data(), c.size()), contents);
+
+  std::remove(filename.c_str());
+}
+
+}  // namespace sherpa_onnx
@@ -6,8 +6,28 @@
 
 #include <fstream>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHERPA_ONNX_HAS_MMAP 1
+#endif
 
 #include "sherpa-onnx/csrc/macros.h"
 
@@ -30,6 +50,115 @@ std::vector<char> ReadFile(const std::string &filename) {
   return buffer;
 }
 
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &filename) {
+#if defined(_WIN32)
+    HANDLE file =
+        CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+      LARGE_INTEGER size;
+      if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE mapping =
+            CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+          void *p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+          if (p) {
+            data_ = reinterpret_cast<const char *>(p);
+            size_ = static_cast<size_t>(size.QuadPart);
+            mapped_ = true;
+          }
+          CloseHandle(mapping);
+        }
+      }
+      CloseHandle(file);
+    }
+#elif SHERPA_ONNX_HAS_MMAP
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd != -1) {
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+          data_ = reinterpret_cast<const char *>(p);
+          size_ = static_cast<size_t>(st.st_size);
+          mapped_ = true;
+        }
+      }
+      close(fd);
+    }
+#endif
+
+    if (!mapped_) {
+      buffer_ = ReadFile(filename);
+      data_ = buffer_.data();
+      size_ = buffer_.size();
+    }
+  }
+
+  ~MappedFile() {
+    if (!mapped_) {
+      return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(data_);
+#elif SHERPA_ONNX_HAS_MMAP
+    munmap(const_cast<char *>(data_), size_);
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+ private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+
+  // Used only if the file cannot be mapped
+  std::vector<char> buffer_;
+};
+
+FileBuffer::FileBuffer(std::shared_ptr<MappedFile> file)
+    : file_(std::move(file)) {}
+
+const char *FileBuffer::data() const {
+  return file_ ? file_->Data() : nullptr;
+}
+
+size_t FileBuffer::size() const { return file_ ? file_->Size() : 0; }
+
+FileBuffer MapFile(const std::string &filename) {
+  AssertFileExists(filename);
+
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::weak_ptr<MappedFile>> files;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto &file = files[filename];
+  auto ans = file.lock();
+  if (!ans) {
+    ans = std::make_shared<MappedFile>(filename);
+    file = ans;
+
+    // Remove entries of files that have been released
+    for (auto it = files.begin(); it != files.end();) {
+      if (it->second.expired()) {
+        it = files.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  return FileBuffer(std::move(ans));
+}
+
 #if __ANDROID_API__ >= 9
 std::vector<char> ReadFile(AAssetManager *mgr, const std::string &filename) {
   if (!filename.empty() && filename[0] == '/') {
@@ -6,6 +6,7 @@
 #define SHERPA_ONNX_CSRC_FILE_UTILS_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -35,6 +36,41 @@ void AssertFileExists(const std::string &filename);
 
 std::vector<char> ReadFile(const std::string &filename);
 
+class MappedFile;
+
+// Contents of a file returned by MapFile().
+//
+// It provides data() and size() like std::vector<char> so that it can
+// be used in place of the return value of ReadFile(). Copying it is
+// cheap; all copies refer to the same memory.
+class FileBuffer {
+ public:
+  FileBuffer() = default;
+  explicit FileBuffer(std::shared_ptr<MappedFile> file);
+
+  // The memory is read-only. Copy it if you need to modify it.
+  const char *data() const;
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+
+ private:
+  std::shared_ptr<MappedFile> file_;
+};
+
+/** Map a file into memory, e.g., an onnx model, without copying it.
+ *
+ * Pages of the file are read on demand from the page cache, which is shared
+ * with other processes mapping the same file, e.g., forked workers.
+ * Calls with the same filename return the same mapping as long as a
+ * returned FileBuffer is alive, so models loaded by several recognizers
+ * at the same time are mapped only once.
+ *
+ * If memory mapping is not supported, it falls back to ReadFile().
+ *
+ * @param filename The file to map. It aborts if it does not exist.
+ */
+FileBuffer MapFile(const std::string &filename);
+
 #if __ANDROID_API__ >= 9
 std::vector<char> ReadFile(AAssetManager *mgr, const std::string &filename);
 #endif
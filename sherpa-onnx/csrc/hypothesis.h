@@ -22,6 +22,18 @@
 
 namespace sherpa_onnx {
 
+// Output and states of the NN LM after it has seen a token sequence.
+// Used in shallow fusion. It is never changed after it is created, so
+// hypotheses with the same history share it.
+struct NnLmState {
+  // log probs of the next token. Its size equals to the vocabulary size
+  std::vector<float> scores;
+
+  // states[i] is the i-th state of the LM for this sequence, e.g., h and c
+  // of an LSTM LM, with the batch axis removed
+  std::vector<std::vector<float>> states;
+};
+
 struct Hypothesis {
   // The predicted tokens so far. Newly predicated tokens are appended.
   std::vector<int64_t> ys;
@@ -53,18 +65,22 @@ struct Hypothesis {
   // LM log prob if any.
   double lm_log_prob = 0;
 
-  // the nn lm score for next token given the current ys,
+  // the nn lm scores and states given the current ys,
   // when using shallow fusion
-  CopyableOrtValue nn_lm_scores;
+  std::shared_ptr<const NnLmState> nn_lm_state;
+
+  // true if nn_lm_state does not include ys.back() yet.
+  // Used in shallow fusion.
+  bool nn_lm_pending = false;
 
   // cur scored tokens by RNN LM, when rescoring
   int32_t cur_scored_pos = 0;
 
-  // the nn lm states
+  // the nn lm states, when rescoring
   std::vector<CopyableOrtValue> nn_lm_states;
 
   // the LODR states
-  std::shared_ptr<LodrStateCost> lodr_state;
+  LodrStateCost lodr_state;
 
   const ContextState *context_state;
 
@@ -122,7 +138,7 @@ class Hypotheses {
   // Get the hyp that has the largest log_prob.
   // If length_norm is true, hyp's log_prob is divided by
   // len(hyp.ys) before comparison.
-  Hypothesis GetMostProbable(bool length_norm) const;
+  const Hypothesis &GetMostProbable(bool length_norm) const;
 
   // Get the k hyps that have the largest log_prob.
   // If length_norm is true, hyp's log_prob is divided by
@@ -0,0 +1,147 @@
+// sherpa-onnx/csrc/io-binding-runner.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/io-binding-runner.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+// Maximum number of free tensors kept for each type and shape. It is
+// about the number of threads running the model at the same time.
+static constexpr int32_t kMaxFreeTensors = 4;
+
+IoBindingRunner::IoBindingRunner(Ort::Session *sess,
+                                 const std::vector<const char *> &input_names,
+                                 const std::vector<const char *> &output_names,
+                                 OrtAllocator *allocator)
+    : sess_(sess),
+      input_names_(input_names),
+      output_names_(output_names),
+      allocator_(allocator) {}
+
+IoBindingRunner::~IoBindingRunner() = default;
+
+IoBindingRunner::TensorInfo IoBindingRunner::GetTensorInfo(
+    const Ort::Value &v) {
+  auto type_and_shape = v.GetTensorTypeAndShapeInfo();
+  return {type_and_shape.GetElementType(), type_and_shape.GetShape()};
+}
+
+std::vector<Ort::Value> IoBindingRunner::Run(const Ort::Value *inputs,
+                                             int32_t num_inputs) {
+  // Key of output_info_: type, rank and dims of each input
+  std::vector<int64_t> key;
+  for (int32_t i = 0; i != num_inputs; ++i) {
+    TensorInfo info = GetTensorInfo(inputs[i]);
+    key.push_back(info.type);
+    key.push_back(info.shape.size());
+    key.insert(key.end(), info.shape.begin(), info.shape.end());
+  }
+
+  std::vector<TensorInfo> output_info;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = output_info_.find(key);
+    if (it != output_info_.end()) {
+      output_info = it->second;
+    }
+  }
+
+  if (output_info.empty()) {
+    // We don't know the output shapes for these inputs yet, so let
+    // onnxruntime allocate the outputs this time.
+    auto out = sess_->Run({}, input_names_.data(), inputs, num_inputs,
+                          output_names_.data(), output_names_.size());
+
+    for (const auto &v : out) {
+      output_info.push_back(GetTensorInfo(v));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    output_info_[key] = std::move(output_info);
+
+    return out;
+  }
+
+  std::vector<Ort::Value> out;
+  out.reserve(output_info.size());
+  for (const auto &info : output_info) {
+    out.push_back(GetTensor(info));
+  }
+
+  auto binding = GetBinding();
+  for (int32_t i = 0; i != num_inputs; ++i) {
+    binding->BindInput(input_names_[i], inputs[i]);
+  }
+
+  for (int32_t i = 0; i != static_cast<int32_t>(out.size()); ++i) {
+    binding->BindOutput(output_names_[i], out[i]);
+  }
+
+  sess_->Run({}, *binding);
+
+  binding->ClearBoundInputs();
+  binding->ClearBoundOutputs();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_bindings_.push_back(std::move(binding));
+
+  return out;
+}
+
+void IoBindingRunner::Recycle(Ort::Value v) {
+  if (!v || !v.IsTensor()) {
+    return;
+  }
+
+  TensorInfo info = GetTensorInfo(v);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (shared_.count(v.GetTensorRawData())) {
+    return;
+  }
+
+  auto &tensors = free_tensors_[info];
+  if (static_cast<int32_t>(tensors.size()) < kMaxFreeTensors) {
+    tensors.push_back(std::move(v));
+  }
+}
+
+void IoBindingRunner::AddSharedTensor(const Ort::Value &v) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  shared_.insert(v.GetTensorRawData());
+}
+
+Ort::Value IoBindingRunner::GetTensor(const TensorInfo &info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = free_tensors_.find(info);
+    if (it != free_tensors_.end() && !it->second.empty()) {
+      Ort::Value ans = std::move(it->second.back());
+      it->second.pop_back();
+      return ans;
+    }
+  }
+
+  return Ort::Value::CreateTensor(allocator_, info.shape.data(),
+                                  info.shape.size(), info.type);
+}
+
+std::unique_ptr<Ort::IoBinding> IoBindingRunner::GetBinding() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_bindings_.empty()) {
+      auto ans = std::move(free_bindings_.back());
+      free_bindings_.pop_back();
+      return ans;
+    }
+  }
+
+  return std::make_unique<Ort::IoBinding>(*sess_);
+}
+
+}  // namespace sherpa_onnx
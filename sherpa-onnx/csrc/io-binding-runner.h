@@ -0,0 +1,95 @@
+// sherpa-onnx/csrc/io-binding-runner.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_IO_BINDING_RUNNER_H_
+#define SHERPA_ONNX_CSRC_IO_BINDING_RUNNER_H_
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+
+namespace sherpa_onnx {
+
+// Run a session with Ort::IoBinding so that outputs are written to tensors
+// we provide instead of tensors allocated by onnxruntime in every call.
+//
+// It is for streaming models whose next states have the same shapes as
+// their input states. After a call, the caller gives the input states back
+// with Recycle() and their memory is used for the next states of a later
+// call. Handing states from one chunk to the next is then a pointer swap
+// and no memory is allocated for states once the pool is warm.
+//
+// It is safe to call its methods from multiple threads.
+class IoBindingRunner {
+ public:
+  IoBindingRunner(Ort::Session *sess,
+                  const std::vector<const char *> &input_names,
+                  const std::vector<const char *> &output_names,
+                  OrtAllocator *allocator);
+
+  ~IoBindingRunner();
+
+  /** Run the session.
+   *
+   * @param inputs Array of size num_inputs. They are in the same order
+   *               as input_names passed to the constructor.
+   * @param num_inputs Number of inputs.
+   *
+   * @return Return the outputs in the same order as output_names passed
+   *         to the constructor. They own their memory.
+   */
+  std::vector<Ort::Value> Run(const Ort::Value *inputs, int32_t num_inputs);
+
+  // Make the memory of v available to the outputs of later calls to Run().
+  // v must own its memory and the caller must not use it afterwards.
+  // It is a no-op if v shares memory with a tensor passed to
+  // AddSharedTensor().
+  void Recycle(Ort::Value v);
+
+  // Register a tensor whose memory is shared, e.g., an initial state that
+  // is returned to streams as a view. Recycle() ignores it.
+  void AddSharedTensor(const Ort::Value &v);
+
+ private:
+  struct TensorInfo {
+    ONNXTensorElementDataType type;
+    std::vector<int64_t> shape;
+
+    bool operator<(const TensorInfo &other) const {
+      if (type != other.type) {
+        return type < other.type;
+      }
+      return shape < other.shape;
+    }
+  };
+
+  static TensorInfo GetTensorInfo(const Ort::Value &v);
+
+  // Return a recycled tensor or allocate one if there is none.
+  Ort::Value GetTensor(const TensorInfo &info);
+
+  std::unique_ptr<Ort::IoBinding> GetBinding();
+
+ private:
+  Ort::Session *sess_;
+  std::vector<const char *> input_names_;
+  std::vector<const char *> output_names_;
+  OrtAllocator *allocator_;
+
+  std::mutex mutex_;
+
+  // Map shapes of all inputs to the types and shapes of outputs
+  std::map<std::vector<int64_t>, std::vector<TensorInfo>> output_info_;
+
+  std::map<TensorInfo, std::vector<Ort::Value>> free_tensors_;
+  std::vector<std::unique_ptr<Ort::IoBinding>> free_bindings_;
+  std::unordered_set<const void *> shared_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_IO_BINDING_RUNNER_H_
@@ -254,7 +254,7 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
         memory_info, all_processed_frames.data(), all_processed_frames.size(),
         processed_frames_shape.data(), processed_frames_shape.size());
 
-    auto states = model_->StackStates(states_vec);
+    auto states = model_->StackStates(std::move(states_vec));
 
     auto pair = model_->RunEncoder(std::move(x), std::move(states),
                                    std::move(processed_frames));
@@ -262,7 +262,7 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
     decoder_->Decode(std::move(pair.first), ss, &results);
 
     std::vector<std::vector<Ort::Value>> next_states =
-        model_->UnStackStates(pair.second);
+        model_->UnStackStates(std::move(pair.second));
 
     for (int32_t i = 0; i != n; ++i) {
       ss[i]->SetKeywordResult(results[i]);
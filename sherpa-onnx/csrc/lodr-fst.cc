@@ -5,22 +5,33 @@
 //
 // Copyright (c)  2025 Tilde SIA (Askars Salimbajevs)
 
+#include "sherpa-onnx/csrc/lodr-fst.h"
+
 #include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
 #include <utility>
 #include <vector>
 
-#include "sherpa-onnx/csrc/lodr-fst.h"
-#include "sherpa-onnx/csrc/log.h"
+#include "kaldifst/csrc/kaldi-fst-io.h"
 #include "sherpa-onnx/csrc/hypothesis.h"
+#include "sherpa-onnx/csrc/log.h"
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
 
-int32_t LodrFst::FindBackoffId() {
+// Use a dense label -> arc table for states whose arcs cover at least
+// 1/kDenseRatio of all labels
+static constexpr int32_t kDenseRatio = 4;
+static constexpr int32_t kMinDenseArcs = 16;
+
+static int32_t FindBackoffId(const fst::StdVectorFst &fst) {
   // assume that the backoff id is the only input label with epsilon output
 
-  for (int32_t state = 0; state < fst_->NumStates(); ++state) {
-    fst::ArcIterator<fst::StdConstFst> arc_iter(*fst_, state);
+  for (int32_t state = 0; state < fst.NumStates(); ++state) {
+    fst::ArcIterator<fst::StdVectorFst> arc_iter(fst, state);
     for ( ; !arc_iter.Done(); arc_iter.Next()) {
       const auto& arc = arc_iter.Value();
       if (arc.olabel == 0) {  // Check if the output label is epsilon (0)
@@ -34,78 +45,128 @@ int32_t LodrFst::FindBackoffId() {
 
 LodrFst::LodrFst(const std::string &fst_path, int32_t backoff_id)
     : backoff_id_(backoff_id) {
-  fst_ = std::unique_ptr<fst::StdConstFst>(
-    CastOrConvertToConstFst(fst::StdVectorFst::Read(fst_path)));
+  std::unique_ptr<fst::StdVectorFst> fst(fst::StdVectorFst::Read(fst_path));
+  if (!fst) {
+    SHERPA_ONNX_LOGE("Failed to read LODR FST from '%s'", fst_path.c_str());
+    SHERPA_ONNX_EXIT(-1);
+  }
 
   if (backoff_id < 0) {
     // backoff_id_ is not provided, find it automatically
-    backoff_id_ = FindBackoffId();
+    backoff_id_ = FindBackoffId(*fst);
     if (backoff_id_ < 0) {
       std::string err_msg = "Failed to initialize LODR: No backoff arc found";
       SHERPA_ONNX_LOGE("%s", err_msg.c_str());
       SHERPA_ONNX_EXIT(-1);
     }
   }
-}
 
-std::vector<std::tuple<int32_t, float>> LodrFst::ProcessBackoffArcs(
-  int32_t state, float cost) {
-  std::vector<std::tuple<int32_t, float>> ans;
-  auto next = GetNextStatesCostsNoBackoff(state, backoff_id_);
-  if (!next.has_value()) {
-    return ans;
-  }
-  auto [next_state, next_cost] = next.value();
-  ans.emplace_back(next_state, next_cost + cost);
-  auto recursive_result = ProcessBackoffArcs(next_state, next_cost + cost);
-  ans.insert(ans.end(), recursive_result.begin(), recursive_result.end());
-  return ans;
-}
+  int32_t num_states = fst->NumStates();
+  arc_offsets_.resize(num_states + 1);
+  final_costs_.resize(num_states);
+
+  std::vector<std::pair<int32_t, int32_t>> order;  // (label, arc index)
+  std::vector<int32_t> next_states;
+  std::vector<float> weights;
+
+  for (int32_t s = 0; s != num_states; ++s) {
+    arc_offsets_[s] = static_cast<int32_t>(labels_.size());
+
+    auto final_weight = fst->Final(s);
+    final_costs_[s] = final_weight == fst::StdArc::Weight::Zero()
+                          ? 0
+                          : final_weight.Value();
 
-std::optional<std::tuple<int32_t, float>> LodrFst::GetNextStatesCostsNoBackoff(
-  int32_t state, int32_t label) {
-  fst::ArcIterator<fst::StdConstFst> arc_iter(*fst_, state);
-  int32_t num_arcs = fst_->NumArcs(state);
-
-  int32_t left = 0, right = num_arcs - 1;
-  while (left <= right) {
-    int32_t mid = (left + right) / 2;
-    arc_iter.Seek(mid);
-    auto arc = arc_iter.Value();
-    if (arc.ilabel < label) {
-      left = mid + 1;
-    } else if (arc.ilabel > label) {
-      right = mid - 1;
-    } else {
-      return std::make_tuple(arc.nextstate, arc.weight.Value());
+    order.clear();
+    next_states.clear();
+    weights.clear();
+
+    for (fst::ArcIterator<fst::StdVectorFst> it(*fst, s); !it.Done();
+         it.Next()) {
+      const auto &arc = it.Value();
+      order.emplace_back(arc.ilabel, static_cast<int32_t>(order.size()));
+      next_states.push_back(arc.nextstate);
+      weights.push_back(arc.weight.Value());
+      max_label_ = std::max(max_label_, static_cast<int32_t>(arc.ilabel));
+    }
+
+    std::sort(order.begin(), order.end());
+
+    for (const auto &p : order) {
+      labels_.push_back(p.first);
+      next_states_.push_back(next_states[p.second]);
+      weights_.push_back(weights[p.second]);
     }
   }
-  return std::nullopt;
-}
+  arc_offsets_[num_states] = static_cast<int32_t>(labels_.size());
 
-std::pair<std::vector<int32_t>, std::vector<float>> LodrFst::GetNextStateCosts(
-  int32_t state, int32_t label) {
-  std::vector<int32_t> states = {state};
-  std::vector<float> costs = {0};
+  dense_offsets_.resize(num_states, -1);
+  for (int32_t s = 0; s != num_states; ++s) {
+    int32_t begin = arc_offsets_[s];
+    int32_t end = arc_offsets_[s + 1];
+    int32_t n = end - begin;
+    if (n < kMinDenseArcs || n * kDenseRatio < max_label_ + 1) {
+      continue;
+    }
 
-  auto extra_states_costs = ProcessBackoffArcs(state, 0);
-  for (const auto& [s, c] : extra_states_costs) {
-    states.push_back(s);
-    costs.push_back(c);
+    dense_offsets_[s] = static_cast<int32_t>(dense_arcs_.size());
+    dense_arcs_.resize(dense_arcs_.size() + max_label_ + 1, -1);
+    int32_t *p = dense_arcs_.data() + dense_offsets_[s];
+    // Go backwards so that the first arc wins if there are duplicates
+    for (int32_t i = end - 1; i >= begin; --i) {
+      if (labels_[i] >= 0) {
+        p[labels_[i]] = i;
+      }
+    }
   }
 
-  std::vector<int32_t> next_states;
-  std::vector<float> next_costs;
-  for (size_t i = 0; i < states.size(); ++i) {
-    auto next = GetNextStatesCostsNoBackoff(states[i], label);
-    if (next.has_value()) {
-      auto [ns, nc] = next.value();
-      next_states.push_back(ns);
-      next_costs.push_back(costs[i] + nc);
+  BuildClosure();
+}
+
+int32_t LodrFst::FindArc(int32_t state, int32_t label) const {
+  if (dense_offsets_[state] >= 0) {
+    if (label < 0 || label > max_label_) {
+      return -1;
     }
+    return dense_arcs_[dense_offsets_[state] + label];
   }
 
-  return std::make_pair(next_states, next_costs);
+  const int32_t *begin = labels_.data() + arc_offsets_[state];
+  const int32_t *end = labels_.data() + arc_offsets_[state + 1];
+  const int32_t *p = std::lower_bound(begin, end, label);
+  if (p == end || *p != label) {
+    return -1;
+  }
+
+  return static_cast<int32_t>(p - labels_.data());
+}
+
+void LodrFst::BuildClosure() {
+  int32_t num_states = static_cast<int32_t>(final_costs_.size());
+  closure_offsets_.resize(num_states + 1);
+
+  for (int32_t s = 0; s != num_states; ++s) {
+    closure_offsets_[s] = static_cast<int32_t>(closure_states_.size());
+
+    int32_t state = s;
+    float cost = 0;
+
+    // An n-gram FST has at most n-1 backoff arcs in a row. We stop at
+    // num_states to guard against malformed FSTs with backoff cycles.
+    for (int32_t k = 0; k <= num_states; ++k) {
+      closure_states_.push_back(state);
+      closure_costs_.push_back(cost);
+
+      int32_t arc = FindArc(state, backoff_id_);
+      if (arc == -1) {
+        break;
+      }
+
+      state = next_states_[arc];
+      cost += weights_[arc];
+    }
+  }
+  closure_offsets_[num_states] = static_cast<int32_t>(closure_states_.size());
 }
 
 void LodrFst::ComputeScore(float scale, Hypothesis *hyp, int32_t offset) {
@@ -113,14 +174,16 @@ void LodrFst::ComputeScore(float scale, Hypothesis *hyp, int32_t offset) {
     return;
   }
 
-  hyp->lodr_state = std::make_unique<LodrStateCost>(this);
+  LodrStateCost state(this);
 
   // Walk through the FST with the input text from the hypothesis
   for (size_t i = offset; i < hyp->ys.size(); ++i) {
-    *hyp->lodr_state = hyp->lodr_state->ForwardOneStep(hyp->ys[i]);
+    state = state.ForwardOneStep(hyp->ys[i]);
   }
 
-  float lodr_score = hyp->lodr_state->FinalScore();
+  hyp->lodr_state = state;
+
+  float lodr_score = state.FinalScore();
 
   if (lodr_score == -std::numeric_limits<float>::infinity()) {
     SHERPA_ONNX_LOGE("Failed to compute LODR. Empty or mismatched FST?");
@@ -131,61 +194,84 @@ void LodrFst::ComputeScore(float scale, Hypothesis *hyp, int32_t offset) {
   hyp->log_prob += scale * lodr_score;
 }
 
-float LodrFst::GetFinalCost(int32_t state) {
-  auto final_weight = fst_->Final(state);
-  if (final_weight == fst::StdArc::Weight::Zero()) {
-    return 0.0;
-  }
-  return final_weight.Value();
+LodrStateCost::LodrStateCost(const LodrFst *fst) : fst_(fst) {
+  Add(0, 0);
 }
 
-LodrStateCost::LodrStateCost(
-    LodrFst* fst, const std::unordered_map<int32_t, float> &state_cost)
-    : fst_(fst) {
-  if (state_cost.empty()) {
-    state_cost_[0] = 0.0;
-  } else {
-    state_cost_ = state_cost;
+void LodrStateCost::Add(int32_t state, float cost) {
+  for (int32_t i = 0; i != num_states_; ++i) {
+    if (states_[i] == state) {
+      costs_[i] = std::min(costs_[i], cost);
+      return;
+    }
+  }
+
+  if (num_states_ < kMaxStates) {
+    states_[num_states_] = state;
+    costs_[num_states_] = cost;
+    ++num_states_;
+    return;
+  }
+
+  // Full. Replace the state with the highest cost
+  int32_t k = static_cast<int32_t>(
+      std::max_element(costs_.begin(), costs_.end()) - costs_.begin());
+  if (cost < costs_[k]) {
+    states_[k] = state;
+    costs_[k] = cost;
   }
 }
 
-LodrStateCost LodrStateCost::ForwardOneStep(int32_t label) {
-  std::unordered_map<int32_t, float> state_cost;
-  for (const auto& [s, c] : state_cost_) {
-    auto [next_states, next_costs] = fst_->GetNextStateCosts(s, label);
-    for (size_t i = 0; i < next_states.size(); ++i) {
-      int32_t ns = next_states[i];
-      float nc = next_costs[i];
-      if (state_cost.find(ns) == state_cost.end()) {
-        state_cost[ns] = std::numeric_limits<float>::infinity();
+LodrStateCost LodrStateCost::ForwardOneStep(int32_t label) const {
+  LodrStateCost ans;
+  ans.fst_ = fst_;
+
+  const LodrFst &fst = *fst_;
+
+  for (int32_t i = 0; i != num_states_; ++i) {
+    int32_t s = states_[i];
+    float c = costs_[i];
+
+    // Try s itself and then the states reached by backoff arcs
+    for (int32_t k = fst.closure_offsets_[s]; k != fst.closure_offsets_[s + 1];
+         ++k) {
+      int32_t arc = fst.FindArc(fst.closure_states_[k], label);
+      if (arc != -1) {
+        ans.Add(fst.next_states_[arc],
+                c + fst.closure_costs_[k] + fst.weights_[arc]);
       }
-      state_cost[ns] = std::min(state_cost[ns], c + nc);
     }
   }
-  return LodrStateCost(fst_, state_cost);
+
+  if (ans.num_states_ == 0) {
+    // No state accepts the label. Restart from the start state.
+    ans.Add(0, 0);
+  }
+
+  return ans;
+}
+
+int32_t LodrStateCost::ArgMin() const {
+  return static_cast<int32_t>(
+      std::min_element(costs_.begin(), costs_.begin() + num_states_) -
+      costs_.begin());
 }
 
 float LodrStateCost::Score() const {
-  if (state_cost_.empty()) {
+  if (num_states_ == 0) {
     return -std::numeric_limits<float>::infinity();
   }
-  auto min_cost = std::min_element(state_cost_.begin(), state_cost_.end(),
-                                   [](const auto& a, const auto& b) {
-                                     return a.second < b.second;
-                                   });
-  return -min_cost->second;
+
+  return -costs_[ArgMin()];
 }
 
 float LodrStateCost::FinalScore() const {
-  if (state_cost_.empty()) {
+  if (num_states_ == 0) {
     return -std::numeric_limits<float>::infinity();
   }
-  auto min_cost = std::min_element(state_cost_.begin(), state_cost_.end(),
-                                   [](const auto& a, const auto& b) {
-                                     return a.second < b.second;
-                                   });
-  return -(min_cost->second +
-           fst_->GetFinalCost(min_cost->first));
+
+  int32_t k = ArgMin();
+  return -(costs_[k] + fst_->GetFinalCost(states_[k]));
 }
 
 }  // namespace sherpa_onnx
@@ -9,65 +9,97 @@
 #ifndef SHERPA_ONNX_CSRC_LODR_FST_H_
 #define SHERPA_ONNX_CSRC_LODR_FST_H_
 
-#include <memory>
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <optional>
-#include <tuple>
-#include <unordered_map>
-#include <limits>
-#include <algorithm>
-#include <utility>
-
-#include "kaldifst/csrc/kaldi-fst-io.h"
 
 namespace sherpa_onnx {
 
 struct Hypothesis;
 
+// The n-gram FST used by LODR, compiled into flat arrays.
+//
+// Arcs of a state are stored contiguously and sorted by label, with labels
+// in a separate array so that a lookup only touches the labels. States with
+// many arcs, e.g., the unigram state, get a dense label -> arc table.
+// The backoff closure of each state, i.e., the states reached by following
+// backoff arcs and the accumulated backoff costs, is precomputed.
 class LodrFst {
  public:
   explicit LodrFst(const std::string &fst_path, int32_t backoff_id = -1);
 
-  std::pair<std::vector<int32_t>, std::vector<float>> GetNextStateCosts(
-    int32_t state, int32_t label);
-
-  float GetFinalCost(int32_t state);
+  float GetFinalCost(int32_t state) const { return final_costs_[state]; }
 
   void ComputeScore(float scale, Hypothesis *hyp, int32_t offset);
 
  private:
-  fst::StdVectorFst YsToFst(const std::vector<int64_t> &ys, int32_t offset);
+  friend class LodrStateCost;
 
-  std::vector<std::tuple<int32_t, float>> ProcessBackoffArcs(
-    int32_t state, float cost);
-
-  std::optional<std::tuple<int32_t, float>> GetNextStatesCostsNoBackoff(
-    int32_t state, int32_t label);
-
-  int32_t FindBackoffId();
+  // Return the index of the arc leaving state with the given label.
+  // Return -1 if there is no such arc.
+  int32_t FindArc(int32_t state, int32_t label) const;
 
+  void BuildClosure();
 
   int32_t backoff_id_ = -1;
-  std::unique_ptr<fst::StdConstFst> fst_;  // owned by this class
+
+  // Arcs of state s are in [arc_offsets_[s], arc_offsets_[s+1])
+  std::vector<int32_t> arc_offsets_;
+  std::vector<int32_t> labels_;
+  std::vector<int32_t> next_states_;
+  std::vector<float> weights_;
+
+  // If dense_offsets_[s] >= 0, dense_arcs_[dense_offsets_[s] + label] is
+  // the arc index of the given label leaving s, or -1
+  std::vector<int32_t> dense_offsets_;
+  std::vector<int32_t> dense_arcs_;
+  int32_t max_label_ = 0;
+
+  // The backoff closure of state s is in
+  // [closure_offsets_[s], closure_offsets_[s+1]). It starts with s itself.
+  std::vector<int32_t> closure_offsets_;
+  std::vector<int32_t> closure_states_;
+  std::vector<float> closure_costs_;
+
+  std::vector<float> final_costs_;
 };
 
+// FST states of a hypothesis and their costs. It has a fixed size so that
+// it is stored inline in a Hypothesis and copied without allocation.
 class LodrStateCost {
  public:
-  explicit LodrStateCost(
-    LodrFst* fst,
-    const std::unordered_map<int32_t, float> &state_cost = {});
+  // It is more than enough for LODR, which uses low order n-grams.
+  // If more states are reachable, only the kMaxStates states with the
+  // lowest costs are kept.
+  static constexpr int32_t kMaxStates = 8;
 
-    LodrStateCost ForwardOneStep(int32_t label);
+  LodrStateCost() = default;
+
+  // Start from state 0 of the given FST
+  explicit LodrStateCost(const LodrFst *fst);
+
+  LodrStateCost ForwardOneStep(int32_t label) const;
 
   float Score() const;
   float FinalScore() const;
 
+  // Return true if it is created with an FST
+  bool IsValid() const { return fst_ != nullptr; }
+
+ private:
+  void Add(int32_t state, float cost);
+
+  // The index in states_ of the state with the lowest cost
+  int32_t ArgMin() const;
+
  private:
   // The fst_ is not owned by this class and borrowed from the caller
   // (e.g. OnlineRnnLM).
-  LodrFst* fst_;
-  std::unordered_map<int32_t, float> state_cost_;
+  const LodrFst *fst_ = nullptr;
+  int32_t num_states_ = 0;
+  std::array<int32_t, kMaxStates> states_;
+  std::array<float, kMaxStates> costs_;
 };
 
 }  // namespace sherpa_onnx
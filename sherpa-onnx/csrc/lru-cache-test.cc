@@ -0,0 +1,122 @@
+// sherpa-onnx/csrc/lru-cache-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/lru-cache.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(LruCache, GetAndPut) {
+  LruCache<std::vector<int32_t>> cache(10);
+
+  std::vector<int32_t> v;
+  EXPECT_FALSE(cache.Get("a", &v));
+
+  cache.Put("a", {1, 2, 3});
+  EXPECT_TRUE(cache.Get("a", &v));
+  EXPECT_EQ(v, (std::vector<int32_t>{1, 2, 3}));
+
+  cache.Put("a", {4});
+  EXPECT_TRUE(cache.Get("a", &v));
+  EXPECT_EQ(v, (std::vector<int32_t>{4}));
+  EXPECT_EQ(cache.Size(), 1);
+
+  cache.Clear();
+  EXPECT_FALSE(cache.Get("a", &v));
+}
+
+TEST(LruCache, Evict) {
+  // a single shard so that the eviction order is deterministic
+  LruCache<int32_t> cache(2, 1);
+  int32_t v = 0;
+
+  cache.Put("a", 1);
+  cache.Put("b", 2);
+  EXPECT_TRUE(cache.Get("a", &v));
+
+  // b is the least recently used one
+  cache.Put("c", 3);
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_FALSE(cache.Get("b", &v));
+  EXPECT_TRUE(cache.Get("a", &v));
+  EXPECT_EQ(v, 1);
+  EXPECT_TRUE(cache.Get("c", &v));
+  EXPECT_EQ(v, 3);
+}
+
+TEST(LruCache, Disabled) {
+  LruCache<int32_t> cache(0);
+  int32_t v = 0;
+  cache.Put("a", 1);
+  EXPECT_FALSE(cache.Get("a", &v));
+  EXPECT_EQ(cache.Size(), 0);
+}
+
+// It is how inverse text normalization and homophone replacement results
+// are cached in the recognizers
+TEST(LruCache, GetOrCompute) {
+  auto normalize = [](const std::string &text) {
+    std::string ans;
+    for (char c : text) {
+      ans += (c == '1') ? std::string("one") : std::string(1, c);
+    }
+    return ans;
+  };
+
+  int32_t num_calls = 0;
+  auto compute = [&](const std::string &text) {
+    ++num_calls;
+    return normalize(text);
+  };
+
+  LruCache<std::string> cache(10);
+  int32_t max_key_length = 8;
+  std::string long_text(max_key_length + 1, '1');
+
+  for (const auto &t : {std::string("a1"), std::string("b11"),
+                        std::string("a1"), std::string(), long_text,
+                        long_text, std::string("b11")}) {
+    EXPECT_EQ(cache.GetOrCompute(t, max_key_length, compute), normalize(t));
+  }
+
+  // a1, b11, the empty string, and long_text twice
+  EXPECT_EQ(num_calls, 5);
+
+  // long_text is not cached
+  EXPECT_EQ(cache.Size(), 3);
+  std::string v;
+  EXPECT_FALSE(cache.Get(long_text, &v));
+}
+
+TEST(LruCache, MultiThreads) {
+  LruCache<int32_t> cache(100);
+
+  std::vector<std::thread> threads;
+  for (int32_t t = 0; t != 4; ++t) {
+    threads.emplace_back([&cache, t]() {
+      for (int32_t i = 0; i != 1000; ++i) {
+        std::string key = std::to_string((i * 7 + t) % 200);
+        int32_t v = 0;
+        if (cache.Get(key, &v)) {
+          EXPECT_EQ(std::to_string(v), key);
+        } else {
+          cache.Put(key, std::stoi(key));
+        }
+      }
+    });
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  EXPECT_LE(cache.Size(), 112);  // 16 shards of 7 items
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,139 @@
+// sherpa-onnx/csrc/lru-cache.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_LRU_CACHE_H_
+#define SHERPA_ONNX_CSRC_LRU_CACHE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+// A thread-safe LRU cache with string keys.
+//
+// Keys are distributed over several shards, each with its own lock, so that
+// threads looking up different keys rarely wait for each other.
+template <typename Value>
+class LruCache {
+ public:
+  /**
+   * @param capacity  Maximum number of items in the cache. If it is not
+   *                  positive, the cache is disabled.
+   * @param num_shards  Number of shards.
+   */
+  explicit LruCache(int32_t capacity, int32_t num_shards = 16)
+      : shards_(std::max(1, std::min(num_shards, capacity))) {
+    int32_t n = static_cast<int32_t>(shards_.size());
+    for (auto &s : shards_) {
+      s.capacity = capacity > 0 ? (capacity + n - 1) / n : 0;
+    }
+  }
+
+  // Return true and copy the value to *value if key is in the cache.
+  bool Get(const std::string &key, Value *value) {
+    Shard &s = GetShard(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto it = s.index.find(key);
+    if (it == s.index.end()) {
+      return false;
+    }
+
+    s.items.splice(s.items.begin(), s.items, it->second);
+    *value = it->second->second;
+    return true;
+  }
+
+  void Put(const std::string &key, Value value) {
+    Shard &s = GetShard(key);
+    if (s.capacity == 0) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto it = s.index.find(key);
+    if (it != s.index.end()) {
+      it->second->second = std::move(value);
+      s.items.splice(s.items.begin(), s.items, it->second);
+      return;
+    }
+
+    s.items.emplace_front(key, std::move(value));
+    s.index[key] = s.items.begin();
+
+    while (static_cast<int32_t>(s.items.size()) > s.capacity) {
+      s.index.erase(s.items.back().first);
+      s.items.pop_back();
+    }
+  }
+
+  // Return compute(key). The result is looked up in the cache first and
+  // put into it on a miss. Keys longer than max_key_length bytes are not
+  // cached, so that a few long inputs do not occupy most of the memory.
+  template <typename Compute>
+  Value GetOrCompute(const std::string &key, int32_t max_key_length,
+                     Compute compute) {
+    if (static_cast<int32_t>(key.size()) > max_key_length) {
+      return compute(key);
+    }
+
+    Value ans;
+    if (Get(key, &ans)) {
+      return ans;
+    }
+
+    ans = compute(key);
+    Put(key, ans);
+
+    return ans;
+  }
+
+  int32_t Size() const {
+    int32_t ans = 0;
+    for (auto &s : shards_) {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      ans += static_cast<int32_t>(s.items.size());
+    }
+    return ans;
+  }
+
+  void Clear() {
+    for (auto &s : shards_) {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.items.clear();
+      s.index.clear();
+    }
+  }
+
+ private:
+  using Item = std::pair<std::string, Value>;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    int32_t capacity = 0;
+
+    // Most recently used first
+    std::list<Item> items;
+    std::unordered_map<std::string, typename std::list<Item>::iterator> index;
+  };
+
+  Shard &GetShard(const std::string &key) {
+    return shards_[std::hash<std::string>{}(key) % shards_.size()];
+  }
+
+ private:
+  std::vector<Shard> shards_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_LRU_CACHE_H_
@@ -0,0 +1,266 @@
+// sherpa-onnx/csrc/multi-stream-voice-activity-detector-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/multi-stream-voice-activity-detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/vad-model.h"
+#include "sherpa-onnx/csrc/vad-state-machine.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+
+namespace sherpa_onnx {
+
+static constexpr int32_t kSampleRate = 16000;
+static constexpr int32_t kWindowSize = 512;
+
+// A fake model. The speech probability of a window is a smoothed energy
+// detector, so it depends on the states of the stream. IsSpeech() uses
+// the same VadStateMachine as the real models.
+class FakeVadModel : public VadModel {
+ public:
+  explicit FakeVadModel(const VadModelConfig &config)
+      : threshold_(config.silero_vad.threshold),
+        min_silence_samples_(kSampleRate *
+                             config.silero_vad.min_silence_duration),
+        min_speech_samples_(kSampleRate *
+                            config.silero_vad.min_speech_duration) {}
+
+  void Reset() override {
+    state_ = 0;
+    state_machine_.Reset();
+  }
+
+  bool IsSpeech(const float *samples, int32_t n) override {
+    float prob = Compute(samples, n);
+
+    return state_machine_.IsSpeech(prob, kWindowSize, threshold_,
+                                   min_speech_samples_, min_silence_samples_);
+  }
+
+  float Compute(const float *samples, int32_t n) override {
+    return Run(samples, n, &state_);
+  }
+
+  int32_t WindowSize() const override { return kWindowSize; }
+
+  int32_t WindowShift() const override { return kWindowSize; }
+
+  int32_t MinSilenceDurationSamples() const override {
+    return min_silence_samples_;
+  }
+
+  int32_t MinSpeechDurationSamples() const override {
+    return min_speech_samples_;
+  }
+
+  void SetMinSilenceDuration(float s) override {
+    min_silence_samples_ = kSampleRate * s;
+  }
+
+  void SetThreshold(float threshold) override { threshold_ = threshold; }
+
+  int32_t AllocateSlot() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.push_back(0);
+    return slots_.size() - 1;
+  }
+
+  void FreeSlot(int32_t /*slot*/) override {}
+
+  void ResetSlot(int32_t slot) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_[slot] = 0;
+  }
+
+  void Compute(const float *const *samples, const int32_t *slots, int32_t n,
+               float *probs) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int32_t i = 0; i != n; ++i) {
+      probs[i] = Run(samples[i], kWindowSize, &slots_[slots[i]]);
+    }
+  }
+
+ private:
+  static float Run(const float *samples, int32_t n, float *state) {
+    float energy = 0;
+    for (int32_t i = 0; i != n; ++i) {
+      energy += samples[i] * samples[i];
+    }
+    energy = std::sqrt(energy / n);
+
+    *state = 0.6f * *state + 0.4f * (energy > 0.05f);
+    return *state;
+  }
+
+  float threshold_;
+  int32_t min_silence_samples_;
+  int32_t min_speech_samples_;
+
+  float state_ = 0;
+  VadStateMachine state_machine_;
+
+  std::mutex mutex_;
+  std::vector<float> slots_;
+};
+
+static VadModelConfig GetConfig() {
+  VadModelConfig config;
+  config.silero_vad.model = "fake.onnx";
+  config.silero_vad.window_size = kWindowSize;
+  config.sample_rate = kSampleRate;
+  return config;
+}
+
+// Alternating speech-like noise and near silence of random durations
+static std::vector<float> GetWave(int32_t seed, float seconds) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> duration(0.1, 2.5);
+  std::normal_distribution<float> noise(0, 1);
+
+  std::vector<float> ans;
+  int32_t n = seconds * kSampleRate;
+  bool speech = false;
+  while (static_cast<int32_t>(ans.size()) < n) {
+    int32_t k = duration(gen) * kSampleRate;
+    float scale = speech ? 0.3f : 0.001f;
+    for (int32_t i = 0; i != k; ++i) {
+      ans.push_back(scale * noise(gen));
+    }
+    speech = !speech;
+  }
+  ans.resize(n);
+  return ans;
+}
+
+static void Collect(VoiceActivityDetector *vad,
+                    std::vector<SpeechSegment> *segments) {
+  for (; !vad->Empty(); vad->Pop()) {
+    segments->push_back(vad->Front());
+  }
+}
+
+// The model of a single stream is run on all windows given to one call
+// of AcceptWaveform() at once, so we give it one window at a time
+static std::vector<SpeechSegment> RunSingleStream(
+    const VadModelConfig &config, const std::vector<float> &wave) {
+  VoiceActivityDetector vad(std::make_unique<FakeVadModel>(config), config);
+
+  std::vector<SpeechSegment> ans;
+  for (int32_t i = 0; i + kWindowSize <= static_cast<int32_t>(wave.size());
+       i += kWindowSize) {
+    vad.AcceptWaveform(wave.data() + i, kWindowSize);
+    Collect(&vad, &ans);
+  }
+  vad.Flush();
+  Collect(&vad, &ans);
+
+  return ans;
+}
+
+static void ExpectEqual(const std::vector<SpeechSegment> &a,
+                        const std::vector<SpeechSegment> &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (int32_t i = 0; i != static_cast<int32_t>(a.size()); ++i) {
+    EXPECT_EQ(a[i].start, b[i].start);
+    EXPECT_EQ(a[i].samples, b[i].samples);
+  }
+}
+
+TEST(MultiStreamVoiceActivityDetector, SameAsSingleStream) {
+  auto config = GetConfig();
+  constexpr int32_t kNumStreams = 5;
+
+  std::vector<std::vector<float>> waves;
+  std::vector<std::vector<SpeechSegment>> expected(kNumStreams);
+  for (int32_t s = 0; s != kNumStreams; ++s) {
+    waves.push_back(GetWave(s, 30));
+
+    expected[s] = RunSingleStream(config, waves[s]);
+    ASSERT_GT(expected[s].size(), 3);
+  }
+
+  MultiStreamVoiceActivityDetector detector(
+      std::make_unique<FakeVadModel>(config), config);
+
+  std::vector<std::unique_ptr<VoiceActivityDetector>> streams;
+  std::vector<VoiceActivityDetector *> ss;
+  for (int32_t s = 0; s != kNumStreams; ++s) {
+    streams.push_back(detector.CreateStream());
+    ss.push_back(streams.back().get());
+  }
+
+  // Each stream gets chunks of a different size
+  std::vector<std::vector<SpeechSegment>> segments(kNumStreams);
+  std::vector<int32_t> offsets(kNumStreams);
+  bool done = false;
+  while (!done) {
+    done = true;
+    for (int32_t s = 0; s != kNumStreams; ++s) {
+      int32_t n = std::min<int32_t>(160 * (s + 1) + 37,
+                                    waves[s].size() - offsets[s]);
+      streams[s]->AcceptWaveform(waves[s].data() + offsets[s], n);
+      offsets[s] += n;
+      done = done && offsets[s] == static_cast<int32_t>(waves[s].size());
+    }
+
+    detector.Compute(ss.data(), ss.size());
+
+    for (int32_t s = 0; s != kNumStreams; ++s) {
+      Collect(streams[s].get(), &segments[s]);
+    }
+  }
+
+  for (int32_t s = 0; s != kNumStreams; ++s) {
+    streams[s]->Flush();
+    Collect(streams[s].get(), &segments[s]);
+    ExpectEqual(segments[s], expected[s]);
+  }
+}
+
+TEST(MultiStreamVoiceActivityDetector, MultipleThreads) {
+  auto config = GetConfig();
+  auto wave = GetWave(100, 10);
+
+  auto expected = RunSingleStream(config, wave);
+
+  MultiStreamVoiceActivityDetector detector(
+      std::make_unique<FakeVadModel>(config), config);
+
+  // Streams are created, computed and destroyed in different threads
+  constexpr int32_t kNumThreads = 4;
+  std::vector<std::vector<SpeechSegment>> segments(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int32_t t = 0; t != kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      auto stream = detector.CreateStream();
+      VoiceActivityDetector *p = stream.get();
+      for (int32_t i = 0; i < static_cast<int32_t>(wave.size()); i += 1600) {
+        int32_t n = std::min<int32_t>(1600, wave.size() - i);
+        stream->AcceptWaveform(wave.data() + i, n);
+        detector.Compute(&p, 1);
+        Collect(stream.get(), &segments[t]);
+      }
+      stream->Flush();
+      Collect(stream.get(), &segments[t]);
+    });
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  for (const auto &s : segments) {
+    ExpectEqual(s, expected);
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,124 @@
+// sherpa-onnx/csrc/multi-stream-voice-activity-detector.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/multi-stream-voice-activity-detector.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if __ANDROID_API__ >= 9
+#include "android/asset_manager.h"
+#include "android/asset_manager_jni.h"
+#endif
+
+#if __OHOS__
+#include "rawfile/raw_file_manager.h"
+#endif
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/vad-model.h"
+
+namespace sherpa_onnx {
+
+MultiStreamVoiceActivityDetector::MultiStreamVoiceActivityDetector(
+    const VadModelConfig &config, float buffer_size_in_seconds /*= 60*/)
+    : model_(VadModel::Create(config)),
+      config_(config),
+      buffer_size_in_seconds_(buffer_size_in_seconds) {
+  if (config.provider == "rknn") {
+    SHERPA_ONNX_LOGE("Multiple streams are not supported for rknn VAD");
+    SHERPA_ONNX_EXIT(-1);
+  }
+}
+
+template <typename Manager>
+MultiStreamVoiceActivityDetector::MultiStreamVoiceActivityDetector(
+    Manager *mgr, const VadModelConfig &config,
+    float buffer_size_in_seconds /*= 60*/)
+    : model_(VadModel::Create(mgr, config)),
+      config_(config),
+      buffer_size_in_seconds_(buffer_size_in_seconds) {
+  if (config.provider == "rknn") {
+    SHERPA_ONNX_LOGE("Multiple streams are not supported for rknn VAD");
+    SHERPA_ONNX_EXIT(-1);
+  }
+}
+
+MultiStreamVoiceActivityDetector::MultiStreamVoiceActivityDetector(
+    std::unique_ptr<VadModel> model, const VadModelConfig &config,
+    float buffer_size_in_seconds /*= 60*/)
+    : model_(std::move(model)),
+      config_(config),
+      buffer_size_in_seconds_(buffer_size_in_seconds) {}
+
+MultiStreamVoiceActivityDetector::~MultiStreamVoiceActivityDetector() =
+    default;
+
+std::unique_ptr<VoiceActivityDetector>
+MultiStreamVoiceActivityDetector::CreateStream() const {
+  // We cannot use std::make_unique() since the constructor is private
+  return std::unique_ptr<VoiceActivityDetector>(
+      new VoiceActivityDetector(model_.get(), config_,
+                                buffer_size_in_seconds_));
+}
+
+void MultiStreamVoiceActivityDetector::Compute(VoiceActivityDetector **ss,
+                                               int32_t n) {
+  std::vector<VoiceActivityDetector *> ready;
+  std::vector<const float *> samples;
+  std::vector<int32_t> slots;
+  std::vector<float> probs;
+
+  ready.reserve(n);
+  samples.reserve(n);
+  slots.reserve(n);
+
+  // Each iteration processes one window from every stream that has one
+  while (true) {
+    ready.clear();
+    samples.clear();
+    slots.clear();
+
+    for (int32_t i = 0; i != n; ++i) {
+      const float *p = ss[i]->GetWindow();
+      if (p) {
+        ready.push_back(ss[i]);
+        samples.push_back(p);
+        slots.push_back(ss[i]->Slot());
+      }
+    }
+
+    if (ready.empty()) {
+      break;
+    }
+
+    int32_t num_ready = static_cast<int32_t>(ready.size());
+    probs.resize(num_ready);
+
+    model_->Compute(samples.data(), slots.data(), num_ready, probs.data());
+
+    for (int32_t i = 0; i != num_ready; ++i) {
+      ready[i]->AcceptProbability(probs[i]);
+    }
+  }
+}
+
+const VadModelConfig &MultiStreamVoiceActivityDetector::GetConfig() const {
+  return config_;
+}
+
+#if __ANDROID_API__ >= 9
+template MultiStreamVoiceActivityDetector::MultiStreamVoiceActivityDetector(
+    AAssetManager *mgr, const VadModelConfig &config,
+    float buffer_size_in_seconds);
+#endif
+
+#if __OHOS__
+template MultiStreamVoiceActivityDetector::MultiStreamVoiceActivityDetector(
+    NativeResourceManager *mgr, const VadModelConfig &config,
+    float buffer_size_in_seconds);
+#endif
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,69 @@
+// sherpa-onnx/csrc/multi-stream-voice-activity-detector.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_MULTI_STREAM_VOICE_ACTIVITY_DETECTOR_H_
+#define SHERPA_ONNX_CSRC_MULTI_STREAM_VOICE_ACTIVITY_DETECTOR_H_
+
+#include <memory>
+
+#include "sherpa-onnx/csrc/vad-model-config.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+
+namespace sherpa_onnx {
+
+class VadModel;
+
+// Run voice activity detection on many streams with a single model.
+//
+// Each stream is a VoiceActivityDetector created by CreateStream().
+// Its AcceptWaveform() only buffers samples; the model is run by
+// Compute(), which stacks windows from all given streams into a single
+// batch. Segments are retrieved from each stream as usual, i.e., with
+// Empty(), Front() and Pop().
+//
+// Only silero-vad and ten-vad are supported.
+//
+// Streams may be created, destroyed and passed to Compute() from different
+// threads; the states kept in the shared model are protected by a mutex and
+// calls of Compute() are serialized. A single stream must not be used by
+// more than one thread at the same time.
+class MultiStreamVoiceActivityDetector {
+ public:
+  explicit MultiStreamVoiceActivityDetector(const VadModelConfig &config,
+                                            float buffer_size_in_seconds = 60);
+
+  template <typename Manager>
+  MultiStreamVoiceActivityDetector(Manager *mgr, const VadModelConfig &config,
+                                   float buffer_size_in_seconds = 60);
+
+  // Use the given model instead of creating one from config. It must
+  // support multiple streams; see VadModel::AllocateSlot().
+  MultiStreamVoiceActivityDetector(std::unique_ptr<VadModel> model,
+                                   const VadModelConfig &config,
+                                   float buffer_size_in_seconds = 60);
+
+  ~MultiStreamVoiceActivityDetector();
+
+  // Create a stream. The returned object must be destroyed before this
+  // object.
+  std::unique_ptr<VoiceActivityDetector> CreateStream() const;
+
+  /** Run the model on all buffered windows of the given streams.
+   *
+   * @param ss Pointer array containing the streams. A stream must not
+   *           appear more than once.
+   * @param n Number of streams in `ss`.
+   */
+  void Compute(VoiceActivityDetector **ss, int32_t n);
+
+  const VadModelConfig &GetConfig() const;
+
+ private:
+  std::unique_ptr<VadModel> model_;
+  VadModelConfig config_;
+  float buffer_size_in_seconds_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_MULTI_STREAM_VOICE_ACTIVITY_DETECTOR_H_
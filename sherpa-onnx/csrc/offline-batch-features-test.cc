@@ -0,0 +1,125 @@
+// sherpa-onnx/csrc/offline-batch-features-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-batch-features.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static std::vector<std::unique_ptr<OfflineStream>> CreateStreams(
+    const FeatureExtractorConfig &config) {
+  std::mt19937 gen(2025);
+  std::uniform_real_distribution<float> dist(-0.5, 0.5);
+
+  std::vector<std::unique_ptr<OfflineStream>> streams;
+  for (int32_t num_samples : {16000, 4000, 24000, 8000, 12345}) {
+    std::vector<float> samples(num_samples);
+    for (auto &s : samples) {
+      s = dist(gen);
+    }
+
+    auto s = std::make_unique<OfflineStream>(config);
+    s->AcceptWaveform(config.sampling_rate, samples.data(), samples.size());
+    streams.push_back(std::move(s));
+  }
+
+  return streams;
+}
+
+static void Check(const FeatureExtractorConfig &config, int32_t num_threads,
+                  const FeatureTransform &transform) {
+  Ort::AllocatorWithDefaultOptions allocator;
+
+  // features computed by GetFrames() one by one
+  auto expected_streams = CreateStreams(config);
+  auto streams = CreateStreams(config);
+
+  std::vector<OfflineStream *> ss;
+  for (auto &s : streams) {
+    ss.push_back(s.get());
+  }
+
+  int32_t n = ss.size();
+  float padding_value = -23.025850929940457f;
+
+  auto features = ComputeBatchedFeatures(allocator, ss.data(), n,
+                                         padding_value, num_threads, transform);
+
+  auto shape = features.first.GetTensorTypeAndShapeInfo().GetShape();
+  ASSERT_EQ(shape.size(), 3);
+  EXPECT_EQ(shape[0], n);
+  EXPECT_EQ(shape[2], config.feature_dim);
+
+  int32_t max_t = shape[1];
+  int32_t feat_dim = shape[2];
+
+  const float *p = features.first.GetTensorData<float>();
+  const int64_t *lengths = features.second.GetTensorData<int64_t>();
+
+  int32_t expected_max_t = 0;
+  for (int32_t i = 0; i != n; ++i) {
+    auto f = expected_streams[i]->GetFrames();
+    int32_t num_frames = f.size() / feat_dim;
+    if (transform) {
+      transform(f.data(), num_frames, feat_dim);
+    }
+
+    EXPECT_EQ(lengths[i], num_frames);
+    expected_max_t = std::max(expected_max_t, num_frames);
+
+    const float *q = p + i * max_t * feat_dim;
+    for (int32_t k = 0; k != num_frames * feat_dim; ++k) {
+      ASSERT_EQ(q[k], f[k]);
+    }
+
+    for (int32_t k = num_frames * feat_dim; k != max_t * feat_dim; ++k) {
+      ASSERT_EQ(q[k], padding_value);
+    }
+  }
+
+  EXPECT_EQ(max_t, expected_max_t);
+}
+
+TEST(ComputeBatchedFeatures, SingleThread) {
+  FeatureExtractorConfig config;
+  Check(config, 1, {});
+}
+
+TEST(ComputeBatchedFeatures, MultipleThreads) {
+  FeatureExtractorConfig config;
+  for (int32_t num_threads : {2, 4, 10}) {
+    Check(config, num_threads, {});
+  }
+}
+
+TEST(ComputeBatchedFeatures, FastFbank) {
+  FeatureExtractorConfig config;
+  config.use_fast_fbank = true;
+  Check(config, 2, {});
+}
+
+TEST(ComputeBatchedFeatures, NemoNormalize) {
+  FeatureExtractorConfig config;
+  config.nemo_normalize_type = "per_feature";
+  Check(config, 3, {});
+}
+
+TEST(ComputeBatchedFeatures, Transform) {
+  FeatureExtractorConfig config;
+  auto transform = [](float *p, int32_t num_frames, int32_t feat_dim) {
+    for (int32_t i = 0; i != num_frames * feat_dim; ++i) {
+      p[i] = p[i] * 0.5f + 1;
+    }
+  };
+
+  Check(config, 3, transform);
+}
+
+}  // namespace sherpa_onnx
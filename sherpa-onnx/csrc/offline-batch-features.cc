@@ -0,0 +1,101 @@
+// sherpa-onnx/csrc/offline-batch-features.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-batch-features.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+// Invoke f(i) for i in [0, n) using up to num_threads threads,
+// including the calling thread.
+template <typename F>
+static void ParallelFor(int32_t n, int32_t num_threads, F f) {
+  num_threads = std::min(num_threads, n);
+  if (num_threads <= 1) {
+    for (int32_t i = 0; i != n; ++i) {
+      f(i);
+    }
+    return;
+  }
+
+  std::atomic<int32_t> next{0};
+  auto worker = [&]() {
+    for (int32_t i = next++; i < n; i = next++) {
+      f(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int32_t i = 1; i != num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+std::pair<Ort::Value, Ort::Value> ComputeBatchedFeatures(
+    OrtAllocator *allocator, OfflineStream **ss, int32_t n,
+    float padding_value, int32_t num_threads,
+    const FeatureTransform &transform /*= {}*/) {
+  if (n <= 0) {
+    SHERPA_ONNX_LOGE("Expect at least 1 stream. Given: %d", n);
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  int32_t feat_dim = ss[0]->FeatureDim();
+
+  // Computing features is the expensive part, so it is done in parallel
+  // in a single pass. Copying them to the padded tensor is cheap.
+  std::vector<std::vector<float>> frames(n);
+  ParallelFor(n, num_threads, [&](int32_t i) {
+    frames[i] = ss[i]->GetFrames();
+
+    if (transform) {
+      transform(frames[i].data(), frames[i].size() / feat_dim, feat_dim);
+    }
+  });
+
+  std::array<int64_t, 1> length_shape = {n};
+  Ort::Value features_length = Ort::Value::CreateTensor<int64_t>(
+      allocator, length_shape.data(), length_shape.size());
+  int64_t *lengths = features_length.GetTensorMutableData<int64_t>();
+
+  for (int32_t i = 0; i != n; ++i) {
+    lengths[i] = frames[i].size() / feat_dim;
+  }
+
+  int64_t max_t = *std::max_element(lengths, lengths + n);
+
+  std::array<int64_t, 3> shape = {n, max_t, feat_dim};
+  Ort::Value features = Ort::Value::CreateTensor<float>(
+      allocator, shape.data(), shape.size());
+  float *p = features.GetTensorMutableData<float>();
+
+  for (int32_t i = 0; i != n; ++i) {
+    float *dst = p + i * max_t * feat_dim;
+    dst = std::copy(frames[i].begin(), frames[i].end(), dst);
+
+    std::fill(dst, p + (i + 1) * max_t * feat_dim, padding_value);
+
+    // Free the memory as early as possible
+    std::vector<float>().swap(frames[i]);
+  }
+
+  return {std::move(features), std::move(features_length)};
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,47 @@
+// sherpa-onnx/csrc/offline-batch-features.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_OFFLINE_BATCH_FEATURES_H_
+#define SHERPA_ONNX_CSRC_OFFLINE_BATCH_FEATURES_H_
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/offline-stream.h"
+
+namespace sherpa_onnx {
+
+// It is invoked on the features of a single stream before padding.
+// Arguments are (features, num_frames, feat_dim)
+using FeatureTransform = std::function<void(float *, int32_t, int32_t)>;
+
+/** Compute features of n streams in parallel and write them to a padded
+ * tensor, which can be passed to the encoder directly. It replaces
+ * calling GetFrames() on each stream followed by PadSequence().
+ *
+ * @param allocator Allocator for the returned tensors.
+ * @param ss Pointer to an array of n streams. All streams must have the
+ *           same feature dim.
+ * @param n Number of streams. It must be positive.
+ * @param padding_value Value used for padding. For log-fbank, you usually
+ *                      use -23.025850929940457f as the padding value.
+ * @param num_threads Number of threads for computing features.
+ * @param transform If not empty, it is applied in place to the features of
+ *                  each stream, e.g., to normalize them. It is called from
+ *                  multiple threads at the same time.
+ *
+ * @return Return a pair containing
+ *          - features, a 3-D float tensor of shape (n, max_T, feat_dim)
+ *          - features_length, a 1-D int64 tensor of shape (n,)
+ */
+std::pair<Ort::Value, Ort::Value> ComputeBatchedFeatures(
+    OrtAllocator *allocator, OfflineStream **ss, int32_t n,
+    float padding_value, int32_t num_threads,
+    const FeatureTransform &transform = {});
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_OFFLINE_BATCH_FEATURES_H_
@@ -27,6 +27,8 @@
 #include "sherpa-onnx/csrc/offline-wenet-ctc-model.h"
 #include "sherpa-onnx/csrc/offline-zipformer-ctc-model.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
+#include "sherpa-onnx/csrc/session.h"
 
 namespace {
 
@@ -45,15 +47,12 @@ enum class ModelType : std::uint8_t {
 
 namespace sherpa_onnx {
 
-static ModelType GetModelType(char *model_data, size_t model_data_length,
+static ModelType GetModelType(const char *model_data, size_t model_data_length,
                               bool debug) {
-  Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
-  Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(1);
-  sess_opts.SetInterOpNumThreads(1);
+  Ort::Env &env = GetOrtEnv();
+  Ort::SessionOptions sess_opts = GetSessionOptions(1, "cpu");
 
-  auto sess = std::make_unique<Ort::Session>(env, model_data, model_data_length,
-                                             sess_opts);
+  auto sess = CreateSession(env, model_data, model_data_length, sess_opts);
 
   Ort::ModelMetadata meta_data = sess->GetModelMetadata();
   if (debug) {
@@ -145,7 +144,7 @@ std::unique_ptr<OfflineCtcModel> OfflineCtcModel::Create(
   }
 
   {
-    auto buffer = ReadFile(filename);
+    auto buffer = MapFile(filename);
 
     model_type = GetModelType(buffer.data(), buffer.size(), config.debug);
   }
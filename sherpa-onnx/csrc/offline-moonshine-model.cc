@@ -20,6 +20,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -29,26 +30,26 @@ class OfflineMoonshineModel::Impl {
  public:
   explicit Impl(const OfflineModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     {
-      auto buf = ReadFile(config.moonshine.preprocessor);
+      auto buf = MapFile(config.moonshine.preprocessor);
       InitPreprocessor(buf.data(), buf.size());
     }
 
     {
-      auto buf = ReadFile(config.moonshine.encoder);
+      auto buf = MapFile(config.moonshine.encoder);
       InitEncoder(buf.data(), buf.size());
     }
 
     {
-      auto buf = ReadFile(config.moonshine.uncached_decoder);
+      auto buf = MapFile(config.moonshine.uncached_decoder);
       InitUnCachedDecoder(buf.data(), buf.size());
     }
 
     {
-      auto buf = ReadFile(config.moonshine.cached_decoder);
+      auto buf = MapFile(config.moonshine.cached_decoder);
       InitCachedDecoder(buf.data(), buf.size());
     }
   }
@@ -56,7 +57,7 @@ class OfflineMoonshineModel::Impl {
   template <typename Manager>
   Impl(Manager *mgr, const OfflineModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     {
@@ -167,9 +168,9 @@ class OfflineMoonshineModel::Impl {
   OrtAllocator *Allocator() { return allocator_; }
 
  private:
-  void InitPreprocessor(void *model_data, size_t model_data_length) {
-    preprocessor_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+  void InitPreprocessor(const void *model_data, size_t model_data_length) {
+    preprocessor_sess_ = CreateSession(env_, model_data, model_data_length,
+                                       sess_opts_);
 
     GetInputNames(preprocessor_sess_.get(), &preprocessor_input_names_,
                   &preprocessor_input_names_ptr_);
@@ -178,9 +179,9 @@ class OfflineMoonshineModel::Impl {
                    &preprocessor_output_names_ptr_);
   }
 
-  void InitEncoder(void *model_data, size_t model_data_length) {
-    encoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+  void InitEncoder(const void *model_data, size_t model_data_length) {
+    encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                  sess_opts_);
 
     GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                   &encoder_input_names_ptr_);
@@ -189,9 +190,9 @@ class OfflineMoonshineModel::Impl {
                    &encoder_output_names_ptr_);
   }
 
-  void InitUnCachedDecoder(void *model_data, size_t model_data_length) {
-    uncached_decoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+  void InitUnCachedDecoder(const void *model_data, size_t model_data_length) {
+    uncached_decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                           sess_opts_);
 
     GetInputNames(uncached_decoder_sess_.get(), &uncached_decoder_input_names_,
                   &uncached_decoder_input_names_ptr_);
@@ -201,9 +202,9 @@ class OfflineMoonshineModel::Impl {
                    &uncached_decoder_output_names_ptr_);
   }
 
-  void InitCachedDecoder(void *model_data, size_t model_data_length) {
-    cached_decoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+  void InitCachedDecoder(const void *model_data, size_t model_data_length) {
+    cached_decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                         sess_opts_);
 
     GetInputNames(cached_decoder_sess_.get(), &cached_decoder_input_names_,
                   &cached_decoder_input_names_ptr_);
@@ -214,7 +215,7 @@ class OfflineMoonshineModel::Impl {
 
  private:
   OfflineModelConfig config_;
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
@@ -12,12 +12,12 @@
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/offline-batch-features.h"
 #include "sherpa-onnx/csrc/offline-ctc-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-fst-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-greedy-search-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-model.h"
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
-#include "sherpa-onnx/csrc/pad-sequence.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
 
 namespace sherpa_onnx {
@@ -194,48 +194,14 @@ class OfflineRecognizerCtcImpl : public OfflineRecognizerImpl {
       return;
     }
 
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    int32_t feat_dim = config_.feat_config.feature_dim;
-
-    std::vector<Ort::Value> features;
-    features.reserve(n);
-
-    std::vector<std::vector<float>> features_vec(n);
-    std::vector<int64_t> features_length_vec(n);
-
-    for (int32_t i = 0; i != n; ++i) {
-      std::vector<float> f = ss[i]->GetFrames();
-
-      int32_t num_frames = f.size() / feat_dim;
-
-      model_->NormalizeFeatures(f.data(), num_frames, feat_dim);
-
-      features_vec[i] = std::move(f);
-
-      features_length_vec[i] = num_frames;
-
-      std::array<int64_t, 2> shape = {num_frames, feat_dim};
-
-      Ort::Value x = Ort::Value::CreateTensor(
-          memory_info, features_vec[i].data(), features_vec[i].size(),
-          shape.data(), shape.size());
-      features.push_back(std::move(x));
-    }  // for (int32_t i = 0; i != n; ++i)
-
-    std::vector<const Ort::Value *> features_pointer(n);
-    for (int32_t i = 0; i != n; ++i) {
-      features_pointer[i] = &features[i];
-    }
-
-    std::array<int64_t, 1> features_length_shape = {n};
-    Ort::Value x_length = Ort::Value::CreateTensor(
-        memory_info, features_length_vec.data(), n,
-        features_length_shape.data(), features_length_shape.size());
-
-    Ort::Value x = PadSequence(model_->Allocator(), features_pointer,
-                               -23.025850929940457f);
+    auto features = ComputeBatchedFeatures(
+        model_->Allocator(), ss, n, -23.025850929940457f,
+        config_.model_config.num_threads,
+        [this](float *p, int32_t num_frames, int32_t feat_dim) {
+          model_->NormalizeFeatures(p, num_frames, feat_dim);
+        });
+    Ort::Value x = std::move(features.first);
+    Ort::Value x_length = std::move(features.second);
     auto t = model_->Forward(std::move(x), std::move(x_length));
 
     auto results = decoder_->Decode(std::move(t[0]), std::move(t[1]));
@@ -33,6 +33,8 @@
 #include "sherpa-onnx/csrc/offline-recognizer-transducer-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer-transducer-nemo-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer-whisper-impl.h"
+#include "sherpa-onnx/csrc/ort-env.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
 #if SHERPA_ONNX_ENABLE_RKNN
@@ -121,11 +123,9 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
     }
   }
 
-  Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
+  Ort::Env &env = GetOrtEnv();
 
-  Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(1);
-  sess_opts.SetInterOpNumThreads(1);
+  Ort::SessionOptions sess_opts = GetSessionOptions(1, "cpu");
 
   std::string model_filename;
   if (!config.model_config.transducer.encoder_filename.empty()) {
@@ -149,10 +149,9 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
     exit(-1);
   }
 
-  auto buf = ReadFile(model_filename);
+  auto buf = MapFile(model_filename);
 
-  auto encoder_sess =
-      std::make_unique<Ort::Session>(env, buf.data(), buf.size(), sess_opts);
+  auto encoder_sess = CreateSession(env, buf.data(), buf.size(), sess_opts);
 
   Ort::ModelMetadata meta_data = encoder_sess->GetModelMetadata();
 
@@ -327,11 +326,9 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
     }
   }
 
-  Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
+  Ort::Env &env = GetOrtEnv();
 
-  Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(1);
-  sess_opts.SetInterOpNumThreads(1);
+  Ort::SessionOptions sess_opts = GetSessionOptions(1, "cpu");
 
   std::string model_filename;
   if (!config.model_config.transducer.encoder_filename.empty()) {
@@ -357,8 +354,7 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
 
   auto buf = ReadFile(mgr, model_filename);
 
-  auto encoder_sess =
-      std::make_unique<Ort::Session>(env, buf.data(), buf.size(), sess_opts);
+  auto encoder_sess = CreateSession(env, buf.data(), buf.size(), sess_opts);
 
   Ort::ModelMetadata meta_data = encoder_sess->GetModelMetadata();
 
@@ -566,22 +562,29 @@ std::string OfflineRecognizerImpl::ApplyInverseTextNormalization(
     std::string text) const {
   text = RemoveInvalidUtf8Sequences(text);
 
-  if (!itn_list_.empty()) {
-    for (const auto &tn : itn_list_) {
-      text = tn->Normalize(text);
-    }
+  if (itn_list_.empty()) {
+    return text;
   }
 
-  return text;
+  return itn_cache_.GetOrCompute(
+      text, kMaxCachedTextLength, [this](const std::string &s) {
+        std::string ans = s;
+        for (const auto &tn : itn_list_) {
+          ans = tn->Normalize(ans);
+        }
+        return ans;
+      });
 }
 
 std::string OfflineRecognizerImpl::ApplyHomophoneReplacer(
     std::string text) const {
-  if (hr_) {
-    text = hr_->Apply(text);
+  if (!hr_) {
+    return text;
   }
 
-  return text;
+  return hr_cache_.GetOrCompute(
+      text, kMaxCachedTextLength,
+      [this](const std::string &s) { return hr_->Apply(s); });
 }
 
 void OfflineRecognizerImpl::SetConfig(const OfflineRecognizerConfig &config) {
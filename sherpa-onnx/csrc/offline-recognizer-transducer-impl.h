@@ -14,16 +14,17 @@
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/context-graph-cache.h"
 #include "sherpa-onnx/csrc/context-graph.h"
 #include "sherpa-onnx/csrc/log.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/offline-batch-features.h"
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/offline-transducer-decoder.h"
 #include "sherpa-onnx/csrc/offline-transducer-greedy-search-decoder.h"
 #include "sherpa-onnx/csrc/offline-transducer-model.h"
 #include "sherpa-onnx/csrc/offline-transducer-modified-beam-search-decoder.h"
-#include "sherpa-onnx/csrc/pad-sequence.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
 #include "sherpa-onnx/csrc/utils.h"
 #include "ssentencepiece/csrc/ssentencepiece.h"
@@ -156,38 +157,8 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
 
   std::unique_ptr<OfflineStream> CreateStream(
       const std::string &hotwords) const override {
-    auto hws = std::regex_replace(hotwords, std::regex("/"), "\n");
-    std::istringstream is(hws);
-    std::vector<std::vector<int32_t>> current;
-    std::vector<float> current_scores;
-    if (!EncodeHotwords(is, config_.model_config.modeling_unit, symbol_table_,
-                        bpe_encoder_.get(), &current, &current_scores)) {
-      SHERPA_ONNX_LOGE("Encode hotwords failed, skipping, hotwords are : '%s'",
-                       hotwords.c_str());
-    }
-
-    int32_t num_default_hws = hotwords_.size();
-    int32_t num_hws = current.size();
-
-    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
-
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_hws,
-                            config_.hotwords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_hws,
-                            config_.hotwords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else {
-      // Do nothing.
-    }
-
-    auto context_graph = std::make_shared<ContextGraph>(
-        current, config_.hotwords_score, current_scores);
+    auto context_graph = hotwords_graph_cache_.Get(
+        hotwords, [this, &hotwords]() { return BuildContextGraph(hotwords); });
     return std::make_unique<OfflineStream>(config_.feat_config, context_graph);
   }
 
@@ -197,44 +168,11 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    int32_t feat_dim = ss[0]->FeatureDim();
-
-    std::vector<Ort::Value> features;
-
-    features.reserve(n);
-
-    std::vector<std::vector<float>> features_vec(n);
-    std::vector<int64_t> features_length_vec(n);
-    for (int32_t i = 0; i != n; ++i) {
-      auto f = ss[i]->GetFrames();
-      int32_t num_frames = f.size() / feat_dim;
-
-      features_length_vec[i] = num_frames;
-      features_vec[i] = std::move(f);
-
-      std::array<int64_t, 2> shape = {num_frames, feat_dim};
-
-      Ort::Value x = Ort::Value::CreateTensor(
-          memory_info, features_vec[i].data(), features_vec[i].size(),
-          shape.data(), shape.size());
-      features.push_back(std::move(x));
-    }
-
-    std::vector<const Ort::Value *> features_pointer(n);
-    for (int32_t i = 0; i != n; ++i) {
-      features_pointer[i] = &features[i];
-    }
-
-    std::array<int64_t, 1> features_length_shape = {n};
-    Ort::Value x_length = Ort::Value::CreateTensor(
-        memory_info, features_length_vec.data(), n,
-        features_length_shape.data(), features_length_shape.size());
-
-    Ort::Value x = PadSequence(model_->Allocator(), features_pointer,
-                               -23.025850929940457f);
+    auto features = ComputeBatchedFeatures(
+        model_->Allocator(), ss, n, -23.025850929940457f,
+        config_.model_config.num_threads);
+    Ort::Value x = std::move(features.first);
+    Ort::Value x_length = std::move(features.second);
 
     auto t = model_->RunEncoder(std::move(x), std::move(x_length));
     auto results =
@@ -254,6 +192,13 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
   OfflineRecognizerConfig GetConfig() const override { return config_; }
 
   void InitHotwords() {
+    if (ContextGraph::IsSavedGraph(config_.hotwords_file)) {
+      // It is built by sherpa-onnx-build-hotwords-graph and is used as is.
+      // Hotwords passed to CreateStream() are not merged with it.
+      hotwords_graph_ = ContextGraph::Load(config_.hotwords_file);
+      return;
+    }
+
     // each line in hotwords_file contains space-separated words
 
     std::ifstream is(config_.hotwords_file);
@@ -298,11 +243,49 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
   }
 
  private:
+  // Build a context graph containing the given hotwords and hotwords_
+  ContextGraphPtr BuildContextGraph(const std::string &hotwords) const {
+    auto hws = std::regex_replace(hotwords, std::regex("/"), "\n");
+    std::istringstream is(hws);
+    std::vector<std::vector<int32_t>> current;
+    std::vector<float> current_scores;
+    if (!EncodeHotwords(is, config_.model_config.modeling_unit, symbol_table_,
+                        bpe_encoder_.get(), &current, &current_scores)) {
+      SHERPA_ONNX_LOGE("Encode hotwords failed, skipping, hotwords are : '%s'",
+                       hotwords.c_str());
+    }
+
+    int32_t num_default_hws = hotwords_.size();
+    int32_t num_hws = current.size();
+
+    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
+
+    if (!current_scores.empty() && !boost_scores_.empty()) {
+      current_scores.insert(current_scores.end(), boost_scores_.begin(),
+                            boost_scores_.end());
+    } else if (!current_scores.empty() && boost_scores_.empty()) {
+      current_scores.insert(current_scores.end(), num_default_hws,
+                            config_.hotwords_score);
+    } else if (current_scores.empty() && !boost_scores_.empty()) {
+      current_scores.insert(current_scores.end(), num_hws,
+                            config_.hotwords_score);
+      current_scores.insert(current_scores.end(), boost_scores_.begin(),
+                            boost_scores_.end());
+    } else {
+      // Do nothing.
+    }
+
+    return std::make_shared<ContextGraph>(current, config_.hotwords_score,
+                                          current_scores);
+  }
+
   OfflineRecognizerConfig config_;
   SymbolTable symbol_table_;
   std::vector<std::vector<int32_t>> hotwords_;
   std::vector<float> boost_scores_;
   ContextGraphPtr hotwords_graph_;
+  // graphs for hotwords passed to CreateStream(hotwords)
+  mutable ContextGraphCache hotwords_graph_cache_;
   std::unique_ptr<ssentencepiece::Ssentencepiece> bpe_encoder_;
   std::unique_ptr<OfflineTransducerModel> model_;
   std::unique_ptr<OfflineTransducerDecoder> decoder_;
@@ -15,11 +15,11 @@
 #include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/offline-batch-features.h"
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/offline-transducer-greedy-search-nemo-decoder.h"
 #include "sherpa-onnx/csrc/offline-transducer-nemo-model.h"
-#include "sherpa-onnx/csrc/pad-sequence.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
 #include "sherpa-onnx/csrc/transpose.h"
 #include "sherpa-onnx/csrc/utils.h"
@@ -77,43 +77,10 @@ class OfflineRecognizerTransducerNeMoImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    int32_t feat_dim = ss[0]->FeatureDim();
-
-    std::vector<Ort::Value> features;
-
-    features.reserve(n);
-
-    std::vector<std::vector<float>> features_vec(n);
-    std::vector<int64_t> features_length_vec(n);
-    for (int32_t i = 0; i != n; ++i) {
-      auto f = ss[i]->GetFrames();
-      int32_t num_frames = f.size() / feat_dim;
-
-      features_length_vec[i] = num_frames;
-      features_vec[i] = std::move(f);
-
-      std::array<int64_t, 2> shape = {num_frames, feat_dim};
-
-      Ort::Value x = Ort::Value::CreateTensor(
-          memory_info, features_vec[i].data(), features_vec[i].size(),
-          shape.data(), shape.size());
-      features.push_back(std::move(x));
-    }
-
-    std::vector<const Ort::Value *> features_pointer(n);
-    for (int32_t i = 0; i != n; ++i) {
-      features_pointer[i] = &features[i];
-    }
-
-    std::array<int64_t, 1> features_length_shape = {n};
-    Ort::Value x_length = Ort::Value::CreateTensor(
-        memory_info, features_length_vec.data(), n,
-        features_length_shape.data(), features_length_shape.size());
-
-    Ort::Value x = PadSequence(model_->Allocator(), features_pointer, 0);
+    auto features = ComputeBatchedFeatures(model_->Allocator(), ss, n, 0,
+                                           config_.model_config.num_threads);
+    Ort::Value x = std::move(features.first);
+    Ort::Value x_length = std::move(features.second);
 
     auto t = model_->RunEncoder(std::move(x), std::move(x_length));
     // t[0] encoder_out, float tensor, (batch_size, dim, T)
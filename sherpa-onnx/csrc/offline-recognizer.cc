@@ -50,7 +50,10 @@ void OfflineRecognizerConfig::Register(ParseOptions *po) {
       "hotwords-file", &hotwords_file,
       "The file containing hotwords, one words/phrases per line, For example: "
       "HELLO WORLD"
-      "你好世界");
+      "你好世界. "
+      "It can also be a graph saved by sherpa-onnx-build-hotwords-graph, "
+      "which is faster to load for a large number of hotwords. "
+      "--hotwords-score is not used in that case.");
 
   po->Register("hotwords-score", &hotwords_score,
                "The bonus score for each token in context word/phrase. "
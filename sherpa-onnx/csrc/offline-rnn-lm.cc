@@ -21,6 +21,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -30,17 +31,17 @@ class OfflineRnnLM::Impl {
  public:
   explicit Impl(const OfflineLMConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_{GetSessionOptions(config)},
         allocator_{} {
-    auto buf = ReadFile(config_.model);
+    auto buf = MapFile(config_.model);
     Init(buf.data(), buf.size());
   }
 
   template <typename Manager>
   Impl(Manager *mgr, const OfflineLMConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_{GetSessionOptions(config)},
         allocator_{} {
     auto buf = ReadFile(mgr, config_.model);
@@ -58,9 +59,8 @@ class OfflineRnnLM::Impl {
   }
 
  private:
-  void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+  void Init(const void *model_data, size_t model_data_length) {
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -69,7 +69,7 @@ class OfflineRnnLM::Impl {
 
  private:
   OfflineLMConfig config_;
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
@@ -20,6 +20,7 @@
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -29,16 +30,16 @@ class OfflineSourceSeparationSpleeterModel::Impl {
  public:
   explicit Impl(const OfflineSourceSeparationModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     {
-      auto buf = ReadFile(config.spleeter.vocals);
+      auto buf = MapFile(config.spleeter.vocals);
       InitVocals(buf.data(), buf.size());
     }
 
     {
-      auto buf = ReadFile(config.spleeter.accompaniment);
+      auto buf = MapFile(config.spleeter.accompaniment);
       InitAccompaniment(buf.data(), buf.size());
     }
   }
@@ -46,7 +47,7 @@ class OfflineSourceSeparationSpleeterModel::Impl {
   template <typename Manager>
   Impl(Manager *mgr, const OfflineSourceSeparationModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     {
@@ -80,9 +81,9 @@ class OfflineSourceSeparationSpleeterModel::Impl {
   }
 
  private:
-  void InitVocals(void *model_data, size_t model_data_length) {
-    vocals_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+  void InitVocals(const void *model_data, size_t model_data_length) {
+    vocals_sess_ = CreateSession(env_, model_data, model_data_length,
+                                 sess_opts_);
 
     GetInputNames(vocals_sess_.get(), &vocals_input_names_,
                   &vocals_input_names_ptr_);
@@ -134,9 +135,9 @@ class OfflineSourceSeparationSpleeterModel::Impl {
     }
   }
 
-  void InitAccompaniment(void *model_data, size_t model_data_length) {
-    accompaniment_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+  void InitAccompaniment(const void *model_data, size_t model_data_length) {
+    accompaniment_sess_ = CreateSession(env_, model_data, model_data_length,
+                                        sess_opts_);
 
     GetInputNames(accompaniment_sess_.get(), &accompaniment_input_names_,
                   &accompaniment_input_names_ptr_);
@@ -149,7 +150,7 @@ class OfflineSourceSeparationSpleeterModel::Impl {
   OfflineSourceSeparationModelConfig config_;
   OfflineSourceSeparationSpleeterModelMetaData meta_;
 
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
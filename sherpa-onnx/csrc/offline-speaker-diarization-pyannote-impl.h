@@ -475,37 +475,58 @@ class OfflineSpeakerDiarizationPyannoteImpl
 
     auto IsNaNWrapper = [](float f) -> bool { return std::isnan(f); };
 
+    // Number of segments whose embeddings are computed with a single call
+    // to the embedding extractor
+    constexpr int32_t kBatchSize = 16;
+
+    int32_t num_segments = sample_indexes.size();
+
     int32_t k = 0;
     int32_t cur_row_index = 0;
-    for (const auto &v : sample_indexes) {
-      auto stream = embedding_extractor_.CreateStream();
-      for (const auto &p : v) {
-        int32_t end = (p.second <= n) ? p.second : n;
-        int32_t num_samples = end - p.first;
-
-        if (num_samples > 0) {
-          stream->AcceptWaveform(sample_rate, audio + p.first, num_samples);
+    std::vector<std::unique_ptr<OnlineStream>> streams;
+    std::vector<OnlineStream *> ss;
+    for (int32_t start = 0; start < num_segments; start += kBatchSize) {
+      int32_t batch_end = std::min(start + kBatchSize, num_segments);
+
+      streams.clear();
+      ss.clear();
+      for (int32_t i = start; i != batch_end; ++i) {
+        auto stream = embedding_extractor_.CreateStream();
+        for (const auto &p : sample_indexes[i]) {
+          int32_t end = (p.second <= n) ? p.second : n;
+          int32_t num_samples = end - p.first;
+
+          if (num_samples > 0) {
+            stream->AcceptWaveform(sample_rate, audio + p.first, num_samples);
+          }
         }
-      }
 
-      stream->InputFinished();
-      if (!embedding_extractor_.IsReady(stream.get())) {
-        SHERPA_ONNX_LOGE(
-            "This segment is too short, which should not happen since we have "
-            "already filtered short segments");
-        SHERPA_ONNX_EXIT(-1);
+        stream->InputFinished();
+        if (!embedding_extractor_.IsReady(stream.get())) {
+          SHERPA_ONNX_LOGE(
+              "This segment is too short, which should not happen since we "
+              "have already filtered short segments");
+          SHERPA_ONNX_EXIT(-1);
+        }
+
+        ss.push_back(stream.get());
+        streams.push_back(std::move(stream));
       }
 
-      std::vector<float> embedding = embedding_extractor_.Compute(stream.get());
+      std::vector<std::vector<float>> embeddings =
+          embedding_extractor_.Compute(ss.data(), ss.size());
 
-      if (std::none_of(embedding.begin(), embedding.end(), IsNaNWrapper)) {
-        // a valid embedding
-        std::copy(embedding.begin(), embedding.end(), &ans(cur_row_index, 0));
-        cur_row_index += 1;
-        valid_indexes->push_back(k);
-      }
+      for (const auto &embedding : embeddings) {
+        if (std::none_of(embedding.begin(), embedding.end(), IsNaNWrapper)) {
+          // a valid embedding
+          std::copy(embedding.begin(), embedding.end(),
+                    &ans(cur_row_index, 0));
+          cur_row_index += 1;
+          valid_indexes->push_back(k);
+        }
 
-      k += 1;
+        k += 1;
+      }
 
       if (callback) {
         callback(k, ans.rows(), callback_arg);
@@ -0,0 +1,58 @@
+// sherpa-onnx/csrc/offline-stream-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-stream.h"
+
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+// Features are computed on first access. Streams are shared between
+// threads, e.g., by ComputeBatchedFeatures(), so the first accesses may
+// happen at the same time.
+TEST(OfflineStream, ConcurrentAccess) {
+  FeatureExtractorConfig config;
+
+  std::mt19937 gen(2025);
+  std::uniform_real_distribution<float> dist(-0.5, 0.5);
+  std::vector<float> samples(16000);
+  for (auto &s : samples) {
+    s = dist(gen);
+  }
+
+  OfflineStream expected_stream(config);
+  expected_stream.AcceptWaveform(config.sampling_rate, samples.data(),
+                                 samples.size());
+  std::vector<float> expected = expected_stream.GetFrames();
+  ASSERT_FALSE(expected.empty());
+
+  for (int32_t k = 0; k != 10; ++k) {
+    OfflineStream s(config);
+    s.AcceptWaveform(config.sampling_rate, samples.data(), samples.size());
+
+    int32_t num_threads = 4;
+    std::vector<std::vector<float>> features(num_threads);
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i != num_threads; ++i) {
+      threads.emplace_back([&s, &features, i]() {
+        EXPECT_GT(s.NumFrames(), 0);
+        features[i] = s.GetFrames();
+      });
+    }
+
+    for (auto &t : threads) {
+      t.join();
+    }
+
+    for (const auto &f : features) {
+      EXPECT_EQ(f, expected);
+    }
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -9,9 +9,11 @@
 #include <cmath>
 #include <iomanip>
 #include <limits>
+#include <mutex>  // NOLINT
 #include <utility>
 
 #include "kaldi-native-fbank/csrc/online-feature.h"
+#include "sherpa-onnx/csrc/fast-fbank.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/resample.h"
@@ -99,7 +101,11 @@ class OfflineStream::Impl {
 
       opts_.mel_opts.is_librosa = config.is_librosa;
 
-      fbank_ = std::make_unique<knf::OnlineFbank>(opts_);
+      if (config_.use_fast_fbank && FastFbank::IsSupported(opts_)) {
+        fast_fbank_ = std::make_unique<FastFbank>(opts_);
+      } else {
+        fbank_ = std::make_unique<knf::OnlineFbank>(opts_);
+      }
     }
   }
 
@@ -142,16 +148,102 @@ class OfflineStream::Impl {
     config_.sampling_rate = 16000;
   }
 
+  // Features are computed lazily on first access so that
+  // ComputeBatchedFeatures() can compute the features of many streams in
+  // parallel.
   void AcceptWaveform(int32_t sampling_rate, const float *waveform, int32_t n) {
-    if (config_.normalize_samples) {
-      AcceptWaveformImpl(sampling_rate, waveform, n);
+    std::vector<float> samples(waveform, waveform + n);
+    if (!config_.normalize_samples) {
+      for (auto &s : samples) {
+        s *= 32768;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.emplace_back(sampling_rate, std::move(samples));
+  }
+
+  int32_t FeatureDim() {
+    if (is_moonshine_) {
+      ComputeFeatures();
+      return samples_.size();
+    }
+
+    return mfcc_ ? mfcc_opts_.num_ceps : opts_.mel_opts.num_bins;
+  }
+
+  int32_t NumFrames() {
+    ComputeFeatures();
+
+    if (is_moonshine_) {
+      return 1;
+    }
+
+    return fast_fbank_ ? fast_fbank_->NumFramesReady()
+           : fbank_    ? fbank_->NumFramesReady()
+           : mfcc_     ? mfcc_->NumFramesReady()
+                       : whisper_fbank_->NumFramesReady();
+  }
+
+  void GetFrames(float *dst) {
+    int32_t n = NumFrames();
+
+    if (is_moonshine_) {
+      std::copy(samples_.begin(), samples_.end(), dst);
+      return;
+    }
+
+    assert(n > 0 && "Please first call AcceptWaveform()");
+
+    int32_t feature_dim = FeatureDim();
+
+    if (fast_fbank_) {
+      fast_fbank_->GetFrames(0, n, dst);
     } else {
-      std::vector<float> buf(n);
+      float *p = dst;
       for (int32_t i = 0; i != n; ++i) {
-        buf[i] = waveform[i] * 32768;
+        const float *f = fbank_  ? fbank_->GetFrame(i)
+                         : mfcc_ ? mfcc_->GetFrame(i)
+                                 : whisper_fbank_->GetFrame(i);
+        std::copy(f, f + feature_dim, p);
+        p += feature_dim;
       }
-      AcceptWaveformImpl(sampling_rate, buf.data(), n);
     }
+
+    NemoNormalizeFeatures(dst, n, feature_dim);
+
+    if (is_ced_) {
+      AmplitudeToDB(dst, n * feature_dim);
+    }
+  }
+
+  std::vector<float> GetFrames() {
+    std::vector<float> features(NumFrames() * FeatureDim());
+    GetFrames(features.data());
+    return features;
+  }
+
+  void SetResult(const OfflineRecognitionResult &r) { r_ = r; }
+
+  const OfflineRecognitionResult &GetResult() const { return r_; }
+
+  const ContextGraphPtr &GetContextGraph() const { return context_graph_; }
+
+ private:
+  // It is called by the const accessors of OfflineStream, which may be
+  // invoked from several threads at the same time
+  void ComputeFeatures() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) {
+      return;
+    }
+
+    for (const auto &p : pending_) {
+      AcceptWaveformImpl(p.first, p.second.data(), p.second.size());
+    }
+
+    // Release the memory of the samples
+    std::vector<std::pair<int32_t, std::vector<float>>>().swap(pending_);
   }
 
   void AcceptWaveformImpl(int32_t sampling_rate, const float *waveform,
@@ -173,27 +265,21 @@ class OfflineStream::Impl {
       std::vector<float> samples;
       resampler->Resample(waveform, n, true, &samples);
 
-      if (is_moonshine_) {
-        samples_.insert(samples_.end(), samples.begin(), samples.end());
-      } else if (fbank_) {
-        fbank_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                               samples.size());
-        fbank_->InputFinished();
-      } else if (mfcc_) {
-        mfcc_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                              samples.size());
-        mfcc_->InputFinished();
-      } else {
-        whisper_fbank_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                                       samples.size());
-        whisper_fbank_->InputFinished();
-      }
-
+      AcceptSamples(samples.data(), samples.size());
       return;
-    }  // if (sampling_rate != config_.sampling_rate)
+    }
+
+    AcceptSamples(waveform, n);
+  }
 
+  // sample rate of waveform is config_.sampling_rate
+  void AcceptSamples(const float *waveform, int32_t n) {
+    float sampling_rate = config_.sampling_rate;
     if (is_moonshine_) {
       samples_.insert(samples_.end(), waveform, waveform + n);
+    } else if (fast_fbank_) {
+      fast_fbank_->AcceptWaveform(sampling_rate, waveform, n);
+      fast_fbank_->InputFinished();
     } else if (fbank_) {
       fbank_->AcceptWaveform(sampling_rate, waveform, n);
       fbank_->InputFinished();
@@ -206,54 +292,6 @@ class OfflineStream::Impl {
     }
   }
 
-  int32_t FeatureDim() const {
-    if (is_moonshine_) {
-      return samples_.size();
-    }
-
-    return mfcc_ ? mfcc_opts_.num_ceps : opts_.mel_opts.num_bins;
-  }
-
-  std::vector<float> GetFrames() const {
-    if (is_moonshine_) {
-      return samples_;
-    }
-
-    int32_t n = fbank_  ? fbank_->NumFramesReady()
-                : mfcc_ ? mfcc_->NumFramesReady()
-                        : whisper_fbank_->NumFramesReady();
-    assert(n > 0 && "Please first call AcceptWaveform()");
-
-    int32_t feature_dim = FeatureDim();
-
-    std::vector<float> features(n * feature_dim);
-
-    float *p = features.data();
-
-    for (int32_t i = 0; i != n; ++i) {
-      const float *f = fbank_  ? fbank_->GetFrame(i)
-                       : mfcc_ ? mfcc_->GetFrame(i)
-                               : whisper_fbank_->GetFrame(i);
-      std::copy(f, f + feature_dim, p);
-      p += feature_dim;
-    }
-
-    NemoNormalizeFeatures(features.data(), n, feature_dim);
-
-    if (is_ced_) {
-      AmplitudeToDB(features.data(), features.size());
-    }
-
-    return features;
-  }
-
-  void SetResult(const OfflineRecognitionResult &r) { r_ = r; }
-
-  const OfflineRecognitionResult &GetResult() const { return r_; }
-
-  const ContextGraphPtr &GetContextGraph() const { return context_graph_; }
-
- private:
   // see
   // https://github.com/pytorch/audio/blob/main/src/torchaudio/functional/functional.py#L359
   void AmplitudeToDB(float *p, int32_t n) const {
@@ -313,6 +351,7 @@ class OfflineStream::Impl {
 
  private:
   FeatureExtractorConfig config_;
+  std::unique_ptr<FastFbank> fast_fbank_;
   std::unique_ptr<knf::OnlineFbank> fbank_;
   std::unique_ptr<knf::OnlineMfcc> mfcc_;
   std::unique_ptr<knf::OnlineWhisperFbank> whisper_fbank_;
@@ -325,6 +364,14 @@ class OfflineStream::Impl {
 
   // used only when is_moonshine_== true
   std::vector<float> samples_;
+
+  // (sampling_rate, samples) passed to AcceptWaveform() whose features
+  // have not been computed yet
+  std::vector<std::pair<int32_t, std::vector<float>>> pending_;
+
+  // Protects pending_ and the feature extractors while features are
+  // computed from pending_
+  std::mutex mutex_;
 };
 
 OfflineStream::OfflineStream(const FeatureExtractorConfig &config /*= {}*/,
@@ -348,10 +395,14 @@ void OfflineStream::AcceptWaveform(int32_t sampling_rate, const float *waveform,
 
 int32_t OfflineStream::FeatureDim() const { return impl_->FeatureDim(); }
 
+int32_t OfflineStream::NumFrames() const { return impl_->NumFrames(); }
+
 std::vector<float> OfflineStream::GetFrames() const {
   return impl_->GetFrames();
 }
 
+void OfflineStream::GetFrames(float *dst) const { impl_->GetFrames(dst); }
+
 void OfflineStream::SetResult(const OfflineRecognitionResult &r) {
   impl_->SetResult(r);
 }
@@ -77,6 +77,9 @@ class OfflineStream {
 
      Caution: You can only invoke this function once so you have to input
               all the samples at once
+
+     Note: Features are computed on the first call to NumFrames() or
+           GetFrames(), not in this function.
    */
   void AcceptWaveform(int32_t sampling_rate, const float *waveform,
                       int32_t n) const;
@@ -87,10 +90,19 @@ class OfflineStream {
   /// currently received.
   int32_t FeatureDim() const;
 
+  /// Return the number of feature frames of this stream.
+  ///
+  /// Note: if it is Moonshine, then it returns 1.
+  int32_t NumFrames() const;
+
   // Get all the feature frames of this stream in a 1-D array, which is
   // flattened from a 2-D array of shape (num_frames, feat_dim).
   std::vector<float> GetFrames() const;
 
+  // Same as above, but write the frames to dst, which must have
+  // NumFrames() * FeatureDim() entries.
+  void GetFrames(float *dst) const;
+
   /** Set the recognition result for this stream. */
   void SetResult(const OfflineRecognitionResult &r);
 
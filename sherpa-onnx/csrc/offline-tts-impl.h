@@ -41,6 +41,21 @@ class OfflineTtsImpl {
         "OfflineTtsImpl backend does not support zero-shot Generate()");
   }
 
+  virtual bool RegisterPrompt(const std::string &name,
+                              const std::string &prompt_text,
+                              const std::vector<float> &prompt_samples,
+                              int32_t sample_rate) const {
+    throw std::runtime_error(
+        "OfflineTtsImpl backend does not support RegisterPrompt()");
+  }
+
+  virtual GeneratedAudio GenerateWithPrompt(
+      const std::string &text, const std::string &name, float speed = 1.0,
+      int32_t num_step = 4, GeneratedAudioCallback callback = nullptr) const {
+    throw std::runtime_error(
+        "OfflineTtsImpl backend does not support GenerateWithPrompt()");
+  }
+
   // Return the sample rate of the generated audio
   virtual int32_t SampleRate() const = 0;
 
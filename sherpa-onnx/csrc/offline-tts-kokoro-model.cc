@@ -21,6 +21,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -30,11 +31,11 @@ class OfflineTtsKokoroModel::Impl {
  public:
   explicit Impl(const OfflineTtsModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
-    auto model_buf = ReadFile(config.kokoro.model);
-    auto voices_buf = ReadFile(config.kokoro.voices);
+    auto model_buf = MapFile(config.kokoro.model);
+    auto voices_buf = MapFile(config.kokoro.voices);
     Init(model_buf.data(), model_buf.size(), voices_buf.data(),
          voices_buf.size());
   }
@@ -42,7 +43,7 @@ class OfflineTtsKokoroModel::Impl {
   template <typename Manager>
   Impl(Manager *mgr, const OfflineTtsModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     auto model_buf = ReadFile(mgr, config.kokoro.model);
@@ -102,10 +103,9 @@ class OfflineTtsKokoroModel::Impl {
   }
 
  private:
-  void Init(void *model_data, size_t model_data_length, const char *voices_data,
-            size_t voices_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+  void Init(const void *model_data, size_t model_data_length,
+            const char *voices_data, size_t voices_data_length) {
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -204,7 +204,7 @@ class OfflineTtsKokoroModel::Impl {
 
  private:
   OfflineTtsModelConfig config_;
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
@@ -238,11 +238,7 @@ class OfflineTtsMatchaImpl : public OfflineTtsImpl {
     int32_t x_size = static_cast<int32_t>(x.size());
 
     if (config_.max_num_sentences <= 0 || x_size <= config_.max_num_sentences) {
-      auto ans = Process(x, sid, speed);
-      if (callback) {
-        callback(ans.samples.data(), ans.samples.size(), 1.0);
-      }
-      return ans;
+      return Process(x, sid, speed, callback);
     }
 
     // the input text is too long, we process sentences within it in batches
@@ -279,17 +275,12 @@ class OfflineTtsMatchaImpl : public OfflineTtsImpl {
         batch_x.push_back(std::move(x[k]));
       }
 
-      auto audio = Process(batch_x, sid, speed);
+      auto audio = Process(batch_x, sid, speed, callback,
+                           b * 1.0 / num_batches, (b + 1) * 1.0 / num_batches,
+                           &should_continue);
       ans.sample_rate = audio.sample_rate;
       ans.samples.insert(ans.samples.end(), audio.samples.begin(),
                          audio.samples.end());
-      if (callback) {
-        should_continue = callback(audio.samples.data(), audio.samples.size(),
-                                   (b + 1) * 1.0 / num_batches);
-        // Caution(fangjun): audio is freed when the callback returns, so users
-        // should copy the data if they want to access the data after
-        // the callback returns to avoid segmentation fault.
-      }
     }
 
     batch_x.clear();
@@ -300,16 +291,10 @@ class OfflineTtsMatchaImpl : public OfflineTtsImpl {
     }
 
     if (!batch_x.empty()) {
-      auto audio = Process(batch_x, sid, speed);
+      auto audio = Process(batch_x, sid, speed, callback, 1.0, 1.0);
       ans.sample_rate = audio.sample_rate;
       ans.samples.insert(ans.samples.end(), audio.samples.begin(),
                          audio.samples.end());
-      if (callback) {
-        callback(audio.samples.data(), audio.samples.size(), 1.0);
-        // Caution(fangjun): audio is freed when the callback returns, so users
-        // should copy the data if they want to access the data after
-        // the callback returns to avoid segmentation fault.
-      }
     }
 
     return ans;
@@ -357,8 +342,20 @@ class OfflineTtsMatchaImpl : public OfflineTtsImpl {
     }
   }
 
+  // If callback is not empty, it is called with the generated samples.
+  // When config_.vocoder_chunk_size is positive, it is called once for each
+  // vocoder chunk, with progress from progress_begin to progress_end.
+  // The value returned by the last call of the callback is saved in
+  // should_continue if it is not null.
+  //
+  // Caution(fangjun): samples passed to the callback are freed when the
+  // callback returns, so users should copy the data if they want to access
+  // the data after the callback returns to avoid segmentation fault.
   GeneratedAudio Process(const std::vector<std::vector<int64_t>> &tokens,
-                         int32_t sid, float speed) const {
+                         int32_t sid, float speed,
+                         GeneratedAudioCallback callback = nullptr,
+                         float progress_begin = 0, float progress_end = 1.0,
+                         int32_t *should_continue = nullptr) const {
     int32_t num_tokens = 0;
     for (const auto &k : tokens) {
       num_tokens += k.size();
@@ -380,15 +377,54 @@ class OfflineTtsMatchaImpl : public OfflineTtsImpl {
     Ort::Value mel = model_->Run(std::move(x_tensor), sid, speed);
 
     GeneratedAudio ans;
-
-    ans.samples = vocoder_->Run(std::move(mel));
     ans.sample_rate = model_->GetMetaData().sample_rate;
 
     float silence_scale = config_.silence_scale;
+
+    if (config_.vocoder_chunk_size > 0 && callback) {
+      // Pass samples to the callback as soon as each chunk is vocoded
+      int32_t ok = 1;
+      vocoder_->RunChunked(
+          std::move(mel), config_.vocoder_chunk_size,
+          [&](const float *samples, int32_t n, float progress) {
+            GeneratedAudio chunk;
+            chunk.sample_rate = ans.sample_rate;
+            chunk.samples.assign(samples, samples + n);
+            if (silence_scale != 1) {
+              chunk = chunk.ScaleSilence(silence_scale);
+            }
+
+            ans.samples.insert(ans.samples.end(), chunk.samples.begin(),
+                               chunk.samples.end());
+
+            ok = callback(chunk.samples.data(), chunk.samples.size(),
+                          progress_begin +
+                              progress * (progress_end - progress_begin));
+            return ok != 0;
+          });
+
+      if (should_continue) {
+        *should_continue = ok;
+      }
+
+      return ans;
+    }
+
+    ans.samples =
+        vocoder_->RunChunked(std::move(mel), config_.vocoder_chunk_size);
+
     if (silence_scale != 1) {
       ans = ans.ScaleSilence(silence_scale);
     }
 
+    if (callback) {
+      int32_t ok = callback(ans.samples.data(), ans.samples.size(),
+                            progress_end);
+      if (should_continue) {
+        *should_continue = ok;
+      }
+    }
+
     return ans;
   }
 
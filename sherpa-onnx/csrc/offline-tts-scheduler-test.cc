@@ -0,0 +1,138 @@
+// sherpa-onnx/csrc/offline-tts-scheduler-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-tts-scheduler.h"
+
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+// It records the order in which requests are synthesized. The request
+// "gate" blocks the worker until Open() is called, so that other requests
+// can be queued in the meantime.
+class FakeTts {
+ public:
+  OfflineTtsScheduler::GenerateFunc GetGenerateFunc() {
+    return [this](const std::string &text, int64_t /*sid*/, float /*speed*/,
+                  GeneratedAudioCallback /*callback*/) {
+      if (text == "gate") {
+        started_.set_value();
+        opened_.wait();
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      order_.push_back(text);
+
+      GeneratedAudio ans;
+      ans.samples.resize(text.size());
+      ans.sample_rate = 16000;
+      return ans;
+    };
+  }
+
+  // Wait until the worker is blocked by "gate"
+  void WaitForGate() { started_.get_future().wait(); }
+
+  void Open() { open_.set_value(); }
+
+  std::vector<std::string> Order() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return order_;
+  }
+
+ private:
+  std::promise<void> started_;
+  std::promise<void> open_;
+  std::shared_future<void> opened_ = open_.get_future().share();
+
+  mutable std::mutex mutex_;
+  std::vector<std::string> order_;
+};
+
+TEST(OfflineTtsScheduler, ShortestFirst) {
+  FakeTts tts;
+  OfflineTtsScheduler scheduler(tts.GetGenerateFunc(),
+                                OfflineTtsSchedulerConfig(1, 60000));
+
+  auto gate = scheduler.Submit("gate");
+  tts.WaitForGate();
+
+  std::vector<std::string> texts = {"ccccc", "aaa", "dddd", "b", "ee"};
+  std::vector<std::future<GeneratedAudio>> futures;
+  for (const auto &t : texts) {
+    futures.push_back(scheduler.Submit(t));
+  }
+
+  tts.Open();
+
+  for (int32_t i = 0; i != static_cast<int32_t>(texts.size()); ++i) {
+    EXPECT_EQ(futures[i].get().samples.size(), texts[i].size());
+  }
+  gate.get();
+
+  EXPECT_EQ(tts.Order(), (std::vector<std::string>{"gate", "b", "ee", "aaa",
+                                                   "dddd", "ccccc"}));
+
+  auto stats = scheduler.GetStats();
+  EXPECT_EQ(stats.num_submitted, 6);
+  EXPECT_EQ(stats.num_finished, 6);
+  EXPECT_EQ(stats.num_queued, 0);
+  EXPECT_EQ(stats.num_running, 0);
+}
+
+TEST(OfflineTtsScheduler, MaxWait) {
+  FakeTts tts;
+  int32_t max_wait_ms = 200;
+  OfflineTtsScheduler scheduler(tts.GetGenerateFunc(),
+                                OfflineTtsSchedulerConfig(1, max_wait_ms));
+
+  auto gate = scheduler.Submit("gate");
+  tts.WaitForGate();
+
+  // It has waited longer than max_wait_ms when the worker is free again,
+  // so it is served before shorter requests
+  auto long_request = scheduler.Submit("a long request");
+  std::this_thread::sleep_for(std::chrono::milliseconds(2 * max_wait_ms));
+
+  auto a = scheduler.Submit("aaa");
+  auto b = scheduler.Submit("b");
+
+  tts.Open();
+
+  gate.get();
+  long_request.get();
+  a.get();
+  b.get();
+
+  EXPECT_EQ(tts.Order(), (std::vector<std::string>{"gate", "a long request",
+                                                   "b", "aaa"}));
+
+  auto stats = scheduler.GetStats();
+  EXPECT_GE(stats.max_queue_wait_ms, 2 * max_wait_ms);
+}
+
+TEST(OfflineTtsScheduler, Exception) {
+  OfflineTtsScheduler scheduler(
+      [](const std::string &text, int64_t, float,
+         GeneratedAudioCallback) -> GeneratedAudio {
+        throw std::runtime_error(text);
+      },
+      OfflineTtsSchedulerConfig(2, 500));
+
+  auto f = scheduler.Submit("error");
+  EXPECT_THROW(f.get(), std::runtime_error);
+
+  // Workers are still alive
+  EXPECT_THROW(scheduler.Generate("error again"), std::runtime_error);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,227 @@
+// sherpa-onnx/csrc/offline-tts-scheduler.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-tts-scheduler.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+bool OfflineTtsSchedulerConfig::Validate() const {
+  if (num_workers < 1) {
+    SHERPA_ONNX_LOGE("num_workers should be positive. Given: %d",
+                     num_workers);
+    return false;
+  }
+
+  if (max_wait_ms < 0) {
+    SHERPA_ONNX_LOGE("max_wait_ms should be non-negative. Given: %d",
+                     max_wait_ms);
+    return false;
+  }
+
+  return true;
+}
+
+std::string OfflineTtsSchedulerConfig::ToString() const {
+  std::ostringstream os;
+
+  os << "OfflineTtsSchedulerConfig(";
+  os << "num_workers=" << num_workers << ", ";
+  os << "max_wait_ms=" << max_wait_ms << ")";
+
+  return os.str();
+}
+
+std::string OfflineTtsSchedulerStats::ToString() const {
+  std::ostringstream os;
+
+  os << "OfflineTtsSchedulerStats(";
+  os << "num_submitted=" << num_submitted << ", ";
+  os << "num_finished=" << num_finished << ", ";
+  os << "num_queued=" << num_queued << ", ";
+  os << "num_running=" << num_running << ", ";
+  os << "avg_queue_wait_ms=" << avg_queue_wait_ms << ", ";
+  os << "max_queue_wait_ms=" << max_queue_wait_ms << ", ";
+  os << "occupancy=" << occupancy << ")";
+
+  return os.str();
+}
+
+OfflineTtsScheduler::OfflineTtsScheduler(
+    const OfflineTts *tts, const OfflineTtsSchedulerConfig &config)
+    : OfflineTtsScheduler(
+          [tts](const std::string &text, int64_t sid, float speed,
+                GeneratedAudioCallback callback) {
+            return tts->Generate(text, sid, speed, std::move(callback));
+          },
+          config) {}
+
+OfflineTtsScheduler::OfflineTtsScheduler(
+    GenerateFunc generate, const OfflineTtsSchedulerConfig &config)
+    : generate_(std::move(generate)),
+      config_(config),
+      start_time_(Clock::now()) {
+  if (!config_.Validate()) {
+    SHERPA_ONNX_LOGE("Errors in config: %s", config_.ToString().c_str());
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  workers_.reserve(config_.num_workers);
+  for (int32_t i = 0; i != config_.num_workers; ++i) {
+    workers_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+OfflineTtsScheduler::~OfflineTtsScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+
+  for (auto &t : workers_) {
+    t.join();
+  }
+}
+
+std::future<GeneratedAudio> OfflineTtsScheduler::Submit(
+    const std::string &text, int64_t sid /*= 0*/, float speed /*= 1.0*/,
+    GeneratedAudioCallback callback /*= nullptr*/) {
+  auto r = std::make_unique<Request>();
+  r->text = text;
+  r->sid = sid;
+  r->speed = speed;
+  r->callback = std::move(callback);
+  r->enqueue_time = Clock::now();
+
+  auto ans = r->promise.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(r));
+    ++num_submitted_;
+  }
+  cv_.notify_one();
+
+  return ans;
+}
+
+GeneratedAudio OfflineTtsScheduler::Generate(
+    const std::string &text, int64_t sid /*= 0*/, float speed /*= 1.0*/,
+    GeneratedAudioCallback callback /*= nullptr*/) {
+  return Submit(text, sid, speed, std::move(callback)).get();
+}
+
+std::unique_ptr<OfflineTtsScheduler::Request> OfflineTtsScheduler::Pop() {
+  auto now = Clock::now();
+
+  auto it = queue_.begin();
+
+  auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now - (*it)->enqueue_time);
+
+  if (waited.count() < config_.max_wait_ms) {
+    // The oldest one has not waited too long. Select the shortest one.
+    // The queue is short, so a linear scan is fine.
+    it = std::min_element(queue_.begin(), queue_.end(),
+                          [](const auto &a, const auto &b) {
+                            return a->text.size() < b->text.size();
+                          });
+  }
+
+  auto ans = std::move(*it);
+  queue_.erase(it);
+
+  return ans;
+}
+
+void OfflineTtsScheduler::WorkerLoop() {
+  while (true) {
+    std::unique_ptr<Request> r;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+
+      if (queue_.empty()) {
+        // stop_ is true and all requests are done
+        return;
+      }
+
+      r = Pop();
+
+      double wait_ms = std::chrono::duration<double, std::milli>(
+                           Clock::now() - r->enqueue_time)
+                           .count();
+      total_queue_wait_ms_ += wait_ms;
+      max_queue_wait_ms_ = std::max(max_queue_wait_ms_, wait_ms);
+      ++num_started_;
+      ++num_running_;
+    }
+
+    auto start = Clock::now();
+
+    GeneratedAudio audio;
+    std::exception_ptr error;
+    try {
+      audio = generate_(r->text, r->sid, r->speed, r->callback);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    double busy_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      total_busy_ms_ += busy_ms;
+      ++num_finished_;
+      --num_running_;
+    }
+
+    // Update the statistics first so that they include this request once
+    // the caller gets the result
+    if (error) {
+      r->promise.set_exception(error);
+    } else {
+      r->promise.set_value(std::move(audio));
+    }
+  }
+}
+
+OfflineTtsSchedulerStats OfflineTtsScheduler::GetStats() const {
+  OfflineTtsSchedulerStats ans;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  ans.num_submitted = num_submitted_;
+  ans.num_finished = num_finished_;
+  ans.num_queued = static_cast<int32_t>(queue_.size());
+  ans.num_running = num_running_;
+
+  if (num_started_ > 0) {
+    ans.avg_queue_wait_ms = total_queue_wait_ms_ / num_started_;
+  }
+  ans.max_queue_wait_ms = max_queue_wait_ms_;
+
+  double elapsed_ms =
+      std::chrono::duration<double, std::milli>(Clock::now() - start_time_)
+          .count();
+  if (elapsed_ms > 0) {
+    ans.occupancy = std::min(
+        1.0, total_busy_ms_ / (elapsed_ms * config_.num_workers));
+  }
+
+  return ans;
+}
+
+}  // namespace sherpa_onnx
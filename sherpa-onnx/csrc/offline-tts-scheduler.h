@@ -0,0 +1,152 @@
+// sherpa-onnx/csrc/offline-tts-scheduler.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_OFFLINE_TTS_SCHEDULER_H_
+#define SHERPA_ONNX_CSRC_OFFLINE_TTS_SCHEDULER_H_
+
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "sherpa-onnx/csrc/offline-tts.h"
+
+namespace sherpa_onnx {
+
+struct OfflineTtsSchedulerConfig {
+  // Number of requests that are synthesized at the same time.
+  // Each of them uses config.model.num_threads threads of onnxruntime,
+  // so num_workers * num_threads should not exceed the number of cores.
+  int32_t num_workers = 2;
+
+  // Shorter requests are served first. A request that has waited longer
+  // than this is served next regardless of its length, so that long
+  // requests are not starved.
+  int32_t max_wait_ms = 500;
+
+  OfflineTtsSchedulerConfig() = default;
+  OfflineTtsSchedulerConfig(int32_t num_workers, int32_t max_wait_ms)
+      : num_workers(num_workers), max_wait_ms(max_wait_ms) {}
+
+  bool Validate() const;
+  std::string ToString() const;
+};
+
+struct OfflineTtsSchedulerStats {
+  int64_t num_submitted = 0;
+  int64_t num_finished = 0;
+
+  // Number of requests waiting in the queue
+  int32_t num_queued = 0;
+
+  // Number of requests being synthesized
+  int32_t num_running = 0;
+
+  // Time requests spent in the queue before they are started
+  float avg_queue_wait_ms = 0;
+  float max_queue_wait_ms = 0;
+
+  // Fraction of time the workers are busy since the scheduler is created.
+  // It is in the range [0, 1].
+  float occupancy = 0;
+
+  std::string ToString() const;
+};
+
+// Serve many concurrent TTS requests with a fixed number of workers.
+//
+// Calling OfflineTts::Generate() from many threads at the same time
+// oversubscribes the CPU since each call runs onnxruntime with its own
+// threads. Requests submitted to this class are queued instead and
+// synthesized by num_workers threads, shortest request first.
+class OfflineTtsScheduler {
+ public:
+  using GenerateFunc = std::function<GeneratedAudio(
+      const std::string &text, int64_t sid, float speed,
+      GeneratedAudioCallback callback)>;
+
+  // tts is not owned and must outlive this object
+  OfflineTtsScheduler(const OfflineTts *tts,
+                      const OfflineTtsSchedulerConfig &config);
+
+  // Requests are synthesized by calling generate, which is called from
+  // num_workers threads at the same time
+  OfflineTtsScheduler(GenerateFunc generate,
+                      const OfflineTtsSchedulerConfig &config);
+
+  // It waits for all submitted requests to finish
+  ~OfflineTtsScheduler();
+
+  OfflineTtsScheduler(const OfflineTtsScheduler &) = delete;
+  OfflineTtsScheduler &operator=(const OfflineTtsScheduler &) = delete;
+
+  /** Queue a request. See OfflineTts::Generate() for the arguments.
+   *
+   * The callback, if any, is called from a worker thread.
+   *
+   * @return Return a future for the generated audio. If Generate() throws,
+   *         the exception is rethrown by get() of the returned future.
+   */
+  std::future<GeneratedAudio> Submit(const std::string &text, int64_t sid = 0,
+                                     float speed = 1.0,
+                                     GeneratedAudioCallback callback = nullptr);
+
+  // Same as Submit(), but it waits for the result
+  GeneratedAudio Generate(const std::string &text, int64_t sid = 0,
+                          float speed = 1.0,
+                          GeneratedAudioCallback callback = nullptr);
+
+  OfflineTtsSchedulerStats GetStats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    std::string text;
+    int64_t sid;
+    float speed;
+    GeneratedAudioCallback callback;
+    std::promise<GeneratedAudio> promise;
+    Clock::time_point enqueue_time;
+  };
+
+  void WorkerLoop();
+
+  // Remove the next request to run from queue_. mutex_ must be held.
+  std::unique_ptr<Request> Pop();
+
+ private:
+  GenerateFunc generate_;
+  OfflineTtsSchedulerConfig config_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+
+  // In the order of arrival
+  std::deque<std::unique_ptr<Request>> queue_;
+
+  std::vector<std::thread> workers_;
+
+  // statistics, protected by mutex_
+  Clock::time_point start_time_;
+  int64_t num_submitted_ = 0;
+  int64_t num_started_ = 0;
+  int64_t num_finished_ = 0;
+  int32_t num_running_ = 0;
+  double total_queue_wait_ms_ = 0;
+  double max_queue_wait_ms_ = 0;
+  double total_busy_ms_ = 0;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_OFFLINE_TTS_SCHEDULER_H_
@@ -14,12 +14,15 @@
 
 #include "kaldi-native-fbank/csrc/mel-computations.h"
 #include "kaldi-native-fbank/csrc/stft.h"
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/lru-cache.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/offline-tts-frontend.h"
 #include "sherpa-onnx/csrc/offline-tts-impl.h"
 #include "sherpa-onnx/csrc/offline-tts-zipvoice-frontend.h"
 #include "sherpa-onnx/csrc/offline-tts-zipvoice-model-config.h"
 #include "sherpa-onnx/csrc/offline-tts-zipvoice-model.h"
+#include "sherpa-onnx/csrc/offline-tts-zipvoice-prompt.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/resample.h"
 #include "sherpa-onnx/csrc/vocoder.h"
@@ -31,7 +34,8 @@ class OfflineTtsZipvoiceImpl : public OfflineTtsImpl {
   explicit OfflineTtsZipvoiceImpl(const OfflineTtsConfig &config)
       : config_(config),
         model_(std::make_unique<OfflineTtsZipvoiceModel>(config.model)),
-        vocoder_(Vocoder::Create(config.model)) {
+        vocoder_(Vocoder::Create(config.model)),
+        prompts_(config.model.zipvoice.max_num_prompts, 1) {
     InitFrontend();
   }
 
@@ -39,7 +43,8 @@ class OfflineTtsZipvoiceImpl : public OfflineTtsImpl {
   OfflineTtsZipvoiceImpl(Manager *mgr, const OfflineTtsConfig &config)
       : config_(config),
         model_(std::make_unique<OfflineTtsZipvoiceModel>(mgr, config.model)),
-        vocoder_(Vocoder::Create(mgr, config.model)) {
+        vocoder_(Vocoder::Create(mgr, config.model)),
+        prompts_(config.model.zipvoice.max_num_prompts, 1) {
     InitFrontend(mgr);
   }
 
@@ -52,42 +57,50 @@ class OfflineTtsZipvoiceImpl : public OfflineTtsImpl {
       const std::vector<float> &prompt_samples, int32_t sample_rate,
       float speed, int32_t num_steps,
       GeneratedAudioCallback callback = nullptr) const override {
-    std::vector<TokenIDs> text_token_ids =
-        frontend_->ConvertTextToTokenIds(text);
+    auto prompt = ProcessPrompt(prompt_text, prompt_samples, sample_rate);
+    if (!prompt) {
+      return {};
+    }
 
-    std::vector<TokenIDs> prompt_token_ids =
-        frontend_->ConvertTextToTokenIds(prompt_text);
+    return Generate(text, *prompt, speed, num_steps, std::move(callback));
+  }
 
-    if (text_token_ids.empty() ||
-        (text_token_ids.size() == 1 && text_token_ids[0].tokens.empty())) {
-#if __OHOS__
-      SHERPA_ONNX_LOGE("Failed to convert '%{public}s' to token IDs",
-                       text.c_str());
-#else
-      SHERPA_ONNX_LOGE("Failed to convert '%s' to token IDs", text.c_str());
-#endif
-      return {};
+  bool RegisterPrompt(const std::string &name, const std::string &prompt_text,
+                      const std::vector<float> &prompt_samples,
+                      int32_t sample_rate) const override {
+    auto prompt = ProcessPrompt(prompt_text, prompt_samples, sample_rate);
+    if (!prompt) {
+      return false;
     }
 
-    if (prompt_token_ids.empty() ||
-        (prompt_token_ids.size() == 1 && prompt_token_ids[0].tokens.empty())) {
+    const auto &prompt_dir = config_.model.zipvoice.prompt_dir;
+    if (!prompt_dir.empty()) {
+      std::string filename;
+      if (!PromptFilename(name, &filename) || !prompt->Save(filename)) {
+        return false;
+      }
+    }
+
+    prompts_.Put(name, std::move(prompt));
+
+    return true;
+  }
+
+  GeneratedAudio GenerateWithPrompt(
+      const std::string &text, const std::string &name, float speed,
+      int32_t num_steps,
+      GeneratedAudioCallback callback = nullptr) const override {
+    auto prompt = GetPrompt(name);
+    if (!prompt) {
 #if __OHOS__
-      SHERPA_ONNX_LOGE(
-          "Failed to convert prompt text '%{public}s' to token IDs",
-          prompt_text.c_str());
+      SHERPA_ONNX_LOGE("Prompt '%{public}s' is not registered", name.c_str());
 #else
-      SHERPA_ONNX_LOGE("Failed to convert prompt text '%s' to token IDs",
-                       prompt_text.c_str());
+      SHERPA_ONNX_LOGE("Prompt '%s' is not registered", name.c_str());
 #endif
       return {};
     }
 
-    // we assume batch size is 1
-    std::vector<int64_t> tokens = text_token_ids[0].tokens;
-    std::vector<int64_t> prompt_tokens = prompt_token_ids[0].tokens;
-
-    return Process(tokens, prompt_tokens, prompt_samples, sample_rate, speed,
-                   num_steps);
+    return Generate(text, *prompt, speed, num_steps, std::move(callback));
   }
 
  private:
@@ -209,26 +222,29 @@ class OfflineTtsZipvoiceImpl : public OfflineTtsImpl {
     }
   }
 
-  GeneratedAudio Process(const std::vector<int64_t> &tokens,
-                         const std::vector<int64_t> &prompt_tokens,
-                         const std::vector<float> &prompt_samples,
-                         int32_t sample_rate, float speed,
-                         int num_steps) const {
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+  std::shared_ptr<const OfflineTtsZipvoicePrompt> ProcessPrompt(
+      const std::string &prompt_text, const std::vector<float> &prompt_samples,
+      int32_t sample_rate) const {
+    std::vector<TokenIDs> prompt_token_ids =
+        frontend_->ConvertTextToTokenIds(prompt_text);
 
-    std::array<int64_t, 2> tokens_shape = {1,
-                                           static_cast<int64_t>(tokens.size())};
-    Ort::Value tokens_tensor = Ort::Value::CreateTensor(
-        memory_info, const_cast<int64_t *>(tokens.data()), tokens.size(),
-        tokens_shape.data(), tokens_shape.size());
+    if (prompt_token_ids.empty() ||
+        (prompt_token_ids.size() == 1 && prompt_token_ids[0].tokens.empty())) {
+#if __OHOS__
+      SHERPA_ONNX_LOGE(
+          "Failed to convert prompt text '%{public}s' to token IDs",
+          prompt_text.c_str());
+#else
+      SHERPA_ONNX_LOGE("Failed to convert prompt text '%s' to token IDs",
+                       prompt_text.c_str());
+#endif
+      return nullptr;
+    }
 
-    std::array<int64_t, 2> prompt_tokens_shape = {
-        1, static_cast<int64_t>(prompt_tokens.size())};
-    Ort::Value prompt_tokens_tensor = Ort::Value::CreateTensor(
-        memory_info, const_cast<int64_t *>(prompt_tokens.data()),
-        prompt_tokens.size(), prompt_tokens_shape.data(),
-        prompt_tokens_shape.size());
+    auto prompt = std::make_shared<OfflineTtsZipvoicePrompt>();
+
+    // we assume batch size is 1
+    prompt->tokens = std::move(prompt_token_ids[0].tokens);
 
     float target_rms = config_.model.zipvoice.target_rms;
     float feat_scale = config_.model.zipvoice.feat_scale;
@@ -248,24 +264,118 @@ class OfflineTtsZipvoiceImpl : public OfflineTtsImpl {
         s *= scale;
       }
     }
+    prompt->rms = prompt_rms;
 
-    std::vector<float> prompt_features;
     auto res_shape = ComputeMelSpectrogram(prompt_samples_scaled, sample_rate,
-                                           &prompt_features);
+                                           &prompt->features);
 
-    int32_t num_frames = res_shape[0];
-    int32_t mel_dim = res_shape[1];
+    prompt->num_frames = res_shape[0];
+    prompt->feat_dim = res_shape[1];
 
     if (feat_scale != 1.0f) {
-      for (auto &item : prompt_features) {
+      for (auto &item : prompt->features) {
         item *= feat_scale;
       }
     }
 
-    std::array<int64_t, 3> shape = {1, num_frames, mel_dim};
+    return prompt;
+  }
+
+  // Return false if name cannot be used as a filename inside prompt_dir
+  bool PromptFilename(const std::string &name, std::string *filename) const {
+    if (name.empty() || name.find('/') != std::string::npos ||
+        name.find('\\') != std::string::npos ||
+        name.find("..") != std::string::npos) {
+#if __OHOS__
+      SHERPA_ONNX_LOGE("Invalid prompt name: '%{public}s'", name.c_str());
+#else
+      SHERPA_ONNX_LOGE("Invalid prompt name: '%s'", name.c_str());
+#endif
+      return false;
+    }
+
+    *filename = config_.model.zipvoice.prompt_dir + "/" + name + ".prompt";
+    return true;
+  }
+
+  std::shared_ptr<const OfflineTtsZipvoicePrompt> GetPrompt(
+      const std::string &name) const {
+    std::shared_ptr<const OfflineTtsZipvoicePrompt> prompt;
+    if (prompts_.Get(name, &prompt)) {
+      return prompt;
+    }
+
+    if (config_.model.zipvoice.prompt_dir.empty()) {
+      return nullptr;
+    }
+
+    std::string filename;
+    if (!PromptFilename(name, &filename) || !FileExists(filename)) {
+      return nullptr;
+    }
+
+    auto loaded = std::make_shared<OfflineTtsZipvoicePrompt>();
+    if (!loaded->Load(filename)) {
+      return nullptr;
+    }
+
+    prompts_.Put(name, loaded);
+
+    return loaded;
+  }
+
+  GeneratedAudio Generate(const std::string &text,
+                          const OfflineTtsZipvoicePrompt &prompt, float speed,
+                          int32_t num_steps,
+                          GeneratedAudioCallback callback) const {
+    std::vector<TokenIDs> text_token_ids =
+        frontend_->ConvertTextToTokenIds(text);
+
+    if (text_token_ids.empty() ||
+        (text_token_ids.size() == 1 && text_token_ids[0].tokens.empty())) {
+#if __OHOS__
+      SHERPA_ONNX_LOGE("Failed to convert '%{public}s' to token IDs",
+                       text.c_str());
+#else
+      SHERPA_ONNX_LOGE("Failed to convert '%s' to token IDs", text.c_str());
+#endif
+      return {};
+    }
+
+    // we assume batch size is 1
+    return Process(text_token_ids[0].tokens, prompt, speed, num_steps,
+                   std::move(callback));
+  }
+
+  GeneratedAudio Process(const std::vector<int64_t> &tokens,
+                         const OfflineTtsZipvoicePrompt &prompt, float speed,
+                         int num_steps,
+                         GeneratedAudioCallback callback = nullptr) const {
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::array<int64_t, 2> tokens_shape = {1,
+                                           static_cast<int64_t>(tokens.size())};
+    Ort::Value tokens_tensor = Ort::Value::CreateTensor(
+        memory_info, const_cast<int64_t *>(tokens.data()), tokens.size(),
+        tokens_shape.data(), tokens_shape.size());
+
+    const auto &prompt_tokens = prompt.tokens;
+    std::array<int64_t, 2> prompt_tokens_shape = {
+        1, static_cast<int64_t>(prompt_tokens.size())};
+    Ort::Value prompt_tokens_tensor = Ort::Value::CreateTensor(
+        memory_info, const_cast<int64_t *>(prompt_tokens.data()),
+        prompt_tokens.size(), prompt_tokens_shape.data(),
+        prompt_tokens_shape.size());
+
+    float target_rms = config_.model.zipvoice.target_rms;
+    float feat_scale = config_.model.zipvoice.feat_scale;
+    float prompt_rms = prompt.rms;
+
+    std::array<int64_t, 3> shape = {1, prompt.num_frames, prompt.feat_dim};
     auto prompt_features_tensor = Ort::Value::CreateTensor(
-        memory_info, prompt_features.data(), prompt_features.size(),
-        shape.data(), shape.size());
+        memory_info, const_cast<float *>(prompt.features.data()),
+        prompt.features.size(), shape.data(), shape.size());
 
     Ort::Value mel =
         model_->Run(std::move(tokens_tensor), std::move(prompt_tokens_tensor),
@@ -291,12 +401,31 @@ class OfflineTtsZipvoiceImpl : public OfflineTtsImpl {
         memory_info, mel_permuted.data(), mel_permuted.size(), new_shape.data(),
         new_shape.size());
 
+    float scale = 1.0f;
+    if (prompt_rms < target_rms && target_rms > 0.0f) {
+      scale = prompt_rms / target_rms;
+    }
+
+    // The callback is used only for chunked vocoding. Without chunks,
+    // zipvoice does not call it, as before.
+    Vocoder::ChunkCallback chunk_callback;
+    if (config_.vocoder_chunk_size > 0 && callback) {
+      chunk_callback = [&callback, scale](const float *samples, int32_t n,
+                                          float progress) {
+        std::vector<float> chunk(samples, samples + n);
+        for (auto &s : chunk) {
+          s *= scale;
+        }
+        return callback(chunk.data(), n, progress) != 0;
+      };
+    }
+
     GeneratedAudio ans;
-    ans.samples = vocoder_->Run(std::move(mel_new));
+    ans.samples = vocoder_->RunChunked(
+        std::move(mel_new), config_.vocoder_chunk_size, chunk_callback);
     ans.sample_rate = model_->GetMetaData().sample_rate;
 
-    if (prompt_rms < target_rms && target_rms > 0.0f) {
-      float scale = prompt_rms / target_rms;
+    if (scale != 1.0f) {
       for (auto &s : ans.samples) {
         s *= scale;
       }
@@ -309,6 +438,10 @@ class OfflineTtsZipvoiceImpl : public OfflineTtsImpl {
   std::unique_ptr<OfflineTtsZipvoiceModel> model_;
   std::unique_ptr<Vocoder> vocoder_;
   std::unique_ptr<OfflineTtsFrontend> frontend_;
+
+  // Prompts registered with RegisterPrompt(), indexed by name. It uses a
+  // single shard so that exactly max_num_prompts prompts are kept.
+  mutable LruCache<std::shared_ptr<const OfflineTtsZipvoicePrompt>> prompts_;
 };
 
 }  // namespace sherpa_onnx
@@ -35,6 +35,14 @@ void OfflineTtsZipvoiceModelConfig::Register(ParseOptions *po) {
       "zipvoice-guidance-scale", &guidance_scale,
       "The scale of classifier-free guidance during inference for ZipVoice "
       "(default: 1.0)");
+  po->Register("zipvoice-solver", &solver,
+               "ODE solver for flow matching. Valid values: euler, midpoint. "
+               "midpoint runs the model twice per step.");
+  po->Register("zipvoice-max-num-prompts", &max_num_prompts,
+               "Maximum number of registered prompts kept in memory");
+  po->Register("zipvoice-prompt-dir", &prompt_dir,
+               "If not empty, registered prompts are also saved to and "
+               "loaded from this directory");
 }
 
 bool OfflineTtsZipvoiceModelConfig::Validate() const {
@@ -125,6 +133,13 @@ bool OfflineTtsZipvoiceModelConfig::Validate() const {
     return false;
   }
 
+  if (solver != "euler" && solver != "midpoint") {
+    SHERPA_ONNX_LOGE(
+        "--zipvoice-solver must be euler or midpoint. Given: '%s'",
+        solver.c_str());
+    return false;
+  }
+
   return true;
 }
 
@@ -141,7 +156,10 @@ std::string OfflineTtsZipvoiceModelConfig::ToString() const {
   os << "feat_scale=" << feat_scale << ", ";
   os << "t_shift=" << t_shift << ", ";
   os << "target_rms=" << target_rms << ", ";
-  os << "guidance_scale=" << guidance_scale << ")";
+  os << "guidance_scale=" << guidance_scale << ", ";
+  os << "solver=\"" << solver << "\", ";
+  os << "max_num_prompts=" << max_num_prompts << ", ";
+  os << "prompt_dir=\"" << prompt_dir << "\")";
 
   return os.str();
 }
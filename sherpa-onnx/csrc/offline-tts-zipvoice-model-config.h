@@ -30,6 +30,21 @@ struct OfflineTtsZipvoiceModelConfig {
   float target_rms = 0.1;
   float guidance_scale = 1.0;
 
+  // ODE solver for flow matching. Valid values: euler, midpoint.
+  // midpoint runs the model twice per step and usually needs fewer steps
+  // than euler for the same quality.
+  std::string solver = "euler";
+
+  // Maximum number of prompts registered with RegisterPrompt() that are
+  // kept in memory. The least recently used one is dropped when it is
+  // exceeded.
+  int32_t max_num_prompts = 100;
+
+  // If not empty, RegisterPrompt() also saves the processed prompt to
+  // this directory and prompts not found in memory are loaded from it,
+  // so registered prompts survive restarts and eviction.
+  std::string prompt_dir;
+
   OfflineTtsZipvoiceModelConfig() = default;
 
   OfflineTtsZipvoiceModelConfig(
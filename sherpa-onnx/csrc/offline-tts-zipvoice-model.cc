@@ -24,6 +24,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -33,18 +34,18 @@ class OfflineTtsZipvoiceModel::Impl {
  public:
   explicit Impl(const OfflineTtsModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
-    auto text_buf = ReadFile(config.zipvoice.text_model);
-    auto fm_buf = ReadFile(config.zipvoice.flow_matching_model);
+    auto text_buf = MapFile(config.zipvoice.text_model);
+    auto fm_buf = MapFile(config.zipvoice.flow_matching_model);
     Init(text_buf.data(), text_buf.size(), fm_buf.data(), fm_buf.size());
   }
 
   template <typename Manager>
   Impl(Manager *mgr, const OfflineTtsModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     auto text_buf = ReadFile(mgr, config.zipvoice.text_model);
@@ -102,19 +103,21 @@ class OfflineTtsZipvoiceModel::Impl {
     int64_t num_frames = text_cond_shape[1];
 
     int64_t feat_dim = meta_data_.feat_dim;
+    int64_t n = batch_size * num_frames * feat_dim;
 
-    std::vector<float> x_data(batch_size * num_frames * feat_dim);
-    std::random_device rd;
-    std::default_random_engine rng(rd());
+    // The engine is seeded once per thread. Seeding it with
+    // std::random_device in every call is slow on some platforms.
+    static thread_local std::default_random_engine rng(std::random_device{}());
     std::normal_distribution<float> norm(0, 1);
+
+    std::vector<float> x_data(n);
     for (auto &v : x_data) v = norm(rng);
     std::vector<int64_t> x_shape = {batch_size, num_frames, feat_dim};
     Ort::Value x = Ort::Value::CreateTensor<float>(
         memory_info, x_data.data(), x_data.size(), x_shape.data(),
         x_shape.size());
 
-    std::vector<float> speech_cond_data(batch_size * num_frames * feat_dim,
-                                        0.0f);
+    std::vector<float> speech_cond_data(n, 0.0f);
     const float *src = prompt_features.GetTensorData<float>();
     float *dst = speech_cond_data.data();
     std::memcpy(dst, src,
@@ -126,6 +129,7 @@ class OfflineTtsZipvoiceModel::Impl {
 
     float t_shift = config_.zipvoice.t_shift;
     float guidance_scale = config_.zipvoice.guidance_scale;
+    bool use_midpoint = config_.zipvoice.solver == "midpoint";
 
     std::vector<float> timesteps(num_steps + 1);
     for (int32_t i = 0; i <= num_steps; ++i) {
@@ -137,39 +141,75 @@ class OfflineTtsZipvoiceModel::Impl {
     Ort::Value guidance_scale_tensor = Ort::Value::CreateTensor<float>(
         memory_info, &guidance_scale, 1, &guidance_scale_shape, 1);
 
+    // All buffers used in the loop below are allocated once here.
+    // The model writes its output to v in every call and t_tensor is
+    // updated by changing t_val.
+    float t_val = 0;
+    int64_t t_shape = 1;
+    Ort::Value t_tensor =
+        Ort::Value::CreateTensor<float>(memory_info, &t_val, 1, &t_shape, 1);
+
+    std::vector<float> v_data(n);
+    Ort::Value v = Ort::Value::CreateTensor<float>(
+        memory_info, v_data.data(), v_data.size(), x_shape.data(),
+        x_shape.size());
+
+    // Input x of the second model call of a midpoint step
+    std::vector<float> x_mid_data(use_midpoint ? n : 0);
+    Ort::Value x_mid{nullptr};
+    if (use_midpoint) {
+      x_mid = Ort::Value::CreateTensor<float>(
+          memory_info, x_mid_data.data(), x_mid_data.size(), x_shape.data(),
+          x_shape.size());
+    }
+
     std::vector<Ort::Value> fm_inputs;
     fm_inputs.reserve(5);
-    // fm_inputs[0] is t tensor, will set in for loop
-    fm_inputs.emplace_back(nullptr);
+    fm_inputs.push_back(std::move(t_tensor));
     fm_inputs.push_back(std::move(x));
     fm_inputs.push_back(std::move(text_condition));
     fm_inputs.push_back(std::move(speech_condition));
     fm_inputs.push_back(std::move(guidance_scale_tensor));
 
-    for (int32_t step = 0; step < num_steps; ++step) {
-      float t_val = timesteps[step];
-      int64_t t_shape = 1;
-      Ort::Value t_tensor =
-          Ort::Value::CreateTensor<float>(memory_info, &t_val, 1, &t_shape, 1);
-      fm_inputs[0] = std::move(t_tensor);
-      auto fm_out = fm_sess_->Run(
-          {}, fm_input_names_ptr_.data(), fm_inputs.data(), fm_inputs.size(),
-          fm_output_names_ptr_.data(), fm_output_names_ptr_.size());
-      Ort::Value &v = fm_out[0];
+    // Only the first output, i.e., the velocity, is used
+    auto run_fm = [&]() {
+      fm_sess_->Run({}, fm_input_names_ptr_.data(), fm_inputs.data(),
+                    fm_inputs.size(), fm_output_names_ptr_.data(), &v, 1);
+    };
 
+    float *x_ptr = x_data.data();
+    const float *v_ptr = v_data.data();
+
+    for (int32_t step = 0; step < num_steps; ++step) {
       float delta_t = timesteps[step + 1] - timesteps[step];
-      float *x_ptr = fm_inputs[1].GetTensorMutableData<float>();
-      const float *v_ptr = v.GetTensorData<float>();
-      int64_t N = batch_size * num_frames * feat_dim;
-      for (int64_t i = 0; i < N; ++i) {
+
+      t_val = timesteps[step];
+      run_fm();
+
+      if (!use_midpoint) {
+        for (int64_t i = 0; i < n; ++i) {
+          x_ptr[i] += v_ptr[i] * delta_t;
+        }
+        continue;
+      }
+
+      float half_dt = 0.5f * delta_t;
+      for (int64_t i = 0; i < n; ++i) {
+        x_mid_data[i] = x_ptr[i] + v_ptr[i] * half_dt;
+      }
+
+      t_val = timesteps[step] + half_dt;
+      std::swap(fm_inputs[1], x_mid);
+      run_fm();
+      std::swap(fm_inputs[1], x_mid);
+
+      for (int64_t i = 0; i < n; ++i) {
         x_ptr[i] += v_ptr[i] * delta_t;
       }
     }
 
     int64_t keep_frames = num_frames - prompt_feat_len;
     std::vector<float> out_data(batch_size * keep_frames * feat_dim);
-    x = std::move(fm_inputs[1]);
-    const float *x_ptr = x.GetTensorData<float>();
     for (int64_t b = 0; b < batch_size; ++b) {
       std::memcpy(out_data.data() + b * keep_frames * feat_dim,
                   x_ptr + (b * num_frames + prompt_feat_len) * feat_dim,
@@ -182,18 +222,18 @@ class OfflineTtsZipvoiceModel::Impl {
   }
 
  private:
-  void Init(void *text_model_data, size_t text_model_data_length,
-            void *fm_model_data, size_t fm_model_data_length) {
+  void Init(const void *text_model_data, size_t text_model_data_length,
+            const void *fm_model_data, size_t fm_model_data_length) {
     // Init text-encoder model
-    text_sess_ = std::make_unique<Ort::Session>(
-        env_, text_model_data, text_model_data_length, sess_opts_);
+    text_sess_ = CreateSession(env_, text_model_data, text_model_data_length,
+                               sess_opts_);
     GetInputNames(text_sess_.get(), &text_input_names_, &text_input_names_ptr_);
     GetOutputNames(text_sess_.get(), &text_output_names_,
                    &text_output_names_ptr_);
 
     // Init flow-matching model
-    fm_sess_ = std::make_unique<Ort::Session>(env_, fm_model_data,
-                                              fm_model_data_length, sess_opts_);
+    fm_sess_ = CreateSession(env_, fm_model_data, fm_model_data_length,
+                             sess_opts_);
     GetInputNames(fm_sess_.get(), &fm_input_names_, &fm_input_names_ptr_);
     GetOutputNames(fm_sess_.get(), &fm_output_names_, &fm_output_names_ptr_);
 
@@ -265,7 +305,7 @@ class OfflineTtsZipvoiceModel::Impl {
 
  private:
   OfflineTtsModelConfig config_;
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
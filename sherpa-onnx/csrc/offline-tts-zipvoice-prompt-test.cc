@@ -0,0 +1,52 @@
+// sherpa-onnx/csrc/offline-tts-zipvoice-prompt-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-tts-zipvoice-prompt.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(OfflineTtsZipvoicePrompt, SaveAndLoad) {
+  OfflineTtsZipvoicePrompt prompt;
+  prompt.tokens = {3, 1, 4, 1, 5};
+  prompt.num_frames = 3;
+  prompt.feat_dim = 2;
+  prompt.features = {0.1f, -0.2f, 0.3f, -0.4f, 0.5f, -0.6f};
+  prompt.rms = 0.05f;
+
+  std::string filename = "zipvoice-prompt-test.prompt";
+  ASSERT_TRUE(prompt.Save(filename));
+
+  OfflineTtsZipvoicePrompt loaded;
+  ASSERT_TRUE(loaded.Load(filename));
+
+  EXPECT_EQ(loaded.tokens, prompt.tokens);
+  EXPECT_EQ(loaded.features, prompt.features);
+  EXPECT_EQ(loaded.num_frames, prompt.num_frames);
+  EXPECT_EQ(loaded.feat_dim, prompt.feat_dim);
+  EXPECT_EQ(loaded.rms, prompt.rms);
+
+  std::remove(filename.c_str());
+}
+
+TEST(OfflineTtsZipvoicePrompt, LoadInvalid) {
+  std::string filename = "zipvoice-prompt-test-invalid.prompt";
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os << "not a prompt file";
+  }
+
+  OfflineTtsZipvoicePrompt prompt;
+  EXPECT_FALSE(prompt.Load(filename));
+  EXPECT_FALSE(prompt.Load("non-existent.prompt"));
+
+  std::remove(filename.c_str());
+}
+
+}  // namespace sherpa_onnx
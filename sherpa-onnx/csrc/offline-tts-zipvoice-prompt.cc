@@ -0,0 +1,155 @@
+// sherpa-onnx/csrc/offline-tts-zipvoice-prompt.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-tts-zipvoice-prompt.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'O', 'Z', 'V', 'P', 'R', 'M', 'T'};
+constexpr int32_t kVersion = 1;
+
+// The serialized prompt is
+//  Header
+//  int64_t tokens[num_tokens]
+//  float features[num_frames * feat_dim]
+struct Header {
+  char magic[8];
+  int32_t version;
+  int32_t num_tokens;
+  int32_t num_frames;
+  int32_t feat_dim;
+  float rms;
+  int32_t padding;
+};
+
+}  // namespace
+
+bool OfflineTtsZipvoicePrompt::Save(const std::string &filename) const {
+  if (features.size() != static_cast<size_t>(num_frames) * feat_dim) {
+    SHERPA_ONNX_LOGE("Invalid prompt. num_frames: %d, feat_dim: %d, size: %d",
+                     num_frames, feat_dim,
+                     static_cast<int32_t>(features.size()));
+    return false;
+  }
+
+  // Write to a temporary file and rename it, so that a concurrent Load()
+  // never sees a partially written file
+#if defined(_WIN32)
+  int32_t pid = _getpid();
+#else
+  int32_t pid = getpid();
+#endif
+
+  std::ostringstream tmp_os;
+  tmp_os << filename << ".tmp" << pid << "-"
+         << std::hash<std::thread::id>{}(std::this_thread::get_id());
+  std::string tmp = tmp_os.str();
+
+  std::ofstream os(tmp, std::ios::binary);
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to open '%s' for writing", tmp.c_str());
+    return false;
+  }
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.num_tokens = static_cast<int32_t>(tokens.size());
+  header.num_frames = num_frames;
+  header.feat_dim = feat_dim;
+  header.rms = rms;
+
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  os.write(reinterpret_cast<const char *>(tokens.data()),
+           tokens.size() * sizeof(int64_t));
+  os.write(reinterpret_cast<const char *>(features.data()),
+           features.size() * sizeof(float));
+  os.close();
+
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to write '%s'", tmp.c_str());
+    std::remove(tmp.c_str());
+    return false;
+  }
+
+#if defined(_WIN32)
+  // rename() does not replace an existing file on Windows
+  std::remove(filename.c_str());
+#endif
+
+  if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+    SHERPA_ONNX_LOGE("Failed to rename '%s' to '%s'", tmp.c_str(),
+                     filename.c_str());
+    std::remove(tmp.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool OfflineTtsZipvoicePrompt::Load(const std::string &filename) {
+  std::ifstream is(filename, std::ios::binary);
+  if (!is) {
+    SHERPA_ONNX_LOGE("Failed to open '%s'", filename.c_str());
+    return false;
+  }
+
+  Header header;
+  is.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!is || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    SHERPA_ONNX_LOGE("'%s' is not a ZipVoice prompt file", filename.c_str());
+    return false;
+  }
+
+  if (header.version != kVersion) {
+    SHERPA_ONNX_LOGE("Unsupported version %d in '%s'. Expected: %d",
+                     header.version, filename.c_str(), kVersion);
+    return false;
+  }
+
+  if (header.num_tokens < 0 || header.num_frames < 0 || header.feat_dim < 0) {
+    SHERPA_ONNX_LOGE("Corrupted prompt file '%s'", filename.c_str());
+    return false;
+  }
+
+  tokens.resize(header.num_tokens);
+  features.resize(static_cast<size_t>(header.num_frames) * header.feat_dim);
+
+  is.read(reinterpret_cast<char *>(tokens.data()),
+          tokens.size() * sizeof(int64_t));
+  is.read(reinterpret_cast<char *>(features.data()),
+          features.size() * sizeof(float));
+
+  if (!is) {
+    SHERPA_ONNX_LOGE("Truncated prompt file '%s'", filename.c_str());
+    return false;
+  }
+
+  num_frames = header.num_frames;
+  feat_dim = header.feat_dim;
+  rms = header.rms;
+
+  return true;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,40 @@
+// sherpa-onnx/csrc/offline-tts-zipvoice-prompt.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_OFFLINE_TTS_ZIPVOICE_PROMPT_H_
+#define SHERPA_ONNX_CSRC_OFFLINE_TTS_ZIPVOICE_PROMPT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+// The result of processing a speaker prompt for ZipVoice, i.e., everything
+// that Generate() would otherwise compute from prompt_text and
+// prompt_samples on every call.
+struct OfflineTtsZipvoicePrompt {
+  // Token IDs of the prompt text
+  std::vector<int64_t> tokens;
+
+  // Mel features of the prompt audio, already multiplied by feat_scale.
+  // Of shape (num_frames, feat_dim)
+  std::vector<float> features;
+  int32_t num_frames = 0;
+  int32_t feat_dim = 0;
+
+  // RMS of the prompt audio before normalization. It is used to scale
+  // the generated audio.
+  float rms = 0;
+
+  // Return true on success. Return false and print an error otherwise.
+  bool Save(const std::string &filename) const;
+
+  // Return true on success. Return false and print an error otherwise.
+  bool Load(const std::string &filename);
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_OFFLINE_TTS_ZIPVOICE_PROMPT_H_
@@ -116,6 +116,13 @@ void OfflineTtsConfig::Register(ParseOptions *po) {
   po->Register("tts-silence-scale", &silence_scale,
                "Duration of the pause is scaled by this number. So a smaller "
                "value leads to a shorter pause.");
+
+  po->Register("tts-vocoder-chunk-size", &vocoder_chunk_size,
+               "If positive, the vocoder processes at most this number of "
+               "mel frames at a time and samples are passed to the callback "
+               "as soon as each chunk is ready. Used only for models with a "
+               "separate vocoder, e.g., matcha and zipvoice. 0 to vocode the "
+               "whole mel at once.");
 }
 
 bool OfflineTtsConfig::Validate() const {
@@ -146,6 +153,13 @@ bool OfflineTtsConfig::Validate() const {
     return false;
   }
 
+  if (vocoder_chunk_size < 0) {
+    SHERPA_ONNX_LOGE(
+        "--tts-vocoder-chunk-size should be non-negative. Given: %d",
+        vocoder_chunk_size);
+    return false;
+  }
+
   return model.Validate();
 }
 
@@ -157,7 +171,8 @@ std::string OfflineTtsConfig::ToString() const {
   os << "rule_fsts=\"" << rule_fsts << "\", ";
   os << "rule_fars=\"" << rule_fars << "\", ";
   os << "max_num_sentences=" << max_num_sentences << ", ";
-  os << "silence_scale=" << silence_scale << ")";
+  os << "silence_scale=" << silence_scale << ", ";
+  os << "vocoder_chunk_size=" << vocoder_chunk_size << ")";
 
   return os.str();
 }
@@ -237,6 +252,45 @@ GeneratedAudio OfflineTts::Generate(
 #endif
 }
 
+bool OfflineTts::RegisterPrompt(const std::string &name,
+                                const std::string &prompt_text,
+                                const std::vector<float> &prompt_samples,
+                                int32_t sample_rate) const {
+#if !defined(_WIN32)
+  return impl_->RegisterPrompt(name, prompt_text, prompt_samples, sample_rate);
+#else
+  if (IsGB2312(prompt_text)) {
+    SHERPA_ONNX_LOGE(
+        "Detected GB2312 encoded prompt text! Converting it to UTF8.");
+    return impl_->RegisterPrompt(name, Gb2312ToUtf8(prompt_text),
+                                 prompt_samples, sample_rate);
+  }
+  return impl_->RegisterPrompt(name, prompt_text, prompt_samples, sample_rate);
+#endif
+}
+
+GeneratedAudio OfflineTts::GenerateWithPrompt(
+    const std::string &text, const std::string &name, float speed /*=1.0*/,
+    int32_t num_steps /*=4*/,
+    GeneratedAudioCallback callback /*=nullptr*/) const {
+#if !defined(_WIN32)
+  return impl_->GenerateWithPrompt(text, name, speed, num_steps,
+                                   std::move(callback));
+#else
+  static bool printed = false;
+  auto utf8_text = text;
+  if (IsGB2312(text)) {
+    utf8_text = Gb2312ToUtf8(text);
+    if (!printed) {
+      SHERPA_ONNX_LOGE("Detected GB2312 encoded text! Converting it to UTF8.");
+      printed = true;
+    }
+  }
+  return impl_->GenerateWithPrompt(utf8_text, name, speed, num_steps,
+                                   std::move(callback));
+#endif
+}
+
 int32_t OfflineTts::SampleRate() const { return impl_->SampleRate(); }
 
 int32_t OfflineTts::NumSpeakers() const { return impl_->NumSpeakers(); }
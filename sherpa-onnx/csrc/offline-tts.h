@@ -37,6 +37,14 @@ struct OfflineTtsConfig {
   // the duration of the new interval is old_duration * silence_scale.
   float silence_scale = 0.2;
 
+  // For models with a separate vocoder, e.g., matcha and zipvoice.
+  // If positive, the vocoder processes at most this number of mel frames
+  // at a time, which reduces the peak memory for long texts. If a callback
+  // is given, samples are passed to it as soon as each chunk is vocoded.
+  // A smaller value gives the first samples earlier at the cost of a
+  // lower throughput. If it is 0, the whole mel is vocoded at once.
+  int32_t vocoder_chunk_size = 0;
+
   // Packed data from memory (set at runtime, not from command line)
   const void *pack_data = nullptr;
   int32_t pack_data_size = 0;
@@ -122,6 +130,28 @@ class OfflineTts {
                           int32_t num_steps = 4,
                           GeneratedAudioCallback callback = nullptr) const;
 
+  // Process a prompt once and keep the result under the given name, so
+  // that GenerateWithPrompt() can reuse it without computing the prompt
+  // features and tokens again. Registering an existing name replaces it.
+  // Only zero-shot models, e.g., ZipVoice, support it.
+  //
+  // @param name The name used to refer to this prompt. If
+  //             config.model.zipvoice.prompt_dir is not empty, it is also
+  //             used as the filename, so it must be a valid filename.
+  // @param prompt_text The transcribe of `prompt_samples`.
+  // @param prompt_samples The prompt audio samples (mono PCM floats in [-1,1]).
+  // @param sample_rate The sample rate of `prompt_samples` in Hz.
+  // @return Return true on success.
+  bool RegisterPrompt(const std::string &name, const std::string &prompt_text,
+                      const std::vector<float> &prompt_samples,
+                      int32_t sample_rate) const;
+
+  // Like the zero-shot Generate() above, but use a prompt registered with
+  // RegisterPrompt(). It returns an empty audio if `name` is not found.
+  GeneratedAudio GenerateWithPrompt(
+      const std::string &text, const std::string &name, float speed = 1.0,
+      int32_t num_steps = 4, GeneratedAudioCallback callback = nullptr) const;
+
   // Return the sample rate of the generated audio
   int32_t SampleRate() const;
 
@@ -5,6 +5,10 @@
 #include "sherpa-onnx/csrc/offline-websocket-server-impl.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
 
@@ -47,8 +51,37 @@ OfflineWebsocketDecoder::OfflineWebsocketDecoder(OfflineWebsocketServer *server)
       recognizer_(config_.recognizer_config) {}
 
 void OfflineWebsocketDecoder::Push(connection_hdl hdl, ConnectionDataPtr d) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  streams_.push_back({hdl, d});
+  auto received_time = Clock::now();
+  asio::post(server_->GetWorkContext(),
+             [this, hdl, d = std::move(d), received_time]() mutable {
+               ComputeFeatures(hdl, std::move(d), received_time);
+             });
+}
+
+void OfflineWebsocketDecoder::ComputeFeatures(connection_hdl hdl,
+                                              ConnectionDataPtr d,
+                                              Clock::time_point received_time) {
+  // Features are computed without holding mutex_, so that utterances
+  // are processed in parallel by all work threads
+  auto sample_rate = d->sample_rate;
+  auto samples = reinterpret_cast<const float *>(&d->data[0]);
+  auto num_samples = d->expected_byte_size / sizeof(float);
+  auto s = recognizer_.CreateStream();
+  s->AcceptWaveform(sample_rate, samples, num_samples);
+
+  // OfflineStream computes features lazily. Compute them here, so that
+  // they are not computed while decoding a batch.
+  s->NumFrames();
+
+  // The samples are not needed any longer
+  d.reset();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    streams_.push_back({hdl, std::move(s), received_time, Clock::now()});
+  }
+
+  Decode();
 }
 
 void OfflineWebsocketDecoder::Decode() {
@@ -59,48 +92,47 @@ void OfflineWebsocketDecoder::Decode() {
 
   int32_t size =
       std::min(static_cast<int32_t>(streams_.size()), config_.max_batch_size);
-  SHERPA_ONNX_LOGE("size: %d", size);
 
   // We first lock the mutex for streams_, take items from it, and then
   // unlock the mutex; in doing so we don't need to lock the mutex to
-  // access hdl and connection_data later.
-  std::vector<connection_hdl> handles(size);
-
-  // Store connection_data here to prevent the data from being freed
-  // while we are still using it.
-  std::vector<ConnectionDataPtr> connection_data(size);
-
-  std::vector<const float *> samples(size);
-  std::vector<int32_t> samples_length(size);
-  std::vector<std::unique_ptr<OfflineStream>> ss(size);
+  // access the streams later.
+  std::vector<ReadyStream> ss(size);
   std::vector<OfflineStream *> p_ss(size);
 
   for (int32_t i = 0; i != size; ++i) {
-    auto &p = streams_.front();
-    handles[i] = p.first;
-    connection_data[i] = p.second;
+    ss[i] = std::move(streams_.front());
     streams_.pop_front();
 
-    auto sample_rate = connection_data[i]->sample_rate;
-    auto samples =
-        reinterpret_cast<const float *>(&connection_data[i]->data[0]);
-    auto num_samples = connection_data[i]->expected_byte_size / sizeof(float);
-    auto s = recognizer_.CreateStream();
-    s->AcceptWaveform(sample_rate, samples, num_samples);
-
-    ss[i] = std::move(s);
-    p_ss[i] = ss[i].get();
+    p_ss[i] = ss[i].stream.get();
   }
 
   lock.unlock();
 
+  auto start = Clock::now();
+
   // Note: DecodeStreams is thread-safe
   recognizer_.DecodeStreams(p_ss.data(), size);
 
+  auto end = Clock::now();
+
+  // Report the latency of each stage for this batch
+  float feature_seconds = 0;
+  float wait_seconds = 0;
+  for (const auto &s : ss) {
+    feature_seconds +=
+        std::chrono::duration<float>(s.ready_time - s.received_time).count();
+    wait_seconds += std::chrono::duration<float>(start - s.ready_time).count();
+  }
+  float decode_seconds = std::chrono::duration<float>(end - start).count();
+
+  SHERPA_ONNX_LOGE(
+      "size: %d, feature extraction: %.3f s, wait: %.3f s, decoding: %.3f s",
+      size, feature_seconds / size, wait_seconds / size, decode_seconds);
+
   for (int32_t i = 0; i != size; ++i) {
-    connection_hdl hdl = handles[i];
+    connection_hdl hdl = ss[i].hdl;
     asio::post(server_->GetConnectionContext(),
-               [this, hdl, result = ss[i]->GetResult()]() {
+               [this, hdl, result = ss[i].stream->GetResult()]() {
                  websocketpp::lib::error_code ec;
                  server_->GetServer().send(hdl, result.AsJsonString(),
                                            websocketpp::frame::opcode::text,
@@ -247,8 +279,6 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
         decoder_.Push(hdl, d);
 
         connection_data->Clear();
-
-        asio::post(io_work_, [this]() { decoder_.Decode(); });
       }
       break;
     }
@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_OFFLINE_WEBSOCKET_SERVER_IMPL_H_
 #define SHERPA_ONNX_CSRC_OFFLINE_WEBSOCKET_SERVER_IMPL_H_
 
+#include <chrono>  // NOLINT
 #include <deque>
 #include <fstream>
 #include <map>
@@ -83,7 +84,10 @@ class OfflineWebsocketDecoder {
    */
   explicit OfflineWebsocketDecoder(OfflineWebsocketServer *server);
 
-  /** Insert received data to the queue for decoding.
+  /** Hand over received data for decoding.
+   *
+   * Features are computed by one of the work threads, so it returns
+   * immediately.
    *
    * @param hdl A handle to the connection. We can use it to send the result
    *            back to the client once it finishes decoding.
@@ -98,18 +102,35 @@ class OfflineWebsocketDecoder {
   const OfflineWebsocketDecoderConfig &GetConfig() const { return config_; }
 
  private:
+  using Clock = std::chrono::steady_clock;
+
+  struct ReadyStream {
+    connection_hdl hdl;
+    std::unique_ptr<OfflineStream> stream;
+
+    // When all data of the utterance has been received
+    Clock::time_point received_time;
+
+    // When its features have been computed
+    Clock::time_point ready_time;
+  };
+
+  // It is called by one of the work threads. It computes features of the
+  // received data and puts the stream into streams_.
+  void ComputeFeatures(connection_hdl hdl, ConnectionDataPtr d,
+                       Clock::time_point received_time);
+
   OfflineWebsocketDecoderConfig config_;
 
-  /** When we have received all the data from the client, we put it into
-   * this queue; the worker threads will get items from this queue for
-   * decoding.
+  /** Streams whose features have been computed. The worker threads take
+   * items from this queue for decoding.
    *
    * Number of items to take from this queue is determined by
    * `--max-batch-size`. If there are not enough items in the queue, we won't
    * wait and take whatever we have for decoding.
    */
   std::mutex mutex_;
-  std::deque<std::pair<connection_hdl, ConnectionDataPtr>> streams_;
+  std::deque<ReadyStream> streams_;
 
   OfflineWebsocketServer *server_;  // Not owned
   OfflineRecognizer recognizer_;
@@ -130,6 +151,7 @@ class OfflineWebsocketServer {
                          const OfflineWebsocketServerConfig &config);
 
   asio::io_context &GetConnectionContext() { return io_conn_; }
+  asio::io_context &GetWorkContext() { return io_work_; }
   server &GetServer() { return server_; }
 
   void Run(uint16_t port);
@@ -27,6 +27,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/unbind.h"
@@ -35,22 +36,22 @@ namespace sherpa_onnx {
 
 OnlineConformerTransducerModel::OnlineConformerTransducerModel(
     const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       config_(config),
       sess_opts_(GetSessionOptions(config)),
       allocator_{} {
   {
-    auto buf = ReadFile(config.transducer.encoder);
+    auto buf = MapFile(config.transducer.encoder);
     InitEncoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.decoder);
+    auto buf = MapFile(config.transducer.decoder);
     InitDecoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.joiner);
+    auto buf = MapFile(config.transducer.joiner);
     InitJoiner(buf.data(), buf.size());
   }
 }
@@ -58,7 +59,7 @@ OnlineConformerTransducerModel::OnlineConformerTransducerModel(
 template <typename Manager>
 OnlineConformerTransducerModel::OnlineConformerTransducerModel(
     Manager *mgr, const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       config_(config),
       sess_opts_(GetSessionOptions(config)),
       allocator_{} {
@@ -78,10 +79,10 @@ OnlineConformerTransducerModel::OnlineConformerTransducerModel(
   }
 }
 
-void OnlineConformerTransducerModel::InitEncoder(void *model_data,
+void OnlineConformerTransducerModel::InitEncoder(const void *model_data,
                                                  size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -112,10 +113,10 @@ void OnlineConformerTransducerModel::InitEncoder(void *model_data,
   SHERPA_ONNX_READ_META_DATA(cnn_module_kernel_, "cnn_module_kernel");
 }
 
-void OnlineConformerTransducerModel::InitDecoder(void *model_data,
+void OnlineConformerTransducerModel::InitDecoder(const void *model_data,
                                                  size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -141,10 +142,9 @@ void OnlineConformerTransducerModel::InitDecoder(void *model_data,
   SHERPA_ONNX_READ_META_DATA(context_size_, "context_size");
 }
 
-void OnlineConformerTransducerModel::InitJoiner(void *model_data,
+void OnlineConformerTransducerModel::InitJoiner(const void *model_data,
                                                 size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                model_data_length, sess_opts_);
+  joiner_sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
@@ -163,7 +163,7 @@ void OnlineConformerTransducerModel::InitJoiner(void *model_data,
 }
 
 std::vector<Ort::Value> OnlineConformerTransducerModel::StackStates(
-    const std::vector<std::vector<Ort::Value>> &states) const {
+    std::vector<std::vector<Ort::Value>> states) const {
   int32_t batch_size = static_cast<int32_t>(states.size());
 
   std::vector<const Ort::Value *> attn_vec(batch_size);
@@ -191,7 +191,7 @@ std::vector<Ort::Value> OnlineConformerTransducerModel::StackStates(
 
 std::vector<std::vector<Ort::Value>>
 OnlineConformerTransducerModel::UnStackStates(
-    const std::vector<Ort::Value> &states) const {
+    std::vector<Ort::Value> states) const {
   const int32_t batch_size =
       states[0].GetTensorTypeAndShapeInfo().GetShape()[2];
   assert(states.size() == 2);
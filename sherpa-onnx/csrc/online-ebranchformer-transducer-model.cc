@@ -30,6 +30,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/unbind.h"
@@ -38,24 +39,24 @@ namespace sherpa_onnx {
 
 OnlineEbranchformerTransducerModel::OnlineEbranchformerTransducerModel(
     const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       encoder_sess_opts_(GetSessionOptions(config)),
       decoder_sess_opts_(GetSessionOptions(config, "decoder")),
       joiner_sess_opts_(GetSessionOptions(config, "joiner")),
       config_(config),
       allocator_{} {
   {
-    auto buf = ReadFile(config.transducer.encoder);
+    auto buf = MapFile(config.transducer.encoder);
     InitEncoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.decoder);
+    auto buf = MapFile(config.transducer.decoder);
     InitDecoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.joiner);
+    auto buf = MapFile(config.transducer.joiner);
     InitJoiner(buf.data(), buf.size());
   }
 }
@@ -63,7 +64,7 @@ OnlineEbranchformerTransducerModel::OnlineEbranchformerTransducerModel(
 template <typename Manager>
 OnlineEbranchformerTransducerModel::OnlineEbranchformerTransducerModel(
     Manager *mgr, const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       config_(config),
       encoder_sess_opts_(GetSessionOptions(config)),
       decoder_sess_opts_(GetSessionOptions(config)),
@@ -85,10 +86,10 @@ OnlineEbranchformerTransducerModel::OnlineEbranchformerTransducerModel(
   }
 }
 
-void OnlineEbranchformerTransducerModel::InitEncoder(void *model_data,
+void OnlineEbranchformerTransducerModel::InitEncoder(const void *model_data,
                                                      size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, encoder_sess_opts_);
+  encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                encoder_sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -152,10 +153,10 @@ void OnlineEbranchformerTransducerModel::InitEncoder(void *model_data,
   }
 }
 
-void OnlineEbranchformerTransducerModel::InitDecoder(void *model_data,
+void OnlineEbranchformerTransducerModel::InitDecoder(const void *model_data,
                                                      size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, decoder_sess_opts_);
+  decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                decoder_sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -177,10 +178,10 @@ void OnlineEbranchformerTransducerModel::InitDecoder(void *model_data,
   SHERPA_ONNX_READ_META_DATA(context_size_, "context_size");
 }
 
-void OnlineEbranchformerTransducerModel::InitJoiner(void *model_data,
+void OnlineEbranchformerTransducerModel::InitJoiner(const void *model_data,
                                                     size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, joiner_sess_opts_);
+  joiner_sess_ = CreateSession(env_, model_data, model_data_length,
+                               joiner_sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
@@ -199,7 +200,7 @@ void OnlineEbranchformerTransducerModel::InitJoiner(void *model_data,
 }
 
 std::vector<Ort::Value> OnlineEbranchformerTransducerModel::StackStates(
-    const std::vector<std::vector<Ort::Value>> &states) const {
+    std::vector<std::vector<Ort::Value>> states) const {
   int32_t batch_size = static_cast<int32_t>(states.size());
 
   std::vector<const Ort::Value *> buf(batch_size);
@@ -255,7 +256,7 @@ std::vector<Ort::Value> OnlineEbranchformerTransducerModel::StackStates(
 
 std::vector<std::vector<Ort::Value>>
 OnlineEbranchformerTransducerModel::UnStackStates(
-    const std::vector<Ort::Value> &states) const {
+    std::vector<Ort::Value> states) const {
   assert(static_cast<int32_t>(states.size()) == num_hidden_layers_ * 4 + 1);
 
   int32_t batch_size = states[0].GetTensorTypeAndShapeInfo().GetShape()[0];
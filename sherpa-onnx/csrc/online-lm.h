@@ -49,13 +49,24 @@ class OnlineLM {
   virtual void ComputeLMScore(float scale, int32_t context_size,
                       std::vector<Hypotheses> *hyps) = 0;
 
-  /** This function updates lm_log_prob and nn_lm_scores of hyp (shallow fusion).
+  /** This function updates lm_log_prob of hyp with the score of its last
+   * token (shallow fusion). It sets hyp->nn_lm_pending to true; call
+   * ComputeNextLMScoresSF() to run the LM on the last token.
    *
    * @param scale LM score
    * @param hyps It is changed in-place.
    *
    */
   virtual void ComputeLMScoreSF(float scale, Hypothesis *hyp) = 0;
+
+  /** Run the LM on the last token of the given hyps in a single batch and
+   * update their nn_lm_state (shallow fusion).
+   *
+   * @param hyps An array of size n. hyps[i]->nn_lm_pending must be true.
+   *             It is set to false on return.
+   * @param n Number of hyps.
+   */
+  virtual void ComputeNextLMScoresSF(Hypothesis **hyps, int32_t n) = 0;
 };
 
 }  // namespace sherpa_onnx
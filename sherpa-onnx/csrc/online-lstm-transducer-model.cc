@@ -26,6 +26,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/unbind.h"
 
@@ -33,22 +34,22 @@ namespace sherpa_onnx {
 
 OnlineLstmTransducerModel::OnlineLstmTransducerModel(
     const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       config_(config),
       sess_opts_(GetSessionOptions(config)),
       allocator_{} {
   {
-    auto buf = ReadFile(config.transducer.encoder);
+    auto buf = MapFile(config.transducer.encoder);
     InitEncoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.decoder);
+    auto buf = MapFile(config.transducer.decoder);
     InitDecoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.joiner);
+    auto buf = MapFile(config.transducer.joiner);
     InitJoiner(buf.data(), buf.size());
   }
 }
@@ -56,7 +57,7 @@ OnlineLstmTransducerModel::OnlineLstmTransducerModel(
 template <typename Manager>
 OnlineLstmTransducerModel::OnlineLstmTransducerModel(
     Manager *mgr, const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       config_(config),
       sess_opts_(GetSessionOptions(config)),
       allocator_{} {
@@ -76,10 +77,10 @@ OnlineLstmTransducerModel::OnlineLstmTransducerModel(
   }
 }
 
-void OnlineLstmTransducerModel::InitEncoder(void *model_data,
+void OnlineLstmTransducerModel::InitEncoder(const void *model_data,
                                             size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -108,10 +109,10 @@ void OnlineLstmTransducerModel::InitEncoder(void *model_data,
   SHERPA_ONNX_READ_META_DATA(d_model_, "d_model");
 }
 
-void OnlineLstmTransducerModel::InitDecoder(void *model_data,
+void OnlineLstmTransducerModel::InitDecoder(const void *model_data,
                                             size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -133,10 +134,9 @@ void OnlineLstmTransducerModel::InitDecoder(void *model_data,
   SHERPA_ONNX_READ_META_DATA(context_size_, "context_size");
 }
 
-void OnlineLstmTransducerModel::InitJoiner(void *model_data,
+void OnlineLstmTransducerModel::InitJoiner(const void *model_data,
                                            size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                model_data_length, sess_opts_);
+  joiner_sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
@@ -155,7 +155,7 @@ void OnlineLstmTransducerModel::InitJoiner(void *model_data,
 }
 
 std::vector<Ort::Value> OnlineLstmTransducerModel::StackStates(
-    const std::vector<std::vector<Ort::Value>> &states) const {
+    std::vector<std::vector<Ort::Value>> states) const {
   int32_t batch_size = static_cast<int32_t>(states.size());
 
   std::vector<const Ort::Value *> h_buf(batch_size);
@@ -180,7 +180,7 @@ std::vector<Ort::Value> OnlineLstmTransducerModel::StackStates(
 }
 
 std::vector<std::vector<Ort::Value>> OnlineLstmTransducerModel::UnStackStates(
-    const std::vector<Ort::Value> &states) const {
+    std::vector<Ort::Value> states) const {
   int32_t batch_size = states[0].GetTensorTypeAndShapeInfo().GetShape()[1];
   assert(states.size() == 2);
 
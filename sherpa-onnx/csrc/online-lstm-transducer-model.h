@@ -23,10 +23,10 @@ class OnlineLstmTransducerModel : public OnlineTransducerModel {
   OnlineLstmTransducerModel(Manager *mgr, const OnlineModelConfig &config);
 
   std::vector<Ort::Value> StackStates(
-      const std::vector<std::vector<Ort::Value>> &states) const override;
+      std::vector<std::vector<Ort::Value>> states) const override;
 
   std::vector<std::vector<Ort::Value>> UnStackStates(
-      const std::vector<Ort::Value> &states) const override;
+      std::vector<Ort::Value> states) const override;
 
   std::vector<Ort::Value> GetEncoderInitStates() override;
 
@@ -48,12 +48,12 @@ class OnlineLstmTransducerModel : public OnlineTransducerModel {
   OrtAllocator *Allocator() override { return allocator_; }
 
  private:
-  void InitEncoder(void *model_data, size_t model_data_length);
-  void InitDecoder(void *model_data, size_t model_data_length);
-  void InitJoiner(void *model_data, size_t model_data_length);
+  void InitEncoder(const void *model_data, size_t model_data_length);
+  void InitDecoder(const void *model_data, size_t model_data_length);
+  void InitJoiner(const void *model_data, size_t model_data_length);
 
  private:
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
@@ -19,8 +19,10 @@
 
 #include "sherpa-onnx/csrc/cat.h"
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/io-binding-runner.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/transpose.h"
@@ -32,11 +34,11 @@ class OnlineNeMoCtcModel::Impl {
  public:
   explicit Impl(const OnlineModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     {
-      auto buf = ReadFile(config.nemo_ctc.model);
+      auto buf = MapFile(config.nemo_ctc.model);
       Init(buf.data(), buf.size());
     }
   }
@@ -44,7 +46,7 @@ class OnlineNeMoCtcModel::Impl {
   template <typename Manager>
   Impl(Manager *mgr, const OnlineModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     {
@@ -77,9 +79,13 @@ class OnlineNeMoCtcModel::Impl {
         std::move(x), View(&length), std::move(cache_last_channel),
         std::move(cache_last_time), std::move(cache_last_channel_len)};
 
-    auto out =
-        sess_->Run({}, input_names_ptr_.data(), inputs.data(), inputs.size(),
-                   output_names_ptr_.data(), output_names_ptr_.size());
+    auto out = runner_->Run(inputs.data(), inputs.size());
+
+    // Reuse the memory of the input states for the next states of the next
+    // chunk. Initial states are views and are skipped by the runner.
+    for (int32_t i = 2; i != static_cast<int32_t>(inputs.size()); ++i) {
+      runner_->Recycle(std::move(inputs[i]));
+    }
     // out[0]: logit
     // out[1] logit_length
     // out[2:] states_next
@@ -193,9 +199,8 @@ class OnlineNeMoCtcModel::Impl {
   }
 
  private:
-  void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+  void Init(const void *model_data, size_t model_data_length) {
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -233,6 +238,12 @@ class OnlineNeMoCtcModel::Impl {
     vocab_size_ += 1;
 
     InitStates();
+
+    runner_ = std::make_unique<IoBindingRunner>(
+        sess_.get(), input_names_ptr_, output_names_ptr_, allocator_);
+    runner_->AddSharedTensor(cache_last_channel_);
+    runner_->AddSharedTensor(cache_last_time_);
+    runner_->AddSharedTensor(cache_last_channel_len_);
   }
 
   void InitStates() {
@@ -263,11 +274,12 @@ class OnlineNeMoCtcModel::Impl {
 
  private:
   OnlineModelConfig config_;
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
   std::unique_ptr<Ort::Session> sess_;
+  std::unique_ptr<IoBindingRunner> runner_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
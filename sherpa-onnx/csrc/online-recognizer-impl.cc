@@ -24,6 +24,8 @@
 #include "sherpa-onnx/csrc/online-recognizer-transducer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer-transducer-nemo-impl.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
 #if SHERPA_ONNX_ENABLE_RKNN
@@ -57,15 +59,13 @@ std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
   }
 
   if (!config.model_config.transducer.encoder.empty()) {
-    Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
+    Ort::Env &env = GetOrtEnv();
 
-    Ort::SessionOptions sess_opts;
-    sess_opts.SetIntraOpNumThreads(1);
-    sess_opts.SetInterOpNumThreads(1);
+    Ort::SessionOptions sess_opts = GetSessionOptions(1, "cpu");
 
-    auto decoder_model = ReadFile(config.model_config.transducer.decoder);
-    auto sess = std::make_unique<Ort::Session>(env, decoder_model.data(),
-                                               decoder_model.size(), sess_opts);
+    auto decoder_model = MapFile(config.model_config.transducer.decoder);
+    auto sess = CreateSession(env, decoder_model.data(), decoder_model.size(),
+                              sess_opts);
 
     size_t node_count = sess->GetOutputCount();
 
@@ -117,15 +117,13 @@ std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
   }
 
   if (!config.model_config.transducer.encoder.empty()) {
-    Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
+    Ort::Env &env = GetOrtEnv();
 
-    Ort::SessionOptions sess_opts;
-    sess_opts.SetIntraOpNumThreads(1);
-    sess_opts.SetInterOpNumThreads(1);
+    Ort::SessionOptions sess_opts = GetSessionOptions(1, "cpu");
 
     auto decoder_model = ReadFile(mgr, config.model_config.transducer.decoder);
-    auto sess = std::make_unique<Ort::Session>(env, decoder_model.data(),
-                                               decoder_model.size(), sess_opts);
+    auto sess = CreateSession(env, decoder_model.data(), decoder_model.size(),
+                              sess_opts);
 
     size_t node_count = sess->GetOutputCount();
 
@@ -259,22 +257,29 @@ std::string OnlineRecognizerImpl::ApplyInverseTextNormalization(
     std::string text) const {
   text = RemoveInvalidUtf8Sequences(text);
 
-  if (!itn_list_.empty()) {
-    for (const auto &tn : itn_list_) {
-      text = tn->Normalize(text);
-    }
+  if (itn_list_.empty()) {
+    return text;
   }
 
-  return text;
+  return itn_cache_.GetOrCompute(
+      text, kMaxCachedTextLength, [this](const std::string &s) {
+        std::string ans = s;
+        for (const auto &tn : itn_list_) {
+          ans = tn->Normalize(ans);
+        }
+        return ans;
+      });
 }
 
 std::string OnlineRecognizerImpl::ApplyHomophoneReplacer(
     std::string text) const {
-  if (hr_) {
-    text = hr_->Apply(text);
+  if (!hr_) {
+    return text;
   }
 
-  return text;
+  return hr_cache_.GetOrCompute(
+      text, kMaxCachedTextLength,
+      [this](const std::string &s) { return hr_->Apply(s); });
 }
 
 #if __ANDROID_API__ >= 9
@@ -11,6 +11,7 @@
 
 #include "kaldifst/csrc/text-normalizer.h"
 #include "sherpa-onnx/csrc/homophone-replacer.h"
+#include "sherpa-onnx/csrc/lru-cache.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/online-stream.h"
@@ -67,6 +68,15 @@ class OnlineRecognizerImpl {
   // config.rule_fars is not empty
   std::vector<std::unique_ptr<kaldifst::TextNormalizer>> itn_list_;
   std::unique_ptr<HomophoneReplacer> hr_;
+
+  // Results of itn_list_ and hr_ keyed by the input text. The text of
+  // partial results often stays the same for several chunks and short
+  // phrases are repeated across streams, so most lookups are hits.
+  // Texts longer than kMaxCachedTextLength bytes are not cached.
+  static constexpr int32_t kTextCacheCapacity = 1000;
+  static constexpr int32_t kMaxCachedTextLength = 512;
+  mutable LruCache<std::string> itn_cache_{kTextCacheCapacity};
+  mutable LruCache<std::string> hr_cache_{kTextCacheCapacity};
 };
 
 }  // namespace sherpa_onnx
@@ -14,6 +14,7 @@
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/context-graph-cache.h"
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/offline-whisper-model.h"
@@ -202,38 +203,8 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
   std::unique_ptr<OnlineStream> CreateStream(
       const std::string &hotwords) const override {
-    auto hws = std::regex_replace(hotwords, std::regex("/"), "\n");
-    std::istringstream is(hws);
-    std::vector<std::vector<int32_t>> current;
-    std::vector<float> current_scores;
-    if (!EncodeHotwords(is, config_.model_config.modeling_unit, sym_,
-                        bpe_encoder_.get(), &current, &current_scores)) {
-      SHERPA_ONNX_LOGE("Encode hotwords failed, skipping, hotwords are : %s",
-                       hotwords.c_str());
-    }
-
-    int32_t num_default_hws = hotwords_.size();
-    int32_t num_hws = current.size();
-
-    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
-
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_hws,
-                            config_.hotwords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_hws,
-                            config_.hotwords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else {
-      // Do nothing.
-    }
-
-    auto context_graph = std::make_shared<ContextGraph>(
-        current, config_.hotwords_score, current_scores);
+    auto context_graph = hotwords_graph_cache_.Get(
+        hotwords, [this, &hotwords]() { return BuildContextGraph(hotwords); });
     auto stream =
         std::make_unique<OnlineStream>(config_.feat_config, context_graph);
     InitOnlineStream(stream.get());
@@ -256,7 +227,6 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
     int32_t feature_dim = 80;
     std::vector<OnlineTransducerDecoderResult> results(max_batch_size);
     std::vector<float> features_vec(max_batch_size * chunk_size * feature_dim);
-    std::vector<std::vector<Ort::Value>> states_vec(max_batch_size);
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
@@ -264,12 +234,17 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
     std::array<int64_t, 3> x_shape{max_batch_size, chunk_size, feature_dim};
 
     for (int32_t i = 0; i != max_batch_size; ++i) {
-      states_vec[i] = model_->GetEncoderInitStates();
       results[i] = decoder_->GetEmptyResult();
     }
 
     for (int32_t i = 0; i != warmup; ++i) {
-      auto states = model_->StackStates(states_vec);
+      // StackStates() takes the states, so they are created for each run
+      std::vector<std::vector<Ort::Value>> states_vec(max_batch_size);
+      for (auto &s : states_vec) {
+        s = model_->GetEncoderInitStates();
+      }
+
+      auto states = model_->StackStates(std::move(states_vec));
       Ort::Value x = Ort::Value::CreateTensor(memory_info, features_vec.data(),
                                               features_vec.size(),
                                               x_shape.data(), x_shape.size());
@@ -333,7 +308,7 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
         memory_info, all_processed_frames.data(), all_processed_frames.size(),
         processed_frames_shape.data(), processed_frames_shape.size());
 
-    auto states = model_->StackStates(states_vec);
+    auto states = model_->StackStates(std::move(states_vec));
 
     auto pair = model_->RunEncoder(std::move(x), std::move(states),
                                    std::move(processed_frames));
@@ -345,7 +320,7 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
     }
 
     std::vector<std::vector<Ort::Value>> next_states =
-        model_->UnStackStates(pair.second);
+        model_->UnStackStates(std::move(pair.second));
 
     for (int32_t i = 0; i != n; ++i) {
       ss[i]->SetResult(results[i]);
@@ -354,14 +329,34 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
   }
 
   OnlineRecognizerResult GetResult(OnlineStream *s) const override {
-    OnlineTransducerDecoderResult decoder_result = s->GetResult();
-    decoder_->StripLeadingBlanks(&decoder_result);
+    // Unlike Convert(), only tokens decoded since the last call are
+    // converted to text. The best path is not copied.
+    auto path = decoder_->GetBestPath(s->GetResult());
+
+    auto &builder = s->GetResultBuilder();
+    builder.Update(path.tokens, path.num_tokens, sym_);
 
     // TODO(fangjun): Remember to change these constants if needed
     int32_t frame_shift_ms = 10;
     int32_t subsampling_factor = 4;
-    auto r = Convert(decoder_result, sym_, frame_shift_ms, subsampling_factor,
-                     s->GetCurrentSegment(), s->GetNumFramesSinceStart());
+
+    OnlineRecognizerResult r;
+    r.text = builder.Text(sym_);
+    r.tokens = builder.Tokens();
+
+    float frame_shift_s = frame_shift_ms / 1000. * subsampling_factor;
+    r.timestamps.reserve(path.timestamps->size());
+    for (auto t : *path.timestamps) {
+      r.timestamps.push_back(frame_shift_s * t);
+    }
+
+    r.ys_probs = *path.ys_probs;
+    r.lm_probs = *path.lm_probs;
+    r.context_scores = *path.context_scores;
+
+    r.segment = s->GetCurrentSegment();
+    r.start_time = s->GetNumFramesSinceStart() * frame_shift_ms / 1000.;
+
     r.text = ApplyInverseTextNormalization(std::move(r.text));
     r.text = ApplyHomophoneReplacer(std::move(r.text));
     return r;
@@ -436,6 +431,13 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
  private:
   void InitHotwords() {
+    if (ContextGraph::IsSavedGraph(config_.hotwords_file)) {
+      // It is built by sherpa-onnx-build-hotwords-graph and is used as is.
+      // Hotwords passed to CreateStream() are not merged with it.
+      hotwords_graph_ = ContextGraph::Load(config_.hotwords_file);
+      return;
+    }
+
     // each line in hotwords_file contains space-separated words
 
     std::ifstream is(config_.hotwords_file);
@@ -509,10 +511,48 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
   }
 
  private:
+  // Build a context graph containing the given hotwords and hotwords_
+  ContextGraphPtr BuildContextGraph(const std::string &hotwords) const {
+    auto hws = std::regex_replace(hotwords, std::regex("/"), "\n");
+    std::istringstream is(hws);
+    std::vector<std::vector<int32_t>> current;
+    std::vector<float> current_scores;
+    if (!EncodeHotwords(is, config_.model_config.modeling_unit, sym_,
+                        bpe_encoder_.get(), &current, &current_scores)) {
+      SHERPA_ONNX_LOGE("Encode hotwords failed, skipping, hotwords are : %s",
+                       hotwords.c_str());
+    }
+
+    int32_t num_default_hws = hotwords_.size();
+    int32_t num_hws = current.size();
+
+    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
+
+    if (!current_scores.empty() && !boost_scores_.empty()) {
+      current_scores.insert(current_scores.end(), boost_scores_.begin(),
+                            boost_scores_.end());
+    } else if (!current_scores.empty() && boost_scores_.empty()) {
+      current_scores.insert(current_scores.end(), num_default_hws,
+                            config_.hotwords_score);
+    } else if (current_scores.empty() && !boost_scores_.empty()) {
+      current_scores.insert(current_scores.end(), num_hws,
+                            config_.hotwords_score);
+      current_scores.insert(current_scores.end(), boost_scores_.begin(),
+                            boost_scores_.end());
+    } else {
+      // Do nothing.
+    }
+
+    return std::make_shared<ContextGraph>(current, config_.hotwords_score,
+                                          current_scores);
+  }
+
   OnlineRecognizerConfig config_;
   std::vector<std::vector<int32_t>> hotwords_;
   std::vector<float> boost_scores_;
   ContextGraphPtr hotwords_graph_;
+  // graphs for hotwords passed to CreateStream(hotwords)
+  mutable ContextGraphCache hotwords_graph_cache_;
   std::unique_ptr<ssentencepiece::Ssentencepiece> bpe_encoder_;
   std::unique_ptr<OnlineTransducerModel> model_;
   std::unique_ptr<OnlineLM> lm_;
@@ -0,0 +1,222 @@
+// sherpa-onnx/csrc/online-result-builder-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-result-builder.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <ios>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/bbpe.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+// Convert all token IDs at once
+static void ConvertAll(const std::vector<int64_t> &ids,
+                       const SymbolTable &sym_table, std::string *text,
+                       std::vector<std::string> *tokens) {
+  text->clear();
+  tokens->clear();
+  for (auto i : ids) {
+    auto sym = sym_table[i];
+    if (sym == "<unk>") {
+      continue;
+    }
+
+    text->append(sym);
+
+    if (sym.size() == 1 && (sym[0] < 0x20 || sym[0] > 0x7e)) {
+      std::ostringstream os;
+      os << "<0x" << std::hex << std::uppercase
+         << (static_cast<int32_t>(sym[0]) & 0xff) << ">";
+      sym = os.str();
+    }
+    tokens->push_back(std::move(sym));
+  }
+
+  if (sym_table.IsByteBpe()) {
+    *text = sym_table.DecodeByteBpe(*text);
+  }
+}
+
+// Map each byte of s to its byte-level BPE symbol
+static std::string ToByteBpe(const std::string &s) {
+  std::unordered_map<uint8_t, std::string> table;
+  for (const auto &p : GetByteBpeTable()) {
+    table[p.second] = p.first;
+  }
+
+  std::string ans;
+  for (uint8_t c : s) {
+    ans.append(table.at(c));
+  }
+  return ans;
+}
+
+static SymbolTable GetByteBpeSymbolTable() {
+  // Some characters are split into several tokens
+  std::vector<std::string> pieces = {
+      "he",     "llo", "wor", "ld", "a",  "b", "c",      ",",  "'",
+      "\xc3",   "\xb6", "ö",  "ß",  "你", "好", "\xe4\xb8", "\x96",
+      "世界",   "。",   "d’", "é",  "1",  "."};
+
+  std::ostringstream os;
+  os << "<blk> 0\n<unk> 1\n▁ 2\n";
+  int32_t id = 3;
+  for (const auto &p : pieces) {
+    os << ToByteBpe(p) << " " << id++ << "\n";
+    os << "▁" << ToByteBpe(p) << " " << id++ << "\n";
+  }
+
+  return SymbolTable(os.str(), false);
+}
+
+static SymbolTable GetBpeSymbolTable() {
+  std::ostringstream os;
+  os << "<blk> 0\n<sos/eos> 1\n<unk> 2\n";
+  for (int32_t i = 0; i != 256; ++i) {
+    os << "<0x" << std::hex << std::uppercase << (i >> 4) << (i & 15)
+       << std::dec << "> " << (i + 3) << "\n";
+  }
+
+  std::vector<std::string> pieces = {"▁hello", "▁wor", "ld", "你", "好",
+                                     ",",      "▁a",   "b"};
+  int32_t id = 259;
+  for (const auto &p : pieces) {
+    os << p << " " << id++ << "\n";
+  }
+
+  return SymbolTable(os.str(), false);
+}
+
+// Simulate partial results of a stream: tokens are appended, and
+// occasionally the last few tokens are replaced or removed
+static void TestRandom(const SymbolTable &sym_table, int32_t num_ids) {
+  std::mt19937 gen(20250101);
+  std::uniform_int_distribution<int32_t> id_dist(1, num_ids - 1);
+  std::uniform_int_distribution<int32_t> op_dist(0, 9);
+
+  OnlineResultBuilder builder;
+  std::vector<int64_t> ids;
+  std::string expected_text;
+  std::vector<std::string> expected_tokens;
+
+  for (int32_t i = 0; i != 2000; ++i) {
+    int32_t op = op_dist(gen);
+    if (op < 6) {
+      int32_t n = op_dist(gen) / 3;
+      for (int32_t k = 0; k != n; ++k) {
+        ids.push_back(id_dist(gen));
+      }
+    } else if (op < 9) {
+      int32_t n = std::min<int32_t>(op_dist(gen) / 2, ids.size());
+      for (int32_t k = 0; k != n; ++k) {
+        ids[ids.size() - 1 - k] = id_dist(gen);
+      }
+    } else {
+      int32_t n = std::min<int32_t>(op_dist(gen), ids.size());
+      ids.resize(ids.size() - n);
+    }
+
+    builder.Update(ids, sym_table);
+    ConvertAll(ids, sym_table, &expected_text, &expected_tokens);
+
+    ASSERT_EQ(builder.NumIds(), static_cast<int32_t>(ids.size()));
+    ASSERT_EQ(builder.Text(sym_table), expected_text) << i;
+    ASSERT_EQ(builder.Tokens(), expected_tokens) << i;
+  }
+
+  builder.Clear();
+  EXPECT_EQ(builder.NumIds(), 0);
+  EXPECT_EQ(builder.Text(sym_table), "");
+  EXPECT_TRUE(builder.Tokens().empty());
+}
+
+TEST(OnlineResultBuilder, ByteBpe) {
+  auto sym_table = GetByteBpeSymbolTable();
+  ASSERT_TRUE(sym_table.IsByteBpe());
+
+  OnlineResultBuilder builder;
+  std::vector<int64_t> ids = {sym_table[ToByteBpe("你")],
+                              sym_table["▁" + ToByteBpe("he")],
+                              sym_table[ToByteBpe("llo")],
+                              sym_table["▁" + ToByteBpe("wor")],
+                              sym_table[ToByteBpe("ld")]};
+  builder.Update(ids, sym_table);
+  // No space is added after a non-printable byte
+  EXPECT_EQ(builder.Text(sym_table), "你hello world");
+
+  ids.pop_back();
+  builder.Update(ids, sym_table);
+  EXPECT_EQ(builder.Text(sym_table), "你hello wor");
+
+  TestRandom(sym_table, sym_table.NumSymbols());
+}
+
+TEST(OnlineResultBuilder, Bpe) {
+  auto sym_table = GetBpeSymbolTable();
+  ASSERT_FALSE(sym_table.IsByteBpe());
+
+  OnlineResultBuilder builder;
+  std::vector<int64_t> ids = {sym_table["▁hello"], 2, sym_table["▁wor"],
+                              sym_table["ld"], 3 + 0xe4};
+  builder.Update(ids, sym_table);
+  EXPECT_EQ(builder.Text(sym_table), " hello world\xe4");
+  EXPECT_EQ(builder.Tokens(), (std::vector<std::string>{
+                                  " hello", " wor", "ld", "<0xE4>"}));
+
+  TestRandom(sym_table, sym_table.NumSymbols());
+}
+
+TEST(OnlineResultBuilder, DISABLED_Benchmark) {
+  auto sym_table = GetByteBpeSymbolTable();
+
+  std::mt19937 gen(20250101);
+  std::uniform_int_distribution<int32_t> id_dist(3,
+                                                 sym_table.NumSymbols() - 1);
+
+  // About 20 minutes of speech with 4 tokens per second, and a partial
+  // result every 3 new tokens
+  std::vector<int64_t> ids;
+  for (int32_t i = 0; i != 4 * 1200; ++i) {
+    ids.push_back(id_dist(gen));
+  }
+
+  std::string text;
+  std::vector<std::string> tokens;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int32_t n = 3; n <= static_cast<int32_t>(ids.size()); n += 3) {
+    ConvertAll({ids.begin(), ids.begin() + n}, sym_table, &text, &tokens);
+  }
+  auto mid = std::chrono::steady_clock::now();
+
+  OnlineResultBuilder builder;
+  for (int32_t n = 3; n <= static_cast<int32_t>(ids.size()); n += 3) {
+    builder.Update(ids.data(), n, sym_table);
+    text = builder.Text(sym_table);
+    tokens = builder.Tokens();
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  int32_t full_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(mid - start)
+          .count();
+  int32_t incremental_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(stop - mid)
+          .count();
+
+  SHERPA_ONNX_LOGE("%d tokens. Full: %d ms, incremental: %d ms",
+                   static_cast<int32_t>(ids.size()), full_ms, incremental_ms);
+}
+
+}  // namespace sherpa_onnx
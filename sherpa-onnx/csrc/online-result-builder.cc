@@ -0,0 +1,106 @@
+// sherpa-onnx/csrc/online-result-builder.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-result-builder.h"
+
+#include <algorithm>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "sherpa-onnx/csrc/text-utils.h"
+
+namespace sherpa_onnx {
+
+void OnlineResultBuilder::Update(const int64_t *ids, int32_t n,
+                                 const SymbolTable &sym_table) {
+  int32_t num_ids = static_cast<int32_t>(ids_.size());
+  int32_t k =
+      std::mismatch(ids_.begin(), ids_.begin() + std::min(num_ids, n), ids)
+          .first -
+      ids_.begin();
+
+  Truncate(k);
+
+  for (int32_t i = k; i < n; ++i) {
+    Append(ids[i], sym_table);
+  }
+}
+
+std::string OnlineResultBuilder::Text(const SymbolTable &sym_table) const {
+  if (!sym_table.IsByteBpe()) {
+    return raw_text_;
+  }
+
+  int32_t start = checkpoints_.empty() ? 0 : checkpoints_.back().first;
+
+  std::string ans;
+  ans.reserve(decoded_.size() + raw_text_.size() - start);
+  ans = decoded_;
+  sym_table.DecodeByteBpe(raw_text_.substr(start), &ans);
+
+  return ans;
+}
+
+void OnlineResultBuilder::Clear() { Truncate(0); }
+
+void OnlineResultBuilder::Truncate(int32_t n) {
+  if (n >= static_cast<int32_t>(ids_.size())) {
+    return;
+  }
+
+  tokens_.resize(num_tokens_[n]);
+  raw_text_.resize(raw_text_size_[n]);
+
+  ids_.resize(n);
+  num_tokens_.resize(n);
+  raw_text_size_.resize(n);
+
+  int32_t size = static_cast<int32_t>(raw_text_.size());
+  while (!checkpoints_.empty() && checkpoints_.back().first > size) {
+    checkpoints_.pop_back();
+  }
+
+  decoded_.resize(checkpoints_.empty() ? 0 : checkpoints_.back().second);
+}
+
+void OnlineResultBuilder::Append(int64_t id, const SymbolTable &sym_table) {
+  ids_.push_back(id);
+  num_tokens_.push_back(static_cast<int32_t>(tokens_.size()));
+  raw_text_size_.push_back(static_cast<int32_t>(raw_text_.size()));
+
+  auto sym = sym_table[id];
+  if (sym == "<unk>") {
+    return;
+  }
+
+  if (sym_table.IsByteBpe() && !raw_text_.empty() &&
+      IsSplitUtf8Boundary(sym)) {
+    // Decoding raw_text_ so far and the remaining text separately gives
+    // the same result as decoding them together
+    int32_t start = checkpoints_.empty() ? 0 : checkpoints_.back().first;
+    int32_t size = static_cast<int32_t>(raw_text_.size());
+    if (start < size) {
+      sym_table.DecodeByteBpe(raw_text_.substr(start), &decoded_);
+      checkpoints_.emplace_back(size, static_cast<int32_t>(decoded_.size()));
+    }
+  }
+
+  raw_text_.append(sym);
+
+  if (sym.size() == 1 && (sym[0] < 0x20 || sym[0] > 0x7e)) {
+    // for bpe models with byte_fallback
+    // (but don't rewrite printable characters 0x20..0x7e,
+    //  which collide with standard BPE units)
+    std::ostringstream os;
+    os << "<0x" << std::hex << std::uppercase
+       << (static_cast<int32_t>(sym[0]) & 0xff) << ">";
+    sym = os.str();
+  }
+
+  tokens_.push_back(std::move(sym));
+}
+
+}  // namespace sherpa_onnx
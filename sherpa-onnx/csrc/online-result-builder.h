@@ -0,0 +1,77 @@
+// sherpa-onnx/csrc/online-result-builder.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_RESULT_BUILDER_H_
+#define SHERPA_ONNX_CSRC_ONLINE_RESULT_BUILDER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/symbol-table.h"
+
+namespace sherpa_onnx {
+
+// Convert token IDs of a stream to text and token strings incrementally.
+//
+// The decoding result of a stream usually differs from the previous one
+// only in the last few tokens. Update() keeps the converted common prefix
+// and converts only the tokens after it, so the cost of a call does not
+// grow with the length of the stream.
+//
+// For byte-level BPE models, the text is decoded piece by piece. The
+// decoded text is cached up to the last token that starts at a boundary
+// of SplitUtf8(); see SymbolTable::DecodeByteBpe().
+class OnlineResultBuilder {
+ public:
+  // Set the token IDs of the result. The same sym_table must be used for
+  // all calls.
+  void Update(const int64_t *ids, int32_t n, const SymbolTable &sym_table);
+
+  void Update(const std::vector<int64_t> &ids, const SymbolTable &sym_table) {
+    Update(ids.data(), static_cast<int32_t>(ids.size()), sym_table);
+  }
+
+  // It is the same as the text produced by converting all token IDs
+  // at once.
+  std::string Text(const SymbolTable &sym_table) const;
+
+  // <unk> is skipped. Single-byte tokens from byte fallback are formatted
+  // as <0xXX>.
+  const std::vector<std::string> &Tokens() const { return tokens_; }
+
+  int32_t NumIds() const { return static_cast<int32_t>(ids_.size()); }
+
+  void Clear();
+
+ private:
+  // Keep only the first n token IDs
+  void Truncate(int32_t n);
+
+  void Append(int64_t id, const SymbolTable &sym_table);
+
+ private:
+  std::vector<int64_t> ids_;
+
+  // Sizes of tokens_ and raw_text_ before appending ids_[i]
+  std::vector<int32_t> num_tokens_;
+  std::vector<int32_t> raw_text_size_;
+
+  std::vector<std::string> tokens_;
+
+  // Concatenation of the symbols of all tokens
+  std::string raw_text_;
+
+  // Used only for byte-level BPE models.
+  // decoded_ is raw_text_[0, p) decoded, where p is the position of the
+  // last checkpoint. A checkpoint (p, s) means that decoding
+  // raw_text_[0, p) gives a text of size s.
+  std::string decoded_;
+  std::vector<std::pair<int32_t, int32_t>> checkpoints_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_RESULT_BUILDER_H_
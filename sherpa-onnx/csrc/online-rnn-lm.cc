@@ -6,6 +6,8 @@
 #include "sherpa-onnx/csrc/online-rnn-lm.h"
 
 #include <algorithm>
+#include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -15,6 +17,7 @@
 #include "sherpa-onnx/csrc/lodr-fst.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -24,7 +27,7 @@ class OnlineRnnLM::Impl {
  public:
   explicit Impl(const OnlineLMConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_{GetSessionOptions(config)},
         allocator_{} {
     Init(config);
@@ -32,40 +35,74 @@ class OnlineRnnLM::Impl {
 
   // shallow fusion scoring function
   void ComputeLMScoreSF(float scale, Hypothesis *hyp) {
-    if (hyp->nn_lm_states.empty()) {
-      auto init_states = GetInitStatesSF();
-      hyp->nn_lm_scores.value = std::move(init_states.first);
-      hyp->nn_lm_states = Convert(std::move(init_states.second));
+    if (!hyp->nn_lm_state) {
+      hyp->nn_lm_state = init_state_sf_;
       // if LODR enabled, we need to initialize the LODR state
       if (lodr_fst_ != nullptr) {
-        hyp->lodr_state = std::make_unique<LodrStateCost>(lodr_fst_.get());
+        hyp->lodr_state = LodrStateCost(lodr_fst_.get());
       }
+    } else if (hyp->nn_lm_pending) {
+      // The LM has not seen the previous token yet
+      Hypothesis *p = hyp;
+      RunSF(&p, 1);
     }
 
     // get lm score for cur token given the hyp->ys[:-1] and save to lm_log_prob
-    const float *nn_lm_scores = hyp->nn_lm_scores.value.GetTensorData<float>();
-    hyp->lm_log_prob += nn_lm_scores[hyp->ys.back()] * scale;
+    hyp->lm_log_prob += hyp->nn_lm_state->scores[hyp->ys.back()] * scale;
 
     // if LODR enabled, we need to update the LODR state
     if (lodr_fst_ != nullptr) {
-      auto next_lodr_state = std::make_unique<LodrStateCost>(
-                            hyp->lodr_state->ForwardOneStep(hyp->ys.back()));
+      LodrStateCost next_lodr_state =
+          hyp->lodr_state.ForwardOneStep(hyp->ys.back());
       // calculate the score of the latest token
-      auto score = next_lodr_state->Score() - hyp->lodr_state->Score();
-      hyp->lodr_state = std::move(next_lodr_state);
+      auto score = next_lodr_state.Score() - hyp->lodr_state.Score();
+      hyp->lodr_state = next_lodr_state;
       // apply LODR to hyp score
       hyp->lm_log_prob += score * config_.lodr_scale;
     }
 
-    // get lm scores for next tokens given the hyp->ys[:] and save to
-    // nn_lm_scores
-    std::array<int64_t, 2> x_shape{1, 1};
-    Ort::Value x = Ort::Value::CreateTensor<int64_t>(allocator_, x_shape.data(),
-                                                     x_shape.size());
-    *x.GetTensorMutableData<int64_t>() = hyp->ys.back();
-    auto lm_out = ScoreToken(std::move(x), Convert(hyp->nn_lm_states));
-    hyp->nn_lm_scores.value = std::move(lm_out.first);
-    hyp->nn_lm_states = Convert(std::move(lm_out.second));
+    // The lm scores for next tokens given hyp->ys[:] are computed later in
+    // ComputeNextLMScoresSF() so that all hyps expanded in a frame are
+    // processed in a single batch
+    hyp->nn_lm_pending = true;
+  }
+
+  void ComputeNextLMScoresSF(Hypothesis **hyps, int32_t n) {
+    if (!support_batch_) {
+      for (int32_t i = 0; i != n; ++i) {
+        RunSF(hyps + i, 1);
+      }
+      return;
+    }
+
+    // Hyps with the same previous state and the same last token have the
+    // same history, e.g., the first token of different streams, so we run
+    // the LM only once for them
+    std::map<std::pair<const NnLmState *, int64_t>, int32_t> index;
+    std::vector<Hypothesis *> unique_hyps;
+    std::vector<int32_t> hyp2unique(n);
+    unique_hyps.reserve(n);
+
+    for (int32_t i = 0; i != n; ++i) {
+      auto key = std::make_pair(hyps[i]->nn_lm_state.get(), hyps[i]->ys.back());
+      auto it = index.find(key);
+      if (it == index.end()) {
+        hyp2unique[i] = static_cast<int32_t>(unique_hyps.size());
+        index.emplace(key, hyp2unique[i]);
+        unique_hyps.push_back(hyps[i]);
+      } else {
+        hyp2unique[i] = it->second;
+      }
+    }
+
+    RunSF(unique_hyps.data(), static_cast<int32_t>(unique_hyps.size()));
+
+    for (int32_t i = 0; i != n; ++i) {
+      if (hyps[i]->nn_lm_pending) {
+        hyps[i]->nn_lm_state = unique_hyps[hyp2unique[i]]->nn_lm_state;
+        hyps[i]->nn_lm_pending = false;
+      }
+    }
   }
 
   // classic rescore function
@@ -137,6 +174,67 @@ class OnlineRnnLM::Impl {
     return {std::move(out[0]), std::move(next_states)};
   }
 
+  // Run the LM on the last token of hyps[0..n-1] in a single batch
+  // and replace their nn_lm_state with the result
+  void RunSF(Hypothesis **hyps, int32_t n) {
+    int32_t hidden_size = rnn_hidden_size_;
+    int32_t state_size = rnn_num_layers_ * hidden_size;
+
+    std::array<int64_t, 2> x_shape{n, 1};
+    Ort::Value x = Ort::Value::CreateTensor<int64_t>(allocator_, x_shape.data(),
+                                                     x_shape.size());
+    int64_t *p_x = x.GetTensorMutableData<int64_t>();
+
+    // (num_layers, n, hidden_size)
+    std::array<int64_t, 3> s_shape{rnn_num_layers_, n, hidden_size};
+    std::vector<Ort::Value> states;
+    states.reserve(2);
+    for (int32_t k = 0; k != 2; ++k) {
+      states.push_back(Ort::Value::CreateTensor<float>(
+          allocator_, s_shape.data(), s_shape.size()));
+    }
+
+    for (int32_t i = 0; i != n; ++i) {
+      p_x[i] = hyps[i]->ys.back();
+
+      for (int32_t k = 0; k != 2; ++k) {
+        const float *src = hyps[i]->nn_lm_state->states[k].data();
+        float *dst = states[k].GetTensorMutableData<float>();
+        for (int32_t l = 0; l != rnn_num_layers_; ++l) {
+          std::copy(src + l * hidden_size, src + (l + 1) * hidden_size,
+                    dst + (l * n + i) * hidden_size);
+        }
+      }
+    }
+
+    auto out = ScoreToken(std::move(x), std::move(states));
+
+    // (n, 1, vocab_size)
+    int32_t vocab_size =
+        out.first.GetTensorTypeAndShapeInfo().GetShape().back();
+    const float *p_scores = out.first.GetTensorData<float>();
+
+    for (int32_t i = 0; i != n; ++i) {
+      auto state = std::make_shared<NnLmState>();
+      state->scores.assign(p_scores + i * vocab_size,
+                           p_scores + (i + 1) * vocab_size);
+
+      state->states.resize(2);
+      for (int32_t k = 0; k != 2; ++k) {
+        const float *src = out.second[k].GetTensorData<float>();
+        auto &dst = state->states[k];
+        dst.reserve(state_size);
+        for (int32_t l = 0; l != rnn_num_layers_; ++l) {
+          const float *p = src + (l * n + i) * hidden_size;
+          dst.insert(dst.end(), p, p + hidden_size);
+        }
+      }
+
+      hyps[i]->nn_lm_state = std::move(state);
+      hyps[i]->nn_lm_pending = false;
+    }
+  }
+
   // get init states for shallow fusion
   std::pair<Ort::Value, std::vector<Ort::Value>> GetInitStatesSF() {
     std::vector<Ort::Value> ans;
@@ -161,10 +259,9 @@ class OnlineRnnLM::Impl {
 
  private:
   void Init(const OnlineLMConfig &config) {
-    auto buf = ReadFile(config_.model);
+    auto buf = MapFile(config_.model);
 
-    sess_ = std::make_unique<Ort::Session>(env_, buf.data(), buf.size(),
-                                           sess_opts_);
+    sess_ = CreateSession(env_, buf.data(), buf.size(), sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
     GetOutputNames(sess_.get(), &output_names_, &output_names_ptr_);
@@ -175,6 +272,11 @@ class OnlineRnnLM::Impl {
     SHERPA_ONNX_READ_META_DATA(rnn_hidden_size_, "hidden_size");
     SHERPA_ONNX_READ_META_DATA(sos_id_, "sos_id");
 
+    // Some models are exported with a fixed batch size of 1
+    auto x_shape =
+        sess_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    support_batch_ = x_shape.empty() || x_shape[0] != 1;
+
     ComputeInitStates();
 
     if (!config_.lodr_fst.empty()) {
@@ -208,11 +310,23 @@ class OnlineRnnLM::Impl {
     init_scores_.value = std::move(pair.first);  // only used during
                                                  // shallow fusion
     init_states_ = std::move(pair.second);
+
+    auto state = std::make_shared<NnLmState>();
+    const Ort::Value &scores = init_scores_.value;
+    const float *p = scores.GetTensorData<float>();
+    state->scores.assign(
+        p, p + scores.GetTensorTypeAndShapeInfo().GetElementCount());
+    for (const auto &s : init_states_) {
+      const float *q = s.GetTensorData<float>();
+      state->states.emplace_back(
+          q, q + s.GetTensorTypeAndShapeInfo().GetElementCount());
+    }
+    init_state_sf_ = std::move(state);
   }
 
  private:
   OnlineLMConfig config_;
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
@@ -227,6 +341,11 @@ class OnlineRnnLM::Impl {
   CopyableOrtValue init_scores_;
   std::vector<Ort::Value> init_states_;
 
+  // shared by all hyps in shallow fusion before they see any token
+  std::shared_ptr<const NnLmState> init_state_sf_;
+
+  bool support_batch_ = true;
+
   int32_t rnn_num_layers_ = 2;
   int32_t rnn_hidden_size_ = 512;
   int32_t sos_id_ = 1;
@@ -265,4 +384,8 @@ void OnlineRnnLM::ComputeLMScoreSF(float scale, Hypothesis *hyp) {
   return impl_->ComputeLMScoreSF(scale, hyp);
 }
 
+void OnlineRnnLM::ComputeNextLMScoresSF(Hypothesis **hyps, int32_t n) {
+  return impl_->ComputeNextLMScoresSF(hyps, n);
+}
+
 }  // namespace sherpa_onnx
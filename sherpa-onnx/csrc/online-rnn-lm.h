@@ -50,7 +50,7 @@ class OnlineRnnLM : public OnlineLM {
   void ComputeLMScore(float scale, int32_t context_size,
                               std::vector<Hypotheses> *hyps) override;
 
-   /** This function updates lm_lob_prob and nn_lm_scores of hyp (shallow fusion).
+   /** This function updates lm_lob_prob of hyp (shallow fusion).
    *
    * @param scale LM score
    * @param hyps It is changed in-place.
@@ -58,6 +58,8 @@ class OnlineRnnLM : public OnlineLM {
    */
   void ComputeLMScoreSF(float scale, Hypothesis *hyp) override;
 
+  void ComputeNextLMScoresSF(Hypothesis **hyps, int32_t n) override;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
@@ -0,0 +1,390 @@
+// sherpa-onnx/csrc/online-speaker-diarization-pyannote-impl.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_ONLINE_SPEAKER_DIARIZATION_PYANNOTE_IMPL_H_
+#define SHERPA_ONNX_CSRC_ONLINE_SPEAKER_DIARIZATION_PYANNOTE_IMPL_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Dense"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/offline-speaker-segmentation-pyannote-model.h"
+#include "sherpa-onnx/csrc/online-speaker-diarization-impl.h"
+#include "sherpa-onnx/csrc/online-speaker-diarization-tracker.h"
+#include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
+
+namespace sherpa_onnx {
+
+// It processes the most recent window of audio every config.step seconds:
+//
+//  (1) The segmentation model finds local speakers in the window
+//  (2) An embedding is computed for each local speaker using the frames
+//      where only this speaker is active
+//  (3) Each local speaker is mapped to a global speaker by comparing
+//      its embedding with the centroids of the global speakers. The
+//      centroids are updated incrementally.
+//  (4) Frames of the window that have not been seen before are used to
+//      extend or finish the segments of the global speakers; see
+//      OnlineSpeakerDiarizationTracker.
+//
+// Only one window of audio, one centroid per speaker and one active segment
+// per speaker are kept, so memory usage does not depend on the length of
+// the input.
+class OnlineSpeakerDiarizationPyannoteImpl
+    : public OnlineSpeakerDiarizationImpl {
+ public:
+  using Matrix2D =
+      Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  using Matrix2DInt32 =
+      Eigen::Matrix<int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  explicit OnlineSpeakerDiarizationPyannoteImpl(
+      const OnlineSpeakerDiarizationConfig &config)
+      : config_(config),
+        segmentation_model_(config_.segmentation),
+        embedding_extractor_(config_.embedding),
+        tracker_(config_, segmentation_model_.GetModelMetaData().sample_rate,
+                 segmentation_model_.GetModelMetaData().window_size) {
+    InitPowersetMapping();
+  }
+
+  template <typename Manager>
+  OnlineSpeakerDiarizationPyannoteImpl(
+      Manager *mgr, const OnlineSpeakerDiarizationConfig &config)
+      : config_(config),
+        segmentation_model_(mgr, config_.segmentation),
+        embedding_extractor_(mgr, config_.embedding),
+        tracker_(config_, segmentation_model_.GetModelMetaData().sample_rate,
+                 segmentation_model_.GetModelMetaData().window_size) {
+    InitPowersetMapping();
+  }
+
+  int32_t SampleRate() const override {
+    return segmentation_model_.GetModelMetaData().sample_rate;
+  }
+
+  void AcceptWaveform(const float *samples, int32_t n) override {
+    tracker_.AcceptWaveform(samples, n, GetProcessWindow());
+  }
+
+  void Flush() override { tracker_.Flush(GetProcessWindow()); }
+
+  bool Empty() const override { return tracker_.Empty(); }
+
+  const OfflineSpeakerDiarizationSegment &Front() const override {
+    return tracker_.Front();
+  }
+
+  void Pop() override { tracker_.Pop(); }
+
+  int32_t NumSpeakers() const override { return centroids_.size(); }
+
+  void Reset() override {
+    centroids_.clear();
+    tracker_.Reset();
+  }
+
+ private:
+  OnlineSpeakerDiarizationTracker::ProcessWindow GetProcessWindow() {
+    return [this](const float *window, int64_t offset) {
+      return ProcessWindow(window, offset);
+    };
+  }
+
+  // Same as OfflineSpeakerDiarizationPyannoteImpl::InitPowersetMapping()
+  void InitPowersetMapping() {
+    const auto &meta_data = segmentation_model_.GetModelMetaData();
+    int32_t num_classes = meta_data.num_classes;
+    int32_t powerset_max_classes = meta_data.powerset_max_classes;
+    int32_t num_speakers = meta_data.num_speakers;
+
+    powerset_mapping_ = Matrix2DInt32(num_classes, num_speakers);
+    powerset_mapping_.setZero();
+
+    int32_t k = 1;
+    for (int32_t i = 1; i <= powerset_max_classes; ++i) {
+      if (i == 1) {
+        for (int32_t j = 0; j != num_speakers; ++j, ++k) {
+          powerset_mapping_(k, j) = 1;
+        }
+      } else if (i == 2) {
+        for (int32_t j = 0; j != num_speakers; ++j) {
+          for (int32_t m = j + 1; m < num_speakers; ++m, ++k) {
+            powerset_mapping_(k, j) = 1;
+            powerset_mapping_(k, m) = 1;
+          }
+        }
+      } else {
+#if __OHOS__
+        SHERPA_ONNX_LOGE(
+            "powerset_max_classes = %{public}d is currently not supported!", i);
+#else
+        SHERPA_ONNX_LOGE(
+            "powerset_max_classes = %d is currently not supported!", i);
+#endif
+        SHERPA_ONNX_EXIT(-1);
+      }
+    }
+  }
+
+  // Return the activity of the global speakers in the window, of shape
+  // (num_frames, NumSpeakers())
+  Matrix2DInt32 ProcessWindow(const float *window, int64_t offset) {
+    Matrix2DInt32 labels = ToMultiLabel(RunSegmentationModel(window));
+    // labels: (num_frames, num_local_speakers)
+
+    std::vector<int32_t> local2global =
+        MapToGlobalSpeakers(labels, window, offset);
+
+    Matrix2DInt32 ans(labels.rows(), centroids_.size());
+    ans.setZero();
+    for (int32_t s = 0; s != labels.cols(); ++s) {
+      if (local2global[s] == -1) {
+        continue;
+      }
+
+      for (int32_t f = 0; f != labels.rows(); ++f) {
+        if (labels(f, s)) {
+          ans(f, local2global[s]) = 1;
+        }
+      }
+    }
+
+    return ans;
+  }
+
+  Matrix2D RunSegmentationModel(const float *window) const {
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    int32_t window_size = segmentation_model_.GetModelMetaData().window_size;
+    std::array<int64_t, 3> shape = {1, 1, window_size};
+
+    Ort::Value x = Ort::Value::CreateTensor(
+        memory_info, const_cast<float *>(window), window_size, shape.data(),
+        shape.size());
+
+    Ort::Value out = segmentation_model_.Forward(std::move(x));
+    std::vector<int64_t> out_shape = out.GetTensorTypeAndShapeInfo().GetShape();
+    Matrix2D m(out_shape[1], out_shape[2]);
+    std::copy(out.GetTensorData<float>(), out.GetTensorData<float>() + m.size(),
+              &m(0, 0));
+    return m;
+  }
+
+  Matrix2DInt32 ToMultiLabel(const Matrix2D &m) const {
+    int32_t num_rows = m.rows();
+    Matrix2DInt32 ans(num_rows, powerset_mapping_.cols());
+
+    std::ptrdiff_t col_id;
+
+    for (int32_t i = 0; i != num_rows; ++i) {
+      m.row(i).maxCoeff(&col_id);
+      ans.row(i) = powerset_mapping_.row(col_id);
+    }
+
+    return ans;
+  }
+
+  // Return a vector of size labels.cols(). ans[s] is the global speaker
+  // index of the local speaker s, or -1 if no embedding can be computed
+  // for it.
+  std::vector<int32_t> MapToGlobalSpeakers(const Matrix2DInt32 &labels,
+                                           const float *window,
+                                           int64_t offset) {
+    int32_t num_local_speakers = labels.cols();
+    std::vector<int32_t> ans(num_local_speakers, -1);
+
+    std::vector<int32_t> candidate_speakers;
+    std::vector<std::unique_ptr<OnlineStream>> streams;
+    std::vector<OnlineStream *> ss;
+    for (int32_t s = 0; s != num_local_speakers; ++s) {
+      auto stream = CreateEmbeddingStream(labels, s, window, offset);
+      if (stream) {
+        candidate_speakers.push_back(s);
+        ss.push_back(stream.get());
+        streams.push_back(std::move(stream));
+      }
+    }
+
+    std::vector<std::vector<float>> outputs =
+        embedding_extractor_.Compute(ss.data(), ss.size());
+
+    std::vector<int32_t> local_speakers;
+    std::vector<std::vector<float>> embeddings;
+    for (int32_t i = 0; i != static_cast<int32_t>(outputs.size()); ++i) {
+      auto &e = outputs[i];
+      if (e.empty() || std::any_of(e.begin(), e.end(),
+                                   [](float f) { return std::isnan(f); })) {
+        continue;
+      }
+
+      float norm = std::sqrt(Dot(e, e)) + 1e-12f;
+      for (auto &f : e) {
+        f /= norm;
+      }
+
+      local_speakers.push_back(candidate_speakers[i]);
+      embeddings.push_back(std::move(e));
+    }
+
+    int32_t num_valid = local_speakers.size();
+    int32_t num_global = centroids_.size();
+
+    // (similarity, local index, global index)
+    std::vector<std::tuple<float, int32_t, int32_t>> candidates;
+    candidates.reserve(num_valid * num_global);
+    for (int32_t i = 0; i != num_valid; ++i) {
+      for (int32_t g = 0; g != num_global; ++g) {
+        candidates.emplace_back(Dot(embeddings[i], centroids_[g]), i, g);
+      }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto &a, const auto &b) {
+                return std::get<0>(a) > std::get<0>(b);
+              });
+
+    // Greedy one-to-one assignment. Two local speakers in the same window
+    // are different speakers, so they must not share a global speaker.
+    std::vector<int32_t> assigned(num_valid, -1);
+    std::vector<bool> used(num_global, false);
+    for (const auto &[sim, i, g] : candidates) {
+      if (1 - sim > config_.threshold) {
+        break;
+      }
+
+      if (assigned[i] != -1 || used[g]) {
+        continue;
+      }
+
+      assigned[i] = g;
+      used[g] = true;
+    }
+
+    for (int32_t i = 0; i != num_valid; ++i) {
+      if (assigned[i] == -1) {
+        if (static_cast<int32_t>(centroids_.size()) <
+            config_.max_num_speakers) {
+          assigned[i] = centroids_.size();
+          centroids_.emplace_back(embeddings[i].size(), 0);
+        } else {
+          assigned[i] = Closest(embeddings[i]);
+        }
+      }
+
+      // Update the centroid. It is the normalized sum of all embeddings
+      // assigned to this speaker so far.
+      auto &c = centroids_[assigned[i]];
+      float norm = 0;
+      for (int32_t d = 0; d != static_cast<int32_t>(c.size()); ++d) {
+        c[d] += embeddings[i][d];
+        norm += c[d] * c[d];
+      }
+
+      norm = std::sqrt(norm) + 1e-12f;
+      for (auto &f : c) {
+        f /= norm;
+      }
+
+      ans[local_speakers[i]] = assigned[i];
+    }
+
+    return ans;
+  }
+
+  // Create a stream containing the samples of the given local speaker from
+  // the frames where only this speaker is active. Return nullptr if there
+  // are not enough frames.
+  std::unique_ptr<OnlineStream> CreateEmbeddingStream(
+      const Matrix2DInt32 &labels, int32_t speaker, const float *window,
+      int64_t offset) const {
+    int32_t window_size = segmentation_model_.GetModelMetaData().window_size;
+    int32_t num_frames = labels.rows();
+    float samples_per_frame = static_cast<float>(window_size) / num_frames;
+
+    // Samples before first_sample belong to the zero padding
+    int32_t first_sample = std::max<int64_t>(0, -offset);
+
+    std::vector<std::pair<int32_t, int32_t>> ranges;
+    int32_t num_active_frames = 0;
+    int32_t start_frame = -1;
+    for (int32_t f = 0; f <= num_frames; ++f) {
+      bool active = f < num_frames && labels(f, speaker) &&
+                    labels.row(f).sum() == 1 &&
+                    (f + 1) * samples_per_frame > first_sample;
+      if (active) {
+        num_active_frames += 1;
+        if (start_frame == -1) {
+          start_frame = f;
+        }
+      } else if (start_frame != -1) {
+        int32_t start = std::max<int32_t>(start_frame * samples_per_frame,
+                                          first_sample);
+        int32_t end = std::min<int32_t>(f * samples_per_frame, window_size);
+        ranges.emplace_back(start, end);
+        start_frame = -1;
+      }
+    }
+
+    // skip segments less than 10 frames
+    if (num_active_frames < 10) {
+      return nullptr;
+    }
+
+    int32_t sample_rate = segmentation_model_.GetModelMetaData().sample_rate;
+    auto stream = embedding_extractor_.CreateStream();
+    for (const auto &p : ranges) {
+      stream->AcceptWaveform(sample_rate, window + p.first,
+                             p.second - p.first);
+    }
+    stream->InputFinished();
+
+    if (!embedding_extractor_.IsReady(stream.get())) {
+      return nullptr;
+    }
+
+    return stream;
+  }
+
+  int32_t Closest(const std::vector<float> &embedding) const {
+    int32_t ans = 0;
+    float best = -2;
+    for (int32_t g = 0; g != static_cast<int32_t>(centroids_.size()); ++g) {
+      float sim = Dot(embedding, centroids_[g]);
+      if (sim > best) {
+        best = sim;
+        ans = g;
+      }
+    }
+    return ans;
+  }
+
+  static float Dot(const std::vector<float> &a, const std::vector<float> &b) {
+    float ans = 0;
+    for (int32_t i = 0; i != static_cast<int32_t>(a.size()); ++i) {
+      ans += a[i] * b[i];
+    }
+    return ans;
+  }
+
+  OnlineSpeakerDiarizationConfig config_;
+  OfflineSpeakerSegmentationPyannoteModel segmentation_model_;
+  SpeakerEmbeddingExtractor embedding_extractor_;
+  Matrix2DInt32 powerset_mapping_;
+
+  // centroids_[i] is the normalized centroid of speaker i
+  std::vector<std::vector<float>> centroids_;
+
+  OnlineSpeakerDiarizationTracker tracker_;
+};
+
+}  // namespace sherpa_onnx
+#endif  // SHERPA_ONNX_CSRC_ONLINE_SPEAKER_DIARIZATION_PYANNOTE_IMPL_H_
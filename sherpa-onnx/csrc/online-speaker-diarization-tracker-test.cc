@@ -0,0 +1,188 @@
+// sherpa-onnx/csrc/online-speaker-diarization-tracker-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-speaker-diarization-tracker.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static constexpr int32_t kSampleRate = 100;
+static constexpr int32_t kWindowSize = 500;  // 5 seconds
+static constexpr int32_t kNumFrames = 50;    // 0.1 second per frame
+
+using Matrix2DInt32 = OnlineSpeakerDiarizationTracker::Matrix2DInt32;
+
+// Return true if speaker s is active at time t (in seconds)
+using Activity = std::function<bool(int32_t s, float t)>;
+
+// Synthetic segmentation output. The activity of each frame is taken at
+// the center of the frame. The zero padding at the beginning is silence,
+// but the zero padding at the end is not, so that segment ends are
+// clamped to the received samples.
+static OnlineSpeakerDiarizationTracker::ProcessWindow GetProcessWindow(
+    int32_t num_speakers, const Activity &activity,
+    std::vector<int64_t> *offsets) {
+  return [=](const float * /*window*/, int64_t offset) {
+    offsets->push_back(offset);
+
+    float samples_per_frame = static_cast<float>(kWindowSize) / kNumFrames;
+    Matrix2DInt32 ans(kNumFrames, num_speakers);
+    for (int32_t f = 0; f != kNumFrames; ++f) {
+      float t = (offset + (f + 0.5f) * samples_per_frame) / kSampleRate;
+      for (int32_t s = 0; s != num_speakers; ++s) {
+        ans(f, s) = t >= 0 && activity(s, t);
+      }
+    }
+    return ans;
+  };
+}
+
+static std::vector<OfflineSpeakerDiarizationSegment> Diarize(
+    const OnlineSpeakerDiarizationConfig &config, int32_t num_samples,
+    int32_t chunk_size, int32_t num_speakers, const Activity &activity) {
+  OnlineSpeakerDiarizationTracker tracker(config, kSampleRate, kWindowSize);
+
+  std::vector<int64_t> offsets;
+  auto process = GetProcessWindow(num_speakers, activity, &offsets);
+
+  std::vector<OfflineSpeakerDiarizationSegment> ans;
+  std::vector<float> samples(chunk_size);
+  for (int32_t i = 0; i < num_samples; i += chunk_size) {
+    int32_t n = std::min(chunk_size, num_samples - i);
+    tracker.AcceptWaveform(samples.data(), n, process);
+    for (; !tracker.Empty(); tracker.Pop()) {
+      ans.push_back(tracker.Front());
+    }
+  }
+
+  tracker.Flush(process);
+  for (; !tracker.Empty(); tracker.Pop()) {
+    ans.push_back(tracker.Front());
+  }
+
+  // The window is moved by one step each time
+  for (int32_t i = 0; i != static_cast<int32_t>(offsets.size()); ++i) {
+    EXPECT_EQ(offsets[i], (i + 1) * tracker.Step() - kWindowSize);
+  }
+
+  return ans;
+}
+
+static void ExpectSegment(const OfflineSpeakerDiarizationSegment &s,
+                          float start, float end, int32_t speaker) {
+  EXPECT_NEAR(s.Start(), start, 1e-4);
+  EXPECT_NEAR(s.End(), end, 1e-4);
+  EXPECT_EQ(s.Speaker(), speaker);
+}
+
+TEST(OnlineSpeakerDiarizationTracker, TwoSpeakers) {
+  OnlineSpeakerDiarizationConfig config;
+  config.step = 2;
+
+  // Speaker 0 talks in [0, 3), speaker 1 from 4 until the end at 7.35
+  Activity activity = [](int32_t s, float t) {
+    return s == 0 ? t < 3 : t >= 4;
+  };
+
+  for (int32_t chunk_size : {1, 37, 200, 735}) {
+    auto segments = Diarize(config, 735, chunk_size, 2, activity);
+    ASSERT_EQ(segments.size(), 2) << chunk_size;
+
+    ExpectSegment(segments[0], 0, 3, 0);
+
+    // Flush() pads the last step with zeros, but the segment ends at the
+    // last received sample
+    ExpectSegment(segments[1], 4, 7.35, 1);
+  }
+}
+
+TEST(OnlineSpeakerDiarizationTracker, GapAndShortSegments) {
+  OnlineSpeakerDiarizationConfig config;
+  config.step = 1.5;
+  config.min_duration_on = 0.3;
+  config.min_duration_off = 0.5;
+
+  // A gap of 0.4 second is merged, a gap of 1 second is not,
+  // and a segment of 0.2 second is dropped
+  Activity activity = [](int32_t /*s*/, float t) {
+    return (t >= 1 && t < 2) || (t >= 2.4f && t < 3) || (t >= 4 && t < 5) ||
+           (t >= 7 && t < 7.2f);
+  };
+
+  auto segments = Diarize(config, 1000, 100, 1, activity);
+  ASSERT_EQ(segments.size(), 2);
+  ExpectSegment(segments[0], 1, 3, 0);
+  ExpectSegment(segments[1], 4, 5, 0);
+}
+
+TEST(OnlineSpeakerDiarizationTracker, MaxSegmentDuration) {
+  OnlineSpeakerDiarizationConfig config;
+  config.max_segment_duration = 10;
+
+  Activity activity = [](int32_t /*s*/, float /*t*/) { return true; };
+
+  auto segments = Diarize(config, 2500, 160, 1, activity);
+  ASSERT_EQ(segments.size(), 3);
+  ExpectSegment(segments[0], 0, 10, 0);
+  ExpectSegment(segments[1], 10, 20, 0);
+  ExpectSegment(segments[2], 20, 25, 0);
+}
+
+TEST(OnlineSpeakerDiarizationTracker, OrderedByEndTime) {
+  OnlineSpeakerDiarizationConfig config;
+  config.max_segment_duration = 10;
+  config.min_duration_off = 0.5;
+
+  // Speaker 1 stops at 9.8, but it is known only after min_duration_off,
+  // i.e., after the segment of speaker 0 is split at 10. Both speakers are
+  // still active when Flush() is called.
+  Activity activity = [](int32_t s, float t) {
+    return s == 0 || (t >= 1 && t < 9.8f) || (t >= 12 && t < 24.8f);
+  };
+
+  for (int32_t chunk_size : {100, 160, 2500}) {
+    auto segments = Diarize(config, 2500, chunk_size, 2, activity);
+    ASSERT_EQ(segments.size(), 6) << chunk_size;
+
+    ExpectSegment(segments[0], 1, 9.8, 1);
+    ExpectSegment(segments[1], 0, 10, 0);
+    ExpectSegment(segments[2], 10, 20, 0);
+    ExpectSegment(segments[3], 12, 22, 1);
+    ExpectSegment(segments[4], 22, 24.8, 1);
+    ExpectSegment(segments[5], 20, 25, 0);
+  }
+}
+
+TEST(OnlineSpeakerDiarizationTracker, Reset) {
+  OnlineSpeakerDiarizationConfig config;
+  OnlineSpeakerDiarizationTracker tracker(config, kSampleRate, kWindowSize);
+
+  std::vector<int64_t> offsets;
+  auto process = GetProcessWindow(
+      1, [](int32_t, float t) { return t < 1; }, &offsets);
+
+  std::vector<float> samples(300);
+  tracker.AcceptWaveform(samples.data(), samples.size(), process);
+  tracker.Flush(process);
+  EXPECT_FALSE(tracker.Empty());
+
+  tracker.Reset();
+  EXPECT_TRUE(tracker.Empty());
+
+  offsets.clear();
+  tracker.AcceptWaveform(samples.data(), samples.size(), process);
+  tracker.Flush(process);
+  ASSERT_FALSE(tracker.Empty());
+  ExpectSegment(tracker.Front(), 0, 1, 0);
+
+  ASSERT_FALSE(offsets.empty());
+  EXPECT_EQ(offsets[0], tracker.Step() - kWindowSize);
+}
+
+}  // namespace sherpa_onnx
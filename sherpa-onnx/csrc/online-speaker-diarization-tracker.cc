@@ -0,0 +1,177 @@
+// sherpa-onnx/csrc/online-speaker-diarization-tracker.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-speaker-diarization-tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sherpa_onnx {
+
+OnlineSpeakerDiarizationTracker::OnlineSpeakerDiarizationTracker(
+    const OnlineSpeakerDiarizationConfig &config, int32_t sample_rate,
+    int32_t window_size)
+    : config_(config), sample_rate_(sample_rate) {
+  step_ = static_cast<int32_t>(config_.step * sample_rate);
+  step_ = std::max(1, std::min(step_, window_size));
+
+  buffer_.resize(window_size);
+  pending_.reserve(step_);
+
+  Reset();
+}
+
+void OnlineSpeakerDiarizationTracker::AcceptWaveform(
+    const float *samples, int32_t n, const ProcessWindow &process) {
+  while (n > 0) {
+    int32_t k = std::min<int32_t>(n, step_ - pending_.size());
+    pending_.insert(pending_.end(), samples, samples + k);
+    samples += k;
+    n -= k;
+    num_samples_ += k;
+
+    if (static_cast<int32_t>(pending_.size()) == step_) {
+      ProcessStep(process);
+    }
+  }
+}
+
+void OnlineSpeakerDiarizationTracker::Flush(const ProcessWindow &process) {
+  if (!pending_.empty()) {
+    ProcessStep(process);
+  }
+
+  for (int32_t i = 0; i != static_cast<int32_t>(active_.size()); ++i) {
+    FinishSegment(i);
+  }
+
+  ReleaseSegments(std::numeric_limits<float>::infinity());
+}
+
+void OnlineSpeakerDiarizationTracker::Reset() {
+  std::fill(buffer_.begin(), buffer_.end(), 0);
+  offset_ = -static_cast<int64_t>(buffer_.size());
+  pending_.clear();
+  num_samples_ = 0;
+  active_.clear();
+  finished_.clear();
+  segments_.clear();
+}
+
+void OnlineSpeakerDiarizationTracker::ProcessStep(
+    const ProcessWindow &process) {
+  int32_t window_size = buffer_.size();
+  int32_t num_new_samples = pending_.size();
+
+  std::copy(buffer_.begin() + step_, buffer_.end(), buffer_.begin());
+  std::copy(pending_.begin(), pending_.end(), buffer_.end() - step_);
+  std::fill(buffer_.end() - step_ + num_new_samples, buffer_.end(), 0);
+  offset_ += step_;
+  pending_.clear();
+
+  Matrix2DInt32 activity = process(buffer_.data(), offset_);
+  // activity: (num_frames, num_speakers)
+
+  if (activity.cols() > static_cast<int32_t>(active_.size())) {
+    active_.resize(activity.cols());
+  }
+
+  int32_t num_frames = activity.rows();
+  float samples_per_frame = static_cast<float>(window_size) / num_frames;
+
+  // Only frames in the new part of the window are used
+  int32_t begin_frame = (window_size - step_) / samples_per_frame;
+  int32_t end_frame =
+      std::ceil((window_size - step_ + num_new_samples) / samples_per_frame);
+  end_frame = std::min(end_frame, num_frames);
+
+  // The last step may be padded with zeros by Flush(). Segments must not
+  // end after the last received sample.
+  float max_end = static_cast<float>(num_samples_) / sample_rate_;
+
+  // Segments finished later end after the start of the last frame used
+  // here or, if they are still active, after their current end.
+  float release_time = 0;
+
+  for (int32_t f = begin_frame; f < end_frame; ++f) {
+    if (offset_ + (f + 1) * samples_per_frame <= 0) {
+      // This frame belongs to the zero padding at the beginning
+      continue;
+    }
+
+    float start = (offset_ + f * samples_per_frame) / sample_rate_;
+    float end = (offset_ + (f + 1) * samples_per_frame) / sample_rate_;
+    start = std::max(start, 0.0f);
+    end = std::min(end, max_end);
+
+    for (int32_t s = 0; s != static_cast<int32_t>(activity.cols()); ++s) {
+      UpdateSegment(s, activity(f, s), start, end);
+    }
+
+    release_time = start;
+  }
+
+  for (const auto &s : active_) {
+    if (s.active) {
+      release_time = std::min(release_time, s.end);
+    }
+  }
+
+  ReleaseSegments(release_time);
+}
+
+void OnlineSpeakerDiarizationTracker::UpdateSegment(int32_t speaker,
+                                                    bool is_active,
+                                                    float start, float end) {
+  auto &s = active_[speaker];
+  if (is_active) {
+    if (s.active && start - s.end > config_.min_duration_off) {
+      FinishSegment(speaker);
+    }
+
+    if (!s.active) {
+      s.active = true;
+      s.start = start;
+    }
+    s.end = end;
+
+    if (s.end - s.start >= config_.max_segment_duration) {
+      FinishSegment(speaker);
+    }
+  } else if (s.active && start - s.end > config_.min_duration_off) {
+    FinishSegment(speaker);
+  }
+}
+
+void OnlineSpeakerDiarizationTracker::FinishSegment(int32_t speaker) {
+  auto &s = active_[speaker];
+  if (!s.active) {
+    return;
+  }
+
+  if (s.end - s.start > config_.min_duration_on) {
+    finished_.emplace_back(s.start, s.end, speaker);
+  }
+
+  s.active = false;
+}
+
+void OnlineSpeakerDiarizationTracker::ReleaseSegments(float t) {
+  std::stable_sort(finished_.begin(), finished_.end(),
+                   [](const OfflineSpeakerDiarizationSegment &a,
+                      const OfflineSpeakerDiarizationSegment &b) {
+                     return a.End() < b.End();
+                   });
+
+  auto it = finished_.begin();
+  while (it != finished_.end() && it->End() <= t) {
+    segments_.push_back(*it);
+    ++it;
+  }
+
+  finished_.erase(finished_.begin(), it);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,110 @@
+// sherpa-onnx/csrc/online-speaker-diarization-tracker.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_SPEAKER_DIARIZATION_TRACKER_H_
+#define SHERPA_ONNX_CSRC_ONLINE_SPEAKER_DIARIZATION_TRACKER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "Eigen/Dense"
+#include "sherpa-onnx/csrc/offline-speaker-diarization-result.h"
+#include "sherpa-onnx/csrc/online-speaker-diarization.h"
+
+namespace sherpa_onnx {
+
+// The model independent part of streaming speaker diarization.
+//
+// It keeps the most recent window of audio, invokes a callback every
+// config.step seconds to get the activity of the global speakers in the
+// window, and turns the activity of frames that have not been seen before
+// into finished segments, which are ordered by end time.
+class OnlineSpeakerDiarizationTracker {
+ public:
+  using Matrix2DInt32 =
+      Eigen::Matrix<int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  // Return the activity of the global speakers in window, which has
+  // window_size samples, as a matrix of shape (num_frames, num_speakers).
+  // num_speakers must not decrease between calls.
+  //
+  // offset is the index of window[0] in the input. It is negative at the
+  // beginning, where the window is padded with zeros.
+  using ProcessWindow =
+      std::function<Matrix2DInt32(const float *window, int64_t offset)>;
+
+  OnlineSpeakerDiarizationTracker(const OnlineSpeakerDiarizationConfig &config,
+                                  int32_t sample_rate, int32_t window_size);
+
+  // In samples
+  int32_t Step() const { return step_; }
+
+  void AcceptWaveform(const float *samples, int32_t n,
+                      const ProcessWindow &process);
+
+  // Process the remaining samples and finish all active segments
+  void Flush(const ProcessWindow &process);
+
+  bool Empty() const { return segments_.empty(); }
+
+  const OfflineSpeakerDiarizationSegment &Front() const {
+    return segments_.front();
+  }
+
+  void Pop() { segments_.pop_front(); }
+
+  void Reset();
+
+ private:
+  struct ActiveSegment {
+    bool active = false;
+    float start = 0;  // in seconds
+    float end = 0;    // in seconds
+  };
+
+  // Process the samples in pending_. If pending_ contains fewer than step_
+  // samples, it is padded with zeros.
+  void ProcessStep(const ProcessWindow &process);
+
+  void UpdateSegment(int32_t speaker, bool is_active, float start, float end);
+
+  void FinishSegment(int32_t speaker);
+
+  // Move segments in finished_ that end no later than t to segments_
+  void ReleaseSegments(float t);
+
+ private:
+  OnlineSpeakerDiarizationConfig config_;
+  int32_t sample_rate_ = 0;
+  int32_t step_ = 0;  // in samples
+
+  // The most recent window of audio samples
+  std::vector<float> buffer_;
+
+  // Index of buffer_[0] in the input
+  int64_t offset_ = 0;
+
+  // Samples that have not been moved into buffer_ yet
+  std::vector<float> pending_;
+
+  // Number of samples received so far
+  int64_t num_samples_ = 0;
+
+  // active_[i] is the current segment of speaker i
+  std::vector<ActiveSegment> active_;
+
+  // Finished segments that may still be followed by a segment that ends
+  // earlier, e.g., when a segment is split at max_segment_duration while
+  // another speaker has stopped but min_duration_off has not passed yet.
+  std::vector<OfflineSpeakerDiarizationSegment> finished_;
+
+  // Finished segments ready to be returned, ordered by end time
+  std::deque<OfflineSpeakerDiarizationSegment> segments_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_SPEAKER_DIARIZATION_TRACKER_H_
@@ -0,0 +1,120 @@
+// sherpa-onnx/csrc/online-speaker-diarization.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_SPEAKER_DIARIZATION_H_
+#define SHERPA_ONNX_CSRC_ONLINE_SPEAKER_DIARIZATION_H_
+
+#include <memory>
+#include <string>
+
+#include "sherpa-onnx/csrc/offline-speaker-diarization-result.h"
+#include "sherpa-onnx/csrc/offline-speaker-segmentation-model-config.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
+
+namespace sherpa_onnx {
+
+struct OnlineSpeakerDiarizationConfig {
+  OfflineSpeakerSegmentationModelConfig segmentation;
+  SpeakerEmbeddingExtractorConfig embedding;
+
+  // Cosine distance threshold, i.e., 1 - cosine similarity.
+  // If the distance between an embedding and all existing speakers is
+  // larger than this value, a new speaker is created.
+  //
+  // The smaller, the more speakers it will generate.
+  float threshold = 0.5;
+
+  // Maximum number of speakers to track. Once reached, new embeddings are
+  // assigned to the closest existing speaker.
+  int32_t max_num_speakers = 20;
+
+  // The segmentation model is run once every step seconds on the most
+  // recent window of audio. A smaller value reduces latency but
+  // increases computation.
+  float step = 2.0;  // in seconds
+
+  // if a segment is less than this value, then it is discarded
+  float min_duration_on = 0.3;  // in seconds
+
+  // if the gap between two segments of the same speaker is less than this
+  // value, then these two segments are merged into a single segment.
+  float min_duration_off = 0.5;  // in seconds
+
+  // A segment that is still active after this duration is emitted and a
+  // new segment is started. It bounds the latency for long monologues.
+  float max_segment_duration = 10;  // in seconds
+
+  OnlineSpeakerDiarizationConfig() = default;
+
+  OnlineSpeakerDiarizationConfig(
+      const OfflineSpeakerSegmentationModelConfig &segmentation,
+      const SpeakerEmbeddingExtractorConfig &embedding, float threshold,
+      int32_t max_num_speakers, float step, float min_duration_on,
+      float min_duration_off, float max_segment_duration)
+      : segmentation(segmentation),
+        embedding(embedding),
+        threshold(threshold),
+        max_num_speakers(max_num_speakers),
+        step(step),
+        min_duration_on(min_duration_on),
+        min_duration_off(min_duration_off),
+        max_segment_duration(max_segment_duration) {}
+
+  void Register(ParseOptions *po);
+  bool Validate() const;
+  std::string ToString() const;
+};
+
+class OnlineSpeakerDiarizationImpl;
+
+// Streaming speaker diarization.
+//
+// Audio samples are accepted incrementally. Speaker-labelled segments become
+// available once they are finished, i.e., once the speaker has been silent
+// for more than min_duration_off seconds or the segment exceeds
+// max_segment_duration seconds. Memory usage does not grow with the length
+// of the input.
+class OnlineSpeakerDiarization {
+ public:
+  explicit OnlineSpeakerDiarization(
+      const OnlineSpeakerDiarizationConfig &config);
+
+  template <typename Manager>
+  OnlineSpeakerDiarization(Manager *mgr,
+                           const OnlineSpeakerDiarizationConfig &config);
+
+  ~OnlineSpeakerDiarization();
+
+  // Expected sample rate of the input audio samples
+  int32_t SampleRate() const;
+
+  void AcceptWaveform(const float *samples, int32_t n);
+
+  // Process the remaining buffered samples and finish all active segments.
+  // Call it when there is no more input.
+  void Flush();
+
+  // Return true if there are no finished segments available
+  bool Empty() const;
+
+  // Return the first finished segment. Segments are ordered by end time.
+  const OfflineSpeakerDiarizationSegment &Front() const;
+
+  // Remove the first finished segment
+  void Pop();
+
+  // Number of speakers found so far
+  int32_t NumSpeakers() const;
+
+  // Clear all states, including the speakers found so far
+  void Reset();
+
+ private:
+  std::unique_ptr<OnlineSpeakerDiarizationImpl> impl_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_SPEAKER_DIARIZATION_H_
@@ -69,6 +69,8 @@ class OnlineStream::Impl {
 
   OnlineTransducerDecoderResult &GetResult() { return result_; }
 
+  OnlineResultBuilder &GetResultBuilder() { return result_builder_; }
+
   void SetKeywordResult(const TransducerKeywordResult &r) {
     keyword_result_ = r;
   }
@@ -149,6 +151,7 @@ class OnlineStream::Impl {
   int32_t start_frame_index_ = 0;     // never reset
   int32_t segment_ = 0;
   OnlineTransducerDecoderResult result_;
+  OnlineResultBuilder result_builder_;
   TransducerKeywordResult prev_keyword_result_;
   TransducerKeywordResult keyword_result_;
   TransducerKeywordResult empty_keyword_result_;
@@ -211,6 +214,10 @@ OnlineTransducerDecoderResult &OnlineStream::GetResult() {
   return impl_->GetResult();
 }
 
+OnlineResultBuilder &OnlineStream::GetResultBuilder() {
+  return impl_->GetResultBuilder();
+}
+
 void OnlineStream::SetKeywordResult(const TransducerKeywordResult &r) {
   impl_->SetKeywordResult(r);
 }
@@ -14,6 +14,7 @@
 #include "sherpa-onnx/csrc/features.h"
 #include "sherpa-onnx/csrc/online-ctc-decoder.h"
 #include "sherpa-onnx/csrc/online-paraformer-decoder.h"
+#include "sherpa-onnx/csrc/online-result-builder.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 
 namespace sherpa_onnx {
@@ -79,6 +80,10 @@ class OnlineStream {
   void SetResult(const OnlineTransducerDecoderResult &r);
   OnlineTransducerDecoderResult &GetResult();
 
+  // Caches the text and tokens of the transducer result across
+  // calls of OnlineRecognizer::GetResult()
+  OnlineResultBuilder &GetResultBuilder();
+
   void SetKeywordResult(const TransducerKeywordResult &r);
   TransducerKeywordResult &GetKeywordResult(bool remove_duplicates = false);
 
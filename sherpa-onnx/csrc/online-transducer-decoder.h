@@ -50,6 +50,19 @@ struct OnlineTransducerDecoderResult {
       OnlineTransducerDecoderResult &&other) noexcept;
 };
 
+// The best path of an OnlineTransducerDecoderResult without the blanks
+// added by OnlineTransducerDecoder::GetEmptyResult(). It refers to data
+// owned by the result and is invalidated when the result is changed.
+struct OnlineTransducerBestPath {
+  const int64_t *tokens = nullptr;
+  int32_t num_tokens = 0;
+
+  const std::vector<int32_t> *timestamps = nullptr;
+  const std::vector<float> *ys_probs = nullptr;
+  const std::vector<float> *lm_probs = nullptr;
+  const std::vector<float> *context_scores = nullptr;
+};
+
 class OnlineStream;
 class OnlineTransducerDecoder {
  public:
@@ -70,6 +83,21 @@ class OnlineTransducerDecoder {
   virtual void StripLeadingBlanks(OnlineTransducerDecoderResult * /*r*/) const {
   }
 
+  /** Return the best path of r with blanks added by `GetEmptyResult()`
+   * stripped. Unlike `StripLeadingBlanks()`, it does not copy anything.
+   */
+  virtual OnlineTransducerBestPath GetBestPath(
+      const OnlineTransducerDecoderResult &r) const {
+    OnlineTransducerBestPath p;
+    p.tokens = r.tokens.data();
+    p.num_tokens = static_cast<int32_t>(r.tokens.size());
+    p.timestamps = &r.timestamps;
+    p.ys_probs = &r.ys_probs;
+    p.lm_probs = &r.lm_probs;
+    p.context_scores = &r.context_scores;
+    return p;
+  }
+
   /** Run transducer beam search given the output from the encoder model.
    *
    * @param encoder_out A 3-D tensor of shape (N, T, joiner_dim)
@@ -71,6 +71,20 @@ void OnlineTransducerGreedySearchDecoder::StripLeadingBlanks(
   r->tokens = std::vector<int64_t>(start, end);
 }
 
+OnlineTransducerBestPath OnlineTransducerGreedySearchDecoder::GetBestPath(
+    const OnlineTransducerDecoderResult &r) const {
+  int32_t context_size = model_->ContextSize();
+
+  OnlineTransducerBestPath p;
+  p.tokens = r.tokens.data() + context_size;
+  p.num_tokens = static_cast<int32_t>(r.tokens.size()) - context_size;
+  p.timestamps = &r.timestamps;
+  p.ys_probs = &r.ys_probs;
+  p.lm_probs = &r.lm_probs;
+  p.context_scores = &r.context_scores;
+  return p;
+}
+
 void OnlineTransducerGreedySearchDecoder::Decode(
     Ort::Value encoder_out,
     std::vector<OnlineTransducerDecoderResult> *result) {
@@ -27,6 +27,9 @@ class OnlineTransducerGreedySearchDecoder : public OnlineTransducerDecoder {
 
   void StripLeadingBlanks(OnlineTransducerDecoderResult *r) const override;
 
+  OnlineTransducerBestPath GetBestPath(
+      const OnlineTransducerDecoderResult &r) const override;
+
   void Decode(Ort::Value encoder_out,
               std::vector<OnlineTransducerDecoderResult> *result) override;
 
@@ -37,7 +37,7 @@ class OnlineTransducerModel {
    * @return Return a single value representing the batched state.
    */
   virtual std::vector<Ort::Value> StackStates(
-      const std::vector<std::vector<Ort::Value>> &states) const = 0;
+      std::vector<std::vector<Ort::Value>> states) const = 0;
 
   /** Unstack a batch state into a list of individual states.
    *
@@ -47,7 +47,7 @@ class OnlineTransducerModel {
    * @return ans[i] contains the state for the i-th utterance.
    */
   virtual std::vector<std::vector<Ort::Value>> UnStackStates(
-      const std::vector<Ort::Value> &states) const = 0;
+      std::vector<Ort::Value> states) const = 0;
 
   /** Get the initial encoder states.
    *
@@ -68,6 +68,22 @@ void OnlineTransducerModifiedBeamSearchDecoder::StripLeadingBlanks(
   r->num_trailing_blanks = hyp.num_trailing_blanks;
 }
 
+OnlineTransducerBestPath
+OnlineTransducerModifiedBeamSearchDecoder::GetBestPath(
+    const OnlineTransducerDecoderResult &r) const {
+  int32_t context_size = model_->ContextSize();
+  const auto &hyp = r.hyps.GetMostProbable(true);
+
+  OnlineTransducerBestPath p;
+  p.tokens = hyp.ys.data() + context_size;
+  p.num_tokens = static_cast<int32_t>(hyp.ys.size()) - context_size;
+  p.timestamps = &hyp.timestamps;
+  p.ys_probs = &hyp.ys_probs;
+  p.lm_probs = &hyp.lm_probs;
+  p.context_scores = &hyp.context_scores;
+  return p;
+}
+
 void OnlineTransducerModifiedBeamSearchDecoder::Decode(
     Ort::Value encoder_out,
     std::vector<OnlineTransducerDecoderResult> *result) {
@@ -238,6 +254,22 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
       cur.push_back(std::move(hyps));
       p_logprob += (end - start) * vocab_size;
     }  // for (int32_t b = 0; b != batch_size; ++b)
+
+    if (lm_ && shallow_fusion_) {
+      // Run the LM on new tokens of all streams in a single batch
+      std::vector<Hypothesis *> pending;
+      for (auto &hyps : cur) {
+        for (auto &h : hyps) {
+          if (h.second.nn_lm_pending) {
+            pending.push_back(&h.second);
+          }
+        }
+      }
+
+      if (!pending.empty()) {
+        lm_->ComputeNextLMScoresSF(pending.data(), pending.size());
+      }
+    }
   }    // for (int32_t t = 0; t != num_frames; ++t)
 
   // classic lm rescore
@@ -39,6 +39,9 @@ class OnlineTransducerModifiedBeamSearchDecoder
 
   void StripLeadingBlanks(OnlineTransducerDecoderResult *r) const override;
 
+  OnlineTransducerBestPath GetBestPath(
+      const OnlineTransducerDecoderResult &r) const override;
+
   void Decode(Ort::Value encoder_out,
               std::vector<OnlineTransducerDecoderResult> *result) override;
 
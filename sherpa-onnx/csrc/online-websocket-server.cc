@@ -5,6 +5,7 @@
 #include "asio.hpp"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-websocket-server-impl.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 
 static constexpr const char *kUsageMessage = R"(
@@ -60,7 +61,9 @@ int32_t main(int32_t argc, char *argv[]) {
     exit(EXIT_FAILURE);
   }
 
-  po.Read(argc, argv);
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
 
   if (po.NumArgs() != 0) {
     SHERPA_ONNX_LOGE("Unrecognized positional arguments!");
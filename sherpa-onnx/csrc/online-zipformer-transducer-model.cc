@@ -27,6 +27,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/unbind.h"
@@ -35,22 +36,22 @@ namespace sherpa_onnx {
 
 OnlineZipformerTransducerModel::OnlineZipformerTransducerModel(
     const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       config_(config),
       sess_opts_(GetSessionOptions(config)),
       allocator_{} {
   {
-    auto buf = ReadFile(config.transducer.encoder);
+    auto buf = MapFile(config.transducer.encoder);
     InitEncoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.decoder);
+    auto buf = MapFile(config.transducer.decoder);
     InitDecoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.joiner);
+    auto buf = MapFile(config.transducer.joiner);
     InitJoiner(buf.data(), buf.size());
   }
 }
@@ -58,7 +59,7 @@ OnlineZipformerTransducerModel::OnlineZipformerTransducerModel(
 template <typename Manager>
 OnlineZipformerTransducerModel::OnlineZipformerTransducerModel(
     Manager *mgr, const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       config_(config),
       sess_opts_(GetSessionOptions(config)),
       allocator_{} {
@@ -78,10 +79,10 @@ OnlineZipformerTransducerModel::OnlineZipformerTransducerModel(
   }
 }
 
-void OnlineZipformerTransducerModel::InitEncoder(void *model_data,
+void OnlineZipformerTransducerModel::InitEncoder(const void *model_data,
                                                  size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -140,10 +141,10 @@ void OnlineZipformerTransducerModel::InitEncoder(void *model_data,
   }
 }
 
-void OnlineZipformerTransducerModel::InitDecoder(void *model_data,
+void OnlineZipformerTransducerModel::InitDecoder(const void *model_data,
                                                  size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -169,10 +170,9 @@ void OnlineZipformerTransducerModel::InitDecoder(void *model_data,
   SHERPA_ONNX_READ_META_DATA(context_size_, "context_size");
 }
 
-void OnlineZipformerTransducerModel::InitJoiner(void *model_data,
+void OnlineZipformerTransducerModel::InitJoiner(const void *model_data,
                                                 size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                model_data_length, sess_opts_);
+  joiner_sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
@@ -195,7 +195,7 @@ void OnlineZipformerTransducerModel::InitJoiner(void *model_data,
 }
 
 std::vector<Ort::Value> OnlineZipformerTransducerModel::StackStates(
-    const std::vector<std::vector<Ort::Value>> &states) const {
+    std::vector<std::vector<Ort::Value>> states) const {
   int32_t batch_size = static_cast<int32_t>(states.size());
   int32_t num_encoders = static_cast<int32_t>(num_encoder_layers_.size());
 
@@ -280,7 +280,7 @@ std::vector<Ort::Value> OnlineZipformerTransducerModel::StackStates(
 
 std::vector<std::vector<Ort::Value>>
 OnlineZipformerTransducerModel::UnStackStates(
-    const std::vector<Ort::Value> &states) const {
+    std::vector<Ort::Value> states) const {
   assert(states.size() == num_encoder_layers_.size() * 7);
 
   int32_t batch_size = states[0].GetTensorTypeAndShapeInfo().GetShape()[1];
@@ -21,8 +21,10 @@
 
 #include "sherpa-onnx/csrc/cat.h"
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/io-binding-runner.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/unbind.h"
@@ -33,11 +35,11 @@ class OnlineZipformer2CtcModel::Impl {
  public:
   explicit Impl(const OnlineModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     {
-      auto buf = ReadFile(config.zipformer2_ctc.model);
+      auto buf = MapFile(config.zipformer2_ctc.model);
       Init(buf.data(), buf.size());
     }
   }
@@ -45,7 +47,7 @@ class OnlineZipformer2CtcModel::Impl {
   template <typename Manager>
   Impl(Manager *mgr, const OnlineModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     {
@@ -64,8 +66,15 @@ class OnlineZipformer2CtcModel::Impl {
       inputs.push_back(std::move(v));
     }
 
-    return sess_->Run({}, input_names_ptr_.data(), inputs.data(), inputs.size(),
-                      output_names_ptr_.data(), output_names_ptr_.size());
+    auto out = runner_->Run(inputs.data(), inputs.size());
+
+    // Reuse the memory of the input states for the next states of the next
+    // chunk. Initial states are views and are skipped by the runner.
+    for (int32_t i = 1; i != static_cast<int32_t>(inputs.size()); ++i) {
+      runner_->Recycle(std::move(inputs[i]));
+    }
+
+    return out;
   }
 
   int32_t VocabSize() const { return vocab_size_; }
@@ -247,9 +256,8 @@ class OnlineZipformer2CtcModel::Impl {
   }
 
  private:
-  void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+  void Init(const void *model_data, size_t model_data_length) {
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -314,6 +322,12 @@ class OnlineZipformer2CtcModel::Impl {
     }
 
     InitStates();
+
+    runner_ = std::make_unique<IoBindingRunner>(
+        sess_.get(), input_names_ptr_, output_names_ptr_, allocator_);
+    for (const auto &s : initial_states_) {
+      runner_->AddSharedTensor(s);
+    }
   }
 
   void InitStates() {
@@ -400,11 +414,12 @@ class OnlineZipformer2CtcModel::Impl {
 
  private:
   OnlineModelConfig config_;
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
   std::unique_ptr<Ort::Session> sess_;
+  std::unique_ptr<IoBindingRunner> runner_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
@@ -0,0 +1,140 @@
+// sherpa-onnx/csrc/online-zipformer2-transducer-model-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-zipformer2-transducer-model.h"
+
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/onnx-model-builder.h"
+#include "sherpa-onnx/csrc/onnx-utils.h"
+
+namespace sherpa_onnx {
+
+static constexpr int32_t kNumStates = 8;  // 6 * num_encoder_layers + 2
+
+// An encoder with one layer that returns its input states as the next
+// states. The first state, which the test checks, has a shape that no
+// other state has.
+static std::string BuildEncoder() {
+  std::vector<std::string> nodes = {
+      OnnxNode("Identity", {"x"}, {"encoder_out"})};
+  std::vector<std::string> inputs = {OnnxValueInfo("x")};
+  std::vector<std::string> outputs = {OnnxValueInfo("encoder_out")};
+
+  for (int32_t i = 0; i != kNumStates; ++i) {
+    // The last state is processed_lens
+    int32_t type = i == kNumStates - 1 ? kOnnxInt64 : kOnnxFloat;
+
+    std::string in = "state_" + std::to_string(i);
+    std::string out = "new_state_" + std::to_string(i);
+
+    nodes.push_back(OnnxNode("Identity", {in}, {out}));
+    inputs.push_back(OnnxValueInfo(in, {}, type));
+    outputs.push_back(OnnxValueInfo(out, {}, type));
+  }
+
+  return OnnxModel(nodes, inputs, outputs,
+                   {{"encoder_dims", "4"},
+                    {"query_head_dims", "2"},
+                    {"value_head_dims", "3"},
+                    {"num_heads", "1"},
+                    {"num_encoder_layers", "1"},
+                    {"cnn_module_kernels", "3"},
+                    {"left_context_len", "2"},
+                    {"T", "9"},
+                    {"decode_chunk_len", "4"}});
+}
+
+static std::string BuildDecoder() {
+  return OnnxModel({OnnxNode("Identity", {"y"}, {"decoder_out"})},
+                   {OnnxValueInfo("y", {}, kOnnxInt64)},
+                   {OnnxValueInfo("decoder_out", {}, kOnnxInt64)},
+                   {{"vocab_size", "5"}, {"context_size", "2"}});
+}
+
+static std::string BuildJoiner() {
+  return OnnxModel(
+      {OnnxNode("Add", {"encoder_out", "decoder_out"}, {"logit"})},
+      {OnnxValueInfo("encoder_out"), OnnxValueInfo("decoder_out")},
+      {OnnxValueInfo("logit")});
+}
+
+static void WriteModel(const std::string &filename, const std::string &model) {
+  std::ofstream os(filename, std::ios::binary);
+  os.write(model.data(), model.size());
+}
+
+// With a single stream, the states of a chunk are passed to the encoder
+// and back without copies, so the encoder writes the next states into the
+// buffers of the states of the previous chunk.
+TEST(OnlineZipformer2TransducerModel, SingleStreamReusesStates) {
+  OnlineModelConfig config;
+  config.transducer.encoder = "zipformer2-test-encoder.onnx";
+  config.transducer.decoder = "zipformer2-test-decoder.onnx";
+  config.transducer.joiner = "zipformer2-test-joiner.onnx";
+
+  WriteModel(config.transducer.encoder, BuildEncoder());
+  WriteModel(config.transducer.decoder, BuildDecoder());
+  WriteModel(config.transducer.joiner, BuildJoiner());
+
+  {
+    OnlineZipformer2TransducerModel model(config);
+    model.SetFeatureDim(80);
+
+    std::vector<Ort::Value> states = model.GetEncoderInitStates();
+    ASSERT_EQ(static_cast<int32_t>(states.size()), kNumStates);
+    Fill<float>(&states[0], 1.5);
+
+    std::array<int64_t, 3> x_shape{1, model.ChunkSize(), 80};
+    std::array<int64_t, 1> processed_frames_shape{1};
+
+    std::unordered_set<const void *> buffers;
+    const void *prev = nullptr;
+    for (int32_t i = 0; i != 10; ++i) {
+      Ort::Value x = Ort::Value::CreateTensor<float>(
+          model.Allocator(), x_shape.data(), x_shape.size());
+      Fill<float>(&x, 0);
+
+      Ort::Value processed_frames = Ort::Value::CreateTensor<int64_t>(
+          model.Allocator(), processed_frames_shape.data(),
+          processed_frames_shape.size());
+      Fill<int64_t>(&processed_frames, 0);
+
+      std::vector<std::vector<Ort::Value>> states_vec;
+      states_vec.push_back(std::move(states));
+
+      auto pair = model.RunEncoder(std::move(x),
+                                   model.StackStates(std::move(states_vec)),
+                                   std::move(processed_frames));
+
+      auto next_states = model.UnStackStates(std::move(pair.second));
+      ASSERT_EQ(next_states.size(), 1u);
+      states = std::move(next_states[0]);
+
+      const float *p = states[0].GetTensorData<float>();
+      EXPECT_EQ(p[0], 1.5f);
+
+      const void *cur = states[0].GetTensorRawData();
+      EXPECT_NE(cur, prev);
+      prev = cur;
+      buffers.insert(cur);
+    }
+
+    // The initial state and the output of the first chunk
+    EXPECT_EQ(buffers.size(), 2u);
+  }
+
+  std::remove(config.transducer.encoder.c_str());
+  std::remove(config.transducer.decoder.c_str());
+  std::remove(config.transducer.joiner.c_str());
+}
+
+}  // namespace sherpa_onnx
@@ -29,6 +29,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/unbind.h"
@@ -37,24 +38,24 @@ namespace sherpa_onnx {
 
 OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
     const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       encoder_sess_opts_(GetSessionOptions(config)),
       decoder_sess_opts_(GetSessionOptions(config, "decoder")),
       joiner_sess_opts_(GetSessionOptions(config, "joiner")),
       config_(config),
       allocator_{} {
   {
-    auto buf = ReadFile(config.transducer.encoder);
+    auto buf = MapFile(config.transducer.encoder);
     InitEncoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.decoder);
+    auto buf = MapFile(config.transducer.decoder);
     InitDecoder(buf.data(), buf.size());
   }
 
   {
-    auto buf = ReadFile(config.transducer.joiner);
+    auto buf = MapFile(config.transducer.joiner);
     InitJoiner(buf.data(), buf.size());
   }
 }
@@ -62,7 +63,7 @@ OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
 template <typename Manager>
 OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
     Manager *mgr, const OnlineModelConfig &config)
-    : env_(ORT_LOGGING_LEVEL_ERROR),
+    : env_(GetOrtEnv()),
       config_(config),
       encoder_sess_opts_(GetSessionOptions(config)),
       decoder_sess_opts_(GetSessionOptions(config)),
@@ -84,10 +85,10 @@ OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
   }
 }
 
-void OnlineZipformer2TransducerModel::InitEncoder(void *model_data,
+void OnlineZipformer2TransducerModel::InitEncoder(const void *model_data,
                                                   size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, encoder_sess_opts_);
+  encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                encoder_sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -95,6 +96,10 @@ void OnlineZipformer2TransducerModel::InitEncoder(void *model_data,
   GetOutputNames(encoder_sess_.get(), &encoder_output_names_,
                  &encoder_output_names_ptr_);
 
+  encoder_runner_ = std::make_unique<IoBindingRunner>(
+      encoder_sess_.get(), encoder_input_names_ptr_, encoder_output_names_ptr_,
+      allocator_);
+
   // get meta data
   Ort::ModelMetadata meta_data = encoder_sess_->GetModelMetadata();
   if (config_.debug) {
@@ -157,10 +162,10 @@ void OnlineZipformer2TransducerModel::InitEncoder(void *model_data,
   }
 }
 
-void OnlineZipformer2TransducerModel::InitDecoder(void *model_data,
+void OnlineZipformer2TransducerModel::InitDecoder(const void *model_data,
                                                   size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, decoder_sess_opts_);
+  decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                decoder_sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -182,10 +187,10 @@ void OnlineZipformer2TransducerModel::InitDecoder(void *model_data,
   SHERPA_ONNX_READ_META_DATA(context_size_, "context_size");
 }
 
-void OnlineZipformer2TransducerModel::InitJoiner(void *model_data,
+void OnlineZipformer2TransducerModel::InitJoiner(const void *model_data,
                                                  size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, joiner_sess_opts_);
+  joiner_sess_ = CreateSession(env_, model_data, model_data_length,
+                               joiner_sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
@@ -204,8 +209,13 @@ void OnlineZipformer2TransducerModel::InitJoiner(void *model_data,
 }
 
 std::vector<Ort::Value> OnlineZipformer2TransducerModel::StackStates(
-    const std::vector<std::vector<Ort::Value>> &states) const {
+    std::vector<std::vector<Ort::Value>> states) const {
   int32_t batch_size = static_cast<int32_t>(states.size());
+  if (batch_size == 1) {
+    // No copy, so that the buffers recycled by encoder_runner_ are passed
+    // from chunk to chunk
+    return std::move(states[0]);
+  }
 
   std::vector<const Ort::Value *> buf(batch_size);
 
@@ -281,7 +291,7 @@ std::vector<Ort::Value> OnlineZipformer2TransducerModel::StackStates(
 
 std::vector<std::vector<Ort::Value>>
 OnlineZipformer2TransducerModel::UnStackStates(
-    const std::vector<Ort::Value> &states) const {
+    std::vector<Ort::Value> states) const {
   int32_t m = std::accumulate(num_encoder_layers_.begin(),
                               num_encoder_layers_.end(), 0);
   assert(static_cast<int32_t>(states.size()) == m * 6 + 2);
@@ -294,6 +304,11 @@ OnlineZipformer2TransducerModel::UnStackStates(
   std::vector<std::vector<Ort::Value>> ans;
   ans.resize(batch_size);
 
+  if (batch_size == 1) {
+    ans[0] = std::move(states);
+    return ans;
+  }
+
   for (int32_t i = 0; i != m; ++i) {
     {
       auto v = Unbind(allocator, &states[i * 6], 1);
@@ -464,10 +479,14 @@ OnlineZipformer2TransducerModel::RunEncoder(Ort::Value features,
     encoder_inputs.push_back(std::move(v));
   }
 
-  auto encoder_out = encoder_sess_->Run(
-      {}, encoder_input_names_ptr_.data(), encoder_inputs.data(),
-      encoder_inputs.size(), encoder_output_names_ptr_.data(),
-      encoder_output_names_ptr_.size());
+  auto encoder_out =
+      encoder_runner_->Run(encoder_inputs.data(), encoder_inputs.size());
+
+  // The input states are created by StackStates() and are not used any
+  // more. Their memory is reused for the next states of the next chunk.
+  for (int32_t i = 1; i != static_cast<int32_t>(encoder_inputs.size()); ++i) {
+    encoder_runner_->Recycle(std::move(encoder_inputs[i]));
+  }
 
   std::vector<Ort::Value> next_states;
   next_states.reserve(states.size());
@@ -0,0 +1,133 @@
+// sherpa-onnx/csrc/onnx-model-builder.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONNX_MODEL_BUILDER_H_
+#define SHERPA_ONNX_CSRC_ONNX_MODEL_BUILDER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Helpers to build small ONNX models in tests. They write the protobuf
+// messages directly, so tests do not depend on onnx or protobuf.
+
+namespace sherpa_onnx {
+
+inline void WriteVarint(uint64_t v, std::string *s) {
+  while (v >= 0x80) {
+    s->push_back(static_cast<char>((v & 0x7f) | 0x80));
+    v >>= 7;
+  }
+  s->push_back(static_cast<char>(v));
+}
+
+// Append a varint field of a protobuf message
+inline void WriteInt(int32_t field, uint64_t v, std::string *s) {
+  WriteVarint(field << 3, s);
+  WriteVarint(v, s);
+}
+
+// Append a length-delimited field, i.e., a string or a message
+inline void WriteBytes(int32_t field, const std::string &v, std::string *s) {
+  WriteVarint((field << 3) | 2, s);
+  WriteVarint(v.size(), s);
+  s->append(v);
+}
+
+// ElemType of TensorProto
+constexpr int32_t kOnnxFloat = 1;
+constexpr int32_t kOnnxInt64 = 7;
+
+// ValueInfoProto of a tensor. If shape is empty, the shape is left
+// unspecified, so tensors of any shape are accepted.
+inline std::string OnnxValueInfo(const std::string &name,
+                                 const std::vector<int64_t> &shape = {},
+                                 int32_t elem_type = kOnnxFloat) {
+  std::string tensor_type;
+  WriteInt(1, elem_type, &tensor_type);
+
+  if (!shape.empty()) {
+    std::string tensor_shape;
+    for (auto d : shape) {
+      std::string dim;
+      WriteInt(1, d, &dim);
+      WriteBytes(1, dim, &tensor_shape);
+    }
+    WriteBytes(2, tensor_shape, &tensor_type);
+  }
+
+  std::string type;
+  WriteBytes(1, tensor_type, &type);
+
+  std::string ans;
+  WriteBytes(1, name, &ans);
+  WriteBytes(2, type, &ans);
+  return ans;
+}
+
+// NodeProto
+inline std::string OnnxNode(const std::string &op_type,
+                            const std::vector<std::string> &inputs,
+                            const std::vector<std::string> &outputs) {
+  std::string ans;
+  for (const auto &i : inputs) {
+    WriteBytes(1, i, &ans);
+  }
+
+  for (const auto &o : outputs) {
+    WriteBytes(2, o, &ans);
+  }
+
+  WriteBytes(4, op_type, &ans);
+  return ans;
+}
+
+// Serialized ModelProto with ir_version 7 and opset 13.
+//
+// @param nodes  Results of OnnxNode()
+// @param inputs  Results of OnnxValueInfo()
+// @param outputs  Results of OnnxValueInfo()
+// @param meta_data  Custom metadata of the model
+inline std::string OnnxModel(
+    const std::vector<std::string> &nodes,
+    const std::vector<std::string> &inputs,
+    const std::vector<std::string> &outputs,
+    const std::vector<std::pair<std::string, std::string>> &meta_data = {}) {
+  std::string graph;
+  for (const auto &n : nodes) {
+    WriteBytes(1, n, &graph);
+  }
+
+  WriteBytes(2, "sherpa-onnx-test", &graph);
+
+  for (const auto &i : inputs) {
+    WriteBytes(11, i, &graph);
+  }
+
+  for (const auto &o : outputs) {
+    WriteBytes(12, o, &graph);
+  }
+
+  std::string opset;
+  WriteInt(2, 13, &opset);
+
+  std::string model;
+  WriteInt(1, 7, &model);  // ir_version
+  WriteBytes(7, graph, &model);
+  WriteBytes(8, opset, &model);
+
+  for (const auto &p : meta_data) {
+    std::string entry;
+    WriteBytes(1, p.first, &entry);
+    WriteBytes(2, p.second, &entry);
+    WriteBytes(14, entry, &model);
+  }
+
+  return model;
+}
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONNX_MODEL_BUILDER_H_
@@ -0,0 +1,175 @@
+// sherpa-onnx/csrc/ort-env.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/ort-env.h"
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <string>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+struct OrtEnvRegistry {
+  std::mutex mutex;
+  OrtEnvConfig config;
+  std::unique_ptr<Ort::Env> env;
+};
+
+OrtEnvRegistry &GetRegistry() {
+  // Never destroyed, so that the environment outlives models in other
+  // static objects
+  static auto *registry = new OrtEnvRegistry;
+  return *registry;
+}
+
+std::unique_ptr<Ort::Env> CreateOrtEnv(const OrtEnvConfig &config) {
+  if (!config.use_global_thread_pools) {
+    return std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_ERROR);
+  }
+
+  Ort::ThreadingOptions tp_options;
+  tp_options.SetGlobalIntraOpNumThreads(config.intra_op_num_threads);
+  tp_options.SetGlobalInterOpNumThreads(config.inter_op_num_threads);
+  tp_options.SetGlobalSpinControl(config.allow_spinning);
+
+  if (!config.intra_op_thread_affinity.empty()) {
+#if ORT_API_VERSION >= 14
+    Ort::ThrowOnError(Ort::GetApi().SetGlobalIntraOpThreadAffinity(
+        tp_options, config.intra_op_thread_affinity.c_str()));
+#else
+    SHERPA_ONNX_LOGE(
+        "Thread affinity is not supported for onnxruntime API version %d. "
+        "Ignore it",
+        static_cast<int32_t>(ORT_API_VERSION));
+#endif
+  }
+
+  return std::make_unique<Ort::Env>(tp_options, ORT_LOGGING_LEVEL_ERROR,
+                                    "sherpa-onnx");
+}
+
+}  // namespace
+
+void OrtEnvConfig::Register(ParseOptions *po) {
+  po->Register("ort-use-global-thread-pools", &use_global_thread_pools,
+               "true to share one intra-op and one inter-op thread pool "
+               "among all models. If true, --num-threads of each model is "
+               "ignored.");
+
+  po->Register("ort-intra-op-num-threads", &intra_op_num_threads,
+               "Number of threads of the global intra-op thread pool. 0 "
+               "means to let onnxruntime decide.");
+
+  po->Register("ort-inter-op-num-threads", &inter_op_num_threads,
+               "Number of threads of the global inter-op thread pool. 0 "
+               "means to let onnxruntime decide.");
+
+  po->Register("ort-intra-op-thread-affinity", &intra_op_thread_affinity,
+               "Affinity of the global intra-op threads, e.g., '1,2;3-4'. "
+               "Threads are separated by ';'.");
+
+  po->Register("ort-allow-spinning", &allow_spinning,
+               "false to disable spinning of idle threads in the global "
+               "thread pools.");
+
+  po->Register("ort-optimized-model-cache-dir", &optimized_model_cache_dir,
+               "If not empty, save models optimized by onnxruntime to this "
+               "directory and load them from it later to reduce start up "
+               "time. The directory must exist.");
+}
+
+bool OrtEnvConfig::Validate() const {
+  if (intra_op_num_threads < 0) {
+    SHERPA_ONNX_LOGE("intra_op_num_threads should be >= 0. Given: %d",
+                     intra_op_num_threads);
+    return false;
+  }
+
+  if (inter_op_num_threads < 0) {
+    SHERPA_ONNX_LOGE("inter_op_num_threads should be >= 0. Given: %d",
+                     inter_op_num_threads);
+    return false;
+  }
+
+  if (!intra_op_thread_affinity.empty() && !use_global_thread_pools) {
+    SHERPA_ONNX_LOGE(
+        "intra_op_thread_affinity requires use_global_thread_pools=true");
+    return false;
+  }
+
+  return true;
+}
+
+std::string OrtEnvConfig::ToString() const {
+  std::ostringstream os;
+
+  os << "OrtEnvConfig(";
+  os << "use_global_thread_pools="
+     << (use_global_thread_pools ? "True" : "False") << ", ";
+  os << "intra_op_num_threads=" << intra_op_num_threads << ", ";
+  os << "inter_op_num_threads=" << inter_op_num_threads << ", ";
+  os << "intra_op_thread_affinity=\"" << intra_op_thread_affinity << "\", ";
+  os << "allow_spinning=" << (allow_spinning ? "True" : "False") << ", ";
+  os << "optimized_model_cache_dir=\"" << optimized_model_cache_dir
+     << "\")";
+
+  return os.str();
+}
+
+bool InitOrtEnv(const OrtEnvConfig &config) {
+  if (!config.Validate()) {
+    SHERPA_ONNX_LOGE("Errors in ort env config: %s", config.ToString().c_str());
+    return false;
+  }
+
+  auto &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  if (registry.env) {
+    SHERPA_ONNX_LOGE(
+        "The onnxruntime environment has already been created. Please call "
+        "InitOrtEnv() before creating any models. Ignore it.");
+    return false;
+  }
+
+  registry.config = config;
+  registry.env = CreateOrtEnv(config);
+
+  return true;
+}
+
+bool ReadOptionsAndInitOrtEnv(ParseOptions *po, int32_t argc,
+                              const char *const *argv) {
+  OrtEnvConfig config;
+  config.Register(po);
+
+  po->Read(argc, argv);
+
+  return InitOrtEnv(config);
+}
+
+Ort::Env &GetOrtEnv() {
+  auto &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  if (!registry.env) {
+    registry.env = CreateOrtEnv(registry.config);
+  }
+
+  return *registry.env;
+}
+
+OrtEnvConfig GetOrtEnvConfig() {
+  auto &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  return registry.config;
+}
+
+}  // namespace sherpa_onnx
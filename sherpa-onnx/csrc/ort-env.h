@@ -0,0 +1,93 @@
+// sherpa-onnx/csrc/ort-env.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ORT_ENV_H_
+#define SHERPA_ONNX_CSRC_ORT_ENV_H_
+
+#include <string>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/parse-options.h"
+
+namespace sherpa_onnx {
+
+// Process-wide settings of the onnxruntime environment that is shared
+// by all models.
+struct OrtEnvConfig {
+  // If true, the environment owns an intra-op and an inter-op thread pool
+  // that are shared by all sessions. Per-session threads are disabled and
+  // num_threads of each model config is ignored.
+  bool use_global_thread_pools = false;
+
+  // Number of threads of the global intra-op thread pool.
+  // 0 means to let onnxruntime decide.
+  int32_t intra_op_num_threads = 0;
+
+  // Number of threads of the global inter-op thread pool.
+  // 0 means to let onnxruntime decide.
+  int32_t inter_op_num_threads = 0;
+
+  // Affinity of the intra-op threads, excluding the calling thread.
+  // Threads are separated by ';' and logical processors by ','. Ranges
+  // are given by '-', e.g., "1,2;3-4" pins the first thread to processors
+  // 1 and 2, and the second thread to processors 3 and 4.
+  // Empty means no affinity.
+  std::string intra_op_thread_affinity;
+
+  // If false, idle threads of the global thread pools do not spin.
+  bool allow_spinning = true;
+
+  // If not empty, it is an existing directory where graphs optimized by
+  // onnxruntime are saved. The first load of a model saves its optimized
+  // graph and later loads use it, which skips graph optimization.
+  // See CreateSession() in session.h.
+  //
+  // Graphs are saved before the CPU specific layout optimizations and are
+  // keyed by the CPU architecture, so the directory can be shared among
+  // machines.
+  std::string optimized_model_cache_dir;
+
+  OrtEnvConfig() = default;
+
+  OrtEnvConfig(bool use_global_thread_pools, int32_t intra_op_num_threads,
+               int32_t inter_op_num_threads,
+               const std::string &intra_op_thread_affinity,
+               bool allow_spinning,
+               const std::string &optimized_model_cache_dir)
+      : use_global_thread_pools(use_global_thread_pools),
+        intra_op_num_threads(intra_op_num_threads),
+        inter_op_num_threads(inter_op_num_threads),
+        intra_op_thread_affinity(intra_op_thread_affinity),
+        allow_spinning(allow_spinning),
+        optimized_model_cache_dir(optimized_model_cache_dir) {}
+
+  void Register(ParseOptions *po);
+  bool Validate() const;
+
+  std::string ToString() const;
+};
+
+// Set up the shared environment. It must be called before any model is
+// created. Return false if the config is invalid or if the environment has
+// already been created, in which case the given config is ignored.
+bool InitOrtEnv(const OrtEnvConfig &config);
+
+// It is used by the main() of binaries in place of po->Read(argc, argv).
+// It registers the options of OrtEnvConfig to po, reads the command line
+// and calls InitOrtEnv() with the given options. Return false if
+// InitOrtEnv() fails.
+bool ReadOptionsAndInitOrtEnv(ParseOptions *po, int32_t argc,
+                              const char *const *argv);
+
+// Return the onnxruntime environment shared by all models in this
+// process. It is created with the default OrtEnvConfig on first use if
+// InitOrtEnv() has not been called.
+Ort::Env &GetOrtEnv();
+
+// Return a copy of the config of the shared environment
+OrtEnvConfig GetOrtEnvConfig();
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ORT_ENV_H_
@@ -6,6 +6,7 @@
 
 #include <codecvt>
 #include <fstream>
+#include <iterator>
 #include <locale>
 #include <map>
 #include <mutex>  // NOLINT
@@ -28,6 +29,7 @@
 #include "phoneme_ids.hpp"
 #include "phonemize.hpp"
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/lru-cache.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/EspeakDataPacker.h"
 
@@ -59,15 +61,52 @@ static std::string ToString(char32_t cp) {
   return result;
 }
 
+// Texts longer than this are not cached
+static constexpr int32_t kMaxCachedTextLength = 512;
+static constexpr int32_t kPhonemizeCacheCapacity = 20000;
+
 void CallPhonemizeEspeak(const std::string &text,
                          piper::eSpeakPhonemeConfig &config,  // NOLINT
                          std::vector<std::vector<piper::Phoneme>> *phonemes) {
-  static std::mutex espeak_mutex;
+  // espeak-ng is not thread-safe, so all callers are serialized. Words and
+  // short sentences are phonemized again and again in a TTS service, so
+  // results are cached and a cache hit does not wait for espeak-ng.
+  //
+  // Note: All callers change only config.voice, so it is the only field of
+  // the config used in the key.
+  static LruCache<std::vector<std::vector<piper::Phoneme>>> cache(
+      kPhonemizeCacheCapacity);
+
+  std::vector<std::vector<piper::Phoneme>> ans;
+
+  bool use_cache = static_cast<int32_t>(text.size()) <= kMaxCachedTextLength;
+  std::string key;
+  if (use_cache) {
+    key = config.voice;
+    key.push_back('\0');
+    key += text;
+
+    if (cache.Get(key, &ans)) {
+      phonemes->insert(phonemes->end(), ans.begin(), ans.end());
+      return;
+    }
+  }
+
+  {
+    static std::mutex espeak_mutex;
+
+    std::lock_guard<std::mutex> lock(espeak_mutex);
 
-  std::lock_guard<std::mutex> lock(espeak_mutex);
+    // keep multi threads from calling into piper::phonemize_eSpeak
+    piper::phonemize_eSpeak(text, config, ans);
+  }
+
+  if (use_cache) {
+    cache.Put(key, ans);
+  }
 
-  // keep multi threads from calling into piper::phonemize_eSpeak
-  piper::phonemize_eSpeak(text, config, *phonemes);
+  phonemes->insert(phonemes->end(), std::make_move_iterator(ans.begin()),
+                   std::make_move_iterator(ans.end()));
 }
 
 static std::unordered_map<char32_t, int32_t> ReadTokens(std::istream &is) {
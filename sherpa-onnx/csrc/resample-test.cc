@@ -0,0 +1,159 @@
+// sherpa-onnx/csrc/resample-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/resample.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+static std::vector<float> GetWave(int32_t n) {
+  std::mt19937 gen(20250101);
+  std::uniform_real_distribution<float> dist(-0.5, 0.5);
+
+  std::vector<float> wave(n);
+  for (auto &w : wave) {
+    w = dist(gen);
+  }
+  return wave;
+}
+
+static std::unique_ptr<LinearResample> CreateResampler(int32_t in_rate,
+                                                       int32_t out_rate) {
+  float min_freq = std::min(in_rate, out_rate);
+  float lowpass_cutoff = 0.99 * 0.5 * min_freq;
+  int32_t lowpass_filter_width = 6;
+  return std::make_unique<LinearResample>(in_rate, out_rate, lowpass_cutoff,
+                                          lowpass_filter_width);
+}
+
+// Evaluate the windowed sinc filter directly for each output sample
+static std::vector<float> Reference(const std::vector<float> &x,
+                                    int32_t in_rate, int32_t out_rate,
+                                    int32_t num_output) {
+  double cutoff = static_cast<float>(0.99 * 0.5 * std::min(in_rate, out_rate));
+  int32_t num_zeros = 6;
+  double window_width = num_zeros / (2.0 * cutoff);
+
+  std::vector<float> y(num_output);
+  for (int32_t n = 0; n != num_output; ++n) {
+    double t = n / static_cast<double>(out_rate);
+    int32_t begin = std::max<int32_t>(
+        0, std::ceil((t - window_width) * in_rate));
+    int32_t end = std::min<int32_t>(
+        x.size() - 1, std::floor((t + window_width) * in_rate));
+
+    double sum = 0;
+    for (int32_t j = begin; j <= end; ++j) {
+      double d = j / static_cast<double>(in_rate) - t;
+      if (std::abs(d) >= window_width) {
+        continue;
+      }
+      double window = 0.5 * (1 + std::cos(2 * M_PI * cutoff / num_zeros * d));
+      double filter = d != 0 ? std::sin(2 * M_PI * cutoff * d) / (M_PI * d)
+                             : 2 * cutoff;
+      sum += x[j] * filter * window / in_rate;
+    }
+    y[n] = sum;
+  }
+  return y;
+}
+
+TEST(LinearResample, CompareWithReference) {
+  std::vector<std::pair<int32_t, int32_t>> rates = {
+      {8000, 16000},  {16000, 8000},  {44100, 16000},
+      {48000, 16000}, {22050, 16000}, {16000, 44100}};
+
+  for (const auto &[in_rate, out_rate] : rates) {
+    auto x = GetWave(in_rate / 2);
+    auto resampler = CreateResampler(in_rate, out_rate);
+
+    std::vector<float> y;
+    resampler->Resample(x.data(), x.size(), true, &y);
+
+    int32_t expected_size = static_cast<int64_t>(x.size()) * out_rate / in_rate;
+    EXPECT_NEAR(y.size(), expected_size, 1);
+
+    auto expected = Reference(x, in_rate, out_rate, y.size());
+
+    float max_diff = 0;
+    for (int32_t i = 0; i != static_cast<int32_t>(y.size()); ++i) {
+      max_diff = std::max(max_diff, std::abs(y[i] - expected[i]));
+    }
+
+    EXPECT_LT(max_diff, 1e-4f) << in_rate << " -> " << out_rate;
+  }
+}
+
+TEST(LinearResample, Streaming) {
+  std::vector<std::pair<int32_t, int32_t>> rates = {
+      {8000, 16000}, {44100, 16000}, {48000, 16000}, {16000, 44100}};
+
+  for (const auto &[in_rate, out_rate] : rates) {
+    auto x = GetWave(in_rate);
+
+    auto resampler = CreateResampler(in_rate, out_rate);
+    std::vector<float> expected;
+    resampler->Resample(x.data(), x.size(), true, &expected);
+
+    for (int32_t chunk_size : {1, 37, 160, 1000, 4410}) {
+      std::vector<float> y;
+      std::vector<float> buf;
+
+      for (int32_t start = 0; start < static_cast<int32_t>(x.size());
+           start += chunk_size) {
+        int32_t n = std::min<int32_t>(chunk_size, x.size() - start);
+        bool flush = start + n == static_cast<int32_t>(x.size());
+
+        buf.resize(resampler->NumOutputSamples(n, flush));
+        int32_t k = resampler->Resample(x.data() + start, n, flush, buf.data());
+        ASSERT_EQ(k, static_cast<int32_t>(buf.size()));
+
+        y.insert(y.end(), buf.begin(), buf.end());
+      }
+
+      ASSERT_EQ(y.size(), expected.size());
+      for (int32_t i = 0; i != static_cast<int32_t>(y.size()); ++i) {
+        ASSERT_EQ(y[i], expected[i]) << i << " " << chunk_size;
+      }
+    }
+  }
+}
+
+TEST(LinearResample, DISABLED_Benchmark) {
+  std::vector<std::pair<int32_t, int32_t>> rates = {
+      {8000, 16000}, {44100, 16000}, {48000, 16000}};
+
+  for (const auto &[in_rate, out_rate] : rates) {
+    // 60 seconds of audio in chunks of 10 ms
+    auto x = GetWave(in_rate * 60);
+    int32_t chunk_size = in_rate / 100;
+
+    auto resampler = CreateResampler(in_rate, out_rate);
+    std::vector<float> y;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i + chunk_size <= static_cast<int32_t>(x.size());
+         i += chunk_size) {
+      resampler->Resample(x.data() + i, chunk_size, false, &y);
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    int32_t us =
+        std::chrono::duration_cast<std::chrono::microseconds>(stop - start)
+            .count();
+
+    SHERPA_ONNX_LOGE("60 seconds of audio, %d -> %d: %d us", in_rate,
+                     out_rate, us);
+  }
+}
+
+}  // namespace sherpa_onnx
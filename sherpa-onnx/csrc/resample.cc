@@ -24,10 +24,14 @@
 
 #include "sherpa-onnx/csrc/resample.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <map>
+#include <mutex>  // NOLINT
+#include <tuple>
 #include <type_traits>
 
 #ifndef M_2PI
@@ -40,6 +44,10 @@
 
 namespace sherpa_onnx {
 
+// The number of taps of each filter is rounded up to a multiple of this
+// so that DotProduct() needs no tail loop
+static constexpr int32_t kTapAlignment = 8;
+
 template <class I>
 static I Gcd(I m, I n) {
   // this function is copied from kaldi/src/base/kaldi-math.h
@@ -72,43 +80,113 @@ static I Lcm(I m, I n) {
   return gcd * (m / gcd) * (n / gcd);
 }
 
+// n must be a multiple of kTapAlignment.
+//
+// We use kTapAlignment partial sums so that the compiler can vectorize
+// the loop without -ffast-math.
 static float DotProduct(const float *a, const float *b, int32_t n) {
-  float sum = 0;
-  for (int32_t i = 0; i != n; ++i) {
-    sum += a[i] * b[i];
+  float sum[kTapAlignment] = {0};
+  for (int32_t i = 0; i != n; i += kTapAlignment) {
+    for (int32_t k = 0; k != kTapAlignment; ++k) {
+      sum[k] += a[i + k] * b[i + k];
+    }
+  }
+
+  float ans = 0;
+  for (int32_t k = 0; k != kTapAlignment; ++k) {
+    ans += sum[k];
   }
-  return sum;
+  return ans;
 }
 
-LinearResample::LinearResample(int32_t samp_rate_in_hz,
-                               int32_t samp_rate_out_hz, float filter_cutoff_hz,
-                               int32_t num_zeros)
-    : samp_rate_in_(samp_rate_in_hz),
-      samp_rate_out_(samp_rate_out_hz),
-      filter_cutoff_(filter_cutoff_hz),
-      num_zeros_(num_zeros) {
-  assert(samp_rate_in_hz > 0.0 && samp_rate_out_hz > 0.0 &&
-         filter_cutoff_hz > 0.0 && filter_cutoff_hz * 2 <= samp_rate_in_hz &&
-         filter_cutoff_hz * 2 <= samp_rate_out_hz && num_zeros > 0);
+/** Here, t is a time in seconds representing an offset from
+    the center of the windowed filter function, and FilterFunction(t)
+    returns the windowed filter function, described
+    in the header as h(t) = f(t)g(t), evaluated at t.
+*/
+static float FilterFunc(float t, float filter_cutoff, int32_t num_zeros) {
+  float window = 0,  // raised-cosine (Hanning) window of width
+                     // num_zeros/2*filter_cutoff
+      filter = 0;    // sinc filter function
+  if (std::fabs(t) < num_zeros / (2.0 * filter_cutoff))
+    window = 0.5 * (1 + cos(M_2PI * filter_cutoff / num_zeros * t));
+  else
+    window = 0.0;  // outside support of window function
+  if (t != 0)
+    filter = sin(M_2PI * filter_cutoff * t) / (M_PI * t);
+  else
+    filter = 2 * filter_cutoff;  // limit of the function at t = 0
+  return filter * window;
+}
+
+struct LinearResample::Filter {
+  int32_t input_samples_in_unit;  ///< The number of input samples in the
+                                  ///< smallest repeating unit: num_samp_in_ =
+                                  ///< samp_rate_in_hz / Gcd(samp_rate_in_hz,
+                                  ///< samp_rate_out_hz)
+
+  int32_t output_samples_in_unit;  ///< The number of output samples in the
+                                   ///< smallest repeating unit: num_samp_out_
+                                   ///< = samp_rate_out_hz /
+                                   ///< Gcd(samp_rate_in_hz, samp_rate_out_hz)
+
+  /// Number of taps of each output phase, a multiple of kTapAlignment.
+  /// Unused taps have weight 0.
+  int32_t num_taps;
+
+  /// The first input-sample index that we sum over, for this output-sample
+  /// index.  May be negative; any truncation at the beginning is handled
+  /// separately.  This is just for the first few output samples, but we can
+  /// extrapolate the correct input-sample index for arbitrary output samples.
+  std::vector<int32_t> first_index;
+
+  /// Weights on the input samples, of shape
+  /// (output_samples_in_unit, num_taps)
+  std::vector<float> weights;
+
+  /// Number of trailing input samples kept between calls
+  int32_t num_history;
+
+  // For GetNumOutputSamples(). We measure time in "ticks" of
+  // 1.0 / tick_freq, where tick_freq is the least common multiple of
+  // samp_rate_in_ and samp_rate_out_.
+  int64_t ticks_per_input_period;
+  int64_t ticks_per_output_period;
+  int64_t window_width_ticks;
+};
+
+std::shared_ptr<const LinearResample::Filter> LinearResample::GetFilter(
+    int32_t samp_rate_in_hz, int32_t samp_rate_out_hz, float filter_cutoff_hz,
+    int32_t num_zeros) {
+  static std::mutex mutex;
+  static std::map<std::tuple<int32_t, int32_t, float, int32_t>,
+                  std::weak_ptr<const Filter>>
+      cache;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto &cached = cache[std::make_tuple(samp_rate_in_hz, samp_rate_out_hz,
+                                       filter_cutoff_hz, num_zeros)];
+  if (auto ans = cached.lock()) {
+    return ans;
+  }
+
+  auto filter = std::make_shared<Filter>();
 
   // base_freq is the frequency of the repeating unit, which is the gcd
   // of the input frequencies.
-  int32_t base_freq = Gcd(samp_rate_in_, samp_rate_out_);
-  input_samples_in_unit_ = samp_rate_in_ / base_freq;
-  output_samples_in_unit_ = samp_rate_out_ / base_freq;
+  int32_t base_freq = Gcd(samp_rate_in_hz, samp_rate_out_hz);
+  filter->input_samples_in_unit = samp_rate_in_hz / base_freq;
+  filter->output_samples_in_unit = samp_rate_out_hz / base_freq;
 
-  SetIndexesAndWeights();
-  Reset();
-}
+  int32_t num_phases = filter->output_samples_in_unit;
 
-void LinearResample::SetIndexesAndWeights() {
-  first_index_.resize(output_samples_in_unit_);
-  weights_.resize(output_samples_in_unit_);
+  double window_width = num_zeros / (2.0 * filter_cutoff_hz);
 
-  double window_width = num_zeros_ / (2.0 * filter_cutoff_);
-
-  for (int32_t i = 0; i < output_samples_in_unit_; i++) {
-    double output_t = i / static_cast<double>(samp_rate_out_);
+  std::vector<int32_t> num_indices(num_phases);
+  filter->first_index.resize(num_phases);
+  for (int32_t i = 0; i < num_phases; i++) {
+    double output_t = i / static_cast<double>(samp_rate_out_hz);
     double min_t = output_t - window_width, max_t = output_t + window_width;
     // we do ceil on the min and floor on the max, because if we did it
     // the other way around we would unnecessarily include indexes just
@@ -117,137 +195,174 @@ void LinearResample::SetIndexesAndWeights() {
     // (e.g. if filter_cutoff_ has an exact ratio with the sample rates),
     // that we unnecessarily include something with a zero coefficient,
     // but this is only a slight efficiency issue.
-    int32_t min_input_index = ceil(min_t * samp_rate_in_),
-            max_input_index = floor(max_t * samp_rate_in_),
-            num_indices = max_input_index - min_input_index + 1;
-    first_index_[i] = min_input_index;
-    weights_[i].resize(num_indices);
-    for (int32_t j = 0; j < num_indices; j++) {
-      int32_t input_index = min_input_index + j;
-      double input_t = input_index / static_cast<double>(samp_rate_in_),
+    int32_t min_input_index = ceil(min_t * samp_rate_in_hz),
+            max_input_index = floor(max_t * samp_rate_in_hz);
+    filter->first_index[i] = min_input_index;
+    num_indices[i] = max_input_index - min_input_index + 1;
+  }
+
+  int32_t num_taps =
+      *std::max_element(num_indices.begin(), num_indices.end());
+  num_taps = (num_taps + kTapAlignment - 1) / kTapAlignment * kTapAlignment;
+  filter->num_taps = num_taps;
+
+  filter->weights.resize(static_cast<size_t>(num_phases) * num_taps);
+  for (int32_t i = 0; i < num_phases; i++) {
+    double output_t = i / static_cast<double>(samp_rate_out_hz);
+    float *w = filter->weights.data() + static_cast<size_t>(i) * num_taps;
+    for (int32_t j = 0; j < num_indices[i]; j++) {
+      int32_t input_index = filter->first_index[i] + j;
+      double input_t = input_index / static_cast<double>(samp_rate_in_hz),
              delta_t = input_t - output_t;
       // sign of delta_t doesn't matter.
-      weights_[i][j] = FilterFunc(delta_t) / samp_rate_in_;
+      w[j] = FilterFunc(delta_t, filter_cutoff_hz, num_zeros) /
+             samp_rate_in_hz;
     }
   }
+
+  // max_remainder_needed is the width of the filter from side to side,
+  // measured in input samples.  you might think it should be half that,
+  // but you have to consider that you might be wanting to output samples
+  // that are "in the past" relative to the beginning of the latest
+  // input... anyway, storing more remainder than needed is not harmful.
+  int32_t max_remainder_needed =
+      std::ceil(samp_rate_in_hz * num_zeros / filter_cutoff_hz);
+  filter->num_history = std::max(max_remainder_needed, num_taps) + 1;
+
+  int64_t tick_freq = Lcm<int64_t>(samp_rate_in_hz, samp_rate_out_hz);
+  filter->ticks_per_input_period = tick_freq / samp_rate_in_hz;
+  filter->ticks_per_output_period = tick_freq / samp_rate_out_hz;
+  // To count the window-width in ticks we take the floor.  This
+  // is because since we're looking for the largest integer num-out-samp
+  // that fits in the interval, which is open on the right, a reduction
+  // in interval length of less than a tick will never make a difference.
+  // For example, the largest integer in the interval [ 0, 2 ) and the
+  // largest integer in the interval [ 0, 2 - 0.9 ) are the same (both one).
+  // So when we're subtracting the window-width we can ignore the fractional
+  // part.
+  filter->window_width_ticks =
+      std::floor(static_cast<float>(window_width) * tick_freq);
+
+  cached = filter;
+
+  return filter;
 }
 
-/** Here, t is a time in seconds representing an offset from
-    the center of the windowed filter function, and FilterFunction(t)
-    returns the windowed filter function, described
-    in the header as h(t) = f(t)g(t), evaluated at t.
-*/
-float LinearResample::FilterFunc(float t) const {
-  float window = 0,  // raised-cosine (Hanning) window of width
-                     // num_zeros_/2*filter_cutoff_
-      filter = 0;    // sinc filter function
-  if (std::fabs(t) < num_zeros_ / (2.0 * filter_cutoff_))
-    window = 0.5 * (1 + cos(M_2PI * filter_cutoff_ / num_zeros_ * t));
-  else
-    window = 0.0;  // outside support of window function
-  if (t != 0)
-    filter = sin(M_2PI * filter_cutoff_ * t) / (M_PI * t);
-  else
-    filter = 2 * filter_cutoff_;  // limit of the function at t = 0
-  return filter * window;
+LinearResample::LinearResample(int32_t samp_rate_in_hz,
+                               int32_t samp_rate_out_hz, float filter_cutoff_hz,
+                               int32_t num_zeros)
+    : samp_rate_in_(samp_rate_in_hz),
+      samp_rate_out_(samp_rate_out_hz),
+      filter_cutoff_(filter_cutoff_hz),
+      num_zeros_(num_zeros) {
+  assert(samp_rate_in_hz > 0.0 && samp_rate_out_hz > 0.0 &&
+         filter_cutoff_hz > 0.0 && filter_cutoff_hz * 2 <= samp_rate_in_hz &&
+         filter_cutoff_hz * 2 <= samp_rate_out_hz && num_zeros > 0);
+
+  filter_ = GetFilter(samp_rate_in_, samp_rate_out_, filter_cutoff_,
+                      num_zeros_);
+  Reset();
 }
 
 void LinearResample::Reset() {
   input_sample_offset_ = 0;
   output_sample_offset_ = 0;
-  input_remainder_.resize(0);
+
+  // Samples before the start of the signal are zeros
+  buffer_.assign(filter_->num_history, 0);
+}
+
+int32_t LinearResample::NumOutputSamples(int32_t input_dim, bool flush) const {
+  return GetNumOutputSamples(input_sample_offset_ + input_dim, flush) -
+         output_sample_offset_;
 }
 
 void LinearResample::Resample(const float *input, int32_t input_dim, bool flush,
                               std::vector<float> *output) {
+  output->resize(NumOutputSamples(input_dim, flush));
+  Resample(input, input_dim, flush, output->data());
+}
+
+int32_t LinearResample::Resample(const float *input, int32_t input_dim,
+                                 bool flush, float *output) {
+  const Filter &filter = *filter_;
+
   int64_t tot_input_samp = input_sample_offset_ + input_dim,
           tot_output_samp = GetNumOutputSamples(tot_input_samp, flush);
 
   assert(tot_output_samp >= output_sample_offset_);
 
-  output->resize(tot_output_samp - output_sample_offset_);
+  // buffer_ contains
+  //  - the last num_history input samples of the previous calls
+  //  - the input of this call
+  //  - num_taps zeros, which are read only when flush is true
+  int32_t num_history = filter.num_history;
+  buffer_.resize(num_history + input_dim + filter.num_taps);
+  std::copy(input, input + input_dim, buffer_.begin() + num_history);
+  std::fill(buffer_.begin() + num_history + input_dim, buffer_.end(), 0);
+
+  // The input-sample index of buffer_[0]
+  int64_t buffer_start = input_sample_offset_ - num_history;
 
   // samp_out is the index into the total output signal, not just the part
   // of it we are producing here.
-  for (int64_t samp_out = output_sample_offset_; samp_out < tot_output_samp;
-       samp_out++) {
-    int64_t first_samp_in = 0;
-    int32_t samp_out_wrapped = 0;
-    GetIndexes(samp_out, &first_samp_in, &samp_out_wrapped);
-    const std::vector<float> &weights = weights_[samp_out_wrapped];
-    // first_input_index is the first index into "input" that we have a weight
-    // for.
-    int32_t first_input_index =
-        static_cast<int32_t>(first_samp_in - input_sample_offset_);
-    float this_output = 0;
-    if (first_input_index >= 0 &&
-        first_input_index + static_cast<int32_t>(weights.size()) <= input_dim) {
-      this_output =
-          DotProduct(input + first_input_index, weights.data(), weights.size());
-    } else {  // Handle edge cases.
-      this_output = 0.0;
-      for (int32_t i = 0; i < static_cast<int32_t>(weights.size()); i++) {
-        float weight = weights[i];
-        int32_t input_index = first_input_index + i;
-        if (input_index < 0 &&
-            static_cast<int32_t>(input_remainder_.size()) + input_index >= 0) {
-          this_output +=
-              weight * input_remainder_[input_remainder_.size() + input_index];
-        } else if (input_index >= 0 && input_index < input_dim) {
-          this_output += weight * input[input_index];
-        } else if (input_index >= input_dim) {
-          // We're past the end of the input and are adding zero; should only
-          // happen if the user specified flush == true, or else we would not
-          // be trying to output this sample.
-          assert(flush);
-        }
-      }
+  int64_t samp_out = output_sample_offset_;
+  int64_t unit_index = samp_out / filter.output_samples_in_unit;
+  int32_t phase = static_cast<int32_t>(
+      samp_out - unit_index * filter.output_samples_in_unit);
+  int64_t unit_start = unit_index * filter.input_samples_in_unit - buffer_start;
+
+  int32_t num_output = static_cast<int32_t>(tot_output_samp - samp_out);
+  for (int32_t i = 0; i != num_output; ++i) {
+    int64_t first_input_index = unit_start + filter.first_index[phase];
+    assert(first_input_index >= 0);
+    assert(first_input_index + filter.num_taps <=
+           static_cast<int64_t>(buffer_.size()));
+
+    output[i] = DotProduct(
+        buffer_.data() + first_input_index,
+        filter.weights.data() + static_cast<size_t>(phase) * filter.num_taps,
+        filter.num_taps);
+
+    if (++phase == filter.output_samples_in_unit) {
+      phase = 0;
+      unit_start += filter.input_samples_in_unit;
     }
-    int32_t output_index =
-        static_cast<int32_t>(samp_out - output_sample_offset_);
-    (*output)[output_index] = this_output;
   }
 
   if (flush) {
     Reset();  // Reset the internal state.
   } else {
-    SetRemainder(input, input_dim);
+    // Keep the last num_history input samples for the next call
+    std::copy(buffer_.begin() + input_dim,
+              buffer_.begin() + input_dim + num_history, buffer_.begin());
+    buffer_.resize(num_history);
+
     input_sample_offset_ = tot_input_samp;
     output_sample_offset_ = tot_output_samp;
   }
+
+  return num_output;
 }
 
 int64_t LinearResample::GetNumOutputSamples(int64_t input_num_samp,
                                             bool flush) const {
-  // For exact computation, we measure time in "ticks" of 1.0 / tick_freq,
-  // where tick_freq is the least common multiple of samp_rate_in_ and
-  // samp_rate_out_.
-  int32_t tick_freq = Lcm(samp_rate_in_, samp_rate_out_);
-  int32_t ticks_per_input_period = tick_freq / samp_rate_in_;
+  const Filter &filter = *filter_;
 
   // work out the number of ticks in the time interval
   // [ 0, input_num_samp/samp_rate_in_ ).
-  int64_t interval_length_in_ticks = input_num_samp * ticks_per_input_period;
+  int64_t interval_length_in_ticks =
+      input_num_samp * filter.ticks_per_input_period;
   if (!flush) {
-    float window_width = num_zeros_ / (2.0 * filter_cutoff_);
-    // To count the window-width in ticks we take the floor.  This
-    // is because since we're looking for the largest integer num-out-samp
-    // that fits in the interval, which is open on the right, a reduction
-    // in interval length of less than a tick will never make a difference.
-    // For example, the largest integer in the interval [ 0, 2 ) and the
-    // largest integer in the interval [ 0, 2 - 0.9 ) are the same (both one).
-    // So when we're subtracting the window-width we can ignore the fractional
-    // part.
-    int32_t window_width_ticks = std::floor(window_width * tick_freq);
     // The time-period of the output that we can sample gets reduced
     // by the window-width (which is actually the distance from the
     // center to the edge of the windowing function) if we're not
     // "flushing the output".
-    interval_length_in_ticks -= window_width_ticks;
+    interval_length_in_ticks -= filter.window_width_ticks;
   }
   if (interval_length_in_ticks <= 0) return 0;
 
-  int32_t ticks_per_output_period = tick_freq / samp_rate_out_;
+  int64_t ticks_per_output_period = filter.ticks_per_output_period;
   // Get the last output-sample in the closed interval, i.e. replacing [ ) with
   // [ ].  Note: integer division rounds down.  See
   // http://en.wikipedia.org/wiki/Interval_(mathematics) for an explanation of
@@ -264,45 +379,4 @@ int64_t LinearResample::GetNumOutputSamples(int64_t input_num_samp,
   return num_output_samp;
 }
 
-// inline
-void LinearResample::GetIndexes(int64_t samp_out, int64_t *first_samp_in,
-                                int32_t *samp_out_wrapped) const {
-  // A unit is the smallest nonzero amount of time that is an exact
-  // multiple of the input and output sample periods.  The unit index
-  // is the answer to "which numbered unit we are in".
-  int64_t unit_index = samp_out / output_samples_in_unit_;
-  // samp_out_wrapped is equal to samp_out % output_samples_in_unit_
-  *samp_out_wrapped =
-      static_cast<int32_t>(samp_out - unit_index * output_samples_in_unit_);
-  *first_samp_in =
-      first_index_[*samp_out_wrapped] + unit_index * input_samples_in_unit_;
-}
-
-void LinearResample::SetRemainder(const float *input, int32_t input_dim) {
-  std::vector<float> old_remainder(input_remainder_);
-  // max_remainder_needed is the width of the filter from side to side,
-  // measured in input samples.  you might think it should be half that,
-  // but you have to consider that you might be wanting to output samples
-  // that are "in the past" relative to the beginning of the latest
-  // input... anyway, storing more remainder than needed is not harmful.
-  int32_t max_remainder_needed =
-      std::ceil(samp_rate_in_ * num_zeros_ / filter_cutoff_);
-  input_remainder_.resize(max_remainder_needed);
-  for (int32_t index = -static_cast<int32_t>(input_remainder_.size());
-       index < 0; index++) {
-    // we interpret "index" as an offset from the end of "input" and
-    // from the end of input_remainder_.
-    int32_t input_index = index + input_dim;
-    if (input_index >= 0) {
-      input_remainder_[index + static_cast<int32_t>(input_remainder_.size())] =
-          input[input_index];
-    } else if (input_index + static_cast<int32_t>(old_remainder.size()) >= 0) {
-      input_remainder_[index + static_cast<int32_t>(input_remainder_.size())] =
-          old_remainder[input_index +
-                        static_cast<int32_t>(old_remainder.size())];
-      // else leave it at zero.
-    }
-  }
-}
-
 }  // namespace sherpa_onnx
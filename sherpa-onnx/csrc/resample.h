@@ -25,6 +25,7 @@
 #define SHERPA_ONNX_CSRC_RESAMPLE_H_
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace sherpa_onnx {
@@ -32,6 +33,11 @@ namespace sherpa_onnx {
 /*
    We require that the input and output sampling rate be specified as
    integers, as this is an easy way to specify that their ratio be rational.
+
+   It is a polyphase FIR resampler. The filter of each output phase is
+   stored in a contiguous table with the same number of taps for every
+   phase. Tables are shared by all resamplers with the same parameters,
+   so creating one per stream is cheap.
 */
 
 class LinearResample {
@@ -70,17 +76,35 @@ class LinearResample {
   /// If your most recent call to the object was with flush == false, it will
   /// have internal state; you can remove this by calling Reset().
   /// Empty input is acceptable.
+  ///
+  /// The capacity of output is reused, so no memory is allocated if you pass
+  /// the same vector in every call.
   void Resample(const float *input, int32_t input_dim, bool flush,
                 std::vector<float> *output);
 
+  /// Same as above, but write to a buffer provided by the caller and
+  /// return the number of output samples. output must have at least
+  /// NumOutputSamples(input_dim, flush) entries.
+  int32_t Resample(const float *input, int32_t input_dim, bool flush,
+                   float *output);
+
+  /// Return the number of output samples of the next call to Resample()
+  /// with input_dim input samples.
+  int32_t NumOutputSamples(int32_t input_dim, bool flush) const;
+
   //// Return the input and output sampling rates (for checks, for example)
   int32_t GetInputSamplingRate() const { return samp_rate_in_; }
   int32_t GetOutputSamplingRate() const { return samp_rate_out_; }
 
  private:
-  void SetIndexesAndWeights();
+  struct Filter;
 
-  float FilterFunc(float) const;
+  /// Return the filter for the given parameters. It is created on the first
+  /// call and shared with all resamplers using it.
+  static std::shared_ptr<const Filter> GetFilter(int32_t samp_rate_in_hz,
+                                                 int32_t samp_rate_out_hz,
+                                                 float filter_cutoff_hz,
+                                                 int32_t num_zeros);
 
   /// This function outputs the number of output samples we will output
   /// for a signal with "input_num_samp" input samples.  If flush == true,
@@ -92,15 +116,6 @@ class LinearResample {
   /// [ 0, input_num_samp/samp_rate_in_ - window_width ).
   int64_t GetNumOutputSamples(int64_t input_num_samp, bool flush) const;
 
-  /// Given an output-sample index, this function outputs to *first_samp_in the
-  /// first input-sample index that we have a weight on (may be negative),
-  /// and to *samp_out_wrapped the index into weights_ where we can get the
-  /// corresponding weights on the input.
-  inline void GetIndexes(int64_t samp_out, int64_t *first_samp_in,
-                         int32_t *samp_out_wrapped) const;
-
-  void SetRemainder(const float *input, int32_t input_dim);
-
  private:
   // The following variables are provided by the user.
   int32_t samp_rate_in_;
@@ -108,35 +123,21 @@ class LinearResample {
   float filter_cutoff_;
   int32_t num_zeros_;
 
-  int32_t input_samples_in_unit_;  ///< The number of input samples in the
-                                   ///< smallest repeating unit: num_samp_in_ =
-                                   ///< samp_rate_in_hz / Gcd(samp_rate_in_hz,
-                                   ///< samp_rate_out_hz)
-
-  int32_t output_samples_in_unit_;  ///< The number of output samples in the
-                                    ///< smallest repeating unit: num_samp_out_
-                                    ///< = samp_rate_out_hz /
-                                    ///< Gcd(samp_rate_in_hz, samp_rate_out_hz)
-
-  /// The first input-sample index that we sum over, for this output-sample
-  /// index.  May be negative; any truncation at the beginning is handled
-  /// separately.  This is just for the first few output samples, but we can
-  /// extrapolate the correct input-sample index for arbitrary output samples.
-  std::vector<int32_t> first_index_;
-
-  /// Weights on the input samples, for this output-sample index.
-  std::vector<std::vector<float>> weights_;
+  /// Filter tables, shared with other resamplers of the same parameters
+  std::shared_ptr<const Filter> filter_;
 
   // the following variables keep track of where we are in a particular signal,
   // if it is being provided over multiple calls to Resample().
 
   int64_t input_sample_offset_ = 0;   ///< The number of input samples we have
                                       ///< already received for this signal
-                                      ///< (including anything in remainder_)
   int64_t output_sample_offset_ = 0;  ///< The number of samples we have already
                                       ///< output for this signal.
-  std::vector<float> input_remainder_;  ///< A small trailing part of the
-                                        ///< previously seen input signal.
+
+  /// It contains the last few input samples of the previous calls
+  /// (zeros at the start of a signal), followed by the input of the current
+  /// call and zero padding for flushing. It is reused across calls.
+  std::vector<float> buffer_;
 };
 
 }  // namespace sherpa_onnx
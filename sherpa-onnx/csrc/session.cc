@@ -5,12 +5,28 @@
 #include "sherpa-onnx/csrc/session.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/provider.h"
+#include "sherpa-onnx/csrc/text-utils.h"
 #if defined(__APPLE__)
 #include "coreml_provider_factory.h"  // NOLINT
 #endif
@@ -25,6 +41,14 @@
 
 namespace sherpa_onnx {
 
+// Keys of the session config entries that record the provider and the
+// provider options of a session option. They are used by CreateSession()
+// to tell apart optimized graphs of the same model for different
+// providers and provider options, e.g., device IDs.
+static constexpr const char *kProviderConfigKey = "sherpa_onnx.provider";
+static constexpr const char *kProviderOptionsConfigKey =
+    "sherpa_onnx.provider_options";
+
 static void OrtStatusFailure(OrtStatus *status, const char *s) {
   const auto &api = Ort::GetApi();
   const char *msg = api.GetErrorMessage(status);
@@ -41,9 +65,20 @@ Ort::SessionOptions GetSessionOptionsImpl(
   Provider p = StringToProvider(provider_str);
 
   Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(num_threads);
+  sess_opts.AddConfigEntry(kProviderConfigKey, provider_str.c_str());
+  if (provider_config) {
+    sess_opts.AddConfigEntry(kProviderOptionsConfigKey,
+                             provider_config->ToString().c_str());
+  }
+
+  if (GetOrtEnvConfig().use_global_thread_pools) {
+    // Use the thread pools of the shared environment. See ort-env.h
+    sess_opts.DisablePerSessionThreads();
+  } else {
+    sess_opts.SetIntraOpNumThreads(num_threads);
 
-  sess_opts.SetInterOpNumThreads(num_threads);
+    sess_opts.SetInterOpNumThreads(num_threads);
+  }
 
   std::vector<std::string> available_providers = Ort::GetAvailableProviders();
   std::ostringstream os;
@@ -278,4 +313,183 @@ Ort::SessionOptions GetSessionOptions(int32_t num_threads,
   return GetSessionOptionsImpl(num_threads, provider_str);
 }
 
+// A fast non-cryptographic hash of the model. It reads 8 bytes at a time
+// so that hashing a large model takes much less time than optimizing it.
+static uint64_t HashModel(const void *data, size_t n) {
+  const char *p = reinterpret_cast<const char *>(data);
+  constexpr uint64_t kPrime = 0x100000001b3ULL;
+  uint64_t h = 0xcbf29ce484222325ULL ^ n;
+
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+    uint64_t w;
+    std::memcpy(&w, p + i, sizeof(w));
+    h = (h ^ w) * kPrime;
+    h ^= h >> 29;
+  }
+
+  for (; i != n; ++i) {
+    h = (h ^ static_cast<uint8_t>(p[i])) * kPrime;
+  }
+
+  return h;
+}
+
+// Graphs are optimized and saved at this level. Unlike ORT_ENABLE_ALL, it
+// does not include layout optimizations, which depend on the CPU. Those
+// are applied when the saved graph is loaded.
+static constexpr GraphOptimizationLevel kSavedOptimizationLevel =
+    GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+
+static const char *CpuArch() {
+#if defined(__x86_64__) || defined(_M_X64)
+  return "x86_64";
+#elif defined(__i386__) || defined(_M_IX86)
+  return "x86";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  return "arm64";
+#elif defined(__arm__) || defined(_M_ARM)
+  return "arm";
+#elif defined(__riscv)
+  return "riscv";
+#else
+  return "unknown";
+#endif
+}
+
+static std::string OptimizedModelFilename(const std::string &dir,
+                                          const void *model_data,
+                                          size_t model_data_length,
+                                          const std::string &key) {
+  uint64_t h = HashModel(model_data, model_data_length);
+
+  h ^= std::hash<std::string>{}(key) + 0x9e3779b97f4a7c15ULL + (h << 6) +
+       (h >> 2);
+
+  std::ostringstream os;
+  os << dir << "/" << std::hex << h << ".onnx";
+  return os.str();
+}
+
+// Other providers, e.g., TensorRT and CoreML, compile the graph into
+// nodes that cannot be saved
+static bool CanSaveOptimizedModel(const std::string &provider) {
+  Provider p = StringToProvider(provider);
+  return p == Provider::kCPU || p == Provider::kCUDA;
+}
+
+std::unique_ptr<Ort::Session> CreateSession(
+    Ort::Env &env, const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts) {
+  std::string dir = GetOrtEnvConfig().optimized_model_cache_dir;
+
+#if ORT_API_VERSION >= 15
+  // A serialized onnx model cannot exceed 2GB
+  constexpr size_t kMaxModelSize = (1ULL << 31) - 1;
+
+  if (dir.empty() || model_data_length >= kMaxModelSize ||
+      !sess_opts.HasConfigEntry(kProviderConfigKey)) {
+    return std::make_unique<Ort::Session>(env, model_data, model_data_length,
+                                          sess_opts);
+  }
+
+  std::string provider =
+      sess_opts.GetConfigEntryOrDefault(kProviderConfigKey, "cpu");
+  if (!CanSaveOptimizedModel(provider)) {
+    return std::make_unique<Ort::Session>(env, model_data, model_data_length,
+                                          sess_opts);
+  }
+
+  // Graphs saved by one version of onnxruntime may not be loadable
+  // by another version
+  std::ostringstream key;
+  key << provider << "-"
+      << sess_opts.GetConfigEntryOrDefault(kProviderOptionsConfigKey, "")
+      << "-" << static_cast<int32_t>(kSavedOptimizationLevel) << "-"
+      << CpuArch() << "-" << OrtGetApiBase()->GetVersionString();
+
+  std::string filename = OptimizedModelFilename(dir, model_data,
+                                                model_data_length, key.str());
+
+  if (FileExists(filename)) {
+    FileBuffer buf = MapFile(filename);
+
+    try {
+      return std::make_unique<Ort::Session>(env, buf.data(), buf.size(),
+                                            sess_opts);
+    } catch (const Ort::Exception &e) {
+      SHERPA_ONNX_LOGE("Failed to load the cached model %s: %s. Ignore it.",
+                       filename.c_str(), e.what());
+    }
+  }
+
+  // If saving the model failed before, it is not tried again, since it
+  // builds the session twice
+  std::string failed = filename + ".failed";
+  if (FileExists(failed)) {
+    return std::make_unique<Ort::Session>(env, model_data, model_data_length,
+                                          sess_opts);
+  }
+
+  // Save to a temporary file first so that other processes never see a
+  // partially written file. The name is unique among threads of all
+  // processes.
+#if defined(_WIN32)
+  int32_t pid = _getpid();
+#else
+  int32_t pid = getpid();
+#endif
+
+  std::ostringstream os;
+  os << filename << ".tmp" << pid << "-"
+     << std::hash<std::thread::id>{}(std::this_thread::get_id());
+  std::string tmp = os.str();
+
+  Ort::SessionOptions opts = sess_opts.Clone();
+  opts.SetGraphOptimizationLevel(kSavedOptimizationLevel);
+#if defined(_WIN32)
+  std::wstring wtmp = ToWideString(tmp);
+  opts.SetOptimizedModelFilePath(wtmp.c_str());
+#else
+  opts.SetOptimizedModelFilePath(tmp.c_str());
+#endif
+
+  try {
+    {
+      // It is only used to save the optimized graph. The returned session
+      // uses the optimization level of sess_opts.
+      Ort::Session sess(env, model_data, model_data_length, opts);
+    }
+
+    if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+      SHERPA_ONNX_LOGE("Failed to save the optimized model to %s",
+                       filename.c_str());
+      std::remove(tmp.c_str());
+    } else {
+      FileBuffer buf = MapFile(filename);
+      return std::make_unique<Ort::Session>(env, buf.data(), buf.size(),
+                                            sess_opts);
+    }
+  } catch (const Ort::Exception &e) {
+    SHERPA_ONNX_LOGE("Failed to save the optimized model to %s: %s",
+                     filename.c_str(), e.what());
+    std::remove(tmp.c_str());
+    std::ofstream(failed).put('\n');
+  }
+#else
+  if (!dir.empty()) {
+    static bool logged = false;
+    if (!logged) {
+      logged = true;
+      SHERPA_ONNX_LOGE(
+          "optimized_model_cache_dir requires onnxruntime >= 1.15. Ignore "
+          "it.");
+    }
+  }
+#endif
+
+  return std::make_unique<Ort::Session>(env, model_data, model_data_length,
+                                        sess_opts);
+}
+
 }  // namespace sherpa_onnx
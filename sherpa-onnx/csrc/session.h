@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_SESSION_H_
 #define SHERPA_ONNX_CSRC_SESSION_H_
 
+#include <memory>
 #include <string>
 
 #include "onnxruntime_cxx_api.h"  // NOLINT
@@ -34,6 +35,24 @@ Ort::SessionOptions GetSessionOptions(const T &config) {
   return GetSessionOptionsImpl(config.num_threads, config.provider);
 }
 
+/** Create a session from a model in memory.
+ *
+ * If OrtEnvConfig::optimized_model_cache_dir is not empty, the graph
+ * optimized by onnxruntime at ORT_ENABLE_EXTENDED is saved to that
+ * directory on the first call. Later calls with the same model, provider,
+ * provider options, CPU architecture and onnxruntime version load the saved
+ * graph, so only the remaining optimizations, e.g., layout optimizations,
+ * are run. Providers that cannot save optimized graphs, i.e., all except
+ * cpu and cuda, do not use the directory.
+ *
+ * Otherwise, it is equivalent to
+ *   std::make_unique<Ort::Session>(env, model_data, model_data_length,
+ *                                  sess_opts)
+ */
+std::unique_ptr<Ort::Session> CreateSession(
+    Ort::Env &env, const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts);
+
 }  // namespace sherpa_onnx
 
 #endif  // SHERPA_ONNX_CSRC_SESSION_H_
@@ -13,6 +13,7 @@
 #include "sherpa-onnx/csrc/alsa.h"
 #include "sherpa-onnx/csrc/audio-tagging.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 
 enum class State {
   kIdle,
@@ -120,7 +121,10 @@ as the device_name.
   sherpa_onnx::AudioTaggingConfig config;
   config.Register(&po);
 
-  po.Read(argc, argv);
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 1) {
     fprintf(stderr, "Please provide only 1 argument: the device name\n");
     po.PrintUsage();
@@ -14,6 +14,7 @@
 
 #include "sherpa-onnx/csrc/alsa.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
 #include "sherpa-onnx/csrc/speaker-embedding-manager.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
@@ -210,7 +211,10 @@ as the device_name.
   sherpa_onnx::SpeakerEmbeddingExtractorConfig config;
   config.Register(&po);
 
-  po.Read(argc, argv);
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 1) {
     fprintf(stderr, "Please provide only 1 argument: the device name\n");
     po.PrintUsage();
@@ -0,0 +1,120 @@
+// sherpa-onnx/csrc/sherpa-onnx-build-hotwords-graph.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <stdio.h>
+
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/context-graph.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/symbol-table.h"
+#include "sherpa-onnx/csrc/utils.h"
+#include "ssentencepiece/csrc/ssentencepiece.h"
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Build a context graph from a hotwords file and save it.
+
+The saved graph can be passed to --hotwords-file of sherpa-onnx and
+sherpa-onnx-offline. It is memory mapped when loaded, so a large number
+of hotwords does not slow down the start of a recognizer.
+
+Usage:
+
+./bin/sherpa-onnx-build-hotwords-graph \
+  --tokens=/path/to/tokens.txt \
+  --modeling-unit=cjkchar+bpe \
+  --bpe-vocab=/path/to/bpe.vocab \
+  --hotwords-score=1.5 \
+  /path/to/hotwords.txt \
+  /path/to/hotwords.graph
+
+--tokens, --modeling-unit and --bpe-vocab must be the same as the ones
+used to decode with the graph.
+)usage";
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+
+  std::string tokens;
+  std::string modeling_unit = "cjkchar";
+  std::string bpe_vocab;
+  float hotwords_score = 1.5;
+
+  po.Register("tokens", &tokens, "Path to tokens.txt of the model");
+
+  po.Register("modeling-unit", &modeling_unit,
+              "The modeling unit of the model, valid values are cjkchar, "
+              "bpe, cjkchar+bpe");
+
+  po.Register("bpe-vocab", &bpe_vocab,
+              "The vocabulary generated by google's sentencepiece program. "
+              "Needed if --modeling-unit is bpe or cjkchar+bpe");
+
+  po.Register("hotwords-score", &hotwords_score,
+              "The bonus score for each token of hotwords that do not have "
+              "their own score");
+
+  po.Read(argc, argv);
+
+  if (po.NumArgs() != 2) {
+    fprintf(stderr,
+            "Error: Please provide the hotwords file and the output file.\n\n");
+    po.PrintUsage();
+    return -1;
+  }
+
+  if (tokens.empty()) {
+    fprintf(stderr, "Please provide --tokens\n");
+    return -1;
+  }
+
+  std::string hotwords_file = po.GetArg(1);
+  std::string output = po.GetArg(2);
+
+  std::ifstream is(hotwords_file);
+  if (!is) {
+    fprintf(stderr, "Failed to open '%s'\n", hotwords_file.c_str());
+    return -1;
+  }
+
+  sherpa_onnx::SymbolTable sym(tokens);
+
+  std::unique_ptr<ssentencepiece::Ssentencepiece> bpe_encoder;
+  if (!bpe_vocab.empty()) {
+    bpe_encoder = std::make_unique<ssentencepiece::Ssentencepiece>(bpe_vocab);
+  }
+
+  const auto begin = std::chrono::steady_clock::now();
+
+  std::vector<std::vector<int32_t>> hotwords;
+  std::vector<float> scores;
+  if (!sherpa_onnx::EncodeHotwords(is, modeling_unit, sym, bpe_encoder.get(),
+                                   &hotwords, &scores)) {
+    fprintf(stderr,
+            "Failed to encode some hotwords, skip them already, see logs "
+            "above for details.\n");
+  }
+
+  sherpa_onnx::ContextGraph graph(hotwords, hotwords_score, scores);
+  graph.Save(output);
+
+  const auto end = std::chrono::steady_clock::now();
+
+  float elapsed_seconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count() /
+      1000.;
+
+  fprintf(stderr, "Number of hotwords: %d\n",
+          static_cast<int32_t>(hotwords.size()));
+  fprintf(stderr, "Number of states: %d\n", graph.NumStates());
+  fprintf(stderr, "Elapsed seconds: %.3f s\n", elapsed_seconds);
+  fprintf(stderr, "Saved to %s\n", output.c_str());
+
+  return 0;
+}
@@ -12,6 +12,7 @@
 #include "sherpa-onnx/csrc/display.h"
 #include "sherpa-onnx/csrc/keyword-spotter.h"
 #include "sherpa-onnx/csrc/microphone.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 
 bool stop = false;
 float mic_sample_rate = 16000;
@@ -61,7 +62,11 @@ for a list of pre-trained models to download.
   sherpa_onnx::KeywordSpotterConfig config;
 
   config.Register(&po);
-  po.Read(argc, argv);
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 0) {
     po.PrintUsage();
     exit(EXIT_FAILURE);
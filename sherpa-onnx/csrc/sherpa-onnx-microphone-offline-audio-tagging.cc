@@ -15,6 +15,7 @@
 #include "sherpa-onnx/csrc/audio-tagging.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/microphone.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 
 enum class State {
   kIdle,
@@ -100,7 +101,10 @@ for more models.
   sherpa_onnx::AudioTaggingConfig config;
   config.Register(&po);
 
-  po.Read(argc, argv);
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 0) {
     fprintf(stderr, "\nThis program does not support positional arguments\n\n");
     po.PrintUsage();
@@ -15,6 +15,7 @@
 #include "portaudio.h"  // NOLINT
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/microphone.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
 #include "sherpa-onnx/csrc/speaker-embedding-manager.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
@@ -190,7 +191,10 @@ Note that `zh` means Chinese, while `en` means English.
   sherpa_onnx::SpeakerEmbeddingExtractorConfig config;
   config.Register(&po);
 
-  po.Read(argc, argv);
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 0) {
     fprintf(stderr,
             "This program does not support any positional arguments.\n");
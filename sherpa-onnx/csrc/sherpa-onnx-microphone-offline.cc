@@ -15,6 +15,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/microphone.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 
 enum class State {
   kIdle,
@@ -117,7 +118,10 @@ for a list of pre-trained models to download.
   sherpa_onnx::OfflineRecognizerConfig config;
   config.Register(&po);
 
-  po.Read(argc, argv);
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 0) {
     po.PrintUsage();
     exit(EXIT_FAILURE);
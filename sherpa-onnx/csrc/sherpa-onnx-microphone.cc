@@ -14,6 +14,7 @@
 #include "sherpa-onnx/csrc/display.h"
 #include "sherpa-onnx/csrc/microphone.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 
 bool stop = false;
 float mic_sample_rate = 16000;
@@ -88,7 +89,11 @@ for a list of pre-trained models to download.
   sherpa_onnx::OnlineRecognizerConfig config;
 
   config.Register(&po);
-  po.Read(argc, argv);
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 0) {
     po.PrintUsage();
     exit(EXIT_FAILURE);
@@ -0,0 +1,234 @@
+// sherpa-onnx/csrc/sherpa-onnx-mixed-load-benchmark.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <stdio.h>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "sherpa-onnx/csrc/offline-punctuation.h"
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/ort-env.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+// Get the number of voluntary and involuntary context switches of this
+// process so far. Both are set to -1 if it is not supported on this platform.
+static void GetContextSwitches(int64_t *voluntary, int64_t *involuntary) {
+#if defined(_WIN32)
+  *voluntary = -1;
+  *involuntary = -1;
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  *voluntary = usage.ru_nvcsw;
+  *involuntary = usage.ru_nivcsw;
+#endif
+}
+
+static void RunAsr(const sherpa_onnx::OnlineRecognizer &recognizer,
+                   const std::vector<float> &samples, int32_t num_iterations) {
+  std::vector<float> tail_paddings(static_cast<int32_t>(0.3 * 16000));
+
+  for (int32_t i = 0; i != num_iterations; ++i) {
+    auto s = recognizer.CreateStream();
+
+    // Feed 0.1 seconds at a time, like a live stream
+    int32_t chunk = 1600;
+    for (int32_t k = 0; k < static_cast<int32_t>(samples.size()); k += chunk) {
+      int32_t n = std::min<int32_t>(chunk, samples.size() - k);
+      s->AcceptWaveform(16000, samples.data() + k, n);
+      while (recognizer.IsReady(s.get())) {
+        recognizer.DecodeStream(s.get());
+      }
+    }
+
+    s->AcceptWaveform(16000, tail_paddings.data(), tail_paddings.size());
+    s->InputFinished();
+    while (recognizer.IsReady(s.get())) {
+      recognizer.DecodeStream(s.get());
+    }
+  }
+}
+
+static void RunVad(const sherpa_onnx::VadModelConfig &config,
+                   const std::vector<float> &samples, int32_t num_iterations) {
+  sherpa_onnx::VoiceActivityDetector vad(config);
+  int32_t window_size = config.ten_vad.model.empty()
+                            ? config.silero_vad.window_size
+                            : config.ten_vad.window_size;
+
+  for (int32_t i = 0; i != num_iterations; ++i) {
+    for (int32_t k = 0; k + window_size <= static_cast<int32_t>(samples.size());
+         k += window_size) {
+      vad.AcceptWaveform(samples.data() + k, window_size);
+      while (!vad.Empty()) {
+        vad.Pop();
+      }
+    }
+    vad.Reset();
+  }
+}
+
+static void RunPunctuation(const sherpa_onnx::OfflinePunctuation &punct,
+                           int32_t num_iterations) {
+  std::string text =
+      "we know that the model runs on many threads at the same time and "
+      "this sentence is long enough to keep the model busy for a while";
+
+  // Punctuation is much faster than ASR and VAD, so it runs more often to
+  // keep it busy during the whole benchmark
+  for (int32_t i = 0; i != 20 * num_iterations; ++i) {
+    punct.AddPunctuation(text);
+  }
+}
+
+int32_t main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Run streaming ASR, VAD and punctuation at the same time in one process and
+report the elapsed time and the number of context switches.
+
+It is for comparing the thread pools of each session with the thread pools
+shared by all sessions. Run it twice, once with
+--ort-use-global-thread-pools=false and once with
+--ort-use-global-thread-pools=true, and compare the results.
+
+Usage:
+
+./bin/sherpa-onnx-mixed-load-benchmark \
+  --tokens=/path/to/tokens.txt \
+  --encoder=/path/to/encoder.onnx \
+  --decoder=/path/to/decoder.onnx \
+  --joiner=/path/to/joiner.onnx \
+  --num-threads=2 \
+  --silero-vad-model=/path/to/silero_vad.onnx \
+  --punct.ct-transformer=/path/to/punct/model.onnx \
+  --num-asr-streams=4 \
+  --num-iterations=3 \
+  --ort-use-global-thread-pools=true \
+  /path/to/foo.wav
+
+The wave file must be 16 kHz and single channel.
+)usage";
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+
+  sherpa_onnx::OnlineRecognizerConfig asr_config;
+  asr_config.Register(&po);
+
+  sherpa_onnx::VadModelConfig vad_config;
+  vad_config.Register(&po);
+
+  // Use a prefix since its model config has the same options as the ASR
+  // model config, e.g., --num-threads
+  sherpa_onnx::OfflinePunctuationConfig punct_config;
+  sherpa_onnx::ParseOptions po_punct("punct", &po);
+  punct_config.Register(&po_punct);
+
+  int32_t num_asr_streams = 4;
+  int32_t num_iterations = 3;
+
+  po.Register("num-asr-streams", &num_asr_streams,
+              "Number of ASR streams decoded at the same time, each in its "
+              "own thread");
+
+  po.Register("num-iterations", &num_iterations,
+              "Number of times each workload processes the input");
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
+  if (po.NumArgs() != 1) {
+    fprintf(stderr, "Error: Please provide exactly 1 wave file.\n\n");
+    po.PrintUsage();
+    return -1;
+  }
+
+  if (!asr_config.Validate() || !vad_config.Validate() ||
+      !punct_config.Validate()) {
+    fprintf(stderr, "Errors in config!\n");
+    return -1;
+  }
+
+  std::string wave_filename = po.GetArg(1);
+  int32_t sampling_rate = -1;
+  bool is_ok = false;
+  std::vector<float> samples =
+      sherpa_onnx::ReadWave(wave_filename, &sampling_rate, &is_ok);
+  if (!is_ok) {
+    fprintf(stderr, "Failed to read '%s'\n", wave_filename.c_str());
+    return -1;
+  }
+
+  if (sampling_rate != 16000) {
+    fprintf(stderr, "Expect a 16 kHz wave file. Given: %d\n", sampling_rate);
+    return -1;
+  }
+
+  sherpa_onnx::OnlineRecognizer recognizer(asr_config);
+  sherpa_onnx::OfflinePunctuation punct(punct_config);
+
+  int64_t voluntary_begin = 0;
+  int64_t involuntary_begin = 0;
+  GetContextSwitches(&voluntary_begin, &involuntary_begin);
+
+  const auto begin = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i != num_asr_streams; ++i) {
+    threads.emplace_back(RunAsr, std::cref(recognizer), std::cref(samples),
+                         num_iterations);
+  }
+
+  threads.emplace_back(RunVad, std::cref(vad_config), std::cref(samples),
+                       num_iterations);
+
+  threads.emplace_back(RunPunctuation, std::cref(punct), num_iterations);
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+
+  int64_t voluntary_end = 0;
+  int64_t involuntary_end = 0;
+  GetContextSwitches(&voluntary_end, &involuntary_end);
+
+  float elapsed_seconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count() /
+      1000.;
+
+  float audio_seconds =
+      samples.size() / 16000. * num_iterations * num_asr_streams;
+
+  fprintf(stderr, "%s\n", sherpa_onnx::GetOrtEnvConfig().ToString().c_str());
+  fprintf(stderr, "ASR streams: %d, iterations: %d\n", num_asr_streams,
+          num_iterations);
+  fprintf(stderr, "Elapsed seconds: %.3f s\n", elapsed_seconds);
+  fprintf(stderr, "ASR real time factor: %.3f\n",
+          elapsed_seconds / audio_seconds);
+
+  if (voluntary_begin >= 0) {
+    fprintf(stderr, "Voluntary context switches: %lld\n",
+            static_cast<long long>(voluntary_end - voluntary_begin));  // NOLINT
+    fprintf(stderr, "Involuntary context switches: %lld\n",
+            static_cast<long long>(                           // NOLINT
+                involuntary_end - involuntary_begin));
+  } else {
+    fprintf(stderr, "Context switches are not available on this platform\n");
+  }
+
+  return 0;
+}
@@ -4,6 +4,7 @@
 #include <stdio.h>
 
 #include "sherpa-onnx/csrc/audio-tagging.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 
@@ -33,7 +34,10 @@ for more models.
   sherpa_onnx::ParseOptions po(kUsageMessage);
   sherpa_onnx::AudioTaggingConfig config;
   config.Register(&po);
-  po.Read(argc, argv);
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
 
   if (po.NumArgs() != 1) {
     fprintf(stderr, "\nError: Please provide 1 wave file\n\n");
@@ -6,6 +6,7 @@
 #include <chrono>  // NOLINT
 
 #include "sherpa-onnx/csrc/offline-speech-denoiser.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 #include "sherpa-onnx/csrc/wave-writer.h"
 
@@ -37,7 +38,10 @@ wget https://github.com/k2-fsa/sherpa-onnx/releases/download/speech-enhancement-
   po.Register("input-wav", &input_wave, "Path to input wav.");
   po.Register("output-wav", &output_wave, "Path to output wav");
 
-  po.Read(argc, argv);
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 0) {
     fprintf(stderr, "Please don't give positional arguments\n");
     po.PrintUsage();
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/spoken-language-identification.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
@@ -48,7 +49,10 @@ for a list of pre-trained models to download.
   sherpa_onnx::SpokenLanguageIdentificationConfig config;
   config.Register(&po);
 
-  po.Read(argc, argv);
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 1) {
     fprintf(stderr, "Error: Please provide 1 wave file.\n\n");
     po.PrintUsage();
@@ -6,6 +6,7 @@
 #include <chrono>  // NOLINT
 
 #include "sherpa-onnx/csrc/offline-punctuation.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 
 int main(int32_t argc, char *argv[]) {
@@ -30,7 +31,11 @@ The output text should look like below:
   sherpa_onnx::ParseOptions po(kUsageMessage);
   sherpa_onnx::OfflinePunctuationConfig config;
   config.Register(&po);
-  po.Read(argc, argv);
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 1) {
     fprintf(stderr,
             "Error: Please provide only 1 position argument containing the "
@@ -19,6 +19,7 @@
 
 #include "sherpa-onnx/csrc/alsa-play.h"
 #include "sherpa-onnx/csrc/offline-tts.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/wave-writer.h"
 
@@ -141,7 +142,10 @@ or details.
   sherpa_onnx::OfflineTtsConfig config;
 
   config.Register(&po);
-  po.Read(argc, argv);
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
 
   if (po.NumArgs() == 0) {
     fprintf(stderr, "Error: Please provide the text to generate audio.\n\n");
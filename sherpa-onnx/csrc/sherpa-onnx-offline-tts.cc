@@ -6,6 +6,7 @@
 #include <fstream>
 
 #include "sherpa-onnx/csrc/offline-tts.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/wave-writer.h"
 
@@ -58,7 +59,10 @@ or details.
   sherpa_onnx::OfflineTtsConfig config;
 
   config.Register(&po);
-  po.Read(argc, argv);
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
 
   if (po.NumArgs() == 0) {
     fprintf(stderr, "Error: Please provide the text to generate audio.\n\n");
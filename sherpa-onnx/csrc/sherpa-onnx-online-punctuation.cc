@@ -8,6 +8,7 @@
 #include <iostream>
 
 #include "sherpa-onnx/csrc/online-punctuation.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 
 int main(int32_t argc, char *argv[]) {
@@ -33,7 +34,11 @@ The output text should look like below:
   sherpa_onnx::ParseOptions po(kUsageMessage);
   sherpa_onnx::OnlinePunctuationConfig config;
   config.Register(&po);
-  po.Read(argc, argv);
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 1) {
     fprintf(stderr,
             "Error: Please provide only 1 positional argument containing the "
@@ -0,0 +1,121 @@
+// sherpa-onnx/csrc/sherpa-onnx-online-speaker-diarization.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/online-speaker-diarization.h"
+#include "sherpa-onnx/csrc/ort-env.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Online/Streaming speaker diarization with sherpa-onnx
+
+It feeds the given wave file chunk by chunk to simulate a live stream and
+prints each speaker segment as soon as it is finished.
+
+Please refer to ./bin/sherpa-onnx-offline-speaker-diarization --help
+for how to download the models and test wave files.
+
+Usage example:
+
+  ./bin/sherpa-onnx-online-speaker-diarization \
+    --threshold=0.5 \
+    --step=2 \
+    --segmentation.pyannote-model=./sherpa-onnx-pyannote-segmentation-3-0/model.onnx \
+    --embedding.model=./3dspeaker_speech_eres2net_base_sv_zh-cn_3dspeaker_16k.onnx \
+    ./0-four-speakers-zh.wav
+
+A larger threshold leads to fewer speakers;
+a smaller threshold leads to more speakers.
+
+A smaller --step leads to lower latency and more computation.
+  )usage";
+  sherpa_onnx::OnlineSpeakerDiarizationConfig config;
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  config.Register(&po);
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
+  std::cout << config.ToString() << "\n";
+
+  if (!config.Validate()) {
+    po.PrintUsage();
+    std::cerr << "Errors in config!\n";
+    return -1;
+  }
+
+  if (po.NumArgs() != 1) {
+    std::cerr << "Error: Please provide exactly 1 wave file.\n\n";
+    po.PrintUsage();
+    return -1;
+  }
+
+  sherpa_onnx::OnlineSpeakerDiarization sd(config);
+
+  std::cout << "Started\n";
+  const auto begin = std::chrono::steady_clock::now();
+  const std::string wav_filename = po.GetArg(1);
+
+  // Read the file chunk by chunk so that long recordings do not need to
+  // be loaded into memory
+  sherpa_onnx::WaveReader reader(wav_filename);
+  if (!reader.IsOk()) {
+    std::cerr << "Failed to read " << wav_filename.c_str() << "\n";
+    return -1;
+  }
+
+  int32_t sample_rate = reader.SampleRate();
+  if (sample_rate != sd.SampleRate()) {
+    std::cerr << "Expect sample rate " << sd.SampleRate()
+              << ". Given: " << sample_rate << "\n";
+    return -1;
+  }
+
+  float duration = reader.NumSamples() / static_cast<float>(sample_rate);
+
+  // 100 ms per chunk
+  int32_t chunk_size = sample_rate / 10;
+  std::vector<float> samples(chunk_size);
+  for (int64_t start = 0; start < reader.NumSamples(); start += chunk_size) {
+    int32_t n = reader.Read(start, chunk_size, samples.data());
+    sd.AcceptWaveform(samples.data(), n);
+
+    while (!sd.Empty()) {
+      std::cout << sd.Front().ToString() << "\n";
+      sd.Pop();
+    }
+  }
+
+  sd.Flush();
+
+  while (!sd.Empty()) {
+    std::cout << sd.Front().ToString() << "\n";
+    sd.Pop();
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+  float elapsed_seconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count() /
+      1000.;
+
+  fprintf(stderr, "Number of speakers: %d\n", sd.NumSpeakers());
+  fprintf(stderr, "Duration : %.3f s\n", duration);
+  fprintf(stderr, "Elapsed seconds: %.3f s\n", elapsed_seconds);
+  float rtf = elapsed_seconds / duration;
+  fprintf(stderr, "Real time factor (RTF): %.3f / %.3f = %.3f\n",
+          elapsed_seconds, duration, rtf);
+
+  return 0;
+}
@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <iomanip>
 
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/voice-activity-detector.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 #include "sherpa-onnx/csrc/wave-writer.h"
@@ -35,7 +36,11 @@ input.wav should be 16kHz.
   sherpa_onnx::VadModelConfig config;
 
   config.Register(&po);
-  po.Read(argc, argv);
+
+  if (!sherpa_onnx::ReadOptionsAndInitOrtEnv(&po, argc, argv)) {
+    return -1;
+  }
+
   if (po.NumArgs() != 2) {
     fprintf(
         stderr,
@@ -52,17 +57,17 @@ input.wav should be 16kHz.
   }
 
   std::string wav_filename = po.GetArg(1);
-  int32_t sampling_rate = -1;
 
-  bool is_ok = false;
-  std::vector<float> samples =
-      sherpa_onnx::ReadWave(wav_filename, &sampling_rate, &is_ok);
+  // Read the file chunk by chunk so that long recordings do not need to
+  // be loaded into memory
+  sherpa_onnx::WaveReader reader(wav_filename);
 
-  if (!is_ok) {
+  if (!reader.IsOk()) {
     fprintf(stderr, "Failed to read '%s'\n", wav_filename.c_str());
     return -1;
   }
 
+  int32_t sampling_rate = reader.SampleRate();
   if (sampling_rate != 16000) {
     fprintf(stderr, "Support only 16000Hz. Given: %d\n", sampling_rate);
     return -1;
@@ -72,14 +77,16 @@ input.wav should be 16kHz.
 
   int32_t window_size = config.silero_vad.window_size;
 
-  int32_t i = 0;
+  int64_t i = 0;
   bool is_eof = false;
 
+  std::vector<float> samples(window_size);
   std::vector<float> samples_without_silence;
 
   while (!is_eof) {
-    if (i + window_size < samples.size()) {
-      vad->AcceptWaveform(samples.data() + i, window_size);
+    if (i + window_size < reader.NumSamples()) {
+      reader.Read(i, window_size, samples.data());
+      vad->AcceptWaveform(samples.data(), window_size);
       i += window_size;
     } else {
       vad->Flush();
@@ -4,6 +4,8 @@
 
 #include "sherpa-onnx/csrc/silero-vad-model.h"
 
+#include <algorithm>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -20,7 +22,10 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
+#include "sherpa-onnx/csrc/vad-slot-table.h"
+#include "sherpa-onnx/csrc/vad-state-machine.h"
 
 namespace sherpa_onnx {
 
@@ -28,11 +33,12 @@ class SileroVadModel::Impl {
  public:
   explicit Impl(const VadModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{},
-        sample_rate_(config.sample_rate) {
-    auto buf = ReadFile(config.silero_vad.model);
+        sample_rate_(config.sample_rate),
+        slots_(kSlotSize) {
+    auto buf = MapFile(config.silero_vad.model);
     Init(buf.data(), buf.size());
 
     if (sample_rate_ != 16000) {
@@ -50,10 +56,11 @@ class SileroVadModel::Impl {
   template <typename Manager>
   Impl(Manager *mgr, const VadModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{},
-        sample_rate_(config.sample_rate) {
+        sample_rate_(config.sample_rate),
+        slots_(kSlotSize) {
     auto buf = ReadFile(mgr, config.silero_vad.model);
     Init(buf.data(), buf.size());
 
@@ -84,10 +91,7 @@ class SileroVadModel::Impl {
       ResetV4();
     }
 
-    triggered_ = false;
-    current_sample_ = 0;
-    temp_start_ = 0;
-    temp_end_ = 0;
+    state_machine_.Reset();
   }
 
   bool IsSpeech(const float *samples, int32_t n) {
@@ -98,68 +102,9 @@ class SileroVadModel::Impl {
 
     float prob = Run(samples, n);
 
-    float threshold = config_.silero_vad.threshold;
-
-    current_sample_ += config_.silero_vad.window_size;
-
-    if (prob > threshold && temp_end_ != 0) {
-      temp_end_ = 0;
-    }
-
-    if (prob > threshold && temp_start_ == 0) {
-      // start speaking, but we require that it must satisfy
-      // min_speech_duration
-      temp_start_ = current_sample_;
-      return false;
-    }
-
-    if (prob > threshold && temp_start_ != 0 && !triggered_) {
-      if (current_sample_ - temp_start_ < min_speech_samples_) {
-        return false;
-      }
-
-      triggered_ = true;
-
-      return true;
-    }
-
-    if ((prob < threshold) && !triggered_) {
-      // silence
-      temp_start_ = 0;
-      temp_end_ = 0;
-      return false;
-    }
-
-    if ((prob > threshold - 0.15) && triggered_) {
-      // speaking
-      return true;
-    }
-
-    if ((prob > threshold) && !triggered_) {
-      // start speaking
-      triggered_ = true;
-
-      return true;
-    }
-
-    if ((prob < threshold) && triggered_) {
-      // stop to speak
-      if (temp_end_ == 0) {
-        temp_end_ = current_sample_;
-      }
-
-      if (current_sample_ - temp_end_ < min_silence_samples_) {
-        // continue speaking
-        return true;
-      }
-      // stopped speaking
-      temp_start_ = 0;
-      temp_end_ = 0;
-      triggered_ = false;
-      return false;
-    }
-
-    return false;
+    return state_machine_.IsSpeech(prob, config_.silero_vad.window_size,
+                                   config_.silero_vad.threshold,
+                                   min_speech_samples_, min_silence_samples_);
   }
 
   int32_t WindowShift() const { return config_.silero_vad.window_size; }
@@ -180,10 +125,38 @@ class SileroVadModel::Impl {
     config_.silero_vad.threshold = threshold;
   }
 
+  int32_t AllocateSlot() {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    return slots_.Allocate();
+  }
+
+  void FreeSlot(int32_t slot) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    slots_.Free(slot);
+  }
+
+  void ResetSlot(int32_t slot) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    slots_.Reset(slot);
+  }
+
+  void Run(const float *const *samples, const int32_t *slots, int32_t n,
+           float *probs) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+
+    // If the batch dimension of the model is fixed to 1, we run the
+    // streams one by one. The states are still kept in the slot table.
+    int32_t batch_size = support_batch_ ? n : 1;
+
+    for (int32_t i = 0; i < n; i += batch_size) {
+      int32_t this_batch_size = std::min(batch_size, n - i);
+      RunBatch(samples + i, slots + i, this_batch_size, probs + i);
+    }
+  }
+
  private:
-  void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+  void Init(const void *model_data, size_t model_data_length) {
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
     GetOutputNames(sess_.get(), &output_names_, &output_names_ptr_);
@@ -210,6 +183,11 @@ class SileroVadModel::Impl {
 
     Check();
 
+    // -1 means the batch dimension is dynamic
+    auto x_shape =
+        sess_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    support_batch_ = !x_shape.empty() && x_shape[0] != 1;
+
     Reset();
   }
 
@@ -396,6 +374,84 @@ class SileroVadModel::Impl {
     return prob;
   }
 
+  // For both v4 and v5, the states of a stream consist of 2x128 floats:
+  //  - v5: state of shape (2, 1, 128)
+  //  - v4: h of shape (2, 1, 64), followed by c of shape (2, 1, 64)
+  static constexpr int32_t kSlotSize = 256;
+
+  void RunBatch(const float *const *samples, const int32_t *slots,
+                int32_t n, float *probs) {
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    int32_t window_size = WindowSize();
+
+    x_buf_.resize(n * window_size);
+    for (int32_t i = 0; i != n; ++i) {
+      std::copy(samples[i], samples[i] + window_size,
+                x_buf_.data() + i * window_size);
+    }
+
+    std::array<int64_t, 2> x_shape = {n, window_size};
+    Ort::Value x = Ort::Value::CreateTensor(memory_info, x_buf_.data(),
+                                            x_buf_.size(), x_shape.data(),
+                                            x_shape.size());
+
+    int64_t sr_shape = 1;
+    Ort::Value sr =
+        Ort::Value::CreateTensor(memory_info, &sample_rate_, 1, &sr_shape, 1);
+
+    std::vector<Ort::Value> inputs;
+    inputs.reserve(input_names_.size());
+    inputs.push_back(std::move(x));
+
+    state_buf_.resize(n * kSlotSize);
+
+    if (is_v5_) {
+      std::array<int64_t, 3> state_shape = {2, n, 128};
+      slots_.Gather(slots, n, 0, 2, 128, state_buf_.data());
+
+      inputs.push_back(Ort::Value::CreateTensor(
+          memory_info, state_buf_.data(), state_buf_.size(),
+          state_shape.data(), state_shape.size()));
+      inputs.push_back(std::move(sr));
+    } else {
+      std::array<int64_t, 3> state_shape = {2, n, 64};
+      float *h = state_buf_.data();
+      float *c = h + n * kSlotSize / 2;
+
+      slots_.Gather(slots, n, 0, 2, 64, h);
+      slots_.Gather(slots, n, kSlotSize / 2, 2, 64, c);
+
+      if (input_names_.size() == 4) {
+        inputs.push_back(std::move(sr));
+      }
+
+      inputs.push_back(Ort::Value::CreateTensor(memory_info, h, n * 128,
+                                                state_shape.data(),
+                                                state_shape.size()));
+      inputs.push_back(Ort::Value::CreateTensor(memory_info, c, n * 128,
+                                                state_shape.data(),
+                                                state_shape.size()));
+    }
+
+    auto out =
+        sess_->Run({}, input_names_ptr_.data(), inputs.data(), inputs.size(),
+                   output_names_ptr_.data(), output_names_ptr_.size());
+
+    if (is_v5_) {
+      slots_.Scatter(out[1].GetTensorData<float>(), slots, n, 0, 2, 128);
+    } else {
+      slots_.Scatter(out[1].GetTensorData<float>(), slots, n, 0, 2, 64);
+      slots_.Scatter(out[2].GetTensorData<float>(), slots, n, kSlotSize / 2,
+                     2, 64);
+    }
+
+    // the output prob is of shape (n, 1)
+    const float *p = out[0].GetTensorData<float>();
+    std::copy(p, p + n, probs);
+  }
+
   float RunV4(const float *samples, int32_t n) {
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
@@ -434,7 +490,7 @@ class SileroVadModel::Impl {
  private:
   VadModelConfig config_;
 
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
@@ -451,14 +507,20 @@ class SileroVadModel::Impl {
   int32_t min_silence_samples_;
   int32_t min_speech_samples_;
 
-  bool triggered_ = false;
-  int32_t current_sample_ = 0;
-  int32_t temp_start_ = 0;
-  int32_t temp_end_ = 0;
+  VadStateMachine state_machine_;
 
   int32_t window_overlap_ = 0;
 
   bool is_v5_ = false;
+
+  // for multiple streams
+  // It protects slots_ and the buffers below, since streams may be
+  // created, destroyed and computed from different threads
+  std::mutex slots_mutex_;
+  VadSlotTable slots_;
+  bool support_batch_ = false;
+  std::vector<float> x_buf_;
+  std::vector<float> state_buf_;
 };
 
 SileroVadModel::SileroVadModel(const VadModelConfig &config)
@@ -500,6 +562,17 @@ float SileroVadModel::Compute(const float *samples, int32_t n) {
   return impl_->Run(samples, n);
 }
 
+int32_t SileroVadModel::AllocateSlot() { return impl_->AllocateSlot(); }
+
+void SileroVadModel::FreeSlot(int32_t slot) { impl_->FreeSlot(slot); }
+
+void SileroVadModel::ResetSlot(int32_t slot) { impl_->ResetSlot(slot); }
+
+void SileroVadModel::Compute(const float *const *samples,
+                             const int32_t *slots, int32_t n, float *probs) {
+  impl_->Run(samples, slots, n, probs);
+}
+
 #if __ANDROID_API__ >= 9
 template SileroVadModel::SileroVadModel(AAssetManager *mgr,
                                         const VadModelConfig &config);
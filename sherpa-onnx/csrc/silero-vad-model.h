@@ -47,6 +47,13 @@ class SileroVadModel : public VadModel {
   void SetMinSilenceDuration(float s) override;
   void SetThreshold(float threshold) override;
 
+  int32_t AllocateSlot() override;
+  void FreeSlot(int32_t slot) override;
+  void ResetSlot(int32_t slot) override;
+
+  void Compute(const float *const *samples, const int32_t *slots, int32_t n,
+               float *probs) override;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
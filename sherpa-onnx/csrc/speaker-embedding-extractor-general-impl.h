@@ -42,7 +42,88 @@ class SpeakerEmbeddingExtractorGeneralImpl
     return s->GetNumProcessedFrames() < s->NumFramesReady();
   }
 
-  std::vector<float> Compute(OnlineStream *s) const override {
+  using SpeakerEmbeddingExtractorImpl::Compute;
+
+  std::vector<std::vector<float>> Compute(OnlineStream **ss,
+                                          int32_t n) const override {
+    std::vector<std::vector<float>> ans(n);
+
+    std::vector<std::vector<float>> features(n);
+    std::vector<int32_t> indexes;
+    indexes.reserve(n);
+
+    int32_t feat_dim = 0;
+    for (int32_t i = 0; i != n; ++i) {
+      features[i] = GetFeatures(ss[i], &feat_dim);
+      if (!features[i].empty()) {
+        indexes.push_back(i);
+      }
+    }
+
+    if (indexes.empty()) {
+      return ans;
+    }
+
+    // The model has no input for the number of valid frames, so padding
+    // would change the result. We only batch streams with the same number
+    // of frames.
+    std::stable_sort(indexes.begin(), indexes.end(),
+                     [&features](int32_t a, int32_t b) {
+                       return features[a].size() < features[b].size();
+                     });
+
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::vector<float> batch;
+    int32_t num_indexes = indexes.size();
+    for (int32_t start = 0; start < num_indexes;) {
+      int32_t end = start + 1;
+      int32_t size = features[indexes[start]].size();
+      while (end < num_indexes &&
+             static_cast<int32_t>(features[indexes[end]].size()) == size) {
+        ++end;
+      }
+
+      int32_t batch_size = end - start;
+      int32_t num_frames = size / feat_dim;
+
+      const float *p = features[indexes[start]].data();
+      if (batch_size > 1) {
+        batch.resize(batch_size * size);
+        for (int32_t i = start; i != end; ++i) {
+          std::copy(features[indexes[i]].begin(), features[indexes[i]].end(),
+                    batch.begin() + (i - start) * size);
+        }
+        p = batch.data();
+      }
+
+      std::array<int64_t, 3> x_shape{batch_size, num_frames, feat_dim};
+      Ort::Value x = Ort::Value::CreateTensor(
+          memory_info, const_cast<float *>(p), batch_size * size,
+          x_shape.data(), x_shape.size());
+
+      Ort::Value embedding = model_.Compute(std::move(x));
+      std::vector<int64_t> embedding_shape =
+          embedding.GetTensorTypeAndShapeInfo().GetShape();
+      int32_t dim = embedding_shape[1];
+
+      const float *q = embedding.GetTensorData<float>();
+      for (int32_t i = start; i != end; ++i, q += dim) {
+        ans[indexes[i]] = std::vector<float>(q, q + dim);
+      }
+
+      start = end;
+    }
+
+    return ans;
+  }
+
+ private:
+  // Return the unprocessed features of the given stream after
+  // normalization. Return an empty vector if there are no unprocessed
+  // features.
+  std::vector<float> GetFeatures(OnlineStream *s, int32_t *feat_dim) const {
     int32_t num_frames = s->NumFramesReady() - s->GetNumProcessedFrames();
     if (num_frames <= 0) {
 #if __OHOS__
@@ -62,12 +143,12 @@ class SpeakerEmbeddingExtractorGeneralImpl
 
     s->GetNumProcessedFrames() += num_frames;
 
-    int32_t feat_dim = features.size() / num_frames;
+    *feat_dim = features.size() / num_frames;
 
     const auto &meta_data = model_.GetMetaData();
     if (!meta_data.feature_normalize_type.empty()) {
       if (meta_data.feature_normalize_type == "global-mean") {
-        SubtractGlobalMean(features.data(), num_frames, feat_dim);
+        SubtractGlobalMean(features.data(), num_frames, *feat_dim);
       } else {
 #if __OHOS__
         SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %{public}s",
@@ -80,25 +161,9 @@ class SpeakerEmbeddingExtractorGeneralImpl
       }
     }
 
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    std::array<int64_t, 3> x_shape{1, num_frames, feat_dim};
-    Ort::Value x =
-        Ort::Value::CreateTensor(memory_info, features.data(), features.size(),
-                                 x_shape.data(), x_shape.size());
-    Ort::Value embedding = model_.Compute(std::move(x));
-    std::vector<int64_t> embedding_shape =
-        embedding.GetTensorTypeAndShapeInfo().GetShape();
-
-    std::vector<float> ans(embedding_shape[1]);
-    std::copy(embedding.GetTensorData<float>(),
-              embedding.GetTensorData<float>() + ans.size(), ans.begin());
-
-    return ans;
+    return features;
   }
 
- private:
   void SubtractGlobalMean(float *p, int32_t num_frames,
                           int32_t feat_dim) const {
     auto m = Eigen::Map<
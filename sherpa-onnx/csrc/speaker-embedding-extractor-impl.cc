@@ -15,6 +15,8 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/speaker-embedding-extractor-general-impl.h"
 #include "sherpa-onnx/csrc/speaker-embedding-extractor-nemo-impl.h"
 
@@ -31,15 +33,12 @@ enum class ModelType : std::uint8_t {
 
 }  // namespace
 
-static ModelType GetModelType(char *model_data, size_t model_data_length,
+static ModelType GetModelType(const char *model_data, size_t model_data_length,
                               bool debug) {
-  Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
-  Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(1);
-  sess_opts.SetInterOpNumThreads(1);
+  Ort::Env &env = GetOrtEnv();
+  Ort::SessionOptions sess_opts = GetSessionOptions(1, "cpu");
 
-  auto sess = std::make_unique<Ort::Session>(env, model_data, model_data_length,
-                                             sess_opts);
+  auto sess = CreateSession(env, model_data, model_data_length, sess_opts);
 
   Ort::ModelMetadata meta_data = sess->GetModelMetadata();
   if (debug) {
@@ -88,7 +87,7 @@ SpeakerEmbeddingExtractorImpl::Create(
   ModelType model_type = ModelType::kUnknown;
 
   {
-    auto buffer = ReadFile(config.model);
+    auto buffer = MapFile(config.model);
 
     model_type = GetModelType(buffer.data(), buffer.size(), config.debug);
   }
@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
@@ -30,7 +31,13 @@ class SpeakerEmbeddingExtractorImpl {
 
   virtual bool IsReady(OnlineStream *s) const = 0;
 
-  virtual std::vector<float> Compute(OnlineStream *s) const = 0;
+  virtual std::vector<float> Compute(OnlineStream *s) const {
+    OnlineStream *ss[1] = {s};
+    return std::move(Compute(ss, 1)[0]);
+  }
+
+  virtual std::vector<std::vector<float>> Compute(OnlineStream **ss,
+                                                  int32_t n) const = 0;
 };
 
 }  // namespace sherpa_onnx
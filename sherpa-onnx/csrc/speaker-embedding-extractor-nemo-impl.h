@@ -50,32 +50,127 @@ class SpeakerEmbeddingExtractorNeMoImpl : public SpeakerEmbeddingExtractorImpl {
     return s->GetNumProcessedFrames() < s->NumFramesReady();
   }
 
-  std::vector<float> Compute(OnlineStream *s) const override {
-    int32_t num_frames = s->NumFramesReady() - s->GetNumProcessedFrames();
-    if (num_frames <= 0) {
+  using SpeakerEmbeddingExtractorImpl::Compute;
+
+  std::vector<std::vector<float>> Compute(OnlineStream **ss,
+                                          int32_t n) const override {
+    std::vector<std::vector<float>> ans(n);
+
+    std::vector<std::vector<float>> features(n);
+    std::vector<int32_t> num_frames(n);
+    std::vector<int32_t> indexes;
+    indexes.reserve(n);
+
+    int32_t feat_dim = 0;
+    for (int32_t i = 0; i != n; ++i) {
+      features[i] = GetFeatures(ss[i], &num_frames[i], &feat_dim);
+      if (!features[i].empty()) {
+        indexes.push_back(i);
+      }
+    }
+
+    if (indexes.empty()) {
+      return ans;
+    }
+
+    // The model accepts the number of valid frames of each utterance, so
+    // we can pad utterances in a batch. To limit the computation wasted on
+    // padding, streams are sorted by length and a new batch is started
+    // once the longest utterance is more than 25% longer than the shortest
+    // one.
+    std::stable_sort(indexes.begin(), indexes.end(),
+                     [&num_frames](int32_t a, int32_t b) {
+                       return num_frames[a] < num_frames[b];
+                     });
+
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::vector<float> batch;
+    std::vector<int64_t> x_lens;
+    int32_t num_indexes = indexes.size();
+    for (int32_t start = 0; start < num_indexes;) {
+      int32_t min_frames = num_frames[indexes[start]];
+      int32_t end = start + 1;
+      while (end < num_indexes &&
+             num_frames[indexes[end]] * 4 <= min_frames * 5) {
+        ++end;
+      }
+
+      int32_t batch_size = end - start;
+      int32_t max_frames = num_frames[indexes[end - 1]];
+      if (batch_size > 1 && max_frames % 16 != 0) {
+        max_frames += 16 - max_frames % 16;
+      }
+
+      batch.assign(batch_size * max_frames * feat_dim, 0);
+      x_lens.resize(batch_size);
+      for (int32_t i = start; i != end; ++i) {
+        std::copy(features[indexes[i]].begin(), features[indexes[i]].end(),
+                  batch.begin() + (i - start) * max_frames * feat_dim);
+        x_lens[i - start] = num_frames[indexes[i]];
+      }
+
+      std::array<int64_t, 3> x_shape{batch_size, max_frames, feat_dim};
+      Ort::Value x =
+          Ort::Value::CreateTensor(memory_info, batch.data(), batch.size(),
+                                   x_shape.data(), x_shape.size());
+
+      x = Transpose12(model_.Allocator(), &x);
+
+      std::array<int64_t, 1> x_lens_shape{batch_size};
+      Ort::Value x_lens_tensor =
+          Ort::Value::CreateTensor(memory_info, x_lens.data(), x_lens.size(),
+                                   x_lens_shape.data(), x_lens_shape.size());
+
+      Ort::Value embedding =
+          model_.Compute(std::move(x), std::move(x_lens_tensor));
+      std::vector<int64_t> embedding_shape =
+          embedding.GetTensorTypeAndShapeInfo().GetShape();
+      int32_t dim = embedding_shape[1];
+
+      const float *q = embedding.GetTensorData<float>();
+      for (int32_t i = start; i != end; ++i, q += dim) {
+        ans[indexes[i]] = std::vector<float>(q, q + dim);
+      }
+
+      start = end;
+    }
+
+    return ans;
+  }
+
+ private:
+  // Return the unprocessed features of the given stream after
+  // normalization. Return an empty vector if there are no unprocessed
+  // features.
+  std::vector<float> GetFeatures(OnlineStream *s, int32_t *num_frames,
+                                 int32_t *feat_dim) const {
+    *num_frames = s->NumFramesReady() - s->GetNumProcessedFrames();
+    if (*num_frames <= 0) {
 #if __OHOS__
       SHERPA_ONNX_LOGE(
           "Please make sure IsReady(s) returns true. num_frames: %{public}d",
-          num_frames);
+          *num_frames);
 #else
       SHERPA_ONNX_LOGE(
           "Please make sure IsReady(s) returns true. num_frames: %d",
-          num_frames);
+          *num_frames);
 #endif
       return {};
     }
 
     std::vector<float> features =
-        s->GetFrames(s->GetNumProcessedFrames(), num_frames);
+        s->GetFrames(s->GetNumProcessedFrames(), *num_frames);
 
-    s->GetNumProcessedFrames() += num_frames;
+    s->GetNumProcessedFrames() += *num_frames;
 
-    int32_t feat_dim = features.size() / num_frames;
+    *feat_dim = features.size() / *num_frames;
 
     const auto &meta_data = model_.GetMetaData();
     if (!meta_data.feature_normalize_type.empty()) {
       if (meta_data.feature_normalize_type == "per_feature") {
-        NormalizePerFeature(features.data(), num_frames, feat_dim);
+        NormalizePerFeature(features.data(), *num_frames, *feat_dim);
       } else {
 #if __OHOS__
         SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %{public}s",
@@ -89,39 +184,9 @@ class SpeakerEmbeddingExtractorNeMoImpl : public SpeakerEmbeddingExtractorImpl {
       }
     }
 
-    if (num_frames % 16 != 0) {
-      int32_t pad = 16 - num_frames % 16;
-      features.resize((num_frames + pad) * feat_dim);
-    }
-
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    std::array<int64_t, 3> x_shape{1, num_frames, feat_dim};
-    Ort::Value x =
-        Ort::Value::CreateTensor(memory_info, features.data(), features.size(),
-                                 x_shape.data(), x_shape.size());
-
-    x = Transpose12(model_.Allocator(), &x);
-
-    int64_t x_lens = num_frames;
-    std::array<int64_t, 1> x_lens_shape{1};
-    Ort::Value x_lens_tensor = Ort::Value::CreateTensor(
-        memory_info, &x_lens, 1, x_lens_shape.data(), x_lens_shape.size());
-
-    Ort::Value embedding =
-        model_.Compute(std::move(x), std::move(x_lens_tensor));
-    std::vector<int64_t> embedding_shape =
-        embedding.GetTensorTypeAndShapeInfo().GetShape();
-
-    std::vector<float> ans(embedding_shape[1]);
-    std::copy(embedding.GetTensorData<float>(),
-              embedding.GetTensorData<float>() + ans.size(), ans.begin());
-
-    return ans;
+    return features;
   }
 
- private:
   void NormalizePerFeature(float *p, int32_t num_frames,
                            int32_t feat_dim) const {
     auto m = Eigen::Map<
@@ -62,6 +62,18 @@ class SpeakerEmbeddingExtractor {
   // You have to ensure IsReady(s) returns true before you call this method.
   std::vector<float> Compute(OnlineStream *s) const;
 
+  /** Compute speaker embeddings for a list of streams.
+   *
+   * Streams are grouped by the number of feature frames and each group
+   * is processed with a single call to the model.
+   *
+   * @param ss Pointer to an array of streams.
+   * @param n  Size of the input array.
+   * @return Return a vector of size n. ans[i] is the embedding for ss[i].
+   *         It is empty if IsReady(ss[i]) is false.
+   */
+  std::vector<std::vector<float>> Compute(OnlineStream **ss, int32_t n) const;
+
  private:
   std::unique_ptr<SpeakerEmbeddingExtractorImpl> impl_;
 };
@@ -242,19 +242,30 @@ std::string SymbolTable::DecodeByteBpe(const std::string &text) const {
   if (!is_bbpe_) {
     return text;
   }
+
+  std::string ans;
+  DecodeByteBpe(text, &ans);
+  return ans;
+}
+
+void SymbolTable::DecodeByteBpe(const std::string &text,
+                                std::string *ans) const {
+  if (!is_bbpe_) {
+    ans->append(text);
+    return;
+  }
   auto v = SplitUtf8(text);
 
   const auto &bbpe_table = GetByteBpeTable();
-  std::string ans;
   for (const auto &s : v) {
     if (s == "▁") {
-      if (!ans.empty() && ans.back() != ' ' && std::isprint(ans.back())) {
-        ans.push_back(' ');
+      if (!ans->empty() && ans->back() != ' ' && std::isprint(ans->back())) {
+        ans->push_back(' ');
       }
     } else if (bbpe_table.count(s)) {
-      ans.push_back(bbpe_table.at(s));
+      ans->push_back(bbpe_table.at(s));
     } else if (std::isprint(s[0])) {
-      ans.append(s);
+      ans->append(s);
     } else {
       // Should not happen
       SHERPA_ONNX_LOGE("Skip OOV: %s from %s", s.c_str(), text.c_str());
@@ -262,7 +273,6 @@ std::string SymbolTable::DecodeByteBpe(const std::string &text) const {
   }
 
   // TODO(fangjun): Filter invalid utf-8 sequences
-  return ans;
 }
 
 #if __ANDROID_API__ >= 9
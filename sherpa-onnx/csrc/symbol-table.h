@@ -58,6 +58,12 @@ class SymbolTable {
 
   std::string DecodeByteBpe(const std::string &text) const;
 
+  // Same as above, but append the result to *ans. Since spaces are added
+  // depending on the last character of *ans, decoding a text piece by piece
+  // gives the same result as decoding it at once if each piece starts at
+  // a boundary of SplitUtf8(); see IsSplitUtf8Boundary().
+  void DecodeByteBpe(const std::string &text, std::string *ans) const;
+
   bool IsByteBpe() const { return is_bbpe_; }
 
  private:
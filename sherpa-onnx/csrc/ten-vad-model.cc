@@ -8,6 +8,7 @@
 #include <cmath>
 #include <cstring>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,8 +27,11 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/vad-slot-table.h"
+#include "sherpa-onnx/csrc/vad-state-machine.h"
 
 namespace sherpa_onnx {
 
@@ -36,11 +40,12 @@ class TenVadModel::Impl {
   explicit Impl(const VadModelConfig &config)
       : config_(config),
         rfft_(1024),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{},
-        sample_rate_(config.sample_rate) {
-    auto buf = ReadFile(config.ten_vad.model);
+        sample_rate_(config.sample_rate),
+        slots_(kSlotSize) {
+    auto buf = MapFile(config.ten_vad.model);
     Init(buf.data(), buf.size());
   }
 
@@ -48,16 +53,17 @@ class TenVadModel::Impl {
   Impl(Manager *mgr, const VadModelConfig &config)
       : config_(config),
         rfft_(1024),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config)),
         allocator_{},
-        sample_rate_(config.sample_rate) {
+        sample_rate_(config.sample_rate),
+        slots_(kSlotSize) {
     auto buf = ReadFile(mgr, config.ten_vad.model);
     Init(buf.data(), buf.size());
   }
 
   float Run(const float *samples, int32_t n) {
-    ComputeFeatures(samples, n);
+    ComputeFeatures(samples, n, &last_sample_, last_features_.data());
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
@@ -89,10 +95,7 @@ class TenVadModel::Impl {
     return prob;
   }
   void Reset() {
-    triggered_ = false;
-    current_sample_ = 0;
-    temp_start_ = 0;
-    temp_end_ = 0;
+    state_machine_.Reset();
 
     last_sample_ = 0;
 
@@ -111,86 +114,117 @@ class TenVadModel::Impl {
 
     float prob = Run(samples, n);
 
-    float threshold = config_.ten_vad.threshold;
+    return state_machine_.IsSpeech(prob, config_.ten_vad.window_size,
+                                   config_.ten_vad.threshold,
+                                   min_speech_samples_, min_silence_samples_);
+  }
 
-    current_sample_ += config_.ten_vad.window_size;
+  int32_t WindowShift() const { return config_.ten_vad.window_size; }
 
-    if (prob > threshold && temp_end_ != 0) {
-      temp_end_ = 0;
-    }
+  int32_t WindowSize() const { return config_.ten_vad.window_size; }
 
-    if (prob > threshold && temp_start_ == 0) {
-      // start speaking, but we require that it must satisfy
-      // min_speech_duration
-      temp_start_ = current_sample_;
-      return false;
-    }
+  int32_t MinSilenceDurationSamples() const { return min_silence_samples_; }
 
-    if (prob > threshold && temp_start_ != 0 && !triggered_) {
-      if (current_sample_ - temp_start_ < min_speech_samples_) {
-        return false;
-      }
+  int32_t MinSpeechDurationSamples() const { return min_speech_samples_; }
 
-      triggered_ = true;
+  void SetMinSilenceDuration(float s) {
+    min_silence_samples_ = sample_rate_ * s;
+  }
 
-      return true;
-    }
+  void SetThreshold(float threshold) { config_.ten_vad.threshold = threshold; }
 
-    if ((prob < threshold) && !triggered_) {
-      // silence
-      temp_start_ = 0;
-      temp_end_ = 0;
-      return false;
-    }
+  int32_t AllocateSlot() {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    return slots_.Allocate();
+  }
 
-    if ((prob > threshold - 0.15) && triggered_) {
-      // speaking
-      return true;
-    }
+  void FreeSlot(int32_t slot) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    slots_.Free(slot);
+  }
+
+  void ResetSlot(int32_t slot) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    slots_.Reset(slot);
+  }
 
-    if ((prob > threshold) && !triggered_) {
-      // start speaking
-      triggered_ = true;
+  void Run(const float *const *samples, const int32_t *slots, int32_t n,
+           float *probs) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
 
-      return true;
+    // If the batch dimension of the model is fixed to 1, we run the
+    // streams one by one. The states are still kept in the slot table.
+    int32_t batch_size = support_batch_ ? n : 1;
+
+    for (int32_t i = 0; i < n; i += batch_size) {
+      int32_t this_batch_size = std::min(batch_size, n - i);
+      RunBatch(samples + i, slots + i, this_batch_size, probs + i);
     }
+  }
 
-    if ((prob < threshold) && triggered_) {
-      // stop to speak
-      if (temp_end_ == 0) {
-        temp_end_ = current_sample_;
-      }
-
-      if (current_sample_ - temp_end_ < min_silence_samples_) {
-        // continue speaking
-        return true;
-      }
-      // stopped speaking
-      temp_start_ = 0;
-      temp_end_ = 0;
-      triggered_ = false;
-      return false;
+ private:
+  // The states of a stream in the slot table:
+  //  - 4 model states, each of shape (1, 64)
+  //  - features of the last 3 frames, of shape (3, 41)
+  //  - the last sample of the previous window, used in pre-emphasis
+  static constexpr int32_t kStateDim = 64;
+  static constexpr int32_t kFeatureOffset = 4 * kStateDim;
+  static constexpr int32_t kLastSampleOffset = kFeatureOffset + 3 * 41;
+  static constexpr int32_t kSlotSize = kLastSampleOffset + 1;
+
+  void RunBatch(const float *const *samples, const int32_t *slots,
+                int32_t n, float *probs) {
+    int32_t window_size = WindowSize();
+    int32_t feature_size = 3 * 41;
+
+    x_buf_.resize(n * feature_size);
+    for (int32_t i = 0; i != n; ++i) {
+      float *s = slots_.Get(slots[i]);
+      ComputeFeatures(samples[i], window_size, s + kLastSampleOffset,
+                      s + kFeatureOffset);
+
+      std::copy(s + kFeatureOffset, s + kFeatureOffset + feature_size,
+                x_buf_.data() + i * feature_size);
     }
 
-    return false;
-  }
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-  int32_t WindowShift() const { return config_.ten_vad.window_size; }
+    std::array<int64_t, 3> x_shape = {n, 3, 41};
 
-  int32_t WindowSize() const { return config_.ten_vad.window_size; }
+    std::vector<Ort::Value> inputs;
+    inputs.reserve(input_names_.size());
 
-  int32_t MinSilenceDurationSamples() const { return min_silence_samples_; }
+    inputs.push_back(Ort::Value::CreateTensor(memory_info, x_buf_.data(),
+                                              x_buf_.size(), x_shape.data(),
+                                              x_shape.size()));
 
-  int32_t MinSpeechDurationSamples() const { return min_speech_samples_; }
+    std::array<int64_t, 2> state_shape = {n, kStateDim};
 
-  void SetMinSilenceDuration(float s) {
-    min_silence_samples_ = sample_rate_ * s;
-  }
+    state_buf_.resize(4 * n * kStateDim);
+    for (int32_t k = 0; k != 4; ++k) {
+      float *p = state_buf_.data() + k * n * kStateDim;
+      slots_.Gather(slots, n, k * kStateDim, 1, kStateDim, p);
 
-  void SetThreshold(float threshold) { config_.ten_vad.threshold = threshold; }
+      inputs.push_back(Ort::Value::CreateTensor(memory_info, p, n * kStateDim,
+                                                state_shape.data(),
+                                                state_shape.size()));
+    }
 
- private:
-  void Init(void *model_data, size_t model_data_length) {
+    auto out =
+        sess_->Run({}, input_names_ptr_.data(), inputs.data(), inputs.size(),
+                   output_names_ptr_.data(), output_names_ptr_.size());
+
+    for (int32_t k = 0; k != 4; ++k) {
+      slots_.Scatter(out[k + 1].GetTensorData<float>(), slots, n,
+                     k * kStateDim, 1, kStateDim);
+    }
+
+    const float *p = out[0].GetTensorData<float>();
+    std::copy(p, p + n, probs);
+  }
+
+  void Init(const void *model_data, size_t model_data_length) {
     if (sample_rate_ != 16000) {
       SHERPA_ONNX_LOGE("Expected sample rate 16000. Given: %d",
                        config_.sample_rate);
@@ -207,8 +241,7 @@ class TenVadModel::Impl {
 
     min_speech_samples_ = sample_rate_ * config_.ten_vad.min_speech_duration;
 
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
     GetOutputNames(sess_.get(), &output_names_, &output_names_ptr_);
@@ -217,6 +250,11 @@ class TenVadModel::Impl {
 
     Check();
 
+    // -1 means the batch dimension is dynamic
+    auto x_shape =
+        sess_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    support_batch_ = !x_shape.empty() && x_shape[0] != 1;
+
     Reset();
   }
 
@@ -319,16 +357,17 @@ class TenVadModel::Impl {
     }
   }
 
-  void Preemphasis(const float *samples, int32_t n, float *out) {
+  static void Preemphasis(const float *samples, int32_t n,
+                          float *last_sample, float *out) {
     float t = samples[n - 1];
 
     for (int32_t i = n - 1; i > 0; --i) {
       out[i] = samples[i] - 0.97 * samples[i - 1];
     }
 
-    out[0] = samples[0] - 0.97 * last_sample_;
+    out[0] = samples[0] - 0.97 * (*last_sample);
 
-    last_sample_ = t;
+    *last_sample = t;
   }
 
   static void ApplyWindow(const float *samples, const float *window, int32_t n,
@@ -363,12 +402,14 @@ class TenVadModel::Impl {
     }
   }
 
-  void ComputeFeatures(const float *samples, int32_t n) {
+  // last_sample and last_features are updated in place
+  void ComputeFeatures(const float *samples, int32_t n, float *last_sample,
+                       float *last_features) {
     std::fill(tmp_samples_.begin() + n, tmp_samples_.end(), 0.0f);
 
     Scale(samples, n, tmp_samples_.data());
 
-    Preemphasis(tmp_samples_.data(), n, tmp_samples_.data());
+    Preemphasis(tmp_samples_.data(), n, last_sample, tmp_samples_.data());
     ApplyWindow(tmp_samples_.data(), window_.data(), n, tmp_samples_.data());
 
     rfft_.Compute(tmp_samples_.data());
@@ -388,11 +429,10 @@ class TenVadModel::Impl {
 
     ApplyNormalization(features_.data(), features_.data());
 
-    std::memmove(last_features_.data(),
-                 last_features_.data() + features_.size(),
+    std::memmove(last_features, last_features + features_.size(),
                  2 * features_.size() * sizeof(float));
     std::copy(features_.begin(), features_.end(),
-              last_features_.begin() + 2 * features_.size());
+              last_features + 2 * features_.size());
   }
 
  private:
@@ -400,7 +440,7 @@ class TenVadModel::Impl {
   knf::Rfft rfft_;
   std::unique_ptr<knf::MelBanks> mel_banks_;
 
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
@@ -417,10 +457,7 @@ class TenVadModel::Impl {
   int32_t min_silence_samples_;
   int32_t min_speech_samples_;
 
-  bool triggered_ = false;
-  int32_t current_sample_ = 0;
-  int32_t temp_start_ = 0;
-  int32_t temp_end_ = 0;
+  VadStateMachine state_machine_;
 
   float last_sample_ = 0;
 
@@ -431,6 +468,15 @@ class TenVadModel::Impl {
   std::vector<float> features_;
   std::vector<float> last_features_;  // (3, 41), row major
   std::vector<float> tmp_samples_;    // (1024,)
+
+  // for multiple streams
+  // It protects slots_ and the buffers below, since streams may be
+  // created, destroyed and computed from different threads
+  std::mutex slots_mutex_;
+  VadSlotTable slots_;
+  bool support_batch_ = false;
+  std::vector<float> x_buf_;
+  std::vector<float> state_buf_;
 };
 
 TenVadModel::TenVadModel(const VadModelConfig &config)
@@ -472,6 +518,17 @@ float TenVadModel::Compute(const float *samples, int32_t n) {
   return impl_->Run(samples, n);
 }
 
+int32_t TenVadModel::AllocateSlot() { return impl_->AllocateSlot(); }
+
+void TenVadModel::FreeSlot(int32_t slot) { impl_->FreeSlot(slot); }
+
+void TenVadModel::ResetSlot(int32_t slot) { impl_->ResetSlot(slot); }
+
+void TenVadModel::Compute(const float *const *samples, const int32_t *slots,
+                          int32_t n, float *probs) {
+  impl_->Run(samples, slots, n, probs);
+}
+
 #if __ANDROID_API__ >= 9
 template TenVadModel::TenVadModel(AAssetManager *mgr,
                                   const VadModelConfig &config);
@@ -301,6 +301,14 @@ static bool IsSpecial(const std::string &w) {
   return ans || ans2;
 }
 
+// Return true if MergeCharactersIntoWords() does not merge w with the
+// characters before it
+static bool IsWordBoundary(const std::string &w) {
+  return w.size() >= 3 || (w.size() == 2 && !IsSpecial(w)) ||
+         (w.size() == 1 &&
+          (IsPunct(w[0]) || std::isspace(static_cast<uint8_t>(w[0]))));
+}
+
 static std::vector<std::string> MergeCharactersIntoWords(
     const std::vector<std::string> &words) {
   std::vector<std::string> ans;
@@ -311,9 +319,7 @@ static std::vector<std::string> MergeCharactersIntoWords(
 
   while (i < n) {
     const auto &w = words[i];
-    if (w.size() >= 3 || (w.size() == 2 && !IsSpecial(w)) ||
-        (w.size() == 1 &&
-         (IsPunct(w[0]) || std::isspace(static_cast<uint8_t>(w[0]))))) {
+    if (IsWordBoundary(w)) {
       if (prev != -1) {
         std::string t;
         for (; prev < i; ++prev) {
@@ -392,6 +398,28 @@ std::vector<std::string> SplitUtf8(const std::string &text) {
   return MergeCharactersIntoWords(ans);
 }
 
+bool IsSplitUtf8Boundary(const std::string &text) {
+  if (text.empty()) {
+    return false;
+  }
+
+  uint8_t c = text[0];
+  int32_t num_bytes = 0;
+  for (uint8_t i = 0x80; c & i; i >>= 1) {
+    ++num_bytes;
+  }
+
+  if (num_bytes == 0) {
+    num_bytes = 1;
+  } else if (num_bytes < 2 || num_bytes > 4 ||
+             num_bytes > static_cast<int32_t>(text.size())) {
+    // SplitUtf8() skips invalid bytes
+    return false;
+  }
+
+  return IsWordBoundary(text.substr(0, num_bytes));
+}
+
 std::string ToLowerCase(const std::string &s) {
   return ToString(ToLowerCase(ToWideString(s)));
 }
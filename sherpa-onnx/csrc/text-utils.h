@@ -121,6 +121,11 @@ bool ConvertStringToReal(const std::string &str, T *out);
 
 std::vector<std::string> SplitUtf8(const std::string &text);
 
+// Return true if the first character of text is never merged with
+// characters before it by SplitUtf8(), i.e., for any string a,
+// SplitUtf8(a + text) equals SplitUtf8(a) followed by SplitUtf8(text).
+bool IsSplitUtf8Boundary(const std::string &text);
+
 std::string ToLowerCase(const std::string &s);
 void ToLowerCase(std::string *in_out);
 
@@ -84,6 +84,29 @@ std::unique_ptr<VadModel> VadModel::Create(Manager *mgr,
   return nullptr;
 }
 
+int32_t VadModel::AllocateSlot() {
+  SHERPA_ONNX_LOGE("This VAD model does not support multiple streams");
+  SHERPA_ONNX_EXIT(-1);
+  return -1;
+}
+
+void VadModel::FreeSlot(int32_t /*slot*/) {
+  SHERPA_ONNX_LOGE("This VAD model does not support multiple streams");
+  SHERPA_ONNX_EXIT(-1);
+}
+
+void VadModel::ResetSlot(int32_t /*slot*/) {
+  SHERPA_ONNX_LOGE("This VAD model does not support multiple streams");
+  SHERPA_ONNX_EXIT(-1);
+}
+
+void VadModel::Compute(const float *const * /*samples*/,
+                       const int32_t * /*slots*/, int32_t /*n*/,
+                       float * /*probs*/) {
+  SHERPA_ONNX_LOGE("This VAD model does not support multiple streams");
+  SHERPA_ONNX_EXIT(-1);
+}
+
 #if __ANDROID_API__ >= 9
 template std::unique_ptr<VadModel> VadModel::Create(
     AAssetManager *mgr, const VadModelConfig &config);
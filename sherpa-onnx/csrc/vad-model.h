@@ -42,6 +42,32 @@ class VadModel {
   virtual int32_t MinSpeechDurationSamples() const = 0;
   virtual void SetMinSilenceDuration(float s) = 0;
   virtual void SetThreshold(float threshold) = 0;
+
+  // The methods below are for running many streams with a single model.
+  // Each stream owns a slot that keeps its model states so that windows
+  // from different streams can be processed in one batched call.
+  // They do not change the states used by IsSpeech() and Compute() above.
+  // They are thread-safe with respect to each other.
+
+  // Return a new slot whose states are set to the initial states.
+  virtual int32_t AllocateSlot();
+
+  virtual void FreeSlot(int32_t slot);
+
+  // Set the states of the given slot to the initial states.
+  virtual void ResetSlot(int32_t slot);
+
+  /**
+   * @param samples samples[i] points to WindowSize() samples of the i-th
+   *                stream
+   * @param slots   slots[i] is the slot of the i-th stream. All slots must
+   *                be distinct.
+   * @param n       Number of streams.
+   * @param probs   On return, probs[i] is the speech probability of the
+   *                i-th stream.
+   */
+  virtual void Compute(const float *const *samples, const int32_t *slots,
+                       int32_t n, float *probs);
 };
 
 }  // namespace sherpa_onnx
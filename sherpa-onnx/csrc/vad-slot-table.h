@@ -0,0 +1,101 @@
+// sherpa-onnx/csrc/vad-slot-table.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_VAD_SLOT_TABLE_H_
+#define SHERPA_ONNX_CSRC_VAD_SLOT_TABLE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+// It keeps the model states of many VAD streams. Each stream occupies
+// a slot of slot_size floats and all slots are stored in a single
+// contiguous buffer, so that the states of a batch of streams can be
+// gathered into (and scattered from) a batched tensor with plain copies.
+class VadSlotTable {
+ public:
+  explicit VadSlotTable(int32_t slot_size) : slot_size_(slot_size) {}
+
+  // Return the index of an unused slot. Its states are set to 0.
+  int32_t Allocate() {
+    int32_t slot;
+    if (!free_slots_.empty()) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      slot = num_slots_++;
+      data_.resize(static_cast<int64_t>(num_slots_) * slot_size_);
+    }
+
+    Reset(slot);
+
+    return slot;
+  }
+
+  void Free(int32_t slot) {
+    Check(slot);
+    free_slots_.push_back(slot);
+  }
+
+  void Reset(int32_t slot) {
+    Check(slot);
+    std::fill_n(Get(slot), slot_size_, 0.0f);
+  }
+
+  float *Get(int32_t slot) {
+    return data_.data() + static_cast<int64_t>(slot) * slot_size_;
+  }
+
+  /* Copy states of the given slots into a batched tensor.
+   *
+   * @param slots  slots[i] is the slot of the i-th stream
+   * @param n      Number of streams
+   * @param offset Offset of the state inside a slot
+   * @param num_rows  The state inside a slot is of shape (num_rows, dim)
+   * @param dim    See above
+   * @param dst    Of shape (num_rows, n, dim)
+   */
+  void Gather(const int32_t *slots, int32_t n, int32_t offset,
+              int32_t num_rows, int32_t dim, float *dst) {
+    for (int32_t r = 0; r != num_rows; ++r) {
+      for (int32_t i = 0; i != n; ++i) {
+        const float *src = Get(slots[i]) + offset + r * dim;
+        std::copy(src, src + dim, dst + (r * n + i) * dim);
+      }
+    }
+  }
+
+  // The inverse of Gather()
+  void Scatter(const float *src, const int32_t *slots, int32_t n,
+               int32_t offset, int32_t num_rows, int32_t dim) {
+    for (int32_t r = 0; r != num_rows; ++r) {
+      for (int32_t i = 0; i != n; ++i) {
+        const float *p = src + (r * n + i) * dim;
+        std::copy(p, p + dim, Get(slots[i]) + offset + r * dim);
+      }
+    }
+  }
+
+ private:
+  void Check(int32_t slot) const {
+    if (slot < 0 || slot >= num_slots_) {
+      SHERPA_ONNX_LOGE("Invalid VAD slot %d. Number of slots: %d", slot,
+                       num_slots_);
+      SHERPA_ONNX_EXIT(-1);
+    }
+  }
+
+ private:
+  int32_t slot_size_;
+  int32_t num_slots_ = 0;
+  std::vector<float> data_;
+  std::vector<int32_t> free_slots_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_VAD_SLOT_TABLE_H_
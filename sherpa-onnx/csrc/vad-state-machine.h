@@ -0,0 +1,100 @@
+// sherpa-onnx/csrc/vad-state-machine.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_VAD_STATE_MACHINE_H_
+#define SHERPA_ONNX_CSRC_VAD_STATE_MACHINE_H_
+
+#include <cstdint>
+
+namespace sherpa_onnx {
+
+// It decides whether a window is speech from the speech probability
+// computed by a VAD model, i.e., it detects the start and the end of
+// speech. It is used by all VAD models and by streams that share a model.
+class VadStateMachine {
+ public:
+  void Reset() {
+    triggered_ = false;
+    current_sample_ = 0;
+    temp_start_ = 0;
+    temp_end_ = 0;
+  }
+
+  /**
+   * @param prob  Speech probability of the current window
+   * @param window_shift  Number of new samples in the current window
+   * @param threshold  Windows with a probability above it are speech
+   * @param min_speech_samples  Speech is detected only after it lasts for
+   *                            this number of samples
+   * @param min_silence_samples  Speech ends only after silence lasts for
+   *                             this number of samples
+   *
+   * @return Return true if the current window is speech.
+   */
+  bool IsSpeech(float prob, int32_t window_shift, float threshold,
+                int32_t min_speech_samples, int32_t min_silence_samples) {
+    current_sample_ += window_shift;
+
+    if (prob > threshold && temp_end_ != 0) {
+      temp_end_ = 0;
+    }
+
+    if (prob > threshold && temp_start_ == 0) {
+      // start speaking, but we require that it must satisfy
+      // min_speech_duration
+      temp_start_ = current_sample_;
+      return false;
+    }
+
+    if (prob > threshold && temp_start_ != 0 && !triggered_) {
+      if (current_sample_ - temp_start_ < min_speech_samples) {
+        return false;
+      }
+
+      triggered_ = true;
+
+      return true;
+    }
+
+    if ((prob < threshold) && !triggered_) {
+      // silence
+      temp_start_ = 0;
+      temp_end_ = 0;
+      return false;
+    }
+
+    if ((prob > threshold - 0.15) && triggered_) {
+      // speaking
+      return true;
+    }
+
+    if ((prob < threshold) && triggered_) {
+      // stop to speak
+      if (temp_end_ == 0) {
+        temp_end_ = current_sample_;
+      }
+
+      if (current_sample_ - temp_end_ < min_silence_samples) {
+        // continue speaking
+        return true;
+      }
+      // stopped speaking
+      temp_start_ = 0;
+      temp_end_ = 0;
+      triggered_ = false;
+      return false;
+    }
+
+    return false;
+  }
+
+ private:
+  bool triggered_ = false;
+  int32_t current_sample_ = 0;
+  int32_t temp_start_ = 0;
+  int32_t temp_end_ = 0;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_VAD_STATE_MACHINE_H_
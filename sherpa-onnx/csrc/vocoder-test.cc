@@ -0,0 +1,138 @@
+// sherpa-onnx/csrc/vocoder-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/vocoder.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static constexpr int32_t kHopLength = 4;
+
+// Sample k of frame t is t * kHopLength + k plus a bias, where t is read
+// from the first feature of the frame. Without bias, it maps each frame to
+// its samples like a real vocoder, so chunking does not change the output.
+// With bias, the output of each call is shifted by the index of its first
+// frame, so that chunks differ where they are cross-faded.
+class FakeVocoder : public Vocoder {
+ public:
+  explicit FakeVocoder(bool bias) : bias_(bias) {}
+
+  std::vector<float> Run(Ort::Value mel) const override {
+    std::vector<int64_t> shape = mel.GetTensorTypeAndShapeInfo().GetShape();
+    int32_t num_frames = static_cast<int32_t>(shape[2]);
+    const float *p = mel.GetTensorData<float>();
+
+    float bias = bias_ ? p[0] : 0;
+
+    std::vector<float> ans(num_frames * kHopLength);
+    for (int32_t t = 0; t != num_frames; ++t) {
+      for (int32_t k = 0; k != kHopLength; ++k) {
+        ans[t * kHopLength + k] = p[t] * kHopLength + k + bias;
+      }
+    }
+
+    return ans;
+  }
+
+ private:
+  bool bias_;
+};
+
+// The first feature of frame t is t
+static Ort::Value CreateMel(int32_t num_frames) {
+  Ort::AllocatorWithDefaultOptions allocator;
+  int32_t feat_dim = 2;
+  std::array<int64_t, 3> shape = {1, feat_dim, num_frames};
+  Ort::Value mel =
+      Ort::Value::CreateTensor<float>(allocator, shape.data(), shape.size());
+
+  float *p = mel.GetTensorMutableData<float>();
+  for (int32_t t = 0; t != num_frames; ++t) {
+    p[t] = t;
+    p[num_frames + t] = -1;
+  }
+
+  return mel;
+}
+
+TEST(Vocoder, RunChunkedSameAsRun) {
+  FakeVocoder vocoder(false);
+  int32_t num_frames = 150;
+
+  std::vector<float> expected = vocoder.Run(CreateMel(num_frames));
+  ASSERT_EQ(static_cast<int32_t>(expected.size()), num_frames * kHopLength);
+
+  for (int32_t chunk_size : {0, 1, 7, 40, 117, 118, 200}) {
+    int32_t num_samples = 0;
+    float last_progress = 0;
+    std::vector<float> samples = vocoder.RunChunked(
+        CreateMel(num_frames), chunk_size,
+        [&](const float *s, int32_t n, float progress) {
+          for (int32_t i = 0; i != n; ++i) {
+            EXPECT_EQ(s[i], expected[num_samples + i]);
+          }
+          num_samples += n;
+
+          EXPECT_GT(progress, last_progress);
+          last_progress = progress;
+          return true;
+        });
+
+    EXPECT_EQ(samples, expected) << "chunk_size: " << chunk_size;
+    EXPECT_EQ(num_samples, static_cast<int32_t>(expected.size()));
+    EXPECT_EQ(last_progress, 1);
+  }
+}
+
+TEST(Vocoder, RunChunkedCrossFade) {
+  FakeVocoder vocoder(true);
+  int32_t num_frames = 150;
+  int32_t chunk_size = 40;
+  int32_t context = Vocoder::kChunkContext;
+
+  std::vector<float> samples =
+      vocoder.RunChunked(CreateMel(num_frames), chunk_size);
+  ASSERT_EQ(static_cast<int32_t>(samples.size()), num_frames * kHopLength);
+
+  for (int32_t i = 0; i != static_cast<int32_t>(samples.size()); ++i) {
+    int32_t t = i / kHopLength;
+    int32_t chunk = t / chunk_size;
+
+    // Bias of the chunk, i.e., the index of the first frame given to Run()
+    int32_t left = std::max(0, chunk * chunk_size - context);
+
+    float expected = i + left;
+
+    // The first frame of a chunk is cross-faded with the frame after the
+    // previous chunk
+    if (chunk > 0 && t == chunk * chunk_size) {
+      int32_t prev_left = std::max(0, (chunk - 1) * chunk_size - context);
+      float w = (i % kHopLength + 0.5f) / kHopLength;
+      expected = (i + prev_left) * (1 - w) + (i + left) * w;
+    }
+
+    EXPECT_FLOAT_EQ(samples[i], expected) << "i: " << i;
+  }
+}
+
+TEST(Vocoder, RunChunkedStop) {
+  FakeVocoder vocoder(false);
+  int32_t num_frames = 150;
+  int32_t chunk_size = 40;
+
+  int32_t num_calls = 0;
+  std::vector<float> samples = vocoder.RunChunked(
+      CreateMel(num_frames), chunk_size,
+      [&](const float *, int32_t, float) { return ++num_calls < 2; });
+
+  EXPECT_EQ(num_calls, 2);
+  EXPECT_EQ(static_cast<int32_t>(samples.size()), 2 * chunk_size * kHopLength);
+}
+
+}  // namespace sherpa_onnx
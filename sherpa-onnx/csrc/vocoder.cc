@@ -4,6 +4,12 @@
 
 #include "sherpa-onnx/csrc/vocoder.h"
 
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
 #include "android/asset_manager_jni.h"
@@ -17,6 +23,8 @@
 #include "sherpa-onnx/csrc/hifigan-vocoder.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/vocos-vocoder.h"
 
 namespace sherpa_onnx {
@@ -31,15 +39,12 @@ enum class ModelType : std::uint8_t {
 
 }  // namespace
 
-static ModelType GetModelType(char *model_data, size_t model_data_length,
+static ModelType GetModelType(const char *model_data, size_t model_data_length,
                               bool debug) {
-  Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
-  Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(1);
-  sess_opts.SetInterOpNumThreads(1);
+  Ort::Env &env = GetOrtEnv();
+  Ort::SessionOptions sess_opts = GetSessionOptions(1, "cpu");
 
-  auto sess = std::make_unique<Ort::Session>(env, model_data, model_data_length,
-                                             sess_opts);
+  auto sess = CreateSession(env, model_data, model_data_length, sess_opts);
 
   Ort::ModelMetadata meta_data = sess->GetModelMetadata();
   if (debug) {
@@ -74,14 +79,14 @@ static ModelType GetModelType(char *model_data, size_t model_data_length,
 }
 
 std::unique_ptr<Vocoder> Vocoder::Create(const OfflineTtsModelConfig &config) {
-  std::vector<char> buffer;
+  FileBuffer buffer;
   if (!config.matcha.vocoder.empty()) {
     SHERPA_ONNX_LOGE("Using matcha vocoder: %s", config.matcha.vocoder.c_str());
-    buffer = ReadFile(config.matcha.vocoder);
+    buffer = MapFile(config.matcha.vocoder);
   } else if (!config.zipvoice.vocoder.empty()) {
     SHERPA_ONNX_LOGE("Using zipvoice vocoder: %s",
                      config.zipvoice.vocoder.c_str());
-    buffer = ReadFile(config.zipvoice.vocoder);
+    buffer = MapFile(config.zipvoice.vocoder);
   } else {
     SHERPA_ONNX_LOGE("No vocoder model provided in the config!");
     exit(-1);
@@ -132,6 +137,93 @@ std::unique_ptr<Vocoder> Vocoder::Create(Manager *mgr,
   }
 }
 
+std::vector<float> Vocoder::RunChunked(
+    Ort::Value mel, int32_t chunk_size,
+    const ChunkCallback &callback /*= {}*/) const {
+  std::vector<int64_t> shape = mel.GetTensorTypeAndShapeInfo().GetShape();
+  int32_t feat_dim = static_cast<int32_t>(shape[1]);
+  int32_t num_frames = static_cast<int32_t>(shape[2]);
+
+  if (chunk_size <= 0 || num_frames <= chunk_size + kChunkContext) {
+    auto samples = Run(std::move(mel));
+    if (callback) {
+      callback(samples.data(), static_cast<int32_t>(samples.size()), 1.0);
+    }
+    return samples;
+  }
+
+  if (shape[0] != 1) {
+    SHERPA_ONNX_LOGE("Support only batch size 1, given: %d",
+                     static_cast<int32_t>(shape[0]));
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  auto memory_info =
+      Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+  const float *p = mel.GetTensorData<float>();
+  int32_t hop_length = HopLength();
+
+  std::vector<float> ans;
+  std::vector<float> buf;
+
+  // Samples after the end of the previous chunk. They are cross-faded
+  // with the beginning of the current chunk.
+  std::vector<float> tail;
+
+  for (int32_t start = 0; start < num_frames; start += chunk_size) {
+    int32_t end = std::min(start + chunk_size, num_frames);
+    int32_t left = std::max(0, start - kChunkContext);
+    int32_t right = std::min(num_frames, end + kChunkContext);
+    int32_t n = right - left;
+
+    buf.resize(feat_dim * n);
+    for (int32_t c = 0; c != feat_dim; ++c) {
+      const float *src = p + c * num_frames + left;
+      std::copy(src, src + n, buf.data() + c * n);
+    }
+
+    std::array<int64_t, 3> x_shape = {1, feat_dim, n};
+    Ort::Value x = Ort::Value::CreateTensor(memory_info, buf.data(),
+                                            buf.size(), x_shape.data(),
+                                            x_shape.size());
+
+    std::vector<float> out = Run(std::move(x));
+    int32_t num_samples = static_cast<int32_t>(out.size());
+
+    if (hop_length == 0) {
+      hop_length = num_samples / n;
+    }
+
+    // out[i] is sample (left * hop_length + i) of the whole output
+    int32_t begin = std::min((start - left) * hop_length, num_samples);
+    int32_t emit_end = num_samples;
+    int32_t keep_end = num_samples;
+    if (end != num_frames) {
+      // Keep one more frame for cross-fading with the next chunk
+      emit_end = std::min((end - left) * hop_length, num_samples);
+      keep_end = std::min(emit_end + hop_length, num_samples);
+    }
+
+    int32_t m = std::min(static_cast<int32_t>(tail.size()), emit_end - begin);
+    for (int32_t i = 0; i != m; ++i) {
+      float w = (i + 0.5f) / m;
+      out[begin + i] = tail[i] * (1 - w) + out[begin + i] * w;
+    }
+
+    tail.assign(out.begin() + emit_end, out.begin() + keep_end);
+
+    ans.insert(ans.end(), out.begin() + begin, out.begin() + emit_end);
+
+    if (callback && !callback(out.data() + begin, emit_end - begin,
+                              static_cast<float>(end) / num_frames)) {
+      break;
+    }
+  }
+
+  return ans;
+}
+
 #if __ANDROID_API__ >= 9
 template std::unique_ptr<Vocoder> Vocoder::Create(
     AAssetManager *mgr, const OfflineTtsModelConfig &config);
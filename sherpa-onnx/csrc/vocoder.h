@@ -5,6 +5,8 @@
 #ifndef SHERPA_ONNX_CSRC_VOCODER_H_
 #define SHERPA_ONNX_CSRC_VOCODER_H_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -28,6 +30,34 @@ class Vocoder {
    *  @return Return a float32 vector containing audio samples..
    */
   virtual std::vector<float> Run(Ort::Value mel) const = 0;
+
+  // It is called with the samples of each chunk in RunChunked().
+  // progress is in the range (0, 1]. Return false to stop.
+  using ChunkCallback =
+      std::function<bool(const float * /*samples*/, int32_t /*n*/,
+                         float /*progress*/)>;
+
+  /** Like Run(), but it processes at most chunk_size frames at a time.
+   *
+   * Each chunk is run together with kChunkContext frames of context on both
+   * sides, which are discarded afterwards, and neighboring chunks are
+   * cross-faded. It reduces the peak memory for long inputs and the samples
+   * of a chunk are passed to the callback as soon as the chunk is done.
+   *
+   * @param mel A float32 tensor of shape (1, feat_dim, num_frames).
+   * @param chunk_size Number of frames per chunk. If it is not positive,
+   *                   the whole input is processed at once.
+   * @param callback If not empty, it is called after each chunk.
+   * @return Return all samples that have been generated.
+   */
+  std::vector<float> RunChunked(Ort::Value mel, int32_t chunk_size,
+                                const ChunkCallback &callback = {}) const;
+
+  // Number of samples per frame. If it returns 0, it is inferred from the
+  // output of Run(), which must be num_frames * hop_length samples.
+  virtual int32_t HopLength() const { return 0; }
+
+  static constexpr int32_t kChunkContext = 32;
 };
 
 }  // namespace sherpa_onnx
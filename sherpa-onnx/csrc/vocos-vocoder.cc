@@ -21,6 +21,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/ort-env.h"
 #include "sherpa-onnx/csrc/session.h"
 
 namespace sherpa_onnx {
@@ -39,14 +40,14 @@ class VocosVocoder::Impl {
  public:
   explicit Impl(const OfflineTtsModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config.num_threads, config.provider)),
         allocator_{} {
-    std::vector<char> buffer;
+    FileBuffer buffer;
     if (!config.matcha.vocoder.empty()) {
-      buffer = ReadFile(config.matcha.vocoder);
+      buffer = MapFile(config.matcha.vocoder);
     } else if (!config.zipvoice.vocoder.empty()) {
-      buffer = ReadFile(config.zipvoice.vocoder);
+      buffer = MapFile(config.zipvoice.vocoder);
     } else {
       SHERPA_ONNX_LOGE("No vocoder model provided in the config!");
       exit(-1);
@@ -57,7 +58,7 @@ class VocosVocoder::Impl {
   template <typename Manager>
   explicit Impl(Manager *mgr, const OfflineTtsModelConfig &config)
       : config_(config),
-        env_(ORT_LOGGING_LEVEL_ERROR),
+        env_(GetOrtEnv()),
         sess_opts_(GetSessionOptions(config.num_threads, config.provider)),
         allocator_{} {
     std::vector<char> buffer;
@@ -121,10 +122,11 @@ class VocosVocoder::Impl {
     return istft.Compute(stft_result);
   }
 
+  int32_t HopLength() const { return meta_.hop_length; }
+
  private:
-  void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+  void Init(const void *model_data, size_t model_data_length) {
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -171,7 +173,7 @@ class VocosVocoder::Impl {
   OfflineTtsModelConfig config_;
   VocosModelMetaData meta_;
 
-  Ort::Env env_;
+  Ort::Env &env_;
   Ort::SessionOptions sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
@@ -197,6 +199,8 @@ std::vector<float> VocosVocoder::Run(Ort::Value mel) const {
   return impl_->Run(std::move(mel));
 }
 
+int32_t VocosVocoder::HopLength() const { return impl_->HopLength(); }
+
 #if __ANDROID_API__ >= 9
 template VocosVocoder::VocosVocoder(AAssetManager *mgr,
                                     const OfflineTtsModelConfig &config);
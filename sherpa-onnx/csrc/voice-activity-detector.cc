@@ -20,13 +20,15 @@
 #include "sherpa-onnx/csrc/circular-buffer.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/vad-model.h"
+#include "sherpa-onnx/csrc/vad-state-machine.h"
 
 namespace sherpa_onnx {
 
 class VoiceActivityDetector::Impl {
  public:
   explicit Impl(const VadModelConfig &config, float buffer_size_in_seconds = 60)
-      : model_(VadModel::Create(config)),
+      : own_model_(VadModel::Create(config)),
+        model_(own_model_.get()),
         config_(config),
         buffer_(buffer_size_in_seconds * config.sample_rate) {
     Init();
@@ -35,40 +37,64 @@ class VoiceActivityDetector::Impl {
   template <typename Manager>
   Impl(Manager *mgr, const VadModelConfig &config,
        float buffer_size_in_seconds = 60)
-      : model_(VadModel::Create(mgr, config)),
+      : own_model_(VadModel::Create(mgr, config)),
+        model_(own_model_.get()),
         config_(config),
         buffer_(buffer_size_in_seconds * config.sample_rate) {
     Init();
   }
 
+  Impl(std::unique_ptr<VadModel> model, const VadModelConfig &config,
+       float buffer_size_in_seconds)
+      : own_model_(std::move(model)),
+        model_(own_model_.get()),
+        config_(config),
+        buffer_(buffer_size_in_seconds * config.sample_rate) {
+    Init();
+  }
+
+  Impl(VadModel *model, const VadModelConfig &config,
+       float buffer_size_in_seconds)
+      : model_(model),
+        config_(config),
+        buffer_(buffer_size_in_seconds * config.sample_rate),
+        slot_(model->AllocateSlot()) {
+    Init();
+    ResetTrigger();
+  }
+
+  ~Impl() {
+    if (slot_ != -1) {
+      model_->FreeSlot(slot_);
+    }
+  }
+
   float Compute(const float *samples, int32_t n) {
     return model_->Compute(samples, n);
   }
 
   void AcceptWaveform(const float *samples, int32_t n) {
-    if (buffer_.Size() > max_utterance_length_) {
+    // note n is usually window_size and there is no need to use
+    // an extra buffer here
+    last_.insert(last_.end(), samples, samples + n);
+
+    if (slot_ != -1) {
+      // The model is shared by multiple streams. The owner of the model
+      // runs it on GetWindow() and invokes AcceptProbability().
+      return;
+    }
+
+    if (BufferSize() > max_utterance_length_) {
       model_->SetMinSilenceDuration(new_min_silence_duration_s_);
       model_->SetThreshold(new_threshold_);
     } else {
-      if (!config_.silero_vad.model.empty()) {
-        model_->SetMinSilenceDuration(config_.silero_vad.min_silence_duration);
-        model_->SetThreshold(config_.silero_vad.threshold);
-      } else if (!config_.ten_vad.model.empty()) {
-        model_->SetMinSilenceDuration(config_.ten_vad.min_silence_duration);
-        model_->SetThreshold(config_.ten_vad.threshold);
-      } else {
-        SHERPA_ONNX_LOGE("Unknown vad model");
-        SHERPA_ONNX_EXIT(-1);
-      }
+      model_->SetMinSilenceDuration(min_silence_duration_s_);
+      model_->SetThreshold(threshold_);
     }
 
     int32_t window_size = model_->WindowSize();
     int32_t window_shift = model_->WindowShift();
 
-    // note n is usually window_size and there is no need to use
-    // an extra buffer here
-    last_.insert(last_.end(), samples, samples + n);
-
     if (last_.size() < window_size) {
       return;
     }
@@ -86,47 +112,67 @@ class VoiceActivityDetector::Impl {
       is_speech = is_speech || this_window_is_speech;
     }
 
-    last_ = std::vector<float>(
-        p, static_cast<const float *>(last_.data()) + last_.size());
+    last_.erase(last_.begin(), last_.begin() + (p - last_.data()));
 
+    UpdateSegments(is_speech);
+  }
+
+  const float *GetWindow() const {
+    if (static_cast<int32_t>(last_.size()) < model_->WindowSize()) {
+      return nullptr;
+    }
+
+    return last_.data();
+  }
+
+  int32_t Slot() const { return slot_; }
+
+  void AcceptProbability(float prob) {
+    if (BufferSize() > max_utterance_length_) {
+      cur_min_silence_samples_ =
+          config_.sample_rate * new_min_silence_duration_s_;
+      cur_threshold_ = new_threshold_;
+    } else {
+      cur_min_silence_samples_ = config_.sample_rate * min_silence_duration_s_;
+      cur_threshold_ = threshold_;
+    }
+
+    int32_t window_shift = model_->WindowShift();
+
+    buffer_.Push(last_.data(), window_shift);
+    last_.erase(last_.begin(), last_.begin() + window_shift);
+
+    UpdateSegments(IsSpeech(prob));
+  }
+
+  void UpdateSegments(bool is_speech) {
     if (is_speech) {
       if (start_ == -1) {
         // beginning of speech
         start_ = std::max(buffer_.Tail() - 2 * model_->WindowSize() -
                               model_->MinSpeechDurationSamples(),
-                          buffer_.Head());
-        cur_segment_.start = start_;
+                          head_);
       }
-      int32_t num_samples = buffer_.Tail() - start_ - 1;
-      cur_segment_.samples = buffer_.Get(start_, num_samples);
     } else {
       // non-speech
 
-      cur_segment_.start = -1;
-      cur_segment_.samples.clear();
-
-      if (start_ != -1 && buffer_.Size()) {
+      if (start_ != -1 && BufferSize()) {
         // end of speech, save the speech segment
-        int32_t end = buffer_.Tail() - model_->MinSilenceDurationSamples();
-
-        std::vector<float> s = buffer_.Get(start_, end - start_);
-        SpeechSegment segment;
+        int32_t end = buffer_.Tail() - MinSilenceDurationSamples();
 
+        SpeechSegmentView segment;
         segment.start = start_;
-        segment.samples = std::move(s);
+        segment.samples = buffer_.View(start_, end - start_);
 
-        segments_.push(std::move(segment));
+        segments_.push(segment);
 
-        buffer_.Pop(end - buffer_.Head());
+        Release(end);
       }
 
       if (start_ == -1) {
         int32_t end = buffer_.Tail() - 2 * model_->WindowSize() -
                       model_->MinSpeechDurationSamples();
-        int32_t n = std::max(0, end - buffer_.Head());
-        if (n > 0) {
-          buffer_.Pop(n);
-        }
+        Release(end);
       }
 
       start_ = -1;
@@ -135,27 +181,54 @@ class VoiceActivityDetector::Impl {
 
   bool Empty() const { return segments_.empty(); }
 
-  void Pop() { segments_.pop(); }
+  void Pop() {
+    segments_.pop();
+    front_.start = -1;
+
+    Release(head_);
+  }
+
+  void Clear() {
+    std::queue<SpeechSegmentView>().swap(segments_);
+    front_.start = -1;
+
+    Release(head_);
+  }
+
+  const SpeechSegment &Front() const {
+    const auto &segment = segments_.front();
+
+    if (front_.start != segment.start) {
+      front_.start = segment.start;
+      front_.samples.resize(segment.samples.Size());
+      segment.samples.CopyTo(front_.samples.data());
+    }
 
-  void Clear() { std::queue<SpeechSegment>().swap(segments_); }
+    return front_;
+  }
 
-  const SpeechSegment &Front() const { return segments_.front(); }
+  const SpeechSegmentView &FrontView() const { return segments_.front(); }
 
   void Reset() {
-    std::queue<SpeechSegment>().swap(segments_);
+    std::queue<SpeechSegmentView>().swap(segments_);
+    front_.start = -1;
+
+    if (slot_ != -1) {
+      model_->ResetSlot(slot_);
+      ResetTrigger();
+    } else {
+      model_->Reset();
+    }
 
-    model_->Reset();
     buffer_.Reset();
+    head_ = 0;
     last_.clear();
 
     start_ = -1;
-
-    cur_segment_.start = -1;
-    cur_segment_.samples.clear();
   }
 
   void Flush() {
-    if (start_ == -1 || buffer_.Size() == 0) {
+    if (start_ == -1 || BufferSize() == 0) {
       return;
     }
 
@@ -164,25 +237,29 @@ class VoiceActivityDetector::Impl {
       return;
     }
 
-    std::vector<float> s = buffer_.Get(start_, end - start_);
-
-    SpeechSegment segment;
-
+    SpeechSegmentView segment;
     segment.start = start_;
-    segment.samples = std::move(s);
+    segment.samples = buffer_.View(start_, end - start_);
 
-    segments_.push(std::move(segment));
+    segments_.push(segment);
 
-    buffer_.Pop(end - buffer_.Head());
+    Release(end);
     start_ = -1;
-
-    cur_segment_.start = -1;
-    cur_segment_.samples.clear();
   }
 
   bool IsSpeechDetected() const { return start_ != -1; }
 
-  SpeechSegment CurrentSpeechSegment() const { return cur_segment_; }
+  SpeechSegment CurrentSpeechSegment() const {
+    SpeechSegment segment;
+    segment.start = start_;
+
+    if (start_ != -1) {
+      int32_t num_samples = buffer_.Tail() - start_ - 1;
+      segment.samples = buffer_.Get(start_, num_samples);
+    }
+
+    return segment;
+  }
 
   const VadModelConfig &GetConfig() const { return config_; }
 
@@ -191,31 +268,91 @@ class VoiceActivityDetector::Impl {
     if (!config_.silero_vad.model.empty()) {
       max_utterance_length_ =
           config_.sample_rate * config_.silero_vad.max_speech_duration;
+      min_silence_duration_s_ = config_.silero_vad.min_silence_duration;
+      threshold_ = config_.silero_vad.threshold;
     } else if (!config_.ten_vad.model.empty()) {
       max_utterance_length_ =
           config_.sample_rate * config_.ten_vad.max_speech_duration;
+      min_silence_duration_s_ = config_.ten_vad.min_silence_duration;
+      threshold_ = config_.ten_vad.threshold;
     } else {
       SHERPA_ONNX_LOGE("Unsupported VAD model");
       SHERPA_ONNX_EXIT(-1);
     }
   }
 
+  // Number of samples that are still needed by the detector itself
+  int32_t BufferSize() const { return buffer_.Tail() - head_; }
+
+  // Samples before pos are no longer needed by the detector. They are
+  // removed from buffer_ unless they belong to a segment that has not been
+  // popped yet.
+  void Release(int32_t pos) {
+    head_ = std::min(std::max(head_, pos), buffer_.Tail());
+
+    int32_t end = head_;
+    if (!segments_.empty()) {
+      end = std::min(end, segments_.front().start);
+    }
+
+    if (end > buffer_.Head()) {
+      buffer_.Pop(end - buffer_.Head());
+    }
+  }
+
+  int32_t MinSilenceDurationSamples() const {
+    return slot_ != -1 ? cur_min_silence_samples_
+                       : model_->MinSilenceDurationSamples();
+  }
+
+  void ResetTrigger() {
+    state_machine_.Reset();
+    cur_min_silence_samples_ = config_.sample_rate * min_silence_duration_s_;
+    cur_threshold_ = threshold_;
+  }
+
+  // Used only when the model is shared by multiple streams.
+  // The speech probability is computed by the caller.
+  bool IsSpeech(float prob) {
+    return state_machine_.IsSpeech(prob, model_->WindowShift(), cur_threshold_,
+                                   model_->MinSpeechDurationSamples(),
+                                   cur_min_silence_samples_);
+  }
+
  private:
-  std::queue<SpeechSegment> segments_;
+  // Samples of a segment stay in buffer_ until the segment is popped
+  std::queue<SpeechSegmentView> segments_;
 
-  // it is empty if no speech is detected
-  SpeechSegment cur_segment_;
+  // A copy of segments_.front(), created on demand by Front()
+  mutable SpeechSegment front_{-1, {}};
 
-  std::unique_ptr<VadModel> model_;
+  // It is empty if the model is shared by multiple streams
+  std::unique_ptr<VadModel> own_model_;
+  VadModel *model_ = nullptr;
   VadModelConfig config_;
   CircularBuffer buffer_;
+
+  // Samples in buffer_ before head_ are no longer needed by the
+  // detector itself. See Release().
+  int32_t head_ = 0;
+
   std::vector<float> last_;
 
   int max_utterance_length_ = -1;  // in samples
   float new_min_silence_duration_s_ = 0.1;
   float new_threshold_ = 0.90;
 
+  float min_silence_duration_s_ = 0;
+  float threshold_ = 0;
+
   int32_t start_ = -1;
+
+  // The following members are used only when the model is shared by
+  // multiple streams. slot_ is -1 otherwise.
+  int32_t slot_ = -1;
+  VadStateMachine state_machine_;
+  int32_t cur_min_silence_samples_ = 0;
+  float cur_threshold_ = 0;
 };
 
 VoiceActivityDetector::VoiceActivityDetector(
@@ -228,6 +365,17 @@ VoiceActivityDetector::VoiceActivityDetector(
     float buffer_size_in_seconds /*= 60*/)
     : impl_(std::make_unique<Impl>(mgr, config, buffer_size_in_seconds)) {}
 
+VoiceActivityDetector::VoiceActivityDetector(
+    std::unique_ptr<VadModel> model, const VadModelConfig &config,
+    float buffer_size_in_seconds /*= 60*/)
+    : impl_(std::make_unique<Impl>(std::move(model), config,
+                                   buffer_size_in_seconds)) {}
+
+VoiceActivityDetector::VoiceActivityDetector(VadModel *model,
+                                             const VadModelConfig &config,
+                                             float buffer_size_in_seconds)
+    : impl_(std::make_unique<Impl>(model, config, buffer_size_in_seconds)) {}
+
 VoiceActivityDetector::~VoiceActivityDetector() = default;
 
 void VoiceActivityDetector::AcceptWaveform(const float *samples, int32_t n) {
@@ -244,6 +392,10 @@ const SpeechSegment &VoiceActivityDetector::Front() const {
   return impl_->Front();
 }
 
+const SpeechSegmentView &VoiceActivityDetector::FrontView() const {
+  return impl_->FrontView();
+}
+
 void VoiceActivityDetector::Reset() const { impl_->Reset(); }
 
 void VoiceActivityDetector::Flush() const { impl_->Flush(); }
@@ -264,6 +416,16 @@ float VoiceActivityDetector::Compute(const float *samples, int32_t n) {
   return impl_->Compute(samples, n);
 }
 
+const float *VoiceActivityDetector::GetWindow() const {
+  return impl_->GetWindow();
+}
+
+int32_t VoiceActivityDetector::Slot() const { return impl_->Slot(); }
+
+void VoiceActivityDetector::AcceptProbability(float prob) {
+  impl_->AcceptProbability(prob);
+}
+
 #if __ANDROID_API__ >= 9
 template VoiceActivityDetector::VoiceActivityDetector(
     AAssetManager *mgr, const VadModelConfig &config,
@@ -7,15 +7,25 @@
 #include <memory>
 #include <vector>
 
+#include "sherpa-onnx/csrc/circular-buffer.h"
 #include "sherpa-onnx/csrc/vad-model-config.h"
 
 namespace sherpa_onnx {
 
+class VadModel;
+
 struct SpeechSegment {
   int32_t start;  // in samples
   std::vector<float> samples;
 };
 
+// Like SpeechSegment, but samples are not copied out of the internal
+// buffer of VoiceActivityDetector.
+struct SpeechSegmentView {
+  int32_t start = -1;  // in samples
+  CircularBufferView samples;
+};
+
 class VoiceActivityDetector {
  public:
   explicit VoiceActivityDetector(const VadModelConfig &config,
@@ -25,6 +35,12 @@ class VoiceActivityDetector {
   VoiceActivityDetector(Manager *mgr, const VadModelConfig &config,
                         float buffer_size_in_seconds = 60);
 
+  // Use the given model instead of creating one from config. Thresholds
+  // and durations are still taken from config.
+  VoiceActivityDetector(std::unique_ptr<VadModel> model,
+                        const VadModelConfig &config,
+                        float buffer_size_in_seconds = 60);
+
   ~VoiceActivityDetector();
 
   void AcceptWaveform(const float *samples, int32_t n);
@@ -40,6 +56,11 @@ class VoiceActivityDetector {
   // methods of VoiceActivityDetector.
   const SpeechSegment &Front() const;
 
+  // Like Front() but no samples are copied. The samples of the returned
+  // segment stay valid until the segment is removed by Pop(), Clear()
+  // or Reset().
+  const SpeechSegmentView &FrontView() const;
+
   bool IsSpeechDetected() const;
 
   // It is empty if IsSpeechDetected() returns false
@@ -54,6 +75,24 @@ class VoiceActivityDetector {
   const VadModelConfig &GetConfig() const;
 
  private:
+  friend class MultiStreamVoiceActivityDetector;
+
+  // Used by MultiStreamVoiceActivityDetector. The model is shared with
+  // other streams and it must outlive this object.
+  VoiceActivityDetector(VadModel *model, const VadModelConfig &config,
+                        float buffer_size_in_seconds);
+
+  // Return the next window to be processed by the model, which contains
+  // WindowSize() samples. Return nullptr if there are not enough samples.
+  const float *GetWindow() const;
+
+  // The slot of this stream in the shared model
+  int32_t Slot() const;
+
+  // Consume the window returned by GetWindow() given its speech
+  // probability.
+  void AcceptProbability(float prob);
+
   class Impl;
   std::unique_ptr<Impl> impl_;
 };
@@ -0,0 +1,193 @@
+// sherpa-onnx/csrc/wave-reader-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+// Write a wave file with the given format. data contains interleaved
+// samples that are already encoded.
+static void WriteWaveFile(const std::string &filename, int32_t sample_rate,
+                          int16_t num_channels, int16_t bits_per_sample,
+                          int16_t audio_format, const std::vector<char> &data) {
+  auto write = [](std::ofstream &os, auto v) {
+    os.write(reinterpret_cast<const char *>(&v), sizeof(v));
+  };
+
+  std::ofstream os(filename, std::ios::binary);
+  os.write("RIFF", 4);
+  write(os, static_cast<int32_t>(36 + data.size()));
+  os.write("WAVE", 4);
+  os.write("fmt ", 4);
+  write(os, static_cast<int32_t>(16));
+  write(os, audio_format);
+  write(os, num_channels);
+  write(os, sample_rate);
+  write(os, sample_rate * num_channels * bits_per_sample / 8);
+  write(os, static_cast<int16_t>(num_channels * bits_per_sample / 8));
+  write(os, bits_per_sample);
+  os.write("data", 4);
+  write(os, static_cast<int32_t>(data.size()));
+  os.write(data.data(), data.size());
+}
+
+// Check that WaveReader returns the same samples as ReadWaveMultiChannel()
+// when reading in chunks of various sizes
+static void Check(const std::string &filename, int32_t num_channels,
+                  int32_t num_samples) {
+  int32_t sample_rate = 0;
+  bool is_ok = false;
+  auto expected = ReadWaveMultiChannel(filename, &sample_rate, &is_ok);
+  ASSERT_TRUE(is_ok);
+  ASSERT_EQ(static_cast<int32_t>(expected.size()), num_channels);
+
+  WaveReader reader(filename);
+  ASSERT_TRUE(reader.IsOk());
+  EXPECT_EQ(reader.SampleRate(), sample_rate);
+  EXPECT_EQ(reader.NumChannels(), num_channels);
+  EXPECT_EQ(reader.NumSamples(), num_samples);
+
+  for (int32_t chunk_size : {1, 7, 100, num_samples + 10}) {
+    for (int32_t c = 0; c != num_channels; ++c) {
+      std::vector<float> samples;
+      std::vector<float> buf(chunk_size);
+      for (int64_t start = 0; start < reader.NumSamples();
+           start += chunk_size) {
+        int32_t n = reader.Read(start, chunk_size, buf.data(), c);
+        ASSERT_GT(n, 0);
+        samples.insert(samples.end(), buf.begin(), buf.begin() + n);
+      }
+      EXPECT_EQ(samples, expected[c]);
+    }
+  }
+
+  std::vector<float> buf(10);
+  EXPECT_EQ(reader.Read(reader.NumSamples(), 10, buf.data()), 0);
+}
+
+TEST(WaveReader, Int16) {
+  std::string filename = "sherpa-onnx-wave-reader-test-int16.wav";
+  std::vector<int16_t> samples = {0, 1, -1, 32767, -32768, 1000, -1000};
+
+  std::vector<char> data(samples.size() * sizeof(int16_t));
+  std::memcpy(data.data(), samples.data(), data.size());
+
+  WriteWaveFile(filename, 16000, 1, 16, 1, data);
+  Check(filename, 1, samples.size());
+
+  WaveReader reader(filename);
+  std::vector<float> buf(samples.size());
+  reader.Read(0, samples.size(), buf.data());
+  for (size_t i = 0; i != samples.size(); ++i) {
+    EXPECT_EQ(buf[i], samples[i] / 32768.0f);
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(WaveReader, Int16TwoChannels) {
+  std::string filename = "sherpa-onnx-wave-reader-test-int16-2.wav";
+  std::vector<int16_t> samples = {0, 1, -1, 32767, -32768, 1000, -1000, 5};
+
+  std::vector<char> data(samples.size() * sizeof(int16_t));
+  std::memcpy(data.data(), samples.data(), data.size());
+
+  WriteWaveFile(filename, 8000, 2, 16, 1, data);
+  Check(filename, 2, samples.size() / 2);
+
+  std::remove(filename.c_str());
+}
+
+TEST(WaveReader, Uint8) {
+  std::string filename = "sherpa-onnx-wave-reader-test-uint8.wav";
+  std::vector<char> data = {0, 1, 127, static_cast<char>(128),
+                            static_cast<char>(255)};
+
+  WriteWaveFile(filename, 16000, 1, 8, 1, data);
+  Check(filename, 1, data.size());
+
+  std::remove(filename.c_str());
+}
+
+TEST(WaveReader, Int24) {
+  std::string filename = "sherpa-onnx-wave-reader-test-int24.wav";
+  std::vector<int32_t> samples = {0, 1, -1, 8388607, -8388608, 12345};
+
+  std::vector<char> data;
+  for (int32_t s : samples) {
+    data.push_back(s & 0xff);
+    data.push_back((s >> 8) & 0xff);
+    data.push_back((s >> 16) & 0xff);
+  }
+
+  WriteWaveFile(filename, 16000, 1, 24, 1, data);
+  Check(filename, 1, samples.size());
+
+  WaveReader reader(filename);
+  std::vector<float> buf(samples.size());
+  reader.Read(0, samples.size(), buf.data());
+  for (size_t i = 0; i != samples.size(); ++i) {
+    EXPECT_EQ(buf[i], samples[i] / 8388608.0f);
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(WaveReader, Int32) {
+  std::string filename = "sherpa-onnx-wave-reader-test-int32.wav";
+  std::vector<int32_t> samples = {0, 1 << 30, -(1 << 30), 12345678};
+
+  std::vector<char> data(samples.size() * sizeof(int32_t));
+  std::memcpy(data.data(), samples.data(), data.size());
+
+  WriteWaveFile(filename, 16000, 1, 32, 1, data);
+  Check(filename, 1, samples.size());
+
+  WaveReader reader(filename);
+  std::vector<float> buf(samples.size());
+  reader.Read(0, samples.size(), buf.data());
+  EXPECT_EQ(buf[1], 0.5f);
+  EXPECT_EQ(buf[2], -0.5f);
+
+  std::remove(filename.c_str());
+}
+
+TEST(WaveReader, Float32) {
+  std::string filename = "sherpa-onnx-wave-reader-test-float32.wav";
+  std::vector<float> samples = {0, 0.5, -0.5, 0.25, -1, 0.999};
+
+  std::vector<char> data(samples.size() * sizeof(float));
+  std::memcpy(data.data(), samples.data(), data.size());
+
+  WriteWaveFile(filename, 16000, 1, 32, 3, data);
+  Check(filename, 1, samples.size());
+
+  std::remove(filename.c_str());
+}
+
+TEST(WaveReader, Invalid) {
+  WaveReader reader("sherpa-onnx-wave-reader-test-not-exist.wav");
+  EXPECT_FALSE(reader.IsOk());
+
+  std::string filename = "sherpa-onnx-wave-reader-test-invalid.wav";
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os << "not a wave file";
+  }
+
+  WaveReader reader2(filename);
+  EXPECT_FALSE(reader2.IsOk());
+
+  std::remove(filename.c_str());
+}
+
+}  // namespace sherpa_onnx
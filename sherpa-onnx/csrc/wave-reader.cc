@@ -4,12 +4,15 @@
 
 #include "sherpa-onnx/csrc/wave-reader.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
@@ -61,20 +64,19 @@ because sox uses WAVE_FORMAT_EXTENSIBLE, which is not easy to support
 in sherpa-onnx.
  */
 
-// Read a wave file of mono-channel.
-// Return its samples normalized to the range [-1, 1).
-std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
-                                             int32_t *sampling_rate,
-                                             bool *is_ok) {
-  WaveHeader header{};
+// Read the header of a wave file. On success, is points to the first
+// byte of the data chunk.
+//
+// Return true on success. Return false and print an error otherwise.
+bool ReadWaveHeader(std::istream &is, WaveHeader *p) {
+  WaveHeader &header = *p;
   is.read(reinterpret_cast<char *>(&header.chunk_id), sizeof(header.chunk_id));
 
   //                        F F I R
   if (header.chunk_id != 0x46464952) {
     SHERPA_ONNX_LOGE("Expected chunk_id RIFF. Given: 0x%08x\n",
                      header.chunk_id);
-    *is_ok = false;
-    return {};
+    return false;
   }
 
   is.read(reinterpret_cast<char *>(&header.chunk_size),
@@ -85,8 +87,7 @@ std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
   //                      E V A W
   if (header.format != 0x45564157) {
     SHERPA_ONNX_LOGE("Expected format WAVE. Given: 0x%08x\n", header.format);
-    *is_ok = false;
-    return {};
+    return false;
   }
 
   is.read(reinterpret_cast<char *>(&header.subchunk1_id),
@@ -109,8 +110,7 @@ std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
   if (header.subchunk1_id != 0x20746d66) {
     SHERPA_ONNX_LOGE("Expected subchunk1_id 0x20746d66. Given: 0x%08x\n",
                      header.subchunk1_id);
-    *is_ok = false;
-    return {};
+    return false;
   }
 
   // NAudio uses 18
@@ -119,8 +119,7 @@ std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
       header.subchunk1_size != 18) {  // 16 for PCM
     SHERPA_ONNX_LOGE("Expected subchunk1_size 16. Given: %d\n",
                      header.subchunk1_size);
-    *is_ok = false;
-    return {};
+    return false;
   }
 
   is.read(reinterpret_cast<char *>(&header.audio_format),
@@ -138,8 +137,7 @@ std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
       SHERPA_ONNX_LOGE("We don't support WAVE_FORMAT_EXTENSIBLE files.");
     }
 
-    *is_ok = false;
-    return {};
+    return false;
   }
 
   is.read(reinterpret_cast<char *>(&header.num_channels),
@@ -162,8 +160,7 @@ std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
     SHERPA_ONNX_LOGE("Incorrect byte rate: %d. Expected: %d", header.byte_rate,
                      (header.sample_rate * header.num_channels *
                       header.bits_per_sample / 8));
-    *is_ok = false;
-    return {};
+    return false;
   }
 
   if (header.block_align !=
@@ -171,16 +168,22 @@ std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
     SHERPA_ONNX_LOGE("Incorrect block align: %d. Expected: %d\n",
                      header.block_align,
                      (header.num_channels * header.bits_per_sample / 8));
-    *is_ok = false;
-    return {};
+    return false;
   }
 
   if (header.bits_per_sample != 8 && header.bits_per_sample != 16 &&
-      header.bits_per_sample != 32) {
-    SHERPA_ONNX_LOGE("Expected bits_per_sample 8, 16 or 32. Given: %d\n",
+      header.bits_per_sample != 24 && header.bits_per_sample != 32) {
+    SHERPA_ONNX_LOGE("Expected bits_per_sample 8, 16, 24 or 32. Given: %d\n",
                      header.bits_per_sample);
-    *is_ok = false;
-    return {};
+    return false;
+  }
+
+  if (header.audio_format == 3 && header.bits_per_sample != 32) {
+    SHERPA_ONNX_LOGE(
+        "Unsupported %d bits per sample and audio format: %d. Supported values "
+        "are: 8, 16, 24, 32 for audio format 1 and 32 for audio format 3.",
+        header.bits_per_sample, header.audio_format);
+    return false;
   }
 
   if (header.subchunk1_size == 18) {
@@ -195,8 +198,7 @@ std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
           "Extra size should be 0 for wave from NAudio. Current extra size "
           "%d\n",
           extra_size);
-      *is_ok = false;
-      return {};
+      return false;
     }
   }
 
@@ -207,126 +209,96 @@ std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
           sizeof(header.subchunk2_size));
 
   header.SeekToDataChunk(is);
-  if (!is) {
-    *is_ok = false;
-    return {};
-  }
 
-  *sampling_rate = header.sample_rate;
-
-  std::vector<std::vector<float>> ans(header.num_channels);
-
-  if (header.bits_per_sample == 16 && header.audio_format == 1) {
-    // header.subchunk2_size contains the number of bytes in the data.
-    // As we assume each sample contains two bytes, so it is divided by 2 here
-    std::vector<int16_t> samples(header.subchunk2_size / 2);
-
-    is.read(reinterpret_cast<char *>(samples.data()), header.subchunk2_size);
-    if (!is) {
-      SHERPA_ONNX_LOGE("Failed to read %d bytes", header.subchunk2_size);
-      *is_ok = false;
-      return {};
-    }
-
-    for (auto &v : ans) {
-      v.resize(samples.size() / header.num_channels);
-    }
+  return static_cast<bool>(is);
+}
 
-    // samples are interleaved
-    for (int32_t i = 0, k = 0; i < static_cast<int32_t>(samples.size());
-         i += header.num_channels, ++k) {
-      for (int32_t c = 0; c != header.num_channels; ++c) {
-        ans[c][k] = samples[i + c] / 32768.;
-      }
+// Convert num_samples samples of the given channel from interleaved PCM
+// data to float and write them to dst. Samples are normalized to the
+// range [-1, 1).
+//
+// We use memcpy() to read samples since data is not necessarily aligned.
+// Loops over mono data are vectorized by the compiler.
+void ConvertSamples(int32_t bits_per_sample, int32_t audio_format,
+                    int32_t block_align, const char *data, int64_t num_samples,
+                    int32_t channel, float *dst) {
+  const char *p = data + channel * (bits_per_sample / 8);
+
+  if (bits_per_sample == 16) {
+    for (int64_t i = 0; i != num_samples; ++i) {
+      int16_t s;
+      std::memcpy(&s, p + i * block_align, sizeof(s));
+      dst[i] = s / 32768.0f;
     }
-  } else if (header.bits_per_sample == 8 && header.audio_format == 1) {
-    // number of samples == number of bytes for 8-bit encoded samples
-    //
+  } else if (bits_per_sample == 8) {
     // For 8-bit encoded samples, they are unsigned!
-    std::vector<uint8_t> samples(header.subchunk2_size);
-
-    is.read(reinterpret_cast<char *>(samples.data()), header.subchunk2_size);
-    if (!is) {
-      SHERPA_ONNX_LOGE("Failed to read %d bytes", header.subchunk2_size);
-      *is_ok = false;
-      return {};
-    }
-
-    for (auto &v : ans) {
-      v.resize(samples.size() / header.num_channels);
-    }
-
-    // samples are interleaved
-    for (int32_t i = 0, k = 0; i < static_cast<int32_t>(samples.size());
-         i += header.num_channels, ++k) {
-      for (int32_t c = 0; c != header.num_channels; ++c) {
-        // Note(fangjun): We want to normalize each sample into the range [-1,
-        // 1] Since each original sample is in the range [0, 256], dividing them
-        // by 128 converts them to the range [0, 2]; so after subtracting 1, we
-        // get the range [-1, 1]
-        //
-        ans[c][k] = samples[i + c] / 128. - 1;
-      }
-    }
-  } else if (header.bits_per_sample == 32 && header.audio_format == 1) {
-    // 32 here is for int32
     //
-    // header.subchunk2_size contains the number of bytes in the data.
-    // As we assume each sample contains 4 bytes, so it is divided by 4 here
-    std::vector<int32_t> samples(header.subchunk2_size / 4);
-
-    is.read(reinterpret_cast<char *>(samples.data()), header.subchunk2_size);
-    if (!is) {
-      SHERPA_ONNX_LOGE("Failed to read %d bytes", header.subchunk2_size);
-      *is_ok = false;
-      return {};
+    // Note(fangjun): We want to normalize each sample into the range [-1,
+    // 1] Since each original sample is in the range [0, 256], dividing them
+    // by 128 converts them to the range [0, 2]; so after subtracting 1, we
+    // get the range [-1, 1]
+    for (int64_t i = 0; i != num_samples; ++i) {
+      uint8_t s = p[i * block_align];
+      dst[i] = s / 128.0f - 1;
     }
-
-    for (auto &v : ans) {
-      v.resize(samples.size() / header.num_channels);
+  } else if (bits_per_sample == 24) {
+    for (int64_t i = 0; i != num_samples; ++i) {
+      const uint8_t *q = reinterpret_cast<const uint8_t *>(p + i * block_align);
+      // Put the 3 bytes into the upper 24 bits of an int32 so that the sign
+      // is correct
+      uint32_t u = (static_cast<uint32_t>(q[0]) << 8) |
+                   (static_cast<uint32_t>(q[1]) << 16) |
+                   (static_cast<uint32_t>(q[2]) << 24);
+      dst[i] = static_cast<int32_t>(u) / 2147483648.0f;
     }
-
-    // samples are interleaved
-    for (int32_t i = 0, k = 0; i < static_cast<int32_t>(samples.size());
-         i += header.num_channels, ++k) {
-      for (int32_t c = 0; c != header.num_channels; ++c) {
-        ans[c][k] = static_cast<float>(samples[i + c]) / (1 << 31);
-      }
+  } else if (audio_format == 1) {
+    // 32 here is for int32
+    for (int64_t i = 0; i != num_samples; ++i) {
+      int32_t s;
+      std::memcpy(&s, p + i * block_align, sizeof(s));
+      dst[i] = s / 2147483648.0f;
     }
-  } else if (header.bits_per_sample == 32 && header.audio_format == 3) {
+  } else {
     // 32 here is for float32
-    //
-    // header.subchunk2_size contains the number of bytes in the data.
-    // As we assume each sample contains 4 bytes, so it is divided by 4 here
-    std::vector<float> samples(header.subchunk2_size / 4);
-
-    is.read(reinterpret_cast<char *>(samples.data()), header.subchunk2_size);
-    if (!is) {
-      SHERPA_ONNX_LOGE("Failed to read %d bytes", header.subchunk2_size);
-      *is_ok = false;
-      return {};
+    for (int64_t i = 0; i != num_samples; ++i) {
+      std::memcpy(dst + i, p + i * block_align, sizeof(float));
     }
+  }
+}
 
-    for (auto &v : ans) {
-      v.resize(samples.size() / header.num_channels);
-    }
+// Read a wave file of mono-channel.
+// Return its samples normalized to the range [-1, 1).
+std::vector<std::vector<float>> ReadWaveImpl(std::istream &is,
+                                             int32_t *sampling_rate,
+                                             bool *is_ok) {
+  WaveHeader header{};
+  if (!ReadWaveHeader(is, &header)) {
+    *is_ok = false;
+    return {};
+  }
 
-    // samples are interleaved
-    for (int32_t i = 0, k = 0; i < static_cast<int32_t>(samples.size());
-         i += header.num_channels, ++k) {
-      for (int32_t c = 0; c != header.num_channels; ++c) {
-        ans[c][k] = samples[i + c];
-      }
-    }
-  } else {
-    SHERPA_ONNX_LOGE(
-        "Unsupported %d bits per sample and audio format: %d. Supported values "
-        "are: 8, 16, 32.",
-        header.bits_per_sample, header.audio_format);
+  *sampling_rate = header.sample_rate;
+
+  // header.subchunk2_size contains the number of bytes in the data.
+  std::vector<char> data(static_cast<uint32_t>(header.subchunk2_size));
+
+  is.read(data.data(), data.size());
+  if (!is) {
+    SHERPA_ONNX_LOGE("Failed to read %d bytes", header.subchunk2_size);
     *is_ok = false;
     return {};
   }
 
+  int64_t num_samples = data.size() / header.block_align;
+
+  std::vector<std::vector<float>> ans(header.num_channels);
+  for (int32_t c = 0; c != header.num_channels; ++c) {
+    ans[c].resize(num_samples);
+    ConvertSamples(header.bits_per_sample, header.audio_format,
+                   header.block_align, data.data(), num_samples, c,
+                   ans[c].data());
+  }
+
   *is_ok = true;
   return ans;
 }
@@ -365,4 +337,55 @@ std::vector<std::vector<float>> ReadWaveMultiChannel(
   return ReadWaveMultiChannel(is, sampling_rate, is_ok);
 }
 
+WaveReader::WaveReader(const std::string &filename) {
+  if (!FileExists(filename)) {
+    SHERPA_ONNX_LOGE("'%s' does not exist", filename.c_str());
+    return;
+  }
+
+  std::ifstream is(filename, std::ifstream::binary);
+
+  WaveHeader header{};
+  if (!ReadWaveHeader(is, &header)) {
+    SHERPA_ONNX_LOGE("Failed to read the header of '%s'", filename.c_str());
+    return;
+  }
+
+  data_offset_ = is.tellg();
+  is.close();
+
+  file_ = MapFile(filename);
+
+  // Use the file size in case the data chunk is truncated
+  int64_t num_bytes =
+      std::min<int64_t>(static_cast<uint32_t>(header.subchunk2_size),
+                        static_cast<int64_t>(file_.size()) - data_offset_);
+
+  sample_rate_ = header.sample_rate;
+  num_channels_ = header.num_channels;
+  bits_per_sample_ = header.bits_per_sample;
+  audio_format_ = header.audio_format;
+  block_align_ = header.block_align;
+  num_samples_ = std::max<int64_t>(num_bytes, 0) / block_align_;
+
+  is_ok_ = true;
+}
+
+int32_t WaveReader::Read(int64_t start, int32_t n, float *dst,
+                         int32_t channel /*= 0*/) const {
+  if (!is_ok_ || start < 0 || start >= num_samples_ || n <= 0) {
+    return 0;
+  }
+
+  assert(channel >= 0 && channel < num_channels_);
+
+  n = static_cast<int32_t>(std::min<int64_t>(n, num_samples_ - start));
+
+  ConvertSamples(bits_per_sample_, audio_format_, block_align_,
+                 file_.data() + data_offset_ + start * block_align_, n,
+                 channel, dst);
+
+  return n;
+}
+
 }  // namespace sherpa_onnx
@@ -5,10 +5,13 @@
 #ifndef SHERPA_ONNX_CSRC_WAVE_READER_H_
 #define SHERPA_ONNX_CSRC_WAVE_READER_H_
 
+#include <cstdint>
 #include <istream>
 #include <string>
 #include <vector>
 
+#include "sherpa-onnx/csrc/file-utils.h"
+
 namespace sherpa_onnx {
 
 /** Read a wave file with expected sample rate.
@@ -33,6 +36,64 @@ std::vector<std::vector<float>> ReadWaveMultiChannel(std::istream &is,
 std::vector<std::vector<float>> ReadWaveMultiChannel(
     const std::string &filename, int32_t *sampling_rate, bool *is_ok);
 
+/** Read a wave file chunk by chunk.
+ *
+ * The file is memory mapped with MapFile() and samples are converted to
+ * float only when they are read, so memory usage does not grow with the
+ * length of the file. It supports the same formats as ReadWave().
+ *
+ * Usage:
+ *
+ *   WaveReader reader(filename);
+ *   if (!reader.IsOk()) { ... }
+ *
+ *   std::vector<float> buf(chunk_size);
+ *   for (int64_t start = 0; start < reader.NumSamples();
+ *        start += chunk_size) {
+ *     int32_t n = reader.Read(start, chunk_size, buf.data());
+ *     stream->AcceptWaveform(reader.SampleRate(), buf.data(), n);
+ *   }
+ */
+class WaveReader {
+ public:
+  explicit WaveReader(const std::string &filename);
+
+  // Return true if the header of the file is valid
+  bool IsOk() const { return is_ok_; }
+
+  int32_t SampleRate() const { return sample_rate_; }
+
+  int32_t NumChannels() const { return num_channels_; }
+
+  // Number of samples per channel
+  int64_t NumSamples() const { return num_samples_; }
+
+  /** Read samples [start, start + n) of the given channel.
+   *
+   * @param start Index of the first sample to read.
+   * @param n Number of samples to read.
+   * @param dst On return, it contains samples normalized to the range
+   *            [-1, 1). It must have space for n samples.
+   * @param channel The channel to read.
+   *
+   * @return Return the number of samples written to dst. It is less than n
+   *         at the end of the file.
+   */
+  int32_t Read(int64_t start, int32_t n, float *dst,
+               int32_t channel = 0) const;
+
+ private:
+  FileBuffer file_;
+  int64_t data_offset_ = 0;
+  int64_t num_samples_ = 0;
+  int32_t sample_rate_ = 0;
+  int32_t num_channels_ = 0;
+  int32_t bits_per_sample_ = 0;
+  int32_t audio_format_ = 0;
+  int32_t block_align_ = 0;
+  bool is_ok_ = false;
+};
+
 }  // namespace sherpa_onnx
 
 #endif  // SHERPA_ONNX_CSRC_WAVE_READER_H_
@@ -14,10 +14,17 @@ namespace sherpa_onnx {
 static void PybindFastClusteringConfig(py::module *m) {
   using PyClass = FastClusteringConfig;
   py::class_<PyClass>(*m, "FastClusteringConfig")
-      .def(py::init<int32_t, float>(), py::arg("num_clusters") = -1,
-           py::arg("threshold") = 0.5)
+      .def(py::init<int32_t, float, int32_t, int32_t, int32_t>(),
+           py::arg("num_clusters") = -1, py::arg("threshold") = 0.5,
+           py::arg("max_exact_num_rows") = 5000,
+           py::arg("num_centroids") = 1000,
+           py::arg("num_kmeans_iterations") = 10)
       .def_readwrite("num_clusters", &PyClass::num_clusters)
       .def_readwrite("threshold", &PyClass::threshold)
+      .def_readwrite("max_exact_num_rows", &PyClass::max_exact_num_rows)
+      .def_readwrite("num_centroids", &PyClass::num_centroids)
+      .def_readwrite("num_kmeans_iterations",
+                     &PyClass::num_kmeans_iterations)
       .def("__str__", &PyClass::ToString)
       .def("validate", &PyClass::Validate);
 }
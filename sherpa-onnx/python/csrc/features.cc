@@ -26,6 +26,7 @@ static void PybindFeatureExtractorConfig(py::module *m) {
       .def_readwrite("dither", &PyClass::dither)
       .def_readwrite("normalize_samples", &PyClass::normalize_samples)
       .def_readwrite("snip_edges", &PyClass::snip_edges)
+      .def_readwrite("use_fast_fbank", &PyClass::use_fast_fbank)
       .def("__str__", &PyClass::ToString);
 }
 
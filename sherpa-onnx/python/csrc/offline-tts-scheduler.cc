@@ -0,0 +1,80 @@
+// sherpa-onnx/python/csrc/offline-tts-scheduler.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#include "sherpa-onnx/python/csrc/offline-tts-scheduler.h"
+
+#include <algorithm>
+#include <string>
+
+#include "sherpa-onnx/csrc/offline-tts-scheduler.h"
+
+namespace sherpa_onnx {
+
+static void PybindOfflineTtsSchedulerConfig(py::module *m) {
+  using PyClass = OfflineTtsSchedulerConfig;
+  py::class_<PyClass>(*m, "OfflineTtsSchedulerConfig")
+      .def(py::init<>())
+      .def(py::init<int32_t, int32_t>(), py::arg("num_workers") = 2,
+           py::arg("max_wait_ms") = 500)
+      .def_readwrite("num_workers", &PyClass::num_workers)
+      .def_readwrite("max_wait_ms", &PyClass::max_wait_ms)
+      .def("validate", &PyClass::Validate)
+      .def("__str__", &PyClass::ToString);
+}
+
+static void PybindOfflineTtsSchedulerStats(py::module *m) {
+  using PyClass = OfflineTtsSchedulerStats;
+  py::class_<PyClass>(*m, "OfflineTtsSchedulerStats")
+      .def_readonly("num_submitted", &PyClass::num_submitted)
+      .def_readonly("num_finished", &PyClass::num_finished)
+      .def_readonly("num_queued", &PyClass::num_queued)
+      .def_readonly("num_running", &PyClass::num_running)
+      .def_readonly("avg_queue_wait_ms", &PyClass::avg_queue_wait_ms)
+      .def_readonly("max_queue_wait_ms", &PyClass::max_queue_wait_ms)
+      .def_readonly("occupancy", &PyClass::occupancy)
+      .def("__str__", &PyClass::ToString);
+}
+
+void PybindOfflineTtsScheduler(py::module *m) {
+  PybindOfflineTtsSchedulerConfig(m);
+  PybindOfflineTtsSchedulerStats(m);
+
+  using PyClass = OfflineTtsScheduler;
+  py::class_<PyClass>(*m, "OfflineTtsScheduler")
+      .def(py::init<const OfflineTts *, const OfflineTtsSchedulerConfig &>(),
+           py::arg("tts"), py::arg("config") = OfflineTtsSchedulerConfig(),
+           py::keep_alive<1, 2>(), py::call_guard<py::gil_scoped_release>())
+      .def(
+          "generate",
+          [](PyClass &self, const std::string &text, int64_t sid, float speed,
+             std::function<int32_t(py::array_t<float>, float)> callback)
+              -> GeneratedAudio {
+            if (!callback) {
+              return self.Generate(text, sid, speed);
+            }
+
+            std::function<int32_t(const float *, int32_t, float)>
+                callback_wrapper = [callback](const float *samples, int32_t n,
+                                              float progress) {
+                  // CAUTION(fangjun): we have to copy samples since it is
+                  // freed once the call back returns.
+
+                  pybind11::gil_scoped_acquire acquire;
+
+                  pybind11::array_t<float> array(n);
+                  py::buffer_info buf = array.request();
+                  auto p = static_cast<float *>(buf.ptr);
+                  std::copy(samples, samples + n, p);
+                  return callback(array, progress);
+                };
+
+            return self.Generate(text, sid, speed, callback_wrapper);
+          },
+          py::arg("text"), py::arg("sid") = 0, py::arg("speed") = 1.0,
+          py::arg("callback") = py::none(),
+          py::call_guard<py::gil_scoped_release>())
+      .def("get_stats", &PyClass::GetStats,
+           py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace sherpa_onnx
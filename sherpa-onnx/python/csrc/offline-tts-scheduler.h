@@ -0,0 +1,16 @@
+// sherpa-onnx/python/csrc/offline-tts-scheduler.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_PYTHON_CSRC_OFFLINE_TTS_SCHEDULER_H_
+#define SHERPA_ONNX_PYTHON_CSRC_OFFLINE_TTS_SCHEDULER_H_
+
+#include "sherpa-onnx/python/csrc/sherpa-onnx.h"
+
+namespace sherpa_onnx {
+
+void PybindOfflineTtsScheduler(py::module *m);
+
+}
+
+#endif  // SHERPA_ONNX_PYTHON_CSRC_OFFLINE_TTS_SCHEDULER_H_
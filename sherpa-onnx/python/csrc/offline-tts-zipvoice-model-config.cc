@@ -34,6 +34,9 @@ void PybindOfflineTtsZipvoiceModelConfig(py::module *m) {
       .def_readwrite("t_shift", &PyClass::t_shift)
       .def_readwrite("target_rms", &PyClass::target_rms)
       .def_readwrite("guidance_scale", &PyClass::guidance_scale)
+      .def_readwrite("solver", &PyClass::solver)
+      .def_readwrite("max_num_prompts", &PyClass::max_num_prompts)
+      .def_readwrite("prompt_dir", &PyClass::prompt_dir)
       .def("__str__", &PyClass::ToString)
       .def("validate", &PyClass::Validate);
 }
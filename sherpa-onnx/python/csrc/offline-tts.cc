@@ -42,6 +42,7 @@ static void PybindOfflineTtsConfig(py::module *m) {
       .def_readwrite("rule_fars", &PyClass::rule_fars)
       .def_readwrite("max_num_sentences", &PyClass::max_num_sentences)
       .def_readwrite("silence_scale", &PyClass::silence_scale)
+      .def_readwrite("vocoder_chunk_size", &PyClass::vocoder_chunk_size)
       .def("validate", &PyClass::Validate)
       .def("__str__", &PyClass::ToString);
 }
@@ -120,6 +121,40 @@ void PybindOfflineTts(py::module *m) {
           py::arg("text"), py::arg("prompt_text"), py::arg("prompt_samples"),
           py::arg("sample_rate"), py::arg("speed") = 1.0,
           py::arg("num_steps") = 4, py::arg("callback") = py::none(),
+          py::call_guard<py::gil_scoped_release>())
+      .def("register_prompt", &PyClass::RegisterPrompt, py::arg("name"),
+           py::arg("prompt_text"), py::arg("prompt_samples"),
+           py::arg("sample_rate"), py::call_guard<py::gil_scoped_release>())
+      .def(
+          "generate_with_prompt",
+          [](const PyClass &self, const std::string &text,
+             const std::string &name, float speed, int32_t num_steps,
+             std::function<int32_t(py::array_t<float>, float)> callback)
+              -> GeneratedAudio {
+            if (!callback) {
+              return self.GenerateWithPrompt(text, name, speed, num_steps);
+            }
+
+            std::function<int32_t(const float *, int32_t, float)>
+                callback_wrapper = [callback](const float *samples, int32_t n,
+                                              float progress) {
+                  // CAUTION(fangjun): we have to copy samples since it is
+                  // freed once the call back returns.
+
+                  pybind11::gil_scoped_acquire acquire;
+
+                  pybind11::array_t<float> array(n);
+                  py::buffer_info buf = array.request();
+                  auto p = static_cast<float *>(buf.ptr);
+                  std::copy(samples, samples + n, p);
+                  return callback(array, progress);
+                };
+
+            return self.GenerateWithPrompt(text, name, speed, num_steps,
+                                           callback_wrapper);
+          },
+          py::arg("text"), py::arg("name"), py::arg("speed") = 1.0,
+          py::arg("num_steps") = 4, py::arg("callback") = py::none(),
           py::call_guard<py::gil_scoped_release>());
 }
 
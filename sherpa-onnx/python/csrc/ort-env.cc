@@ -0,0 +1,46 @@
+// sherpa-onnx/python/csrc/ort-env.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/python/csrc/ort-env.h"
+
+#include <string>
+
+#include "sherpa-onnx/csrc/ort-env.h"
+
+namespace sherpa_onnx {
+
+static void PybindOrtEnvConfig(py::module *m) {
+  using PyClass = OrtEnvConfig;
+  py::class_<PyClass>(*m, "OrtEnvConfig")
+      .def(py::init<bool, int32_t, int32_t, const std::string &, bool,
+                    const std::string &>(),
+           py::arg("use_global_thread_pools") = false,
+           py::arg("intra_op_num_threads") = 0,
+           py::arg("inter_op_num_threads") = 0,
+           py::arg("intra_op_thread_affinity") = "",
+           py::arg("allow_spinning") = true,
+           py::arg("optimized_model_cache_dir") = "")
+      .def_readwrite("use_global_thread_pools",
+                     &PyClass::use_global_thread_pools)
+      .def_readwrite("intra_op_num_threads", &PyClass::intra_op_num_threads)
+      .def_readwrite("inter_op_num_threads", &PyClass::inter_op_num_threads)
+      .def_readwrite("intra_op_thread_affinity",
+                     &PyClass::intra_op_thread_affinity)
+      .def_readwrite("allow_spinning", &PyClass::allow_spinning)
+      .def_readwrite("optimized_model_cache_dir",
+                     &PyClass::optimized_model_cache_dir)
+      .def("validate", &PyClass::Validate)
+      .def("__str__", &PyClass::ToString);
+}
+
+void PybindOrtEnv(py::module *m) {
+  PybindOrtEnvConfig(m);
+
+  m->def("init_ort_env", &InitOrtEnv, py::arg("config"),
+         "Call it before creating any models. Return False if the config "
+         "is invalid or if it is called too late, in which case the config "
+         "is ignored.");
+}
+
+}  // namespace sherpa_onnx
@@ -26,6 +26,7 @@
 #include "sherpa-onnx/python/csrc/online-punctuation.h"
 #include "sherpa-onnx/python/csrc/online-recognizer.h"
 #include "sherpa-onnx/python/csrc/online-stream.h"
+#include "sherpa-onnx/python/csrc/ort-env.h"
 #include "sherpa-onnx/python/csrc/speaker-embedding-extractor.h"
 #include "sherpa-onnx/python/csrc/speaker-embedding-manager.h"
 #include "sherpa-onnx/python/csrc/spoken-language-identification.h"
@@ -36,6 +37,7 @@
 #include "sherpa-onnx/python/csrc/wave-writer.h"
 
 #if SHERPA_ONNX_ENABLE_TTS == 1
+#include "sherpa-onnx/python/csrc/offline-tts-scheduler.h"
 #include "sherpa-onnx/python/csrc/offline-tts.h"
 #endif
 
@@ -50,6 +52,8 @@ namespace sherpa_onnx {
 PYBIND11_MODULE(_sherpa_onnx, m) {
   m.doc() = "pybind11 binding of sherpa-onnx";
 
+  PybindOrtEnv(&m);
+
   PybindWaveWriter(&m);
   PybindAudioTagging(&m);
   PybindOfflinePunctuation(&m);
@@ -79,6 +83,7 @@ PYBIND11_MODULE(_sherpa_onnx, m) {
 
 #if SHERPA_ONNX_ENABLE_TTS == 1
   PybindOfflineTts(&m);
+  PybindOfflineTtsScheduler(&m);
 #else
   /* Define "empty" TTS sybmbols */
   m.attr("OfflineTtsKokoroModelConfig") = py::none();
@@ -88,6 +93,9 @@ PYBIND11_MODULE(_sherpa_onnx, m) {
   m.attr("GeneratedAudio") = py::none();
   m.attr("OfflineTtsConfig") = py::none();
   m.attr("OfflineTts") = py::none();
+  m.attr("OfflineTtsSchedulerConfig") = py::none();
+  m.attr("OfflineTtsSchedulerStats") = py::none();
+  m.attr("OfflineTtsScheduler") = py::none();
 #endif
 
   PybindSpeakerEmbeddingExtractor(&m);
@@ -5,6 +5,7 @@
 #include "sherpa-onnx/python/csrc/speaker-embedding-extractor.h"
 
 #include <string>
+#include <vector>
 
 #include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
 
@@ -35,8 +36,15 @@ void PybindSpeakerEmbeddingExtractor(py::module *m) {
       .def_property_readonly("dim", &PyClass::Dim)
       .def("create_stream", &PyClass::CreateStream,
            py::call_guard<py::gil_scoped_release>())
-      .def("compute", &PyClass::Compute,
+      .def("compute",
+           py::overload_cast<OnlineStream *>(&PyClass::Compute, py::const_),
            py::call_guard<py::gil_scoped_release>())
+      .def(
+          "compute_streams",
+          [](const PyClass &self, std::vector<OnlineStream *> ss) {
+            return self.Compute(ss.data(), ss.size());
+          },
+          py::arg("ss"), py::call_guard<py::gil_scoped_release>())
       .def("is_ready", &PyClass::IsReady,
            py::call_guard<py::gil_scoped_release>());
 }
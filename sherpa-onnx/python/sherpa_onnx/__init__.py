@@ -48,6 +48,9 @@ from sherpa_onnx.lib._sherpa_onnx import (
     OfflineTtsKokoroModelConfig,
     OfflineTtsMatchaModelConfig,
     OfflineTtsModelConfig,
+    OfflineTtsScheduler,
+    OfflineTtsSchedulerConfig,
+    OfflineTtsSchedulerStats,
     OfflineTtsVitsModelConfig,
     OfflineTtsZipvoiceModelConfig,
     OfflineWenetCtcModelConfig,
@@ -58,6 +61,7 @@ from sherpa_onnx.lib._sherpa_onnx import (
     OnlinePunctuationConfig,
     OnlinePunctuationModelConfig,
     OnlineStream,
+    OrtEnvConfig,
     SileroVadModelConfig,
     SpeakerEmbeddingExtractor,
     SpeakerEmbeddingExtractorConfig,
@@ -72,6 +76,7 @@ from sherpa_onnx.lib._sherpa_onnx import (
     VoiceActivityDetector,
     git_date,
     git_sha1,
+    init_ort_env,
     version,
     write_wave,
 )